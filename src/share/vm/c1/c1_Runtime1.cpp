@@ -51,6 +51,7 @@
 #include "runtime/compilationPolicy.hpp"
 #include "runtime/interfaceSupport.hpp"
 #include "runtime/javaCalls.hpp"
+#include "runtime/recoveryWriteBack.hpp"
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/threadCritical.hpp"
 #include "runtime/vframe.hpp"
@@ -512,6 +513,9 @@ JRT_ENTRY_NO_ASYNC(static address, exception_handler_for_pc_helper(JavaThread* t
   if (guard_pages_enabled) {
     address fast_continuation = nm->handler_for_exception_and_pc(exception, pc);
     if (fast_continuation != NULL) {
+      if (RecoveryWriteBack::is_enabled()) {
+        RecoveryWriteBack::compiled_dispatched(thread, nm, pc, exception, false);
+      }
       // Set flag if return address is a method handle call site.
       thread->set_is_method_handle_return(nm->is_method_handle_return(pc));
       return fast_continuation;
@@ -558,6 +562,9 @@ JRT_ENTRY_NO_ASYNC(static address, exception_handler_for_pc_helper(JavaThread* t
     if (continuation != NULL && original_exception() == exception()) {
       nm->add_handler_for_exception_and_pc(exception, pc, continuation);
     }
+    if (continuation != NULL && RecoveryWriteBack::is_enabled()) {
+      RecoveryWriteBack::compiled_dispatched(thread, nm, pc, exception, false);
+    }
   }
 
   thread->set_vm_result(exception());
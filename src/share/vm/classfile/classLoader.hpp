@@ -155,6 +155,7 @@ class ClassLoader: AllStatic {
   };
  protected:
   friend class LazyClassPathEntry;
+  friend class RecoveryMetadata;
 
   // Performance counters
   static PerfCounter* _perf_accumulated_time;
@@ -1226,6 +1226,11 @@ void java_lang_Throwable::set_message(oop throwable, oop value) {
 }
 
 
+void java_lang_Throwable::set_cause(oop throwable, oop value) {
+  throwable->obj_field_put(cause_offset, value);
+}
+
+
 void java_lang_Throwable::set_stacktrace(oop throwable, oop st_element_array) {
   throwable->obj_field_put(stackTrace_offset, st_element_array);
 }
@@ -1726,6 +1731,57 @@ void java_lang_Throwable::fill_in_stack_trace(Handle throwable, methodHandle met
   CLEAR_PENDING_EXCEPTION;
 }
 
+// The depth frames above the frame of method are skipped, and the frame
+// itself is recorded at bci, where the exception was constructed. If the
+// frame is not there the backtrace is left empty.
+void java_lang_Throwable::fill_in_stack_trace_from_frame(Handle throwable, Method* method, int bci, int depth) {
+  if (!StackTraceInThrowable) {
+    return;
+  }
+
+  PRESERVE_EXCEPTION_MARK;
+
+  JavaThread* thread = JavaThread::active();
+  ResourceMark rm(thread);
+
+  set_backtrace(throwable(), NULL);
+  if (!thread->has_last_Java_frame()) {
+    return;
+  }
+
+  vframeStream st(thread);
+  for (int i = 0; i < depth && !st.at_end(); i++) {
+    st.next();
+  }
+  if (st.at_end() || st.method() != method) {
+    return;
+  }
+
+  BacktraceBuilder bt(thread);
+  if (HAS_PENDING_EXCEPTION) {
+    CLEAR_PENDING_EXCEPTION;
+    return;
+  }
+
+  int total_count = 0;
+  bool top = true;
+  for (; !st.at_end() && total_count != MaxJavaStackTraceDepth; st.next(), top = false) {
+    Method* m = st.method();
+    if (m->is_hidden() && !ShowHiddenFrames) {
+      continue;
+    }
+    bt.push(m, top ? bci : st.bci(), thread);
+    if (HAS_PENDING_EXCEPTION) {
+      // ignore exceptions thrown during stack trace filling
+      CLEAR_PENDING_EXCEPTION;
+      return;
+    }
+    total_count++;
+  }
+
+  set_backtrace(throwable(), bt.backtrace());
+}
+
 void java_lang_Throwable::allocate_backtrace(Handle throwable, TRAPS) {
   // Allocate stack trace - backtrace is created but not filled in
 
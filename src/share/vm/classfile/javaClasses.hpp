@@ -518,6 +518,8 @@ class java_lang_Throwable: AllStatic {
   static oop message(oop throwable);
   static oop message(Handle throwable);
   static void set_message(oop throwable, oop value);
+  // Cause
+  static void set_cause(oop throwable, oop value);
   static void print_stack_element(outputStream *st, Handle mirror, int method,
                                   int version, int bci, int cpref);
   static void print_stack_element(outputStream *st, methodHandle method, int bci);
@@ -530,6 +532,9 @@ class java_lang_Throwable: AllStatic {
   // Fill in current stack trace, can cause GC
   static void fill_in_stack_trace(Handle throwable, methodHandle method, TRAPS);
   static void fill_in_stack_trace(Handle throwable, methodHandle method = methodHandle());
+  // Fill in the stack trace from the frame of method depth frames below the
+  // top, at bci, used for the backtraces deferred by LazyRecoveryBacktrace
+  static void fill_in_stack_trace_from_frame(Handle throwable, Method* method, int bci, int depth);
   // Programmatic access to stack trace
   static oop  get_stack_trace_element(oop throwable, int index, TRAPS);
   static int  get_stack_trace_depth(oop throwable, TRAPS);
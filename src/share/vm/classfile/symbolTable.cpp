@@ -31,13 +31,16 @@
 #include "memory/allocation.inline.hpp"
 #include "memory/filemap.hpp"
 #include "memory/gcLocker.inline.hpp"
+#include "memory/metaspaceShared.hpp"
 #include "oops/oop.inline.hpp"
 #include "oops/oop.inline2.hpp"
 #include "runtime/mutexLocker.hpp"
+#include "utilities/copy.hpp"
 #include "utilities/hashtable.inline.hpp"
 #if INCLUDE_ALL_GCS
+#include "gc_implementation/g1/g1CollectedHeap.hpp"
 #include "gc_implementation/g1/g1SATBCardTableModRefBS.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
@@ -753,11 +756,11 @@ oop StringTable::intern(Handle string_or_null, jchar* name,
   }
 
 #if INCLUDE_ALL_GCS
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     // Deduplicate the string before it is interned. Note that we should never
     // deduplicate a string after it has been interned. Doing so will counteract
     // compiler optimizations done on e.g. interned string literals.
-    G1StringDedup::deduplicate(string());
+    StringDedup::deduplicate(string());
   }
 #endif
 
@@ -847,9 +850,10 @@ void StringTable::buckets_oops_do(OopClosure* f, int start_idx, int end_idx) {
   for (int i = start_idx; i < end_idx; i += 1) {
     HashtableEntry<oop, mtSymbol>* entry = the_table()->bucket(i);
     while (entry != NULL) {
-      assert(!entry->is_shared(), "CDS not used for the StringTable");
-
-      f->do_oop((oop*)entry->literal_addr());
+      // Shared entries refer to archived strings, which never move.
+      if (!entry->is_shared()) {
+        f->do_oop((oop*)entry->literal_addr());
+      }
 
       entry = entry->next();
     }
@@ -871,23 +875,98 @@ void StringTable::buckets_unlink_or_oops_do(BoolObjectClosure* is_alive, OopClos
     HashtableEntry<oop, mtSymbol>** p = the_table()->bucket_addr(i);
     HashtableEntry<oop, mtSymbol>* entry = the_table()->bucket(i);
     while (entry != NULL) {
-      assert(!entry->is_shared(), "CDS not used for the StringTable");
-
-      if (is_alive->do_object_b(entry->literal())) {
+      // Shared entries refer to archived strings, which are always live
+      // and never move. They are at the end of the bucket unless the
+      // table has been rehashed, so keep walking.
+      if (entry->is_shared()) {
+        p = entry->next_addr();
+      } else if (is_alive->do_object_b(entry->literal())) {
         if (f != NULL) {
           f->do_oop((oop*)entry->literal_addr());
         }
         p = entry->next_addr();
       } else {
-        *p = entry->next();
+        // Keep the shared bit of a shared predecessor.
+        *p = (HashtableEntry<oop, mtSymbol>*)((intptr_t)entry->next() | ((intptr_t)*p & 1));
         the_table()->free_entry(entry);
         (*removed)++;
       }
       (*processed)++;
-      entry = *p;
+      entry = (HashtableEntry<oop, mtSymbol>*)HashtableEntry<oop, mtSymbol>::make_ptr(*p);
+    }
+  }
+}
+
+#if INCLUDE_CDS
+#if INCLUDE_ALL_GCS
+// Copy the string and its value array into the archive regions. The
+// copies only refer to each other, so they need no remembered set.
+oop StringTable::archive_string(oop s) {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  typeArrayOop v = java_lang_String::value(s);
+  int v_len = v->size();
+  int s_len = s->size();
+  if (g1h->is_archive_alloc_too_large(v_len)) {
+    return NULL;
+  }
+  HeapWord* v_copy = g1h->archive_mem_allocate(v_len);
+  if (v_copy == NULL) {
+    return NULL;
+  }
+  HeapWord* s_copy = g1h->archive_mem_allocate(s_len);
+  if (s_copy == NULL) {
+    return NULL;
+  }
+  Copy::aligned_disjoint_words((HeapWord*)v, v_copy, v_len);
+  Copy::aligned_disjoint_words((HeapWord*)s, s_copy, s_len);
+
+  // Drop any lock or identity hash of the originals.
+  oop new_v = oop(v_copy);
+  oop new_s = oop(s_copy);
+  new_v->set_mark(markOopDesc::prototype());
+  new_s->set_mark(markOopDesc::prototype());
+  new_s->obj_field_put_raw(java_lang_String::value_offset_in_bytes(), new_v);
+  if (java_lang_String::has_hash_field()) {
+    java_lang_String::set_hash(new_s, java_lang_String::hash_code(new_s));
+  }
+  return new_s;
+}
+#endif // INCLUDE_ALL_GCS
+
+MemRegion StringTable::archive_strings() {
+  assert(DumpSharedSpaces, "dump time only");
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
+#if INCLUDE_ALL_GCS
+  if (!MetaspaceShared::is_heap_object_archiving_allowed() || use_alternate_hashcode()) {
+    return MemRegion();
+  }
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  bool archived = true;
+  g1h->begin_archive_alloc_range();
+  for (int i = 0; i < the_table()->table_size() && archived; ++i) {
+    HashtableEntry<oop, mtSymbol>* entry = the_table()->bucket(i);
+    for ( ; entry != NULL; entry = entry->next()) {
+      oop new_s = archive_string(entry->literal());
+      if (new_s == NULL) {
+        archived = false;
+        break;
+      }
+      entry->set_literal(new_s);
     }
   }
+  MemRegion range = g1h->end_archive_alloc_range();
+  if (!archived) {
+    // The dumping VM exits afterwards, the copies made so far are simply
+    // left in the archive regions.
+    return MemRegion();
+  }
+  return range;
+#else
+  return MemRegion();
+#endif // INCLUDE_ALL_GCS
 }
+#endif // INCLUDE_CDS
 
 void StringTable::oops_do(OopClosure* f) {
   buckets_oops_do(f, 0, the_table()->table_size());
@@ -26,6 +26,7 @@
 #define SHARE_VM_CLASSFILE_SYMBOLTABLE_HPP
 
 #include "memory/allocation.inline.hpp"
+#include "memory/memRegion.hpp"
 #include "oops/symbol.hpp"
 #include "utilities/hashtable.hpp"
 
@@ -271,6 +272,10 @@ private:
 
   oop lookup(int index, jchar* chars, int length, unsigned int hashValue);
 
+#if INCLUDE_ALL_GCS
+  static oop archive_string(oop s);
+#endif // INCLUDE_ALL_GCS
+
   // Apply the give oop closure to the entries to the buckets
   // in the range [start_idx, end_idx).
   static void buckets_oops_do(OopClosure* f, int start_idx, int end_idx);
@@ -296,6 +301,17 @@ public:
     _the_table = new StringTable();
   }
 
+  static void create_table(HashtableBucket<mtSymbol>* t, int length,
+                           int number_of_entries) {
+    assert(_the_table == NULL, "One string table allowed.");
+
+    // If CDS archive used a different string table size, use that size instead
+    // which is better than giving an error.
+    StringTableSize = length/bucket_size();
+
+    _the_table = new StringTable(t, number_of_entries);
+  }
+
   // GC support
   //   Delete pointers to otherwise-unreachable objects.
   static void unlink_or_oops_do(BoolObjectClosure* cl, OopClosure* f) {
@@ -373,6 +389,9 @@ public:
   static void reverse() {
     the_table()->Hashtable<oop, mtSymbol>::reverse();
   }
+  // Copy the interned strings into archive regions of the heap and return
+  // the range they occupy, or an empty range if they can not be archived.
+  static MemRegion archive_strings() NOT_CDS_RETURN_(MemRegion());
 
   // Rehash the symbol table if it gets out of balance
   static void rehash_table();
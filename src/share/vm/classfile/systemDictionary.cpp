@@ -59,7 +59,11 @@
 #include "runtime/javaCalls.hpp"
 #include "runtime/mutexLocker.hpp"
 #include "runtime/orderAccess.inline.hpp"
+#include "runtime/recoveryDecisionCache.hpp"
+#include "runtime/recoveryEventLog.hpp"
+#include "runtime/recoveryOutcome.hpp"
 #include "runtime/signature.hpp"
+#include "runtime/transformedExceptionCache.hpp"
 #include "services/classLoadingService.hpp"
 #include "services/threadService.hpp"
 #include "utilities/macros.hpp"
@@ -1697,6 +1701,10 @@ bool SystemDictionary::do_unloading(BoolObjectClosure* is_alive, bool clean_aliv
     dictionary()->do_unloading();
     constraints()->purge_loader_constraints();
     resolution_errors()->purge_resolution_errors();
+    RecoveryDecisionCache::purge();
+    TransformedExceptionCache::purge();
+    RecoveryEventLog::purge();
+    RecoveryOutcome::purge();
   }
   // Oops referenced by the system dictionary may get unreachable independently
   // of the class loader (eg. cached protection domain oops). So we need to
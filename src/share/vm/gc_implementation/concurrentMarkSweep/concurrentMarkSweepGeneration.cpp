@@ -41,6 +41,7 @@
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/isGCActiveMark.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_interface/collectedHeap.inline.hpp"
 #include "memory/allocation.hpp"
 #include "memory/cardTableRS.hpp"
@@ -6288,6 +6289,12 @@ void CMSCollector::refProcessingWork(bool asynch, bool clear_all_soft_refs) {
     }
   }
 
+  if (StringDedup::is_enabled()) {
+    GCTraceTime t("scrub string dedup", PrintGCDetails, false, _gc_timer_cm, _gc_tracer_cm->gc_id());
+    // Delete entries for dead strings being deduplicated.
+    StringDedup::unlink(&_is_alive_closure);
+  }
+
 
   // Restore any preserved marks as a result of mark stack or
   // work queue overflow
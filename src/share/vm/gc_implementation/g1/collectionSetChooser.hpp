@@ -82,6 +82,20 @@ public:
     return res;
   }
 
+  // Return the candidate region offset positions after the current one
+  // without removing it from the CSet chooser, or NULL if there are not
+  // as many candidates.
+  HeapRegion* peek_at(uint offset) {
+    HeapRegion* res = NULL;
+    if (_curr_index + offset < _length) {
+      res = regions_at(_curr_index + offset);
+      assert(res != NULL,
+             err_msg("Unexpected NULL hr in _regions at index %u",
+                     _curr_index + offset));
+    }
+    return res;
+  }
+
   // Remove the given region from the CSet chooser and move to the
   // next one. The given region should be the current candidate region
   // in the CSet chooser.
@@ -104,12 +118,15 @@ public:
 
   // Determine whether to add the given region to the CSet chooser or
   // not. Currently, we skip humongous regions (we never add them to
-  // the CSet, we only reclaim them during cleanup) and regions whose
-  // live bytes are over the threshold.
+  // the CSet, we only reclaim them during cleanup), archive regions
+  // (which are never collected), pinned regions (whose objects can not
+  // move) and regions whose live bytes are over the threshold.
   bool should_add(HeapRegion* hr) {
     assert(hr->is_marked(), "pre-condition");
     assert(!hr->is_young(), "should never consider young regions");
     return !hr->isHumongous() &&
+           !hr->is_archive() &&
+           !hr->is_pinned() &&
             hr->live_bytes() < _region_live_threshold_bytes;
   }
 
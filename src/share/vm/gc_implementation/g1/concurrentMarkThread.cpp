@@ -31,6 +31,7 @@
 #include "gc_implementation/g1/vm_operations_g1.hpp"
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "memory/resourceArea.hpp"
+#include "runtime/init.hpp"
 #include "runtime/vmThread.hpp"
 
 // ======= Concurrent Mark Thread ========
@@ -45,6 +46,7 @@ ConcurrentMarkThread::ConcurrentMarkThread(ConcurrentMark* cm) :
   _cm(cm),
   _started(false),
   _in_progress(false),
+  _periodic_cycle(false),
   _vtime_accum(0.0),
   _vtime_mark_accum(0.0) {
   create_and_start();
@@ -75,6 +77,12 @@ public:
   }
 };
 
+class CMPeriodicUncommit: public VoidClosure {
+public:
+  void do_void(){
+    G1CollectedHeap::heap()->shrink_after_periodic_collection();
+  }
+};
 
 
 void ConcurrentMarkThread::run() {
@@ -271,7 +279,14 @@ void ConcurrentMarkThread::run() {
           gclog_or_tty->gclog_stamp(cm()->concurrent_gc_id());
           gclog_or_tty->print_cr("[GC concurrent-mark-abort]");
         }
+      } else if (_periodic_cycle) {
+        // The regions reclaimed by the cleanup are free now, give
+        // back what is beyond MaxHeapFreeRatio.
+        CMPeriodicUncommit uncommit_cl;
+        VM_CGC_Operation op(&uncommit_cl, "GC periodic uncommit", false /* needs_pll */);
+        VMThread::execute(&op);
       }
+      _periodic_cycle = false;
 
       // We now want to allow clearing of the marking bitmap to be
       // suspended by a collection pause.
@@ -336,7 +351,15 @@ void ConcurrentMarkThread::sleepBeforeNextCycle() {
 
   MutexLockerEx x(CGC_lock, Mutex::_no_safepoint_check_flag);
   while (!started() && !_should_terminate) {
-    CGC_lock->wait(Mutex::_no_safepoint_check_flag);
+    if (G1PeriodicGCInterval == 0) {
+      CGC_lock->wait(Mutex::_no_safepoint_check_flag);
+    } else {
+      CGC_lock->wait(Mutex::_no_safepoint_check_flag, (long)G1PeriodicGCInterval);
+      if (!started() && !_should_terminate && should_start_periodic_collection()) {
+        MutexUnlockerEx ul(CGC_lock, Mutex::_no_safepoint_check_flag);
+        start_periodic_collection();
+      }
+    }
   }
 
   if (started()) {
@@ -345,6 +368,44 @@ void ConcurrentMarkThread::sleepBeforeNextCycle() {
   }
 }
 
+bool ConcurrentMarkThread::should_start_periodic_collection() {
+  // The pause needs the SLT, which is created after VM initialization.
+  if (!is_init_completed() || _slt == NULL) {
+    return false;
+  }
+  if (G1CollectedHeap::heap()->millis_since_last_gc() < (jlong)G1PeriodicGCInterval) {
+    return false;
+  }
+  if (G1PeriodicGCSystemLoadThreshold > 0.0) {
+    double recent_load;
+    if (os::loadavg(&recent_load, 1) != -1 &&
+        recent_load > G1PeriodicGCSystemLoadThreshold) {
+      if (G1Log::finer()) {
+        gclog_or_tty->print_cr("[GC periodic collection skipped, system load %1.2lf]",
+                               recent_load);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConcurrentMarkThread::start_periodic_collection() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  uint gc_count_before;
+  {
+    MutexLockerEx ml(Heap_lock);
+    gc_count_before = g1h->total_collections();
+  }
+
+  VM_G1PeriodicCollection op(gc_count_before);
+  VMThread::execute(&op);
+  // started() was set by the pause, the uncommit follows the cycle.
+  if (op.cycle_started()) {
+    _periodic_cycle = true;
+  }
+}
+
 // Note: As is the case with CMS - this method, although exported
 // by the ConcurrentMarkThread, which is a non-JavaThread, can only
 // be called by a JavaThread. Currently this is done at vm creation
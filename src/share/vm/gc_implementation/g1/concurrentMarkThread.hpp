@@ -48,9 +48,16 @@ class ConcurrentMarkThread: public ConcurrentGCThread {
   ConcurrentMark*                  _cm;
   volatile bool                    _started;
   volatile bool                    _in_progress;
+  // Set when this thread started the cycle, see G1PeriodicGCInterval.
+  bool                             _periodic_cycle;
 
   void sleepBeforeNextCycle();
 
+  // Whether there was no collection for G1PeriodicGCInterval ms and the
+  // system load is below G1PeriodicGCSystemLoadThreshold.
+  bool should_start_periodic_collection();
+  void start_periodic_collection();
+
   static SurrogateLockerThread*         _slt;
 
  public:
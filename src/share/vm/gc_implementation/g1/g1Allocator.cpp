@@ -27,6 +27,7 @@
 #include "gc_implementation/g1/g1CollectedHeap.hpp"
 #include "gc_implementation/g1/g1CollectorPolicy.hpp"
 #include "gc_implementation/g1/heapRegion.inline.hpp"
+#include "gc_implementation/g1/heapRegionBounds.inline.hpp"
 #include "gc_implementation/g1/heapRegionSet.inline.hpp"
 
 void G1DefaultAllocator::init_mutator_alloc_region() {
@@ -110,6 +111,112 @@ void G1DefaultAllocator::abandon_gc_alloc_regions() {
   _retained_old_gc_alloc_region = NULL;
 }
 
+G1NUMAAllocator::G1NUMAAllocator(G1CollectedHeap* heap) :
+  G1Allocator(heap), _num_nodes(G1NUMA::num_active_nodes()) {
+  _mutator_alloc_regions = NEW_C_HEAP_ARRAY(MutatorAllocRegion, _num_nodes, mtGC);
+  _survivor_gc_alloc_regions = NEW_C_HEAP_ARRAY(SurvivorGCAllocRegion, _num_nodes, mtGC);
+  _old_gc_alloc_regions = NEW_C_HEAP_ARRAY(OldGCAllocRegion, _num_nodes, mtGC);
+  _retained_old_gc_alloc_regions = NEW_C_HEAP_ARRAY(HeapRegion*, _num_nodes, mtGC);
+  for (uint i = 0; i < _num_nodes; i++) {
+    ::new (&_mutator_alloc_regions[i]) MutatorAllocRegion();
+    ::new (&_survivor_gc_alloc_regions[i]) SurvivorGCAllocRegion();
+    ::new (&_old_gc_alloc_regions[i]) OldGCAllocRegion();
+    _mutator_alloc_regions[i].set_node_index(i);
+    _survivor_gc_alloc_regions[i].set_node_index(i);
+    _old_gc_alloc_regions[i].set_node_index(i);
+    _retained_old_gc_alloc_regions[i] = NULL;
+  }
+}
+
+void G1NUMAAllocator::init_mutator_alloc_region() {
+  for (uint i = 0; i < _num_nodes; i++) {
+    assert(_mutator_alloc_regions[i].get() == NULL, "pre-condition");
+    _mutator_alloc_regions[i].init();
+  }
+}
+
+void G1NUMAAllocator::release_mutator_alloc_region() {
+  for (uint i = 0; i < _num_nodes; i++) {
+    _mutator_alloc_regions[i].release();
+    assert(_mutator_alloc_regions[i].get() == NULL, "post-condition");
+  }
+}
+
+void G1NUMAAllocator::init_gc_alloc_regions(EvacuationInfo& evacuation_info) {
+  assert_at_safepoint(true /* should_be_vm_thread */);
+
+  size_t used_before = 0;
+  for (uint i = 0; i < _num_nodes; i++) {
+    _survivor_gc_alloc_regions[i].init();
+    _old_gc_alloc_regions[i].init();
+    reuse_retained_old_region(evacuation_info,
+                              &_old_gc_alloc_regions[i],
+                              &_retained_old_gc_alloc_regions[i]);
+    if (_old_gc_alloc_regions[i].get() != NULL) {
+      used_before += _old_gc_alloc_regions[i].get()->used();
+    }
+  }
+  evacuation_info.set_alloc_regions_used_before(used_before);
+}
+
+void G1NUMAAllocator::release_gc_alloc_regions(uint no_of_gc_workers, EvacuationInfo& evacuation_info) {
+  evacuation_info.set_allocation_regions(gc_alloc_region_count(InCSetState::Young) +
+                                         gc_alloc_region_count(InCSetState::Old));
+  for (uint i = 0; i < _num_nodes; i++) {
+    _survivor_gc_alloc_regions[i].release();
+    // See G1DefaultAllocator::release_gc_alloc_regions().
+    _retained_old_gc_alloc_regions[i] = _old_gc_alloc_regions[i].release();
+    if (_retained_old_gc_alloc_regions[i] != NULL) {
+      _retained_old_gc_alloc_regions[i]->record_retained_region();
+    }
+  }
+
+  if (ResizePLAB) {
+    _g1h->_survivor_plab_stats.adjust_desired_plab_sz(no_of_gc_workers);
+    _g1h->_old_plab_stats.adjust_desired_plab_sz(no_of_gc_workers);
+  }
+}
+
+void G1NUMAAllocator::abandon_gc_alloc_regions() {
+  for (uint i = 0; i < _num_nodes; i++) {
+    assert(_survivor_gc_alloc_regions[i].get() == NULL, "pre-condition");
+    assert(_old_gc_alloc_regions[i].get() == NULL, "pre-condition");
+    _retained_old_gc_alloc_regions[i] = NULL;
+  }
+}
+
+bool G1NUMAAllocator::is_retained_old_region(HeapRegion* hr) {
+  for (uint i = 0; i < _num_nodes; i++) {
+    if (_retained_old_gc_alloc_regions[i] == hr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint G1NUMAAllocator::gc_alloc_region_count(InCSetState dest) {
+  uint count = 0;
+  for (uint i = 0; i < _num_nodes; i++) {
+    count += dest.is_young() ? _survivor_gc_alloc_regions[i].count() : _old_gc_alloc_regions[i].count();
+  }
+  return count;
+}
+
+size_t G1NUMAAllocator::used() {
+  assert(Heap_lock->owner() != NULL,
+         "Should be owned on this thread's behalf.");
+  size_t result = _summary_bytes_used;
+
+  for (uint i = 0; i < _num_nodes; i++) {
+    // Read only once in case it is set to NULL concurrently
+    HeapRegion* hr = _mutator_alloc_regions[i].get();
+    if (hr != NULL) {
+      result += hr->used();
+    }
+  }
+  return result;
+}
+
 G1ParGCAllocBuffer::G1ParGCAllocBuffer(size_t gclab_word_size) :
   ParGCAllocBuffer(gclab_word_size), _retired(true) { }
 
@@ -149,6 +256,100 @@ G1DefaultParGCAllocator::G1DefaultParGCAllocator(G1CollectedHeap* g1h) :
   _alloc_buffers[InCSetState::Old]  = &_tenured_alloc_buffer;
 }
 
+bool G1ArchiveAllocator::_archive_check_enabled = false;
+G1ArchiveRegionMap G1ArchiveAllocator::_archive_region_map;
+
+bool G1ArchiveAllocator::is_archive_alloc_too_large(size_t word_size) {
+  return word_size >= (HeapRegionBounds::min_size() >> LogHeapWordSize) / 2;
+}
+
+bool G1ArchiveAllocator::alloc_new_region() {
+  uint index;
+  if (_allocation_region == NULL) {
+    index = _g1h->max_regions() - 1;
+  } else if (_allocation_region->hrm_index() > 0) {
+    index = _allocation_region->hrm_index() - 1;
+  } else {
+    return false;
+  }
+
+  HeapWord* bottom = _g1h->bottom_addr_for_region(index);
+  if (!_g1h->alloc_archive_regions(MemRegion(bottom, HeapRegion::GrainWords))) {
+    return false;
+  }
+  _allocation_region = _g1h->region_at(index);
+  if (_range_end == NULL) {
+    _range_end = _allocation_region->end();
+  }
+  _top = _allocation_region->end();
+  _chunk_bottom = _top - (HeapRegionBounds::min_size() >> LogHeapWordSize);
+  return true;
+}
+
+bool G1ArchiveAllocator::alloc_new_chunk() {
+  if (_top > _chunk_bottom) {
+    CollectedHeap::fill_with_objects(_chunk_bottom, pointer_delta(_top, _chunk_bottom));
+  }
+  _top = _chunk_bottom;
+  if (_chunk_bottom == _allocation_region->bottom()) {
+    return alloc_new_region();
+  }
+  _chunk_bottom -= HeapRegionBounds::min_size() >> LogHeapWordSize;
+  return true;
+}
+
+HeapWord* G1ArchiveAllocator::archive_mem_allocate(size_t word_size) {
+  assert(!is_archive_alloc_too_large(word_size),
+         err_msg("archive allocation of " SIZE_FORMAT " words is too large", word_size));
+  assert(word_size >= CollectedHeap::min_fill_size(), "object smaller than a filler");
+  if (_failed) {
+    return NULL;
+  }
+  if (_allocation_region == NULL && !alloc_new_region()) {
+    _failed = true;
+    return NULL;
+  }
+
+  // The rest of a chunk must be either empty or large enough to be
+  // filled with a dummy object.
+  size_t free_words = pointer_delta(_top, _chunk_bottom);
+  if (free_words < word_size ||
+      (free_words > word_size && free_words - word_size < CollectedHeap::min_fill_size())) {
+    if (!alloc_new_chunk()) {
+      _failed = true;
+      return NULL;
+    }
+  }
+  _top -= word_size;
+  return _top;
+}
+
+MemRegion G1ArchiveAllocator::complete_archive() {
+  if (_allocation_region == NULL || _top == _range_end) {
+    return MemRegion();
+  }
+  // Fill the rest of the current chunk, so that the range starts at a
+  // chunk boundary and can be mapped at the same address at run time.
+  if (_top > _chunk_bottom) {
+    CollectedHeap::fill_with_objects(_chunk_bottom, pointer_delta(_top, _chunk_bottom));
+  }
+  MemRegion range(_chunk_bottom, _range_end);
+  _g1h->fill_archive_regions(range);
+  return range;
+}
+
+void G1ArchiveAllocator::set_range_archive(MemRegion range) {
+  if (!_archive_check_enabled) {
+    MemRegion reserved = G1CollectedHeap::heap()->reserved_region();
+    _archive_region_map.initialize(reserved.start(), reserved.end(), HeapRegion::GrainBytes);
+    _archive_check_enabled = true;
+  }
+  for (HeapWord* addr = range.start(); addr < range.end(); addr += HeapRegion::GrainWords) {
+    _archive_region_map.set_by_address(addr, true);
+  }
+  _archive_region_map.set_by_address(range.last(), true);
+}
+
 void G1DefaultParGCAllocator::retire_alloc_buffers() {
   for (uint state = 0; state < InCSetState::Num; state++) {
     G1ParGCAllocBuffer* const buf = _alloc_buffers[state];
@@ -27,7 +27,9 @@
 
 #include "gc_implementation/g1/g1AllocationContext.hpp"
 #include "gc_implementation/g1/g1AllocRegion.hpp"
+#include "gc_implementation/g1/g1BiasedArray.hpp"
 #include "gc_implementation/g1/g1InCSetState.hpp"
+#include "gc_implementation/g1/g1NUMA.hpp"
 #include "gc_implementation/shared/parGCAllocBuffer.hpp"
 
 // Base class for G1 allocators.
@@ -59,6 +61,9 @@ public:
    virtual size_t                 used() = 0;
    virtual bool                   is_retained_old_region(HeapRegion* hr) = 0;
 
+   // The number of regions allocated for dest since init_gc_alloc_regions().
+   virtual uint                   gc_alloc_region_count(InCSetState dest) = 0;
+
    void                           reuse_retained_old_region(EvacuationInfo& evacuation_info,
                                                             OldGCAllocRegion* old,
                                                             HeapRegion** retained);
@@ -130,6 +135,10 @@ public:
     return &_old_gc_alloc_region;
   }
 
+  virtual uint gc_alloc_region_count(InCSetState dest) {
+    return dest.is_young() ? _survivor_gc_alloc_region.count() : _old_gc_alloc_region.count();
+  }
+
   virtual size_t used() {
     assert(Heap_lock->owner() != NULL,
            "Should be owned on this thread's behalf.");
@@ -144,6 +153,48 @@ public:
   }
 };
 
+// The allocator for G1 with UseNUMA.  It keeps one mutator, survivor and
+// old alloc region per NUMA node, which take their regions from that node
+// if possible.  Threads allocate in the regions of the node they run on,
+// see G1NUMA.
+class G1NUMAAllocator : public G1Allocator {
+protected:
+  uint                   _num_nodes;
+
+  MutatorAllocRegion*    _mutator_alloc_regions;
+  SurvivorGCAllocRegion* _survivor_gc_alloc_regions;
+  OldGCAllocRegion*      _old_gc_alloc_regions;
+  HeapRegion**           _retained_old_gc_alloc_regions;
+
+public:
+  G1NUMAAllocator(G1CollectedHeap* heap);
+
+  virtual void init_mutator_alloc_region();
+  virtual void release_mutator_alloc_region();
+
+  virtual void init_gc_alloc_regions(EvacuationInfo& evacuation_info);
+  virtual void release_gc_alloc_regions(uint no_of_gc_workers, EvacuationInfo& evacuation_info);
+  virtual void abandon_gc_alloc_regions();
+
+  virtual bool is_retained_old_region(HeapRegion* hr);
+
+  virtual MutatorAllocRegion* mutator_alloc_region(AllocationContext_t context) {
+    return &_mutator_alloc_regions[G1NUMA::index_of_current_thread()];
+  }
+
+  virtual SurvivorGCAllocRegion* survivor_gc_alloc_region(AllocationContext_t context) {
+    return &_survivor_gc_alloc_regions[G1NUMA::index_of_current_thread()];
+  }
+
+  virtual OldGCAllocRegion* old_gc_alloc_region(AllocationContext_t context) {
+    return &_old_gc_alloc_regions[G1NUMA::index_of_current_thread()];
+  }
+
+  virtual uint gc_alloc_region_count(InCSetState dest);
+
+  virtual size_t used();
+};
+
 class G1ParGCAllocBuffer: public ParGCAllocBuffer {
 private:
   bool _retired;
@@ -274,4 +325,78 @@ public:
   virtual void retire_alloc_buffers() ;
 };
 
+// Tells which regions of the heap are archive regions, for the archive
+// object check of full GCs.
+class G1ArchiveRegionMap : public G1BiasedMappedArray<bool> {
+protected:
+  bool default_value() const { return false; }
+};
+
+// Allocates the objects written to the CDS archive at dump time. Free
+// regions are taken from the top of the heap downwards, and objects are
+// allocated from the top of each region downwards, so that the archived
+// objects form a single range ending at the top of the reserved heap.
+// Allocation proceeds in chunks of the minimum region size, whose unused
+// part is filled with dummy objects, so that whatever the region size at
+// run time no object of the range crosses a region boundary.
+class G1ArchiveAllocator : public CHeapObj<mtGC> {
+  G1CollectedHeap* _g1h;
+
+  // The lowest archive region allocated so far, if any.
+  HeapRegion* _allocation_region;
+
+  // The end of the archive range, that is the end of the first region.
+  HeapWord* _range_end;
+
+  // Objects are allocated downwards from _top, down to the bottom of
+  // the current chunk.
+  HeapWord* _chunk_bottom;
+  HeapWord* _top;
+
+  // Set once no more regions could be allocated.
+  bool _failed;
+
+  // Whether full GCs have to check for archive objects, and the regions
+  // they have to leave alone.
+  static bool _archive_check_enabled;
+  static G1ArchiveRegionMap _archive_region_map;
+
+  // Allocate the region below the lowest one allocated so far. Fails if
+  // it is in use.
+  bool alloc_new_region();
+
+  // Fill the unused part of the current chunk, and move on to the chunk
+  // below it.
+  bool alloc_new_chunk();
+
+public:
+  G1ArchiveAllocator(G1CollectedHeap* g1h) :
+    _g1h(g1h),
+    _allocation_region(NULL),
+    _range_end(NULL),
+    _chunk_bottom(NULL),
+    _top(NULL),
+    _failed(false) { }
+
+  // Objects that do not fit into half a chunk are not archived.
+  static bool is_archive_alloc_too_large(size_t word_size);
+
+  // Allocate memory for an individual object, or return NULL if no more
+  // archive regions are available.
+  HeapWord* archive_mem_allocate(size_t word_size);
+
+  // Make the allocated regions parsable, and return the range of the
+  // archived objects.
+  MemRegion complete_archive();
+
+  // Record the given range as being in archive regions, which full GCs
+  // must not mark or move.
+  static void set_range_archive(MemRegion range);
+
+  static inline bool is_archive_object(oop object) {
+    return _archive_check_enabled &&
+           _archive_region_map.get_by_address((HeapWord*)object);
+  }
+};
+
 #endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1ALLOCATOR_HPP
@@ -27,6 +27,9 @@
 #include "gc_implementation/g1/g1CollectedHeap.hpp"
 
 G1Allocator* G1Allocator::create_allocator(G1CollectedHeap* g1h) {
+  if (G1NUMA::is_enabled()) {
+    return new G1NUMAAllocator(g1h);
+  }
   return new G1DefaultAllocator(g1h);
 }
 
@@ -83,6 +83,8 @@ uint G1CardCounts::add_card_count(jbyte* card_ptr) {
   // Unless G1ConcRSHotCardLimit has been set appropriately,
   // returning 0 will result in the card being considered
   // cold and will be refined immediately.
+  // Counts keep going up to max_jubyte past G1ConcRSHotCardLimit,
+  // the hot card cache retains the cards with the higher counts.
   uint count = 0;
   if (has_count_table()) {
     size_t card_num = ptr_2_card_num(card_ptr);
@@ -90,14 +92,20 @@ uint G1CardCounts::add_card_count(jbyte* card_ptr) {
            err_msg("Card "SIZE_FORMAT" outside of card counts table (max size "SIZE_FORMAT")",
                    card_num, _reserved_max_card_num));
     count = (uint) _card_counts[card_num];
-    if (count < G1ConcRSHotCardLimit) {
-      _card_counts[card_num] =
-        (jubyte)(MIN2((uintx)(_card_counts[card_num] + 1), G1ConcRSHotCardLimit));
+    if (count < max_jubyte) {
+      _card_counts[card_num] = (jubyte)(count + 1);
     }
   }
   return count;
 }
 
+uint G1CardCounts::card_count(jbyte* card_ptr) {
+  if (has_count_table()) {
+    return (uint) _card_counts[ptr_2_card_num(card_ptr)];
+  }
+  return 0;
+}
+
 bool G1CardCounts::is_hot(uint count) {
   return (count >= G1ConcRSHotCardLimit);
 }
@@ -107,6 +107,9 @@ class G1CardCounts: public CHeapObj<mtGC> {
   // Returns the pre-increment count value.
   uint add_card_count(jbyte* card_ptr);
 
+  // Returns the refinement count of the given card.
+  uint card_count(jbyte* card_ptr);
+
   // Returns true if the given count is high enough to be considered
   // 'hot'; false otherwise.
   bool is_hot(uint count);
@@ -547,7 +547,7 @@ G1CollectedHeap::new_region_try_secondary_free_list(bool is_old) {
   return NULL;
 }
 
-HeapRegion* G1CollectedHeap::new_region(size_t word_size, bool is_old, bool do_expand) {
+HeapRegion* G1CollectedHeap::new_region(size_t word_size, bool is_old, bool do_expand, uint node_index) {
   assert(!isHumongous(word_size) || word_size <= HeapRegion::GrainWords,
          "the only time we use this to allocate a humongous region is "
          "when we are allocating a single humongous region");
@@ -566,7 +566,7 @@ HeapRegion* G1CollectedHeap::new_region(size_t word_size, bool is_old, bool do_e
     }
   }
 
-  res = _hrm.allocate_free_region(is_old);
+  res = _hrm.allocate_free_region(is_old, node_index);
 
   if (res == NULL) {
     if (G1ConcRegionFreeingVerbose) {
@@ -592,7 +592,7 @@ HeapRegion* G1CollectedHeap::new_region(size_t word_size, bool is_old, bool do_e
       // always expand the heap by an amount aligned to the heap
       // region size, the free list should in theory not be empty.
       // In either case allocate_free_region() will check for NULL.
-      res = _hrm.allocate_free_region(is_old);
+      res = _hrm.allocate_free_region(is_old, node_index);
     } else {
       _expand_heap_after_alloc_failure = false;
     }
@@ -823,6 +823,106 @@ HeapWord* G1CollectedHeap::humongous_obj_allocate(size_t word_size, AllocationCo
   return result;
 }
 
+void G1CollectedHeap::begin_archive_alloc_range() {
+  assert_at_safepoint(true /* should_be_vm_thread */);
+  assert(_archive_allocator == NULL, "should not be initialized");
+  _archive_allocator = new G1ArchiveAllocator(this);
+}
+
+bool G1CollectedHeap::is_archive_alloc_too_large(size_t word_size) {
+  return G1ArchiveAllocator::is_archive_alloc_too_large(word_size);
+}
+
+HeapWord* G1CollectedHeap::archive_mem_allocate(size_t word_size) {
+  assert_at_safepoint(true /* should_be_vm_thread */);
+  assert(_archive_allocator != NULL, "_archive_allocator not initialized");
+  if (is_archive_alloc_too_large(word_size)) {
+    return NULL;
+  }
+  return _archive_allocator->archive_mem_allocate(word_size);
+}
+
+MemRegion G1CollectedHeap::end_archive_alloc_range() {
+  assert_at_safepoint(true /* should_be_vm_thread */);
+  assert(_archive_allocator != NULL, "_archive_allocator not initialized");
+  MemRegion range = _archive_allocator->complete_archive();
+  delete _archive_allocator;
+  _archive_allocator = NULL;
+  return range;
+}
+
+bool G1CollectedHeap::check_archive_addresses(MemRegion range) {
+  return !range.is_empty() && _hrm.reserved().contains(range);
+}
+
+bool G1CollectedHeap::alloc_archive_regions(MemRegion range) {
+  assert(check_archive_addresses(range), "range must be within the reserved heap");
+  MutexLockerEx x(SafepointSynchronize::is_at_safepoint() ? NULL : Heap_lock);
+
+  uint commits = 0;
+  if (!_hrm.allocate_containing_regions(range, &commits)) {
+    return false;
+  }
+  if (commits != 0) {
+    ergo_verbose1(ErgoHeapSizing,
+                  "attempt heap expansion",
+                  ergo_format_reason("allocate archive regions")
+                  ergo_format_byte("total size"),
+                  (size_t)commits * HeapRegion::GrainBytes);
+    g1_policy()->record_new_heap_size(num_regions());
+  }
+
+  // The regions are used from their bottom on, the part of the first one
+  // that precedes the range is filled by fill_archive_regions().
+  HeapRegion* curr_region = _hrm.addr_to_region(range.start());
+  HeapRegion* last_region = _hrm.addr_to_region(range.last());
+  while (true) {
+    assert(curr_region->is_free() && curr_region->is_empty(),
+           err_msg("Region %u is not free", curr_region->hrm_index()));
+    curr_region->set_top(curr_region == last_region ? range.end() : curr_region->end());
+    curr_region->set_archive();
+    _hr_printer.alloc(curr_region, G1HRPrinter::Old);
+    _old_set.add(curr_region);
+    _allocator->increase_used(curr_region->used());
+    if (curr_region == last_region) {
+      break;
+    }
+    curr_region = _hrm.next_region_in_heap(curr_region);
+  }
+  return true;
+}
+
+void G1CollectedHeap::fill_archive_regions(MemRegion range) {
+  assert(check_archive_addresses(range), "range must be within the reserved heap");
+  MutexLockerEx x(SafepointSynchronize::is_at_safepoint() ? NULL : Heap_lock);
+
+  HeapRegion* curr_region = _hrm.addr_to_region(range.start());
+  HeapRegion* last_region = _hrm.addr_to_region(range.last());
+  if (curr_region->bottom() < range.start()) {
+    CollectedHeap::fill_with_objects(curr_region->bottom(),
+                                     pointer_delta(range.start(), curr_region->bottom()));
+  }
+
+  // The objects were put in place without going through the allocation
+  // paths, so the block offset tables have yet to be updated.
+  while (true) {
+    assert(curr_region->is_archive(),
+           err_msg("Region %u is not an archive region", curr_region->hrm_index()));
+    HeapWord* p = curr_region->bottom();
+    while (p < curr_region->top()) {
+      HeapWord* next = p + oop(p)->size();
+      curr_region->alloc_block_in_bot(p, next);
+      p = next;
+    }
+    if (curr_region == last_region) {
+      break;
+    }
+    curr_region = _hrm.next_region_in_heap(curr_region);
+  }
+
+  G1ArchiveAllocator::set_range_archive(range);
+}
+
 HeapWord* G1CollectedHeap::allocate_new_tlab(size_t word_size) {
   assert_heap_not_locked_and_not_at_safepoint();
   assert(!isHumongous(word_size), "we do not allow humongous TLABs");
@@ -913,22 +1013,25 @@ HeapWord* G1CollectedHeap::attempt_allocation_slow(size_t word_size,
 
     {
       MutexLockerEx x(Heap_lock);
-      result = _allocator->mutator_alloc_region(context)->attempt_allocation_locked(word_size,
-                                                                                    false /* bot_updates */);
+      // With UseNUMA the alloc region depends on the node the thread runs
+      // on, which may change at any time, so look it up only once.
+      MutatorAllocRegion* alloc_region = _allocator->mutator_alloc_region(context);
+      result = alloc_region->attempt_allocation_locked(word_size,
+                                                       false /* bot_updates */);
       if (result != NULL) {
         return result;
       }
 
       // If we reach here, attempt_allocation_locked() above failed to
       // allocate a new region. So the mutator alloc region should be NULL.
-      assert(_allocator->mutator_alloc_region(context)->get() == NULL, "only way to get here");
+      assert(alloc_region->get() == NULL, "only way to get here");
 
       if (GC_locker::is_active_and_needs_gc()) {
         if (g1_policy()->can_expand_young_list()) {
           // No need for an ergo verbose message here,
           // can_expand_young_list() does this when it returns true.
-          result = _allocator->mutator_alloc_region(context)->attempt_allocation_force(word_size,
-                                                                                       false /* bot_updates */);
+          result = alloc_region->attempt_allocation_force(word_size,
+                                                          false /* bot_updates */);
           if (result != NULL) {
             return result;
           }
@@ -1193,7 +1296,8 @@ public:
   { }
 
   bool doHeapRegion(HeapRegion* r) {
-    if (!r->continuesHumongous()) {
+    // Archive objects only refer to other archive objects.
+    if (!r->continuesHumongous() && !r->is_archive()) {
       _cl.set_from(r);
       r->oop_iterate(&_cl);
     }
@@ -1234,7 +1338,7 @@ public:
       }
     } else if (hr->continuesHumongous()) {
       _hr_printer->post_compaction(hr, G1HRPrinter::ContinuesHumongous);
-    } else if (hr->is_old()) {
+    } else if (hr->is_old() || hr->is_archive()) {
       _hr_printer->post_compaction(hr, G1HRPrinter::Old);
     } else {
       ShouldNotReachHere();
@@ -1641,6 +1745,45 @@ resize_if_necessary_after_full_collection(size_t word_size) {
   }
 }
 
+void G1CollectedHeap::shrink_after_periodic_collection() {
+  assert_at_safepoint(true /* should_be_vm_thread */);
+
+  // The regions freed by the cleanup of the cycle are still on the
+  // secondary free list.
+  append_secondary_free_list_if_not_empty_with_lock();
+
+  const size_t used_now = used();
+  const size_t capacity_now = capacity();
+
+  // As in resize_if_necessary_after_full_collection(). Keeping
+  // MaxHeapFreeRatio free also keeps MinHeapFreeRatio free.
+  const double maximum_free_percentage = (double) MaxHeapFreeRatio / 100.0;
+  const double minimum_used_percentage = 1.0 - maximum_free_percentage;
+  const size_t min_heap_size = collector_policy()->min_heap_byte_size();
+  const size_t max_heap_size = collector_policy()->max_heap_byte_size();
+
+  double maximum_desired_capacity_d = (double) used_now / minimum_used_percentage;
+  maximum_desired_capacity_d = MIN2(maximum_desired_capacity_d, (double) max_heap_size);
+  size_t maximum_desired_capacity = (size_t) maximum_desired_capacity_d;
+  maximum_desired_capacity = MAX2(maximum_desired_capacity, min_heap_size);
+
+  if (capacity_now > maximum_desired_capacity) {
+    size_t shrink_bytes = capacity_now - maximum_desired_capacity;
+    ergo_verbose4(ErgoHeapSizing,
+                  "attempt heap shrinking",
+                  ergo_format_reason("capacity higher than "
+                                     "max desired capacity after periodic collection")
+                  ergo_format_byte("capacity")
+                  ergo_format_byte("occupancy")
+                  ergo_format_byte_perc("max desired capacity"),
+                  capacity_now, used_now,
+                  maximum_desired_capacity, (double) MaxHeapFreeRatio);
+    // The mutator alloc regions are never empty, so they are left
+    // alone when the free list is rebuilt.
+    shrink(shrink_bytes);
+  }
+}
+
 
 HeapWord*
 G1CollectedHeap::satisfy_failed_allocation(size_t word_size,
@@ -1811,9 +1954,10 @@ void G1CollectedHeap::shrink_helper(size_t shrink_bytes) {
 void G1CollectedHeap::shrink(size_t shrink_bytes) {
   verify_region_sets_optional();
 
-  // We should only reach here at the end of a Full GC which means we
-  // should not not be holding to any GC alloc regions. The method
-  // below will make sure of that and do any remaining clean up.
+  // We should only reach here at the end of a Full GC or of a periodic
+  // concurrent cycle which means we should not not be holding to any GC
+  // alloc regions. The method below will make sure of that and do any
+  // remaining clean up.
   _allocator->abandon_gc_alloc_regions();
 
   // Instead of tearing down / rebuilding the free lists here, we
@@ -1864,6 +2008,7 @@ G1CollectedHeap::G1CollectedHeap(G1CollectorPolicy* policy_) :
   _surviving_young_words(NULL),
   _old_marking_cycles_started(0),
   _old_marking_cycles_completed(0),
+  _last_gc_end_millis(os::javaTimeNanos() / NANOSECS_PER_MILLISEC),
   _concurrent_cycle_started(false),
   _heap_summary_sent(false),
   _in_cset_fast_test(),
@@ -1877,7 +2022,10 @@ G1CollectedHeap::G1CollectedHeap(G1CollectorPolicy* policy_) :
 
   _g1h = this;
 
+  G1NUMA::initialize(HeapRegion::GrainBytes,
+                     UseLargePages ? os::large_page_size() : os::vm_page_size());
   _allocator = G1Allocator::create_allocator(_g1h);
+  _archive_allocator = NULL;
   _humongous_object_threshold_in_words = HeapRegion::GrainWords / 2;
 
   int n_queues = MAX2((int)ParallelGCThreads, 1);
@@ -1889,12 +2037,14 @@ G1CollectedHeap::G1CollectedHeap(G1CollectorPolicy* policy_) :
   _worker_cset_start_region = NEW_C_HEAP_ARRAY(HeapRegion*, n_queues, mtGC);
   _worker_cset_start_region_time_stamp = NEW_C_HEAP_ARRAY(uint, n_queues, mtGC);
   _evacuation_failed_info_array = NEW_C_HEAP_ARRAY(EvacuationFailedInfo, n_queues, mtGC);
+  _optional_region_refs_array = NEW_C_HEAP_ARRAY(G1OptionalRegionRefs, n_queues, mtGC);
 
   for (int i = 0; i < n_queues; i++) {
     RefToScanQueue* q = new RefToScanQueue();
     q->initialize();
     _task_queues->register_queue(i, q);
     ::new (&_evacuation_failed_info_array[i]) EvacuationFailedInfo();
+    ::new (&_optional_region_refs_array[i]) G1OptionalRegionRefs();
   }
   clear_cset_start_regions();
 
@@ -2131,7 +2281,7 @@ jint G1CollectedHeap::initialize() {
   // values in the heap have been properly initialized.
   _g1mm = new G1MonitoringSupport(this);
 
-  G1StringDedup::initialize();
+  StringDedup::initialize();
 
   return JNI_OK;
 }
@@ -2142,8 +2292,8 @@ void G1CollectedHeap::stop() {
   // that are destroyed during shutdown.
   _cg1r->stop();
   _cmThread->stop();
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::stop();
+  if (StringDedup::is_enabled()) {
+    StringDedup::stop();
   }
 }
 
@@ -2848,7 +2998,8 @@ void G1CollectedHeap::collection_set_iterate_from(HeapRegion* r,
 
 HeapRegion* G1CollectedHeap::next_compaction_region(const HeapRegion* from) const {
   HeapRegion* result = _hrm.next_region_in_heap(from);
-  while (result != NULL && result->isHumongous()) {
+  while (result != NULL &&
+         (result->isHumongous() || result->is_archive() || result->is_pinned())) {
     result = _hrm.next_region_in_heap(result);
   }
   return result;
@@ -2913,8 +3064,14 @@ size_t G1CollectedHeap::max_capacity() const {
 }
 
 jlong G1CollectedHeap::millis_since_last_gc() {
-  // assert(false, "NYI");
-  return 0;
+  // As in GenCollectedHeap, guard against a time source which is not
+  // monotonic.
+  jlong now = os::javaTimeNanos() / NANOSECS_PER_MILLISEC;
+  jlong ret_val = now - _last_gc_end_millis;
+  if (ret_val < 0) {
+    return 0;
+  }
+  return ret_val;
 }
 
 void G1CollectedHeap::prepare_for_verify() {
@@ -3341,9 +3498,9 @@ void G1CollectedHeap::verify(bool silent, VerifyOption vo) {
     if (!silent) gclog_or_tty->print("RemSet ");
     rem_set()->verify();
 
-    if (G1StringDedup::is_enabled()) {
+    if (StringDedup::is_enabled()) {
       if (!silent) gclog_or_tty->print("StrDedup ");
-      G1StringDedup::verify();
+      StringDedup::verify();
     }
 
     if (failures) {
@@ -3365,7 +3522,7 @@ void G1CollectedHeap::verify(bool silent, VerifyOption vo) {
   } else {
     if (!silent) {
       gclog_or_tty->print("(SKIPPING Roots, HeapRegionSets, HeapRegions, RemSet");
-      if (G1StringDedup::is_enabled()) {
+      if (StringDedup::is_enabled()) {
         gclog_or_tty->print(", StrDedup");
       }
       gclog_or_tty->print(") ");
@@ -3417,7 +3574,7 @@ bool G1CollectedHeap::is_obj_dead_cond(const oop obj,
   switch (vo) {
   case VerifyOption_G1UsePrevMarking: return is_obj_dead(obj, hr);
   case VerifyOption_G1UseNextMarking: return is_obj_ill(obj, hr);
-  case VerifyOption_G1UseMarkWord:    return !obj->is_gc_marked();
+  case VerifyOption_G1UseMarkWord:    return !obj->is_gc_marked() && !hr->is_archive();
   default:                            ShouldNotReachHere();
   }
   return false; // keep some compilers happy
@@ -3428,7 +3585,8 @@ bool G1CollectedHeap::is_obj_dead_cond(const oop obj,
   switch (vo) {
   case VerifyOption_G1UsePrevMarking: return is_obj_dead(obj);
   case VerifyOption_G1UseNextMarking: return is_obj_ill(obj);
-  case VerifyOption_G1UseMarkWord:    return !obj->is_gc_marked();
+  case VerifyOption_G1UseMarkWord:    return !obj->is_gc_marked() &&
+                                             !heap_region_containing(obj)->is_archive();
   default:                            ShouldNotReachHere();
   }
   return false; // keep some compilers happy
@@ -3485,8 +3643,8 @@ void G1CollectedHeap::print_gc_threads_on(outputStream* st) const {
   st->cr();
   _cm->print_worker_threads_on(st);
   _cg1r->print_worker_threads_on(st);
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::print_worker_threads_on(st);
+  if (StringDedup::is_enabled()) {
+    StringDedup::print_worker_threads_on(st);
   }
 }
 
@@ -3496,8 +3654,8 @@ void G1CollectedHeap::gc_threads_do(ThreadClosure* tc) const {
   }
   tc->do_thread(_cmThread);
   _cg1r->threads_do(tc);
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::threads_do(tc);
+  if (StringDedup::is_enabled()) {
+    StringDedup::threads_do(tc);
   }
 }
 
@@ -3609,6 +3767,8 @@ void G1CollectedHeap::gc_epilogue(bool full) {
   // We have just completed a GC. Update the soft reference
   // policy with the new heap occupancy
   Universe::update_heap_info_at_gc();
+
+  _last_gc_end_millis = os::javaTimeNanos() / NANOSECS_PER_MILLISEC;
 }
 
 HeapWord* G1CollectedHeap::do_collection_pause(size_t word_size,
@@ -3726,7 +3886,9 @@ class RegisterHumongousWithInCSetFastTestClosure : public HeapRegionClosure {
     // important use case for eager reclaim, and this special handling
     // may reduce needed headroom.
 
-    return is_typeArray_region(region) && is_remset_small(region);
+    // Pinned objects are in use by JNI critical sections.
+    return is_typeArray_region(region) && is_remset_small(region) &&
+           !region->is_pinned();
   }
 
  public:
@@ -3906,15 +4068,17 @@ void G1CollectedHeap::log_gc_footer(double pause_time_sec) {
   }
 
   if (G1Log::finer()) {
-    if (evacuation_failed()) {
+    if (to_space_exhausted()) {
       gclog_or_tty->print(" (to-space exhausted)");
+    } else if (evacuation_failed()) {
+      gclog_or_tty->print(" (pinned regions retained)");
     }
     gclog_or_tty->print_cr(", %3.7f secs]", pause_time_sec);
     g1_policy()->phase_times()->note_gc_end();
     g1_policy()->phase_times()->print(pause_time_sec);
     g1_policy()->print_detailed_heap_transition();
   } else {
-    if (evacuation_failed()) {
+    if (to_space_exhausted()) {
       gclog_or_tty->print("--");
     }
     g1_policy()->print_heap_transition();
@@ -4383,6 +4547,9 @@ G1CollectedHeap::handle_evacuation_failure_par(G1ParScanThreadState* _par_scan_s
     uint queue_num = _par_scan_state->queue_num();
 
     _evacuation_failed = true;
+    if (!heap_region_containing_raw(old)->is_pinned()) {
+      _to_space_exhausted = true;
+    }
     _evacuation_failed_info_array[queue_num].register_copy_failure(old->size());
     if (_evac_failure_closure != cl) {
       MutexLockerEx x(EvacFailureStack_lock, Mutex::_no_safepoint_check_flag);
@@ -4507,6 +4674,8 @@ void G1ParCopyClosure<barrier, do_mark_object>::do_oop_work(T* p) {
   } else {
     if (state.is_humongous()) {
       _g1->set_humongous_is_live(obj);
+    } else if (state.is_optional()) {
+      _par_scan_state->remember_root_into_optional_region(p);
     }
     // The object is not in collection set. If we're a root scanning
     // closure during an initial mark pause then attempt to mark the object.
@@ -4758,6 +4927,92 @@ public:
   }
 };
 
+// Evacuates the optional regions which were just added to the collection
+// set. Every worker first processes the references into them it found in
+// the increments before, then the remembered sets and code roots of the
+// regions are scanned.
+class G1ParEvacuateOptionalTask : public AbstractGangTask {
+protected:
+  G1CollectedHeap*       _g1h;
+  RefToScanQueueSet      *_queues;
+  G1RootProcessor*       _root_processor;
+  ParallelTaskTerminator _terminator;
+  uint _n_workers;
+
+public:
+  G1ParEvacuateOptionalTask(G1CollectedHeap* g1h, RefToScanQueueSet *task_queues, G1RootProcessor* root_processor)
+    : AbstractGangTask("G1 optional collection"),
+      _g1h(g1h),
+      _queues(task_queues),
+      _root_processor(root_processor),
+      _terminator(0, _queues)
+  {}
+
+  virtual void set_for_termination(int active_workers) {
+    _root_processor->set_num_workers(active_workers);
+    _terminator.reset_for_reuse(active_workers);
+    _n_workers = active_workers;
+  }
+
+  void work(uint worker_id) {
+    if (worker_id >= _n_workers) return;  // no work needed this round
+
+    ResourceMark rm;
+    HandleMark   hm;
+
+    ReferenceProcessor*             rp = _g1h->ref_processor_stw();
+
+    G1ParScanThreadState            pss(_g1h, worker_id, rp);
+    G1ParScanHeapEvacFailureClosure evac_failure_cl(_g1h, &pss, rp);
+
+    pss.set_evac_failure_closure(&evac_failure_cl);
+
+    // Mixed collections never are initial mark pauses.
+    G1ParScanExtRootClosure scan_root_cl(_g1h, &pss, rp);
+    G1ParPushHeapRSClosure  push_heap_rs_cl(_g1h, &pss);
+
+    G1OptionalRegionRefs* refs = _g1h->optional_region_refs(worker_id);
+    refs->start_increment();
+
+    GrowableArray<StarTask>* roots = refs->prev_roots();
+    for (int i = 0; i < roots->length(); i++) {
+      StarTask task = roots->at(i);
+      if (task.is_narrow()) {
+        scan_root_cl.do_oop((narrowOop*) task);
+      } else {
+        scan_root_cl.do_oop((oop*) task);
+      }
+    }
+    roots->clear();
+
+    GrowableArray<StarTask>* heap_refs = refs->prev_refs();
+    for (int i = 0; i < heap_refs->length(); i++) {
+      StarTask task = heap_refs->at(i);
+      // The live objects of the regions evacuated now are copied, and
+      // their copies are scanned.
+      HeapRegion* from = task.is_narrow() ? _g1h->heap_region_containing_raw((narrowOop*) task)
+                                          : _g1h->heap_region_containing_raw((oop*) task);
+      if (!from->in_collection_set()) {
+        if (task.is_narrow()) {
+          pss.push_on_queue((narrowOop*) task);
+        } else {
+          pss.push_on_queue((oop*) task);
+        }
+      }
+    }
+    heap_refs->clear();
+
+    _root_processor->scan_optional_remembered_sets(&push_heap_rs_cl,
+                                                   &scan_root_cl,
+                                                   worker_id);
+
+    G1ParEvacuateFollowersClosure evac(_g1h, &pss, _queues, &_terminator);
+    evac.do_void();
+
+    assert(pss.queue_is_empty(), "should be empty");
+  }
+};
+
 class G1StringSymbolTableUnlinkTask : public AbstractGangTask {
 private:
   BoolObjectClosure* _is_alive;
@@ -5159,7 +5414,7 @@ void G1CollectedHeap::unlink_string_and_symbol_table(BoolObjectClosure* is_alive
     }
   }
 
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     G1StringDedup::unlink(is_alive);
   }
 }
@@ -5714,9 +5969,62 @@ void G1CollectedHeap::enqueue_discovered_references(uint no_of_gc_workers) {
   g1_policy()->phase_times()->record_ref_enq_time(ref_enq_time * 1000.0);
 }
 
+G1OptionalRegionRefs* G1CollectedHeap::optional_region_refs(uint i) const {
+  return &_optional_region_refs_array[i];
+}
+
+void G1CollectedHeap::evacuate_optional_regions(uint n_workers) {
+  G1CollectorPolicy* policy = g1_policy();
+  G1GCPhaseTimes* phase_times = policy->phase_times();
+  double start_sec = os::elapsedTime();
+  uint evacuated_regions = 0;
+
+  // The references into the optional regions are only updated if the
+  // region is evacuated without failure, so there are no increments
+  // after an evacuation failure.
+  while (policy->has_optional_regions() && !evacuation_failed()) {
+    double pause_time_ms = (os::elapsedTime() - phase_times->cur_collection_start_sec()) * 1000.0;
+    double time_remaining_ms = policy->max_pause_time_ms() - pause_time_ms;
+    uint added = policy->add_optional_regions_to_cset(time_remaining_ms);
+    if (added == 0) {
+      break;
+    }
+
+    // The added regions are at the head of the collection set.
+    if (_hr_printer.is_active()) {
+      HeapRegion* hr = policy->collection_set();
+      for (uint i = 0; i < added; i++) {
+        _hr_printer.cset(hr);
+        hr = hr->next_in_collection_set();
+      }
+    }
+
+    G1RootProcessor root_processor(this);
+    G1ParEvacuateOptionalTask optional_task(this, _task_queues, &root_processor);
+    if (G1CollectedHeap::use_parallel_gc_threads()) {
+      workers()->run_task(&optional_task);
+    } else {
+      optional_task.set_for_termination(n_workers);
+      optional_task.work(0);
+    }
+    evacuated_regions += added;
+  }
+
+  // The regions left stay candidates in the CSet chooser, the references
+  // into them are updated with the regions.
+  policy->clear_optional_regions();
+  for (uint i = 0; i < n_workers; i++) {
+    optional_region_refs(i)->clear();
+  }
+
+  double optional_time_ms = (os::elapsedTime() - start_sec) * 1000.0;
+  phase_times->record_optional_evacuation(optional_time_ms, evacuated_regions);
+}
+
 void G1CollectedHeap::evacuate_collection_set(EvacuationInfo& evacuation_info) {
   _expand_heap_after_alloc_failure = true;
   _evacuation_failed = false;
+  _to_space_exhausted = false;
 
   // Should G1EvacuationFailureALot be in effect for this GC?
   NOT_PRODUCT(set_evacuation_failure_alot_for_current_gc();)
@@ -5792,6 +6100,9 @@ void G1CollectedHeap::evacuate_collection_set(EvacuationInfo& evacuation_info) {
         (os::elapsedTime() - end_par_time_sec) * 1000.0;
   phase_times->record_code_root_fixup_time(code_root_fixup_time_ms);
 
+  evacuate_optional_regions(n_workers);
+  evacuation_info.set_collectionset_regions(g1_policy()->cset_region_length());
+
   set_par_threads(0);
 
   // Process any discovered reference objects - we have
@@ -5801,7 +6112,7 @@ void G1CollectedHeap::evacuate_collection_set(EvacuationInfo& evacuation_info) {
   // not copied during the pause.
   process_discovered_references(n_workers);
 
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     double fixup_start = os::elapsedTime();
 
     G1STWIsAliveClosure is_alive(this);
@@ -6552,7 +6863,7 @@ public:
   TearDownRegionSetsClosure(HeapRegionSet* old_set) : _old_set(old_set) { }
 
   bool doHeapRegion(HeapRegion* r) {
-    if (r->is_old()) {
+    if (r->is_old() || r->is_archive()) {
       _old_set->remove(r);
     } else {
       // We ignore free regions, we'll empty the free list afterwards.
@@ -6620,10 +6931,13 @@ public:
         // We ignore humongous regions, we left the humongous set unchanged
       } else {
         // Objects that were compacted would have ended up on regions
-        // that were previously old or free.
-        assert(r->is_free() || r->is_old(), "invariant");
+        // that were previously old or free. Archive regions were not
+        // compacted and keep their type.
+        assert(r->is_free() || r->is_old() || r->is_archive(), "invariant");
         // We now consider them old, so register as such.
-        r->set_old();
+        if (!r->is_archive()) {
+          r->set_old();
+        }
         _old_set->add(r);
       }
       _total_used += r->used();
@@ -6668,7 +6982,8 @@ bool G1CollectedHeap::is_in_closed_subset(const void* p) const {
 // Methods for the mutator alloc region
 
 HeapRegion* G1CollectedHeap::new_mutator_alloc_region(size_t word_size,
-                                                      bool force) {
+                                                      bool force,
+                                                      uint node_index) {
   assert_heap_locked_or_at_safepoint(true /* should_be_vm_thread */);
   assert(!force || g1_policy()->can_expand_young_list(),
          "if force is true we should be able to expand the young list");
@@ -6676,7 +6991,8 @@ HeapRegion* G1CollectedHeap::new_mutator_alloc_region(size_t word_size,
   if (force || !young_list_full) {
     HeapRegion* new_alloc_region = new_region(word_size,
                                               false /* is_old */,
-                                              false /* do_expand */);
+                                              false /* do_expand */,
+                                              node_index);
     if (new_alloc_region != NULL) {
       set_region_short_lived_locked(new_alloc_region);
       _hr_printer.alloc(new_alloc_region, G1HRPrinter::Eden, young_list_full);
@@ -6721,14 +7037,16 @@ void G1CollectedHeap::set_par_threads() {
 
 HeapRegion* G1CollectedHeap::new_gc_alloc_region(size_t word_size,
                                                  uint count,
-                                                 InCSetState dest) {
+                                                 InCSetState dest,
+                                                 uint node_index) {
   assert(FreeList_lock->owned_by_self(), "pre-condition");
 
   if (count < g1_policy()->max_regions(dest)) {
     const bool is_survivor = (dest.is_young());
     HeapRegion* new_alloc_region = new_region(word_size,
                                               !is_survivor,
-                                              true /* do_expand */);
+                                              true /* do_expand */,
+                                              node_index);
     if (new_alloc_region != NULL) {
       // We really only need to do this for old regions given that we
       // should never scan survivors. But it doesn't hurt to do it
@@ -6797,7 +7115,7 @@ public:
     } else if (hr->is_empty()) {
       assert(_hrm->is_free(hr), err_msg("Heap region %u is empty but not on the free list.", hr->hrm_index()));
       _free_count.increment(1u, hr->capacity());
-    } else if (hr->is_old()) {
+    } else if (hr->is_old() || hr->is_archive()) {
       assert(hr->containing_set() == _old_set, err_msg("Heap region %u is old but not in the old set.", hr->hrm_index()));
       _old_count.increment(1u, hr->capacity());
     } else {
@@ -6932,6 +7250,14 @@ void G1CollectedHeap::unregister_nmethod(nmethod* nm) {
   nm->oops_do(&reg_cl, true);
 }
 
+void G1CollectedHeap::pin_object(JavaThread* thread, oop obj) {
+  heap_region_containing(obj)->increment_pinned_object_count();
+}
+
+void G1CollectedHeap::unpin_object(JavaThread* thread, oop obj) {
+  heap_region_containing(obj)->decrement_pinned_object_count();
+}
+
 void G1CollectedHeap::purge_code_root_memory() {
   double purge_start = os::elapsedTime();
   G1CodeRootSet::purge();
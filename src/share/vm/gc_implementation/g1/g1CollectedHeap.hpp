@@ -34,6 +34,7 @@
 #include "gc_implementation/g1/g1HRPrinter.hpp"
 #include "gc_implementation/g1/g1InCSetState.hpp"
 #include "gc_implementation/g1/g1MonitoringSupport.hpp"
+#include "gc_implementation/g1/g1NUMA.hpp"
 #include "gc_implementation/g1/g1SATBCardTableModRefBS.hpp"
 #include "gc_implementation/g1/g1YCTypes.hpp"
 #include "gc_implementation/g1/heapRegionManager.hpp"
@@ -74,6 +75,7 @@ class STWGCTimer;
 class G1NewTracer;
 class G1OldTracer;
 class EvacuationFailedInfo;
+class G1OptionalRegionRefs;
 class nmethod;
 class Ticks;
 
@@ -181,12 +183,14 @@ class G1CollectedHeap : public SharedHeap {
   friend class VM_G1CollectForAllocation;
   friend class VM_G1CollectFull;
   friend class VM_G1IncCollectionPause;
+  friend class VM_G1PeriodicCollection;
   friend class VMStructs;
   friend class MutatorAllocRegion;
   friend class SurvivorGCAllocRegion;
   friend class OldGCAllocRegion;
   friend class G1Allocator;
   friend class G1DefaultAllocator;
+  friend class G1NUMAAllocator;
   friend class G1ResManAllocator;
 
   // Closures used in implementation.
@@ -198,6 +202,7 @@ class G1CollectedHeap : public SharedHeap {
   friend class G1ParScanClosureSuper;
   friend class G1ParEvacuateFollowersClosure;
   friend class G1ParTask;
+  friend class G1ParEvacuateOptionalTask;
   friend class G1ParGCAllocator;
   friend class G1DefaultParGCAllocator;
   friend class G1FreeGarbageRegionClosure;
@@ -266,6 +271,10 @@ private:
   // Class that handles the different kinds of allocations.
   G1Allocator* _allocator;
 
+  // Allocator for archive objects, only set at CDS dump time between
+  // begin_archive_alloc_range() and end_archive_alloc_range().
+  G1ArchiveAllocator* _archive_allocator;
+
   // Statistics for each allocation context
   AllocationContextStats _allocation_context_stats;
 
@@ -352,6 +361,10 @@ private:
   // concurrent cycles) we have completed.
   volatile uint _old_marking_cycles_completed;
 
+  // Time in ms, from os::javaTimeNanos(), at the end of the last
+  // collection pause.
+  jlong _last_gc_end_millis;
+
   bool _concurrent_cycle_started;
   bool _heap_summary_sent;
 
@@ -462,8 +475,10 @@ protected:
   // an allocation of the given word_size. If do_expand is true,
   // attempt to expand the heap if necessary to satisfy the allocation
   // request. If the region is to be used as an old region or for a
-  // humongous object, set is_old to true. If not, to false.
-  HeapRegion* new_region(size_t word_size, bool is_old, bool do_expand);
+  // humongous object, set is_old to true. If not, to false. A region of
+  // the NUMA node with node_index is preferred.
+  HeapRegion* new_region(size_t word_size, bool is_old, bool do_expand,
+                         uint node_index = G1NUMA::AnyNodeIndex);
 
   // Initialize a contiguous set of free regions of length num_regions
   // and starting at index first so that they appear as a single
@@ -577,13 +592,14 @@ protected:
   // These methods are the "callbacks" from the G1AllocRegion class.
 
   // For mutator alloc regions.
-  HeapRegion* new_mutator_alloc_region(size_t word_size, bool force);
+  HeapRegion* new_mutator_alloc_region(size_t word_size, bool force,
+                                       uint node_index);
   void retire_mutator_alloc_region(HeapRegion* alloc_region,
                                    size_t allocated_bytes);
 
   // For GC alloc regions.
   HeapRegion* new_gc_alloc_region(size_t word_size, uint count,
-                                  InCSetState dest);
+                                  InCSetState dest, uint node_index);
   void retire_gc_alloc_region(HeapRegion* alloc_region,
                               size_t allocated_bytes, InCSetState dest);
 
@@ -635,6 +651,37 @@ public:
     return _allocator;
   }
 
+  // Archive regions hold objects that are shared through the CDS
+  // archive. At dump time the objects to archive are allocated in such
+  // regions at the top of the heap, whose contents are then written to
+  // the archive. At run time the archived range is mapped at the same
+  // address into the regions spanning it, which are never collected.
+
+  // Facility for allocating objects in archive regions at dump time.
+  // begin_archive_alloc_range() must be called first, objects are then
+  // allocated with archive_mem_allocate(), and end_archive_alloc_range()
+  // returns the range of the archived objects, or an empty range if
+  // nothing could be allocated.
+  void begin_archive_alloc_range();
+  bool is_archive_alloc_too_large(size_t word_size);
+  HeapWord* archive_mem_allocate(size_t word_size);
+  MemRegion end_archive_alloc_range();
+
+  // Return whether the given range lies within the reserved heap, so
+  // that it can be allocated as archive regions.
+  bool check_archive_addresses(MemRegion range);
+
+  // Commit the regions spanning the given range and turn them into
+  // archive regions, whose used parts cover the range. Returns false if
+  // any of these regions is in use.
+  bool alloc_archive_regions(MemRegion range);
+
+  // Fill the parts of the archive regions spanning the given range that
+  // precede it with dummy objects, so that the regions are parsable,
+  // and update their block offset tables. From then on full GCs leave
+  // the objects of these regions alone.
+  void fill_archive_regions(MemRegion range);
+
   G1MonitoringSupport* g1mm() {
     assert(_g1mm != NULL, "should have been initialized");
     return _g1mm;
@@ -680,6 +727,15 @@ public:
   void register_old_region_with_in_cset_fast_test(HeapRegion* r) {
     _in_cset_fast_test.set_in_old(r->hrm_index());
   }
+  // Optional regions are registered when the collection set is chosen,
+  // and either registered as old regions or cleared again before the
+  // references are processed.
+  void register_optional_region_with_in_cset_fast_test(HeapRegion* r) {
+    _in_cset_fast_test.set_optional(r->hrm_index());
+  }
+  void clear_optional_region_in_cset_fast_test(HeapRegion* r) {
+    _in_cset_fast_test.clear_optional(r->hrm_index());
+  }
 
   // This is a fast test on whether a reference points into the
   // collection set or not. Assume that the reference
@@ -781,6 +837,12 @@ protected:
   // Actually do the work of evacuating the collection set.
   void evacuate_collection_set(EvacuationInfo& evacuation_info);
 
+  // Adds the optional regions of a mixed collection to the collection
+  // set and evacuates them, a few at a time, as long as the pause time
+  // target allows it. Called after the rest of the collection set has
+  // been evacuated.
+  void evacuate_optional_regions(uint n_workers);
+
   // The g1 remembered set of the heap.
   G1RemSet* _g1_rem_set;
 
@@ -822,8 +884,16 @@ protected:
   // True iff a evacuation has failed in the current collection.
   bool _evacuation_failed;
 
+  // True iff an object of a region that is not pinned failed evacuation
+  // in the current collection, i.e. to-space was exhausted.
+  bool _to_space_exhausted;
+
   EvacuationFailedInfo* _evacuation_failed_info_array;
 
+  // The references into optional regions found by each worker, see
+  // evacuate_optional_regions().
+  G1OptionalRegionRefs* _optional_region_refs_array;
+
   // Failed evacuations cause some logical from-space objects to have
   // forwarding pointers to themselves.  Reset them.
   void remove_self_forwarding_pointers();
@@ -1002,6 +1072,8 @@ public:
 
   RefToScanQueue *task_queue(int i) const;
 
+  G1OptionalRegionRefs* optional_region_refs(uint i) const;
+
   // A set of cards where updates happened during the GC
   DirtyCardQueueSet& dirty_card_queue_set() { return _dirty_card_queue_set; }
 
@@ -1222,6 +1294,7 @@ public:
 
   // True iff an evacuation has failed in the most-recent collection.
   bool evacuation_failed() { return _evacuation_failed; }
+  bool to_space_exhausted() { return _to_space_exhausted; }
 
   void remove_from_old_sets(const HeapRegionSetCount& old_regions_removed, const HeapRegionSetCount& humongous_regions_removed);
   void prepend_to_freelist(FreeRegionList* list);
@@ -1472,6 +1545,11 @@ public:
 
   virtual jlong millis_since_last_gc();
 
+  // Shrink the heap down to MaxHeapFreeRatio at the end of a periodic
+  // concurrent cycle, see G1PeriodicGCInterval. The heap is never
+  // expanded here.
+  void shrink_after_periodic_collection();
+
 
   // Convenience function to be used in situations where the heap type can be
   // asserted to be this type.
@@ -1561,6 +1639,11 @@ public:
   // Unregister the given nmethod from the G1 heap
   virtual void unregister_nmethod(nmethod* nm);
 
+  // Pinning support for JNI critical sections, see HeapRegion::is_pinned().
+  virtual bool supports_object_pinning() const { return G1PinJNICriticalRegions; }
+  virtual void pin_object(JavaThread* thread, oop obj);
+  virtual void unpin_object(JavaThread* thread, oop obj);
+
   // Free up superfluous code root memory.
   void purge_code_root_memory();
 
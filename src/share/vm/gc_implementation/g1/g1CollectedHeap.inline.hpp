@@ -158,12 +158,13 @@ inline HeapWord* G1CollectedHeap::survivor_attempt_allocation(size_t word_size,
   assert(!isHumongous(word_size),
          "we should not be seeing humongous-size allocations in this path");
 
-  HeapWord* result = _allocator->survivor_gc_alloc_region(context)->attempt_allocation(word_size,
-                                                                                       false /* bot_updates */);
+  SurvivorGCAllocRegion* alloc_region = _allocator->survivor_gc_alloc_region(context);
+  HeapWord* result = alloc_region->attempt_allocation(word_size,
+                                                      false /* bot_updates */);
   if (result == NULL) {
     MutexLockerEx x(FreeList_lock, Mutex::_no_safepoint_check_flag);
-    result = _allocator->survivor_gc_alloc_region(context)->attempt_allocation_locked(word_size,
-                                                                                      false /* bot_updates */);
+    result = alloc_region->attempt_allocation_locked(word_size,
+                                                     false /* bot_updates */);
   }
   if (result != NULL) {
     dirty_young_block(result, word_size);
@@ -176,12 +177,13 @@ inline HeapWord* G1CollectedHeap::old_attempt_allocation(size_t word_size,
   assert(!isHumongous(word_size),
          "we should not be seeing humongous-size allocations in this path");
 
-  HeapWord* result = _allocator->old_gc_alloc_region(context)->attempt_allocation(word_size,
-                                                                                  true /* bot_updates */);
+  OldGCAllocRegion* alloc_region = _allocator->old_gc_alloc_region(context);
+  HeapWord* result = alloc_region->attempt_allocation(word_size,
+                                                      true /* bot_updates */);
   if (result == NULL) {
     MutexLockerEx x(FreeList_lock, Mutex::_no_safepoint_check_flag);
-    result = _allocator->old_gc_alloc_region(context)->attempt_allocation_locked(word_size,
-                                                                                 true /* bot_updates */);
+    result = alloc_region->attempt_allocation_locked(word_size,
+                                                     true /* bot_updates */);
   }
   return result;
 }
@@ -141,6 +141,7 @@ G1CollectorPolicy::G1CollectorPolicy() :
 
   _collection_set(NULL),
   _collection_set_bytes_used_before(0),
+  _optional_regions_added(0),
 
   // Incremental CSet attributes
   _inc_cset_build_state(Inactive),
@@ -318,6 +319,7 @@ G1CollectorPolicy::G1CollectorPolicy() :
   _reserve_regions = 0;
 
   _collectionSetChooser = new CollectionSetChooser();
+  _optional_regions = new (ResourceObj::C_HEAP, mtGC) GrowableArray<HeapRegion*>(8, true, mtGC);
 }
 
 void G1CollectorPolicy::initialize_alignments() {
@@ -1134,7 +1136,11 @@ void G1CollectorPolicy::record_collection_pause_end(double pause_time_ms, Evacua
     double cost_per_byte_ms = 0.0;
 
     if (copied_bytes > 0) {
-      cost_per_byte_ms = phase_times()->average_time_ms(G1GCPhaseTimes::ObjCopy) / (double) copied_bytes;
+      // The optional regions are evacuated after the parallel phases, the
+      // time it took is mostly copying.
+      double copy_time_ms = phase_times()->average_time_ms(G1GCPhaseTimes::ObjCopy) +
+                            phase_times()->cur_optional_evac_time_ms();
+      cost_per_byte_ms = copy_time_ms / (double) copied_bytes;
       if (_in_marking_window) {
         _cost_per_byte_ms_during_cm_seq->add(cost_per_byte_ms);
       } else {
@@ -1144,7 +1150,8 @@ void G1CollectorPolicy::record_collection_pause_end(double pause_time_ms, Evacua
 
     double all_other_time_ms = pause_time_ms -
       (phase_times()->average_time_ms(G1GCPhaseTimes::UpdateRS) + phase_times()->average_time_ms(G1GCPhaseTimes::ScanRS) +
-          phase_times()->average_time_ms(G1GCPhaseTimes::ObjCopy) + phase_times()->average_time_ms(G1GCPhaseTimes::Termination));
+          phase_times()->average_time_ms(G1GCPhaseTimes::ObjCopy) + phase_times()->average_time_ms(G1GCPhaseTimes::Termination) +
+          phase_times()->cur_optional_evac_time_ms());
 
     double young_other_time_ms = 0.0;
     if (young_cset_region_length() > 0) {
@@ -1664,6 +1671,10 @@ G1CollectorPolicy::record_concurrent_mark_cleanup_end(int no_of_gc_threads) {
 // Add the heap region at the head of the non-incremental collection set
 void G1CollectorPolicy::add_old_region_to_cset(HeapRegion* hr) {
   assert(_inc_cset_build_state == Active, "Precondition");
+  link_old_region_into_cset(hr);
+}
+
+void G1CollectorPolicy::link_old_region_into_cset(HeapRegion* hr) {
   assert(hr->is_old(), "the region should be old");
 
   assert(!hr->in_collection_set(), "should not already be in the CSet");
@@ -2031,8 +2042,25 @@ void G1CollectorPolicy::finalize_cset(double target_pause_time_ms, EvacuationInf
     uint expensive_region_num = 0;
     bool check_time_remaining = adaptive_young_list_length();
 
+    // Keep the last G1OptionalCSetPercent of the time left for the
+    // optional regions, which are selected after the old regions.
+    double old_time_remaining_ms = time_remaining_ms;
+    double optional_time_ms = 0.0;
+    if (check_time_remaining) {
+      optional_time_ms = time_remaining_ms * (double) G1OptionalCSetPercent / 100.0;
+      time_remaining_ms -= optional_time_ms;
+    }
+
     HeapRegion* hr = cset_chooser->peek();
     while (hr != NULL) {
+      if (hr->is_pinned()) {
+        // Pinned regions can not be evacuated, drop them from the
+        // candidates of this marking cycle.
+        cset_chooser->remove_and_move_to_next(hr);
+        hr = cset_chooser->peek();
+        continue;
+      }
+
       if (old_cset_region_length() >= max_old_cset_length) {
         // Added maximum number of old regions to the CSet.
         ergo_verbose2(ErgoCSetConstruction,
@@ -2119,6 +2147,10 @@ void G1CollectorPolicy::finalize_cset(double target_pause_time_ms, EvacuationInf
       ergo_verbose0(ErgoCSetConstruction,
                     "finish adding old regions to CSet",
                     ergo_format_reason("candidate old regions not available"));
+    } else if (optional_time_ms > 0.0) {
+      // The predictions are conservative, so the optional regions may add
+      // up to the time the old regions had.
+      select_optional_regions(old_time_remaining_ms, max_old_cset_length);
     }
 
     if (expensive_region_num > 0) {
@@ -2159,6 +2191,82 @@ void G1CollectorPolicy::finalize_cset(double target_pause_time_ms, EvacuationInf
   evacuation_info.set_collectionset_regions(cset_region_length());
 }
 
+void G1CollectorPolicy::select_optional_regions(double time_limit_ms, uint max_old_cset_length) {
+  assert(_optional_regions->is_empty(), "Precondition");
+  CollectionSetChooser* cset_chooser = _collectionSetChooser;
+  size_t reclaimable_bytes = cset_chooser->remaining_reclaimable_bytes();
+  double predicted_time_ms = 0.0;
+
+  uint optional_region_num = 0;
+  HeapRegion* hr = cset_chooser->peek_at(0);
+  // The optional regions must be taken in candidate order, so stop at a
+  // pinned region.
+  while (hr != NULL && !hr->is_pinned() &&
+         old_cset_region_length() + optional_region_num < max_old_cset_length) {
+    // As for the old regions, stop once the space left in the candidates
+    // is not above G1HeapWastePercent.
+    if (reclaimable_bytes_perc(reclaimable_bytes) <= (double) G1HeapWastePercent) {
+      break;
+    }
+    double region_time_ms = predict_region_elapsed_time_ms(hr, false);
+    if (predicted_time_ms + region_time_ms > time_limit_ms) {
+      break;
+    }
+    predicted_time_ms += region_time_ms;
+    reclaimable_bytes -= hr->reclaimable_bytes();
+    _optional_regions->append(hr);
+    _g1->register_optional_region_with_in_cset_fast_test(hr);
+    optional_region_num += 1;
+    hr = cset_chooser->peek_at(optional_region_num);
+  }
+
+  ergo_verbose3(ErgoCSetConstruction,
+                "select optional regions",
+                ergo_format_region("optional")
+                ergo_format_ms("predicted time")
+                ergo_format_ms("time limit"),
+                optional_region_num, predicted_time_ms, time_limit_ms);
+}
+
+uint G1CollectorPolicy::add_optional_regions_to_cset(double time_remaining_ms) {
+  assert(_inc_cset_build_state == Inactive, "Precondition");
+  CollectionSetChooser* cset_chooser = _collectionSetChooser;
+  double predicted_time_ms = 0.0;
+
+  uint added = 0;
+  while (has_optional_regions()) {
+    HeapRegion* hr = _optional_regions->at(_optional_regions_added);
+    double region_time_ms = predict_region_elapsed_time_ms(hr, false);
+    if (predicted_time_ms + region_time_ms > time_remaining_ms) {
+      break;
+    }
+    predicted_time_ms += region_time_ms;
+    cset_chooser->remove_and_move_to_next(hr);
+    _g1->old_set_remove(hr);
+    link_old_region_into_cset(hr);
+    _optional_regions_added += 1;
+    added += 1;
+  }
+
+  ergo_verbose4(ErgoCSetConstruction,
+                "add optional regions to CSet",
+                ergo_format_region("added")
+                ergo_format_region("left")
+                ergo_format_ms("predicted time")
+                ergo_format_ms("remaining time"),
+                added, _optional_regions->length() - _optional_regions_added,
+                predicted_time_ms, time_remaining_ms);
+  return added;
+}
+
+void G1CollectorPolicy::clear_optional_regions() {
+  for (uint i = _optional_regions_added; i < (uint) _optional_regions->length(); i++) {
+    _g1->clear_optional_region_in_cset_fast_test(_optional_regions->at(i));
+  }
+  _optional_regions->clear();
+  _optional_regions_added = 0;
+}
+
 void TraceGen0TimeData::record_start_collection(double time_to_stop_the_world_ms) {
   if(TraceGen0Time) {
     _all_stop_world_times_ms.add(time_to_stop_the_world_ms);
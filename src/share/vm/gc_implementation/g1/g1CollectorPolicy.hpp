@@ -492,6 +492,16 @@ private:
   // The number of bytes copied during the GC.
   size_t _bytes_copied_during_gc;
 
+  // The optional regions of a mixed collection: the candidates which
+  // follow the old regions of the collection set in the CSet chooser, in
+  // order. They are only added to the collection set if the pause has
+  // time left after evacuating it, see
+  // G1CollectedHeap::evacuate_optional_regions(). The first
+  // _optional_regions_added of them have been added, the others stay
+  // candidates in the CSet chooser.
+  GrowableArray<HeapRegion*>* _optional_regions;
+  uint _optional_regions_added;
+
   // The associated information that is maintained while the incremental
   // collection set is being built with young regions. Used to populate
   // the recorded info for the evacuation pause.
@@ -633,6 +643,12 @@ private:
   // as a percentage of the current heap capacity.
   double reclaimable_bytes_perc(size_t reclaimable_bytes);
 
+  // Selects the optional regions of a mixed collection, whose predicted
+  // time adds up to at most time_limit_ms.
+  void select_optional_regions(double time_limit_ms, uint max_old_cset_length);
+
+  void link_old_region_into_cset(HeapRegion* hr);
+
 public:
 
   G1CollectorPolicy();
@@ -733,6 +749,18 @@ public:
   // Add old region "hr" to the CSet.
   void add_old_region_to_cset(HeapRegion* hr);
 
+  bool has_optional_regions() {
+    return _optional_regions_added < (uint) _optional_regions->length();
+  }
+
+  // Adds the next optional regions to the head of the CSet, as many as
+  // are predicted to fit into time_remaining_ms. Returns their number.
+  uint add_optional_regions_to_cset(double time_remaining_ms);
+
+  // Forgets the optional regions which were not added to the CSet. They
+  // are left to the following mixed collections.
+  void clear_optional_regions();
+
   // Incremental CSet Support
 
   // The head of the incrementally built collection set.
@@ -83,6 +83,8 @@ class G1GCPhaseTimes : public CHeapObj<mtGC> {
 
   double _cur_collection_par_time_ms;
   double _cur_collection_code_root_fixup_time_ms;
+  double _cur_optional_evac_time_ms;
+  uint   _cur_optional_evac_regions;
   double _cur_strong_code_root_purge_time_ms;
 
   double _cur_evac_fail_recalc_used;
@@ -163,6 +165,11 @@ class G1GCPhaseTimes : public CHeapObj<mtGC> {
     _cur_collection_code_root_fixup_time_ms = ms;
   }
 
+  void record_optional_evacuation(double ms, uint regions) {
+    _cur_optional_evac_time_ms = ms;
+    _cur_optional_evac_regions = regions;
+  }
+
   void record_strong_code_root_purge_time(double ms) {
     _cur_strong_code_root_purge_time_ms = ms;
   }
@@ -248,6 +255,10 @@ class G1GCPhaseTimes : public CHeapObj<mtGC> {
     return _cur_collection_par_time_ms;
   }
 
+  double cur_optional_evac_time_ms() {
+    return _cur_optional_evac_time_ms;
+  }
+
   double cur_clear_ct_time_ms() {
     return _cur_clear_ct_time_ms;
   }
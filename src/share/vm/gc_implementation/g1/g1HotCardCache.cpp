@@ -23,14 +23,17 @@
  */
 
 #include "precompiled.hpp"
+#include "gc_implementation/g1/concurrentG1Refine.hpp"
 #include "gc_implementation/g1/dirtyCardQueue.hpp"
 #include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
 #include "gc_implementation/g1/g1HotCardCache.hpp"
 #include "gc_implementation/g1/g1RemSet.hpp"
+#include "memory/padded.inline.hpp"
 #include "runtime/atomic.hpp"
 
 G1HotCardCache::G1HotCardCache(G1CollectedHeap *g1h):
-  _g1h(g1h), _hot_cache(NULL), _use_cache(false), _card_counts(g1h) {}
+  _g1h(g1h), _hot_cache(NULL), _use_cache(false), _card_counts(g1h),
+  _n_partitions(0), _partition_size(0), _partition_idx(NULL) {}
 
 void G1HotCardCache::initialize(G1RegionToSpaceMapper* card_counts_storage) {
   if (default_use_cache()) {
@@ -39,10 +42,27 @@ void G1HotCardCache::initialize(G1RegionToSpaceMapper* card_counts_storage) {
     _hot_cache_size = (size_t)1 << G1ConcRSLogCacheSize;
     _hot_cache = NEW_C_HEAP_ARRAY(jbyte*, _hot_cache_size, mtGC);
 
+    // One partition per refinement thread, rounded down to a power of
+    // two, as long as a partition holds at least one claim chunk.
+    uint n_threads = MAX2(ConcurrentG1Refine::thread_num(), 1u);
+    _n_partitions = 1;
+    while (_n_partitions * 2 <= n_threads &&
+           _hot_cache_size / (_n_partitions * 2) >= ClaimChunkSize) {
+      _n_partitions *= 2;
+    }
+    _partition_size = _hot_cache_size / _n_partitions;
+    _partition_idx = PaddedArray<G1HotCardCachePartitionIndex, mtGC>::create_unfreeable(_n_partitions);
+    if (G1TraceConcRefinement) {
+      gclog_or_tty->print_cr("G1-Refine hot card cache partitions: %u, cards per partition: " SIZE_FORMAT,
+                             _n_partitions, _partition_size);
+    }
+
     reset_hot_cache_internal();
 
-    // For refining the cards in the hot cache in parallel
-    _hot_cache_par_chunk_size = (int)(ParallelGCThreads > 0 ? ClaimChunkSize : _hot_cache_size);
+    // For refining the cards in the hot cache in parallel. A chunk
+    // never spans two partitions.
+    _hot_cache_par_chunk_size = (int)(ParallelGCThreads > 0 ? MIN2(_partition_size, (size_t)ClaimChunkSize)
+                                                            : _partition_size);
     _hot_cache_par_claimed_idx = 0;
 
     _card_counts.initialize(card_counts_storage);
@@ -56,17 +76,37 @@ G1HotCardCache::~G1HotCardCache() {
   }
 }
 
-jbyte* G1HotCardCache::insert(jbyte* card_ptr) {
+void G1HotCardCache::print_partition_insertions() {
+  gclog_or_tty->print("G1-Refine hot card cache insertions per partition:");
+  for (uint i = 0; i < _n_partitions; i++) {
+    gclog_or_tty->print(" " SIZE_FORMAT, _partition_idx[i]._idx);
+  }
+  gclog_or_tty->cr();
+}
+
+jbyte* G1HotCardCache::insert(jbyte* card_ptr, uint worker_i) {
   uint count = _card_counts.add_card_count(card_ptr);
   if (!_card_counts.is_hot(count)) {
     // The card is not hot so do not store it in the cache;
     // return it for immediate refining.
     return card_ptr;
   }
-  // Otherwise, the card is hot.
-  size_t index = Atomic::add_ptr((intptr_t)1, (volatile intptr_t*)&_hot_cache_idx) - 1;
-  size_t masked_index = index & (_hot_cache_size - 1);
-  jbyte* current_ptr = _hot_cache[masked_index];
+  // Otherwise, the card is hot. Take the next slot of the partition
+  // of this worker.
+  uint partition = worker_i & (_n_partitions - 1);
+  volatile size_t* partition_idx = &_partition_idx[partition]._idx;
+  size_t index = Atomic::add_ptr((intptr_t)1, (volatile intptr_t*)partition_idx) - 1;
+  size_t slot = (size_t)partition * _partition_size + (index & (_partition_size - 1));
+  return insert_at(card_ptr, count + 1, slot);
+}
+
+jbyte* G1HotCardCache::insert_at(jbyte* card_ptr, uint count, size_t slot) {
+  jbyte* current_ptr = _hot_cache[slot];
+  if (current_ptr != NULL && _card_counts.card_count(current_ptr) > count) {
+    // The card in the slot has been refined more often, it is the
+    // better one to delay.
+    return card_ptr;
+  }
 
   // Try to store the new card pointer into the cache. Compare-and-swap to guard
   // against the unlikely event of a race resulting in another card pointer to
@@ -75,7 +115,7 @@ jbyte* G1HotCardCache::insert(jbyte* card_ptr) {
   // should be OK since card_ptr will likely be the older card already when/if
   // this ever happens.
   jbyte* previous_ptr = (jbyte*)Atomic::cmpxchg_ptr(card_ptr,
-                                                    &_hot_cache[masked_index],
+                                                    &_hot_cache[slot],
                                                     current_ptr);
   return (previous_ptr == current_ptr) ? previous_ptr : card_ptr;
 }
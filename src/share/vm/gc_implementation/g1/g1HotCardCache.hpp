@@ -28,6 +28,7 @@
 #include "gc_implementation/g1/g1_globals.hpp"
 #include "gc_implementation/g1/g1CardCounts.hpp"
 #include "memory/allocation.hpp"
+#include "memory/padded.hpp"
 #include "runtime/safepoint.hpp"
 #include "runtime/thread.inline.hpp"
 #include "utilities/globalDefinitions.hpp"
@@ -52,6 +53,19 @@ class HeapRegion;
 //
 // This can significantly reduce the overhead of the write barrier
 // code, increasing throughput.
+//
+// The cache is split into a power of two number of partitions, at most
+// one per concurrent refinement thread. A thread inserts into the
+// partition selected by its worker id, so threads do not contend on a
+// single insertion index and each fills consecutive slots of its own
+// partition. When a slot is reused, the card with the higher refinement
+// count stays in the cache and the other one is returned for refinement.
+
+// The insertion index of a partition, padded to a cache line.
+class G1HotCardCachePartitionIndex VALUE_OBJ_CLASS_SPEC {
+ public:
+  volatile size_t _idx;
+};
 
 class G1HotCardCache: public CHeapObj<mtGC> {
 
@@ -68,12 +82,17 @@ class G1HotCardCache: public CHeapObj<mtGC> {
 
   int               _hot_cache_par_chunk_size;
 
-  // Avoids false sharing when concurrently updating _hot_cache_idx or
-  // _hot_cache_par_claimed_idx. These are never updated at the same time
-  // thus it's not necessary to separate them as well
-  char _pad_before[DEFAULT_CACHE_LINE_SIZE];
+  // The partitions of the card cache table, each _partition_size
+  // consecutive entries with its own insertion index
+  uint              _n_partitions;
+
+  size_t            _partition_size;
 
-  volatile size_t _hot_cache_idx;
+  PaddedEnd<G1HotCardCachePartitionIndex>* _partition_idx;
+
+  // Avoids false sharing when concurrently updating
+  // _hot_cache_par_claimed_idx.
+  char _pad_before[DEFAULT_CACHE_LINE_SIZE];
 
   volatile size_t _hot_cache_par_claimed_idx;
 
@@ -86,6 +105,10 @@ class G1HotCardCache: public CHeapObj<mtGC> {
     return (G1ConcRSLogCacheSize > 0);
   }
 
+  // Stores card_ptr into the given slot unless the card in there has
+  // been refined more often. Returns the card to be refined or NULL.
+  jbyte* insert_at(jbyte* card_ptr, uint count, size_t slot);
+
  public:
   G1HotCardCache(G1CollectedHeap* g1h);
   ~G1HotCardCache();
@@ -103,11 +126,11 @@ class G1HotCardCache: public CHeapObj<mtGC> {
   // Increments the count for given the card. if the card is not 'hot',
   // it is returned for immediate refining. Otherwise the card is
   // added to the hot card cache.
-  // If there is enough room in the hot card cache for the card we're
-  // adding, NULL is returned and no further action in needed.
-  // If we evict a card from the cache to make room for the new card,
-  // the evicted card is then returned for refinement.
-  jbyte* insert(jbyte* card_ptr);
+  // If there is enough room in the partition of worker_i for the card
+  // we're adding, NULL is returned and no further action in needed.
+  // Otherwise the colder one of the new card and the card in the slot
+  // it would take is returned for refinement.
+  jbyte* insert(jbyte* card_ptr, uint worker_i);
 
   // Refine the cards that have delayed as a result of
   // being in the cache.
@@ -123,6 +146,9 @@ class G1HotCardCache: public CHeapObj<mtGC> {
     assert(SafepointSynchronize::is_at_safepoint(), "Should be at a safepoint");
     assert(Thread::current()->is_VM_thread(), "Current thread should be the VMthread");
     if (default_use_cache()) {
+        if (G1TraceConcRefinement) {
+          print_partition_insertions();
+        }
         reset_hot_cache_internal();
     }
   }
@@ -134,9 +160,15 @@ class G1HotCardCache: public CHeapObj<mtGC> {
   void reset_card_counts(HeapRegion* hr);
 
  private:
+  // Prints the number of cards inserted into each partition since the
+  // last reset.
+  void print_partition_insertions();
+
   void reset_hot_cache_internal() {
     assert(_hot_cache != NULL, "Logic");
-    _hot_cache_idx = 0;
+    for (uint i = 0; i < _n_partitions; i++) {
+      _partition_idx[i]._idx = 0;
+    }
     for (size_t i = 0; i < _hot_cache_size; i++) {
       _hot_cache[i] = NULL;
     }
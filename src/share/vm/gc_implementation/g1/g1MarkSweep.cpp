@@ -31,12 +31,13 @@
 #include "code/icBuffer.hpp"
 #include "gc_implementation/g1/g1Log.hpp"
 #include "gc_implementation/g1/g1MarkSweep.hpp"
+#include "gc_implementation/g1/g1ParMarkSweep.hpp"
 #include "gc_implementation/g1/g1RootProcessor.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
 #include "gc_implementation/shared/gcHeapSummary.hpp"
 #include "gc_implementation/shared/gcTimer.hpp"
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "gc_implementation/shared/gcTraceTime.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/gcLocker.hpp"
 #include "memory/genCollectedHeap.hpp"
 #include "memory/modRefBarrierSet.hpp"
@@ -86,16 +87,22 @@ void G1MarkSweep::invoke_at_safepoint(ReferenceProcessor* rp,
   // The marking doesn't preserve the marks of biased objects.
   BiasedLocking::preserve_marks();
 
-  mark_sweep_phase1(marked_for_unloading, clear_all_softrefs);
+  if (G1ParMarkSweep::should_collect_in_parallel()) {
+    // All four phases in the gang, with the marks preserved by the
+    // workers restored before returning.
+    G1ParMarkSweep::invoke_at_safepoint(rp, clear_all_softrefs);
+  } else {
+    mark_sweep_phase1(marked_for_unloading, clear_all_softrefs);
 
-  mark_sweep_phase2();
+    mark_sweep_phase2();
 
-  // Don't add any more derived pointers during phase3
-  COMPILER2_PRESENT(DerivedPointerTable::set_active(false));
+    // Don't add any more derived pointers during phase3
+    COMPILER2_PRESENT(DerivedPointerTable::set_active(false));
 
-  mark_sweep_phase3();
+    mark_sweep_phase3();
 
-  mark_sweep_phase4();
+    mark_sweep_phase4();
+  }
 
   GenMarkSweep::restore_marks();
   BiasedLocking::restore_marks();
@@ -158,6 +165,10 @@ void G1MarkSweep::mark_sweep_phase1(bool& marked_for_unloading,
   // This is the point where the entire marking should have completed.
   assert(GenMarkSweep::_marking_stack.is_empty(), "Marking should have completed");
 
+  unload_classes_and_verify();
+}
+
+void G1MarkSweep::unload_classes_and_verify() {
   // Unload classes and purge the SystemDictionary.
   bool purged_class = SystemDictionary::do_unloading(&GenMarkSweep::is_alive);
 
@@ -210,23 +221,26 @@ void G1MarkSweep::mark_sweep_phase2() {
   prepare_compaction();
 }
 
-class G1AdjustPointersClosure: public HeapRegionClosure {
- public:
-  bool doHeapRegion(HeapRegion* r) {
-    if (r->isHumongous()) {
-      if (r->startsHumongous()) {
-        // We must adjust the pointers on the single H object.
-        oop obj = oop(r->bottom());
-        // point all the oops to the new location
-        obj->adjust_pointers();
-      }
-    } else {
-      // This really ought to be "as_CompactibleSpace"...
-      r->adjust_pointers();
-    }
+bool G1AdjustPointersClosure::doHeapRegion(HeapRegion* r) {
+  if (r->is_archive()) {
+    // Archive objects only refer to other archive objects.
     return false;
   }
-};
+  if (r->isHumongous()) {
+    if (r->startsHumongous()) {
+      // We must adjust the pointers on the single H object.
+      oop obj = oop(r->bottom());
+      // point all the oops to the new location
+      obj->adjust_pointers();
+    }
+  } else if (r->is_pinned()) {
+    r->adjust_pinned_pointers();
+  } else {
+    // This really ought to be "as_CompactibleSpace"...
+    r->adjust_pointers();
+  }
+  return false;
+}
 
 class G1AlwaysTrueClosure: public BoolObjectClosure {
 public:
@@ -252,6 +266,17 @@ void G1MarkSweep::mark_sweep_phase3() {
                                      &adjust_code_closure);
   }
 
+  adjust_weak_roots();
+
+  GenMarkSweep::adjust_marks();
+
+  G1AdjustPointersClosure blk;
+  g1h->heap_region_iterate(&blk);
+}
+
+void G1MarkSweep::adjust_weak_roots() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+
   assert(GenMarkSweep::ref_processor() == g1h->ref_processor_stw(), "Sanity");
   g1h->ref_processor_stw()->weak_oops_do(&GenMarkSweep::adjust_pointer_closure);
 
@@ -259,37 +284,32 @@ void G1MarkSweep::mark_sweep_phase3() {
   // have been cleared if they pointed to non-surviving objects.)
   JNIHandles::weak_oops_do(&always_true, &GenMarkSweep::adjust_pointer_closure);
 
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::oops_do(&GenMarkSweep::adjust_pointer_closure);
+  if (StringDedup::is_enabled()) {
+    StringDedup::oops_do(&GenMarkSweep::adjust_pointer_closure);
   }
-
-  GenMarkSweep::adjust_marks();
-
-  G1AdjustPointersClosure blk;
-  g1h->heap_region_iterate(&blk);
 }
 
-class G1SpaceCompactClosure: public HeapRegionClosure {
-public:
-  G1SpaceCompactClosure() {}
-
-  bool doHeapRegion(HeapRegion* hr) {
-    if (hr->isHumongous()) {
-      if (hr->startsHumongous()) {
-        oop obj = oop(hr->bottom());
-        if (obj->is_gc_marked()) {
-          obj->init_mark();
-        } else {
-          assert(hr->is_empty(), "Should have been cleared in phase 2.");
-        }
-        hr->reset_during_compaction();
+bool G1SpaceCompactClosure::doHeapRegion(HeapRegion* hr) {
+  if (hr->is_archive()) {
+    return false;
+  }
+  if (hr->isHumongous()) {
+    if (hr->startsHumongous()) {
+      oop obj = oop(hr->bottom());
+      if (obj->is_gc_marked()) {
+        obj->init_mark();
+      } else {
+        assert(hr->is_empty(), "Should have been cleared in phase 2.");
       }
-    } else {
-      hr->compact();
+      hr->reset_during_compaction();
     }
-    return false;
+  } else if (hr->is_pinned()) {
+    hr->reset_pinned_after_compaction();
+  } else {
+    hr->compact();
   }
-};
+  return false;
+}
 
 void G1MarkSweep::mark_sweep_phase4() {
   // All pointers are now adjusted, move objects accordingly
@@ -356,6 +376,10 @@ void G1PrepareCompactClosure::update_sets() {
 }
 
 bool G1PrepareCompactClosure::doHeapRegion(HeapRegion* hr) {
+  if (hr->is_archive()) {
+    // Archive regions are neither compacted nor compacted into.
+    return false;
+  }
   if (hr->isHumongous()) {
     if (hr->startsHumongous()) {
       oop obj = oop(hr->bottom());
@@ -367,6 +391,9 @@ bool G1PrepareCompactClosure::doHeapRegion(HeapRegion* hr) {
     } else {
       assert(hr->continuesHumongous(), "Invalid humongous.");
     }
+  } else if (hr->is_pinned()) {
+    // Pinned regions are neither compacted nor compacted into.
+    hr->prepare_pinned_for_compaction();
   } else {
     prepare_for_compaction(hr, hr->end());
   }
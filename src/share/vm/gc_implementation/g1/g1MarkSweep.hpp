@@ -48,6 +48,7 @@ class G1PrepareCompactClosure;
 class G1MarkSweep : AllStatic {
   friend class VM_G1MarkSweep;
   friend class Scavenge;
+  friend class G1ParMarkSweep;
 
  public:
 
@@ -69,6 +70,11 @@ class G1MarkSweep : AllStatic {
   // Move objects to new positions
   static void mark_sweep_phase4();
 
+  // Class unloading and verification once marking is complete
+  static void unload_classes_and_verify();
+  // Adjust the weak roots not covered by the root processor
+  static void adjust_weak_roots();
+
   static void allocate_stacks();
   static void prepare_compaction();
   static void prepare_compaction_work(G1PrepareCompactClosure* blk);
@@ -96,4 +102,16 @@ class G1PrepareCompactClosure : public HeapRegionClosure {
   bool doHeapRegion(HeapRegion* hr);
 };
 
+class G1AdjustPointersClosure: public HeapRegionClosure {
+ public:
+  bool doHeapRegion(HeapRegion* r);
+};
+
+class G1SpaceCompactClosure: public HeapRegionClosure {
+public:
+  G1SpaceCompactClosure() {}
+
+  bool doHeapRegion(HeapRegion* hr);
+};
+
 #endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1MARKSWEEP_HPP
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#include "precompiled.hpp"
+#include "gc_implementation/g1/g1NUMA.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/os.hpp"
+#include "runtime/thread.inline.hpp"
+
+int*   G1NUMA::_node_ids = NULL;
+uint   G1NUMA::_num_active_nodes = 1;
+size_t G1NUMA::_region_size = 0;
+size_t G1NUMA::_page_size = 0;
+
+void G1NUMA::initialize(size_t region_size, size_t page_size) {
+  _region_size = region_size;
+  _page_size = page_size;
+
+  if (!UseNUMA) {
+    return;
+  }
+  int lgrp_limit = (int)os::numa_get_groups_num();
+  int* lgrp_ids = NEW_C_HEAP_ARRAY(int, MAX2(lgrp_limit, 1), mtGC);
+  int lgrp_num = (int)os::numa_get_leaf_groups(lgrp_ids, lgrp_limit);
+  if (lgrp_num <= 1) {
+    FREE_C_HEAP_ARRAY(int, lgrp_ids, mtGC);
+    return;
+  }
+  _node_ids = lgrp_ids;
+  _num_active_nodes = (uint)lgrp_num;
+
+  if (PrintGCDetails && Verbose) {
+    gclog_or_tty->print_cr("G1 NUMA: %u active nodes", _num_active_nodes);
+  }
+}
+
+uint G1NUMA::index_of_current_thread() {
+  if (!is_enabled()) {
+    return 0;
+  }
+  Thread* thr = Thread::current();
+  int lgrp_id = thr->lgrp_id();
+  if (lgrp_id == -1 || !os::numa_has_group_homing()) {
+    lgrp_id = os::numa_get_group_id();
+    thr->set_lgrp_id(lgrp_id);
+  }
+  for (uint i = 0; i < _num_active_nodes; i++) {
+    if (_node_ids[i] == lgrp_id) {
+      return i;
+    }
+  }
+  // A CPU hotplugged after initialization.
+  return (uint)lgrp_id % _num_active_nodes;
+}
+
+uint G1NUMA::preferred_node_index_for_index(uint region_index) {
+  if (!is_enabled()) {
+    return 0;
+  }
+  if (_region_size >= _page_size) {
+    return region_index % _num_active_nodes;
+  } else {
+    // Several regions share a page, which can only live on one node.
+    size_t regions_per_page = _page_size / _region_size;
+    return (uint)((region_index / regions_per_page) % _num_active_nodes);
+  }
+}
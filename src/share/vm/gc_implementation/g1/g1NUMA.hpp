@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1NUMA_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_G1_G1NUMA_HPP
+
+#include "memory/allocation.hpp"
+
+// NUMA support of G1, -XX:+UseNUMA.
+//
+// The regions of the heap are spread over the active NUMA nodes by their
+// index: region i lives on node i % n, or, if a page spans several
+// regions, on the node of its page.  The memory of a region is bound to
+// its node when it is committed.  Every region is tagged with the index of
+// its node, see HeapRegion::node_index().
+//
+// The mutator and GC allocation regions are kept per node.  A thread
+// allocates in the region of the node it runs on, which is taken from a
+// free region of that node when possible.
+//
+// Node indices run from 0 to num_active_nodes() - 1.  Without UseNUMA, or
+// on a single node, there is one node with index 0.
+
+class G1NUMA : AllStatic {
+ private:
+  // The locality group ids of the active nodes, by node index.
+  static int*   _node_ids;
+  static uint   _num_active_nodes;
+
+  static size_t _region_size;
+  static size_t _page_size;
+
+ public:
+  static const uint AnyNodeIndex = (uint)-1;
+
+  // Called before the heap is committed.
+  static void initialize(size_t region_size, size_t page_size);
+
+  static bool is_enabled() { return _num_active_nodes > 1; }
+  static uint num_active_nodes() { return _num_active_nodes; }
+
+  // The index of the node the current thread runs on.
+  static uint index_of_current_thread();
+
+  // The index of the node the region with the given index lives on.
+  static uint preferred_node_index_for_index(uint region_index);
+
+  // The locality group id of the node with the given index.
+  static int node_id(uint node_index) {
+    assert(node_index < _num_active_nodes, "sanity");
+    return _node_ids[node_index];
+  }
+};
+
+#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1NUMA_HPP
@@ -218,10 +218,23 @@ bool G1PageBasedVirtualSpace::commit(size_t start_page, size_t size_in_pages) {
   }
   _committed.set_range(start_page, end_page);
 
+  return zero_filled;
+}
+
+void G1PageBasedVirtualSpace::pretouch(size_t start_page, size_t size_in_pages) {
   if (AlwaysPreTouch) {
-    pretouch_internal(start_page, end_page);
+    pretouch_internal(start_page, start_page + size_in_pages);
   }
-  return zero_filled;
+}
+
+void G1PageBasedVirtualSpace::numa_make_local(size_t start_page, size_t size_in_pages, int lgrp_id) {
+  guarantee(is_area_committed(start_page, size_in_pages), "Specified area is not committed");
+  if (_special) {
+    // Pinned memory cannot be moved.
+    return;
+  }
+  char* start_addr = page_start(start_page);
+  os::numa_make_local(start_addr, pointer_delta(bounded_end_addr(start_page + size_in_pages), start_addr, sizeof(char)), lgrp_id);
 }
 
 void G1PageBasedVirtualSpace::uncommit_internal(size_t start_page, size_t end_page) {
@@ -112,8 +112,16 @@ class G1PageBasedVirtualSpace VALUE_OBJ_CLASS_SPEC {
 
   // Commit the given area of pages starting at start being size_in_pages large.
   // Returns true if the given area is zero filled upon completion.
+  // The caller is responsible for pretouching the area, see pretouch().
   bool commit(size_t start_page, size_t size_in_pages);
 
+  // Pretouch the given committed area of pages if AlwaysPreTouch.
+  void pretouch(size_t start_page, size_t size_in_pages);
+
+  // Bind the given committed area of pages to the locality group lgrp_id.
+  // Must be called before the area is touched.
+  void numa_make_local(size_t start_page, size_t size_in_pages, int lgrp_id);
+
   // Uncommit the given area of pages starting at start being size_in_pages large.
   void uncommit(size_t start_page, size_t size_in_pages);
 
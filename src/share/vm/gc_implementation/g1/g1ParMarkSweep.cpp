@@ -0,0 +1,566 @@
+/*
+ * Copyright (c) 2001, 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#include "precompiled.hpp"
+#include "classfile/classLoaderData.hpp"
+#include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
+#include "gc_implementation/g1/g1Log.hpp"
+#include "gc_implementation/g1/g1ParMarkSweep.hpp"
+#include "gc_implementation/g1/g1RootProcessor.hpp"
+#include "gc_implementation/shared/adaptiveSizePolicy.hpp"
+#include "gc_implementation/shared/gcTimer.hpp"
+#include "gc_implementation/shared/gcTrace.hpp"
+#include "gc_implementation/shared/gcTraceTime.hpp"
+#include "gc_implementation/shared/markSweep.inline.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "memory/iterator.inline.hpp"
+#include "memory/referenceProcessor.hpp"
+#include "oops/objArrayOop.hpp"
+#include "oops/oop.inline.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/stack.inline.hpp"
+#include "utilities/workgroup.hpp"
+
+G1ParMarkSweepMarker**                G1ParMarkSweep::_markers = NULL;
+OopTaskQueueSet*                      G1ParMarkSweep::_marking_stacks = NULL;
+G1ParMarkSweep::ObjArrayTaskQueueSet* G1ParMarkSweep::_objarray_stacks = NULL;
+uint                                  G1ParMarkSweep::_n_workers = 0;
+
+template <class T> inline void G1ParMarkAndPushClosure::do_oop_work(T* p) {
+  _marker->mark_and_push(p);
+}
+
+void G1ParMarkAndPushClosure::do_oop(oop* p)       { do_oop_work(p); }
+void G1ParMarkAndPushClosure::do_oop(narrowOop* p) { do_oop_work(p); }
+
+void G1ParFollowStackClosure::do_void() {
+  if (_terminator == NULL) {
+    _marker->drain_stacks();
+  } else {
+    _marker->complete_marking(_terminator);
+  }
+}
+
+G1ParMarkSweepMarker::G1ParMarkSweepMarker(uint worker_id) :
+  _worker_id(worker_id),
+  _mark_and_push_closure(this),
+  _follow_cld_closure(&_mark_and_push_closure) {
+  _marking_stack.initialize();
+  _objarray_stack.initialize();
+  _regions = new (ResourceObj::C_HEAP, mtGC) GrowableArray<HeapRegion*>(64, true);
+}
+
+inline bool G1ParMarkSweepMarker::mark_object(oop obj) {
+  markOop mark = obj->mark();
+  if (mark->is_marked() || MarkSweep::is_archive_object(obj)) {
+    return false;
+  }
+
+  if (StringDedup::is_enabled()) {
+    // We must enqueue the object before it is marked as we otherwise
+    // can't read the object's age. A string marked by two workers at
+    // once may be enqueued twice, which deduplication tolerates. The
+    // VM thread only marks while the workers are idle, and shares the
+    // queue of the last one.
+    StringDedup::enqueue_from_mark(MIN2(_worker_id, (uint)ParallelGCThreads - 1), obj);
+  }
+
+  // The mark can only change under us by another worker marking obj.
+  if (obj->cas_set_mark(markOopDesc::prototype()->set_marked(), mark) != mark) {
+    return false;
+  }
+  if (mark->must_be_preserved(obj)) {
+    preserve_mark(obj, mark);
+  }
+  return true;
+}
+
+template <class T> inline void G1ParMarkSweepMarker::mark_and_push(T* p) {
+  T heap_oop = oopDesc::load_heap_oop(p);
+  if (!oopDesc::is_null(heap_oop)) {
+    oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
+    if (mark_object(obj)) {
+      _marking_stack.push(obj);
+    }
+  }
+}
+
+void G1ParMarkSweepMarker::follow_object(oop obj) {
+  if (obj->is_objArray()) {
+    // Large arrays are followed in chunks, which the other workers can
+    // steal.
+    _mark_and_push_closure.do_klass(obj->klass());
+    follow_array_chunk(objArrayOop(obj), 0);
+  } else {
+    obj->oop_iterate(&_mark_and_push_closure);
+  }
+}
+
+void G1ParMarkSweepMarker::follow_array_chunk(objArrayOop array, int index) {
+  const size_t len = size_t(array->length());
+  const size_t beg_index = size_t(index);
+  assert(beg_index < len || len == 0, "index too large");
+
+  const size_t stride = MIN2(len - beg_index, ObjArrayMarkingStride);
+  const size_t end_index = beg_index + stride;
+
+  // Push the continuation first to allow it to be stolen.
+  if (end_index < len) {
+    _objarray_stack.push(ObjArrayTask(array, end_index));
+  }
+  array->oop_iterate_range(&_mark_and_push_closure, (int)beg_index, (int)end_index);
+}
+
+void G1ParMarkSweepMarker::drain_stacks() {
+  do {
+    oop obj;
+    // Drain the overflow stack first, to allow stealing from the marking stack.
+    while (_marking_stack.pop_overflow(obj)) {
+      follow_object(obj);
+    }
+    while (_marking_stack.pop_local(obj)) {
+      follow_object(obj);
+    }
+
+    // Process ObjArrays one at a time to avoid marking stack bloat.
+    ObjArrayTask task;
+    if (_objarray_stack.pop_overflow(task) || _objarray_stack.pop_local(task)) {
+      follow_array_chunk(objArrayOop(task.obj()), task.index());
+    }
+  } while (!_marking_stack.is_empty() || !_objarray_stack.is_empty());
+}
+
+void G1ParMarkSweepMarker::complete_marking(ParallelTaskTerminator* terminator) {
+  assert(_worker_id < G1ParMarkSweep::n_workers(), "only workers steal");
+  int seed = 17;
+  while (true) {
+    drain_stacks();
+
+    ObjArrayTask task;
+    oop obj;
+    if (G1ParMarkSweep::objarray_stacks()->steal(_worker_id, &seed, task)) {
+      follow_array_chunk(objArrayOop(task.obj()), task.index());
+    } else if (G1ParMarkSweep::marking_stacks()->steal(_worker_id, &seed, obj)) {
+      follow_object(obj);
+    } else if (terminator->offer_termination()) {
+      break;
+    }
+  }
+}
+
+void G1ParMarkSweepMarker::preserve_mark(oop obj, markOop mark) {
+  _preserved_mark_stack.push(mark);
+  _preserved_oop_stack.push(obj);
+}
+
+void G1ParMarkSweepMarker::adjust_marks() {
+  assert(_preserved_oop_stack.size() == _preserved_mark_stack.size(),
+         "inconsistent preserved oop stacks");
+  StackIterator<oop, mtGC> iter(_preserved_oop_stack);
+  while (!iter.is_empty()) {
+    oop* p = iter.next_addr();
+    MarkSweep::adjust_pointer(p);
+  }
+}
+
+void G1ParMarkSweepMarker::restore_marks() {
+  assert(_preserved_oop_stack.size() == _preserved_mark_stack.size(),
+         "inconsistent preserved oop stacks");
+  while (!_preserved_oop_stack.is_empty()) {
+    oop obj       = _preserved_oop_stack.pop();
+    markOop mark  = _preserved_mark_stack.pop();
+    obj->set_mark(mark);
+  }
+}
+
+void G1ParPrepareCompactClosure::prepare_for_compaction(HeapRegion* hr, HeapWord* end) {
+  // Chain hr to the regions of this worker before preparing it, the
+  // compaction point may move on to it.  It never moves past it: the
+  // live objects of hr fit below their current addresses.
+  assert(hr->CompactibleSpace::next_compaction_space() == NULL, "chained twice");
+  if (!is_cp_initialized()) {
+    _cp.space = hr;
+    _cp.threshold = hr->initialize_threshold();
+  } else {
+    _last->set_next_compaction_space(hr);
+  }
+  _last = hr;
+  _marker->regions()->append(hr);
+  prepare_for_compaction_work(&_cp, hr, end);
+}
+
+void G1ParPrepareCompactClosure::free_humongous_series(HeapRegion* hr) {
+  HeapWord* end = hr->end();
+  uint last_index = hr->last_hc_index();
+  FreeRegionList dummy_free_list("Dummy Free List for G1ParMarkSweep");
+
+  hr->set_containing_set(NULL);
+  _humongous_regions_removed.increment(1u, hr->capacity());
+
+  // Freed as par, which keeps the claim values; the remembered sets are
+  // cleared after the collection anyway.
+  _g1h->free_humongous_region(hr, &dummy_free_list, true /* par */);
+  prepare_for_compaction(hr, end);
+
+  // The continues humongous regions were claimed and skipped when they
+  // were visited before hr, they are this worker's to compact into.
+  for (uint i = hr->hrm_index() + 1; i < last_index; i++) {
+    HeapRegion* curr_hr = _g1h->region_at(i);
+    prepare_for_compaction(curr_hr, curr_hr->end());
+  }
+  dummy_free_list.remove_all();
+}
+
+bool G1ParPrepareCompactClosure::doHeapRegion(HeapRegion* hr) {
+  if (hr->is_archive()) {
+    // Archive regions are neither compacted nor compacted into.
+    return false;
+  }
+  if (hr->isHumongous()) {
+    if (hr->startsHumongous()) {
+      oop obj = oop(hr->bottom());
+      if (obj->is_gc_marked()) {
+        obj->forward_to(obj);
+        _marker->regions()->append(hr);
+      } else  {
+        free_humongous_series(hr);
+      }
+    } else {
+      assert(hr->continuesHumongous(), "Invalid humongous.");
+    }
+  } else if (hr->is_pinned()) {
+    // Pinned regions are neither compacted nor compacted into, they are
+    // only adjusted and have their marks reset by this worker.
+    hr->prepare_pinned_for_compaction();
+    _marker->regions()->append(hr);
+  } else {
+    prepare_for_compaction(hr, hr->end());
+  }
+  return false;
+}
+
+class G1ParMarkTask : public AbstractGangTask {
+ private:
+  G1RootProcessor*       _root_processor;
+  ParallelTaskTerminator _terminator;
+
+ public:
+  G1ParMarkTask(G1RootProcessor* root_processor, uint n_workers) :
+    AbstractGangTask("G1 full GC marking"),
+    _root_processor(root_processor),
+    _terminator(n_workers, G1ParMarkSweep::marking_stacks()) { }
+
+  void work(uint worker_id) {
+    G1ParMarkSweepMarker* marker = G1ParMarkSweep::marker(worker_id);
+    MarkingCodeBlobClosure follow_code_closure(marker->mark_and_push_closure(), !CodeBlobToOopClosure::FixRelocations);
+    _root_processor->process_strong_roots(marker->mark_and_push_closure(),
+                                          marker->follow_cld_closure(),
+                                          &follow_code_closure);
+    marker->complete_marking(&_terminator);
+  }
+};
+
+class G1ParMarkSweepRefProcTaskProxy : public AbstractGangTask {
+  typedef AbstractRefProcTaskExecutor::ProcessTask ProcessTask;
+  ProcessTask&           _proc_task;
+  ParallelTaskTerminator _terminator;
+
+ public:
+  G1ParMarkSweepRefProcTaskProxy(ProcessTask& proc_task, uint n_workers) :
+    AbstractGangTask("G1 full GC reference processing"),
+    _proc_task(proc_task),
+    _terminator(n_workers, G1ParMarkSweep::marking_stacks()) { }
+
+  void work(uint worker_id) {
+    G1ParMarkSweepMarker* marker = G1ParMarkSweep::marker(worker_id);
+    G1ParFollowStackClosure follow_stack_closure(marker, &_terminator);
+    _proc_task.work(worker_id, GenMarkSweep::is_alive,
+                    *marker->mark_and_push_closure(), follow_stack_closure);
+  }
+};
+
+class G1ParMarkSweepRefEnqueueTaskProxy : public AbstractGangTask {
+  typedef AbstractRefProcTaskExecutor::EnqueueTask EnqueueTask;
+  EnqueueTask& _enq_task;
+
+ public:
+  G1ParMarkSweepRefEnqueueTaskProxy(EnqueueTask& enq_task) :
+    AbstractGangTask("G1 full GC reference enqueueing"),
+    _enq_task(enq_task) { }
+
+  void work(uint worker_id) {
+    _enq_task.work(worker_id);
+  }
+};
+
+class G1ParMarkSweepRefProcTaskExecutor : public AbstractRefProcTaskExecutor {
+ public:
+  virtual void execute(ProcessTask& task);
+  virtual void execute(EnqueueTask& task);
+};
+
+void G1ParMarkSweepRefProcTaskExecutor::execute(ProcessTask& task) {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  G1ParMarkSweepRefProcTaskProxy proc_task_proxy(task, G1ParMarkSweep::n_workers());
+  g1h->set_par_threads(G1ParMarkSweep::n_workers());
+  g1h->workers()->run_task(&proc_task_proxy);
+  g1h->set_par_threads(0);
+}
+
+void G1ParMarkSweepRefProcTaskExecutor::execute(EnqueueTask& task) {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  G1ParMarkSweepRefEnqueueTaskProxy enq_task_proxy(task);
+  g1h->set_par_threads(G1ParMarkSweep::n_workers());
+  g1h->workers()->run_task(&enq_task_proxy);
+  g1h->set_par_threads(0);
+}
+
+class G1ParPrepareCompactTask : public AbstractGangTask {
+ public:
+  G1ParPrepareCompactTask() : AbstractGangTask("G1 full GC forwarding") { }
+
+  void work(uint worker_id) {
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    G1ParMarkSweepMarker* marker = G1ParMarkSweep::marker(worker_id);
+    assert(marker->regions()->is_empty(), "regions of the last collection");
+
+    G1ParPrepareCompactClosure blk(marker);
+    g1h->heap_region_par_iterate_chunked(&blk, worker_id,
+                                         G1ParMarkSweep::n_workers(),
+                                         HeapRegion::ParMarkSweepClaimValue);
+    blk.update_sets();
+  }
+};
+
+class G1ParAdjustTask : public AbstractGangTask {
+ private:
+  G1RootProcessor* _root_processor;
+
+ public:
+  G1ParAdjustTask(G1RootProcessor* root_processor) :
+    AbstractGangTask("G1 full GC adjust pointers"),
+    _root_processor(root_processor) { }
+
+  void work(uint worker_id) {
+    G1ParMarkSweepMarker* marker = G1ParMarkSweep::marker(worker_id);
+
+    CodeBlobToOopClosure adjust_code_closure(&GenMarkSweep::adjust_pointer_closure, CodeBlobToOopClosure::FixRelocations);
+    _root_processor->process_all_roots(&GenMarkSweep::adjust_pointer_closure,
+                                       &GenMarkSweep::adjust_cld_closure,
+                                       &adjust_code_closure);
+
+    marker->adjust_marks();
+
+    G1AdjustPointersClosure blk;
+    GrowableArray<HeapRegion*>* regions = marker->regions();
+    for (int i = 0; i < regions->length(); i++) {
+      blk.doHeapRegion(regions->at(i));
+    }
+  }
+};
+
+class G1ParCompactTask : public AbstractGangTask {
+ public:
+  G1ParCompactTask() : AbstractGangTask("G1 full GC compaction") { }
+
+  void work(uint worker_id) {
+    G1ParMarkSweepMarker* marker = G1ParMarkSweep::marker(worker_id);
+
+    G1SpaceCompactClosure blk;
+    GrowableArray<HeapRegion*>* regions = marker->regions();
+    for (int i = 0; i < regions->length(); i++) {
+      HeapRegion* hr = regions->at(i);
+      blk.doHeapRegion(hr);
+      hr->set_next_compaction_space(NULL);
+    }
+    regions->clear();
+  }
+};
+
+// Marks are restored once all objects are in place, the object of a
+// preserved mark was not necessarily moved by the worker that marked it.
+class G1ParRestoreMarksTask : public AbstractGangTask {
+ public:
+  G1ParRestoreMarksTask() : AbstractGangTask("G1 full GC restore marks") { }
+
+  void work(uint worker_id) {
+    G1ParMarkSweep::marker(worker_id)->restore_marks();
+  }
+};
+
+void G1ParMarkSweep::initialize() {
+  uint parallel_gc_threads = (uint)ParallelGCThreads;
+
+  _markers = NEW_C_HEAP_ARRAY(G1ParMarkSweepMarker*, parallel_gc_threads + 1, mtGC);
+  _marking_stacks = new OopTaskQueueSet(parallel_gc_threads);
+  _objarray_stacks = new ObjArrayTaskQueueSet(parallel_gc_threads);
+
+  for (uint i = 0; i < parallel_gc_threads; i++) {
+    _markers[i] = new G1ParMarkSweepMarker(i);
+    _marking_stacks->register_queue(i, &_markers[i]->_marking_stack);
+    _objarray_stacks->register_queue(i, &_markers[i]->_objarray_stack);
+  }
+  _markers[parallel_gc_threads] = new G1ParMarkSweepMarker(parallel_gc_threads);
+}
+
+void G1ParMarkSweep::invoke_at_safepoint(ReferenceProcessor* rp,
+                                         bool clear_all_softrefs) {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  assert(should_collect_in_parallel(), "Precondition");
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  if (_markers == NULL) {
+    initialize();
+  }
+
+  _n_workers = AdaptiveSizePolicy::calc_active_workers(g1h->workers()->total_workers(),
+                                                       g1h->workers()->active_workers(),
+                                                       Threads::number_of_non_daemon_threads());
+  g1h->workers()->set_active_workers(_n_workers);
+  rp->set_active_mt_degree(_n_workers);
+
+  mark_sweep_phase1(rp, clear_all_softrefs);
+
+  mark_sweep_phase2();
+
+  // Don't add any more derived pointers during phase3
+  COMPILER2_PRESENT(DerivedPointerTable::set_active(false));
+
+  mark_sweep_phase3();
+
+  mark_sweep_phase4();
+
+  G1ParRestoreMarksTask restore_task;
+  g1h->set_par_threads(_n_workers);
+  g1h->workers()->run_task(&restore_task);
+  g1h->set_par_threads(0);
+  vm_thread_marker()->restore_marks();
+}
+
+void G1ParMarkSweep::mark_sweep_phase1(ReferenceProcessor* rp,
+                                       bool clear_all_softrefs) {
+  // Recursively traverse all live objects and mark them
+  GCTraceTime tm("phase 1", G1Log::fine() && Verbose, true, G1MarkSweep::gc_timer(), G1MarkSweep::gc_tracer()->gc_id());
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+
+  // Need cleared claim bits for the roots processing
+  ClassLoaderDataGraph::clear_claimed_marks();
+
+  for (uint i = 0; i < _n_workers; i++) {
+    marker(i)->mark_and_push_closure()->_ref_processor = rp;
+  }
+
+  g1h->set_par_threads(_n_workers);
+  {
+    // Every worker discovers references into its own lists.
+    ReferenceProcessorMTDiscoveryMutator rp_disc_mt(rp, true);
+
+    G1RootProcessor root_processor(g1h);
+    root_processor.set_num_workers(_n_workers);
+    G1ParMarkTask mark_task(&root_processor, _n_workers);
+    g1h->workers()->run_task(&mark_task);
+  }
+  g1h->set_par_threads(0);
+
+  // Process reference objects found during marking. The VM thread
+  // marks whatever it keeps alive itself.
+  G1ParMarkSweepMarker* vm_marker = vm_thread_marker();
+  G1ParFollowStackClosure follow_stack_closure(vm_marker, NULL);
+  G1ParMarkSweepRefProcTaskExecutor executor;
+
+  rp->setup_policy(clear_all_softrefs);
+  const ReferenceProcessorStats& stats =
+    rp->process_discovered_references(&GenMarkSweep::is_alive,
+                                      vm_marker->mark_and_push_closure(),
+                                      &follow_stack_closure,
+                                      rp->processing_is_mt() ? &executor : NULL,
+                                      G1MarkSweep::gc_timer(),
+                                      G1MarkSweep::gc_tracer()->gc_id());
+  G1MarkSweep::gc_tracer()->report_gc_reference_stats(stats);
+
+  for (uint i = 0; i < _n_workers; i++) {
+    marker(i)->mark_and_push_closure()->_ref_processor = NULL;
+  }
+
+#ifdef ASSERT
+  // This is the point where the entire marking should have completed.
+  for (uint i = 0; i <= ParallelGCThreads; i++) {
+    assert(marker(i)->_marking_stack.is_empty() && marker(i)->_objarray_stack.is_empty(),
+           "Marking should have completed");
+  }
+#endif
+
+  G1MarkSweep::unload_classes_and_verify();
+}
+
+void G1ParMarkSweep::mark_sweep_phase2() {
+  // Now all live objects are marked, compute the new object addresses.
+  GCTraceTime tm("phase 2", G1Log::fine() && Verbose, true, G1MarkSweep::gc_timer(), G1MarkSweep::gc_tracer()->gc_id());
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+
+  assert(g1h->check_heap_region_claim_values(HeapRegion::InitialClaimValue), "sanity check");
+  G1ParPrepareCompactTask prepare_task;
+  g1h->set_par_threads(_n_workers);
+  g1h->workers()->run_task(&prepare_task);
+  g1h->set_par_threads(0);
+  assert(g1h->check_heap_region_claim_values(HeapRegion::ParMarkSweepClaimValue), "sanity check");
+  g1h->reset_heap_region_claim_values();
+}
+
+void G1ParMarkSweep::mark_sweep_phase3() {
+  // Adjust the pointers to reflect the new locations
+  GCTraceTime tm("phase 3", G1Log::fine() && Verbose, true, G1MarkSweep::gc_timer(), G1MarkSweep::gc_tracer()->gc_id());
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+
+  // Need cleared claim bits for the roots processing
+  ClassLoaderDataGraph::clear_claimed_marks();
+
+  g1h->set_par_threads(_n_workers);
+  {
+    G1RootProcessor root_processor(g1h);
+    root_processor.set_num_workers(_n_workers);
+    G1ParAdjustTask adjust_task(&root_processor);
+    g1h->workers()->run_task(&adjust_task);
+  }
+  g1h->set_par_threads(0);
+
+  G1MarkSweep::adjust_weak_roots();
+
+  vm_thread_marker()->adjust_marks();
+}
+
+void G1ParMarkSweep::mark_sweep_phase4() {
+  // All pointers are now adjusted, move objects accordingly
+  GCTraceTime tm("phase 4", G1Log::fine() && Verbose, true, G1MarkSweep::gc_timer(), G1MarkSweep::gc_tracer()->gc_id());
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+
+  G1ParCompactTask compact_task;
+  g1h->set_par_threads(_n_workers);
+  g1h->workers()->run_task(&compact_task);
+  g1h->set_par_threads(0);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2001, 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1PARMARKSWEEP_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_G1_G1PARMARKSWEEP_HPP
+
+#include "gc_implementation/g1/g1MarkSweep.hpp"
+#include "memory/iterator.hpp"
+#include "utilities/growableArray.hpp"
+#include "utilities/stack.hpp"
+#include "utilities/taskqueue.hpp"
+
+class G1ParMarkSweepMarker;
+class ReferenceProcessor;
+
+// G1ParMarkSweep runs the four phases of G1MarkSweep in the parallel
+// GC threads, -XX:+G1ParallelFullGC.
+//
+// Phase 1: every worker scans its share of the strong roots and marks
+// through the objects it reaches, using its own marking stack and
+// stealing from the stacks of the other workers.  Objects are marked by
+// a CAS on the mark word, so each object is pushed by exactly one
+// worker, which also preserves its mark.  References are discovered per
+// worker and processed in the gang when ParallelRefProcEnabled.  Class
+// unloading and the weak tables are cleaned by the VM thread.
+//
+// Phase 2: the workers claim the regions in chunks.  Each worker chains
+// the regions it claimed and compacts them into each other only, in
+// claim order, with its own CompactPoint.
+//
+// Phase 3: the roots are adjusted as in phase 1, the regions a worker
+// claimed in phase 2 by that worker.
+//
+// Phase 4: every worker moves the objects of its own regions, in the
+// order of phase 2, so a region is only written to after its own live
+// objects moved out.
+//
+// The result is not as dense as the one of the serial collector: each
+// chain ends in a partially filled region.
+
+class G1ParMarkAndPushClosure: public MetadataAwareOopClosure {
+ private:
+  G1ParMarkSweepMarker* _marker;
+
+  template <class T> inline void do_oop_work(T* p);
+
+ public:
+  G1ParMarkAndPushClosure(G1ParMarkSweepMarker* marker) : _marker(marker) { }
+
+  virtual void do_oop(oop* p);
+  virtual void do_oop(narrowOop* p);
+};
+
+class G1ParFollowStackClosure: public VoidClosure {
+ private:
+  G1ParMarkSweepMarker*   _marker;
+  ParallelTaskTerminator* _terminator;
+
+ public:
+  // Without a terminator only the stacks of marker are drained.
+  G1ParFollowStackClosure(G1ParMarkSweepMarker* marker,
+                          ParallelTaskTerminator* terminator) :
+    _marker(marker), _terminator(terminator) { }
+
+  void do_void();
+};
+
+class G1ParMarkSweepMarker : public CHeapObj<mtGC> {
+  friend class G1ParMarkSweep;
+ private:
+  typedef OverflowTaskQueue<ObjArrayTask, mtGC> ObjArrayTaskQueue;
+
+  uint                          _worker_id;
+  OverflowTaskQueue<oop, mtGC>  _marking_stack;
+  ObjArrayTaskQueue             _objarray_stack;
+  Stack<oop, mtGC>              _preserved_oop_stack;
+  Stack<markOop, mtGC>          _preserved_mark_stack;
+
+  G1ParMarkAndPushClosure       _mark_and_push_closure;
+  CLDToOopClosure               _follow_cld_closure;
+
+  // The regions claimed in phase 2, in claim order
+  GrowableArray<HeapRegion*>*   _regions;
+
+  void follow_object(oop obj);
+  void follow_array_chunk(objArrayOop array, int index);
+  void preserve_mark(oop obj, markOop mark);
+
+ public:
+  G1ParMarkSweepMarker(uint worker_id);
+
+  G1ParMarkAndPushClosure* mark_and_push_closure() { return &_mark_and_push_closure; }
+  CLDClosure* follow_cld_closure()                 { return &_follow_cld_closure; }
+  GrowableArray<HeapRegion*>* regions()            { return _regions; }
+
+  // Marks obj, returns false if it was marked before.
+  inline bool mark_object(oop obj);
+  template <class T> inline void mark_and_push(T* p);
+
+  // Empties the marking stacks of this worker.
+  void drain_stacks();
+  // Drains, then steals from the other workers until all stacks are empty.
+  void complete_marking(ParallelTaskTerminator* terminator);
+
+  void adjust_marks();
+  void restore_marks();
+};
+
+// Phase 2 closure of a worker.
+class G1ParPrepareCompactClosure : public G1PrepareCompactClosure {
+ private:
+  G1ParMarkSweepMarker* _marker;
+  HeapRegion*           _last;
+
+  void free_humongous_series(HeapRegion* hr);
+
+ protected:
+  virtual void prepare_for_compaction(HeapRegion* hr, HeapWord* end);
+
+ public:
+  G1ParPrepareCompactClosure(G1ParMarkSweepMarker* marker) :
+    G1PrepareCompactClosure(), _marker(marker), _last(NULL) { }
+
+  bool doHeapRegion(HeapRegion* hr);
+};
+
+class G1ParMarkSweep : AllStatic {
+  friend class G1ParMarkSweepMarker;
+ private:
+  typedef GenericTaskQueueSet<G1ParMarkSweepMarker::ObjArrayTaskQueue, mtGC> ObjArrayTaskQueueSet;
+
+  // One marker per GC thread, and one for the VM thread at index
+  // ParallelGCThreads which is not available for stealing.
+  static G1ParMarkSweepMarker** _markers;
+  static OopTaskQueueSet*       _marking_stacks;
+  static ObjArrayTaskQueueSet*  _objarray_stacks;
+
+  static uint _n_workers;
+
+  static void initialize();
+
+  static void mark_sweep_phase1(ReferenceProcessor* rp, bool clear_all_softrefs);
+  static void mark_sweep_phase2();
+  static void mark_sweep_phase3();
+  static void mark_sweep_phase4();
+
+ public:
+  static bool should_collect_in_parallel() {
+    return G1ParallelFullGC && ParallelGCThreads > 1;
+  }
+
+  static G1ParMarkSweepMarker* marker(uint worker_id) {
+    assert(worker_id <= ParallelGCThreads, "sanity");
+    return _markers[worker_id];
+  }
+  static G1ParMarkSweepMarker* vm_thread_marker() { return _markers[ParallelGCThreads]; }
+
+  static OopTaskQueueSet* marking_stacks()       { return _marking_stacks; }
+  static ObjArrayTaskQueueSet* objarray_stacks() { return _objarray_stacks; }
+
+  static uint n_workers() { return _n_workers; }
+
+  // Called by G1MarkSweep::invoke_at_safepoint() in place of its phases.
+  static void invoke_at_safepoint(ReferenceProcessor* rp, bool clear_all_softrefs);
+};
+
+#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1PARMARKSWEEP_HPP
@@ -30,12 +30,37 @@
 #include "oops/oop.pcgc.inline.hpp"
 #include "runtime/prefetch.inline.hpp"
 
+G1OptionalRegionRefs::G1OptionalRegionRefs() {
+  _roots = new (ResourceObj::C_HEAP, mtGC) GrowableArray<StarTask>(16, true, mtGC);
+  _refs = new (ResourceObj::C_HEAP, mtGC) GrowableArray<StarTask>(16, true, mtGC);
+  _prev_roots = new (ResourceObj::C_HEAP, mtGC) GrowableArray<StarTask>(16, true, mtGC);
+  _prev_refs = new (ResourceObj::C_HEAP, mtGC) GrowableArray<StarTask>(16, true, mtGC);
+}
+
+void G1OptionalRegionRefs::start_increment() {
+  assert(_prev_roots->is_empty() && _prev_refs->is_empty(), "Previous increment not processed");
+  GrowableArray<StarTask>* roots = _prev_roots;
+  _prev_roots = _roots;
+  _roots = roots;
+  GrowableArray<StarTask>* refs = _prev_refs;
+  _prev_refs = _refs;
+  _refs = refs;
+}
+
+void G1OptionalRegionRefs::clear() {
+  _roots->clear();
+  _refs->clear();
+  _prev_roots->clear();
+  _prev_refs->clear();
+}
+
 G1ParScanThreadState::G1ParScanThreadState(G1CollectedHeap* g1h, uint queue_num, ReferenceProcessor* rp)
   : _g1h(g1h),
     _refs(g1h->task_queue(queue_num)),
     _dcq(&g1h->dirty_card_queue_set()),
     _ct_bs(g1h->g1_barrier_set()),
     _g1_rem(g1h->g1_rem_set()),
+    _optional_refs(g1h->optional_region_refs(queue_num)),
     _hash_seed(17), _queue_num(queue_num),
     _term_attempts(0),
     _tenuring_threshold(g1h->g1_policy()->tenuring_threshold()),
@@ -207,6 +232,12 @@ oop G1ParScanThreadState::copy_to_survivor_space(InCSetState const state,
          (!from_region->is_young() && young_index == 0), "invariant" );
   const AllocationContext_t context = from_region->allocation_context();
 
+  if (from_region->is_pinned()) {
+    // The objects of pinned regions stay in place. The region is retained
+    // as an old region like one whose evacuation failed.
+    return _g1h->handle_evacuation_failure_par(this, old);
+  }
+
   uint age = 0;
   InCSetState dest_state = next_state(state, old_mark, age);
   HeapWord* obj_ptr = _g1_par_allocator->plab_allocate(dest_state, word_sz, context);
@@ -263,17 +294,17 @@ oop G1ParScanThreadState::copy_to_survivor_space(InCSetState const state,
       obj->set_mark(old_mark);
     }
 
-    if (G1StringDedup::is_enabled()) {
+    if (StringDedup::is_enabled()) {
       const bool is_from_young = state.is_young();
       const bool is_to_young = dest_state.is_young();
       assert(is_from_young == _g1h->heap_region_containing_raw(old)->is_young(),
              "sanity");
       assert(is_to_young == _g1h->heap_region_containing_raw(obj)->is_young(),
              "sanity");
-      G1StringDedup::enqueue_from_evacuation(is_from_young,
-                                             is_to_young,
-                                             queue_num(),
-                                             obj);
+      StringDedup::enqueue_from_evacuation(is_from_young,
+                                           is_to_young,
+                                           queue_num(),
+                                           obj);
     }
 
     size_t* const surv_young_words = surviving_young_words();
@@ -34,10 +34,43 @@
 #include "gc_implementation/shared/ageTable.hpp"
 #include "memory/allocation.hpp"
 #include "oops/oop.hpp"
+#include "utilities/growableArray.hpp"
 
 class HeapRegion;
 class outputStream;
 
+// The references into optional regions (see G1CollectorPolicy) which a
+// worker found during an evacuation pause. They are kept across the
+// increments of the pause: an increment processes the references found
+// before it and records anew those which still point into optional
+// regions.
+class G1OptionalRegionRefs VALUE_OBJ_CLASS_SPEC {
+ private:
+  // Locations outside of the heap, found by the root closures.
+  GrowableArray<StarTask>* _roots;
+  // Locations in the heap.
+  GrowableArray<StarTask>* _refs;
+
+  // The references found before the current increment.
+  GrowableArray<StarTask>* _prev_roots;
+  GrowableArray<StarTask>* _prev_refs;
+
+ public:
+  G1OptionalRegionRefs();
+
+  template <class T> void add_root(T* p) { _roots->append(StarTask(p)); }
+  template <class T> void add_ref(T* p)  { _refs->append(StarTask(p)); }
+
+  // Moves the references recorded so far to the prev lists, which are
+  // processed and cleared by the increment.
+  void start_increment();
+
+  GrowableArray<StarTask>* prev_roots() { return _prev_roots; }
+  GrowableArray<StarTask>* prev_refs()  { return _prev_refs; }
+
+  void clear();
+};
+
 class G1ParScanThreadState : public StackObj {
  private:
   G1CollectedHeap* _g1h;
@@ -59,6 +92,8 @@ class G1ParScanThreadState : public StackObj {
 
   OopsInHeapRegionClosure*      _evac_failure_cl;
 
+  G1OptionalRegionRefs*         _optional_refs;
+
   int  _hash_seed;
   uint _queue_num;
 
@@ -111,6 +146,15 @@ class G1ParScanThreadState : public StackObj {
     _refs->push(ref);
   }
 
+  // The given root or heap location points into an optional region. It is
+  // updated by the increment of the pause which evacuates the region, if any.
+  template <class T> void remember_root_into_optional_region(T* p) {
+    _optional_refs->add_root(p);
+  }
+  template <class T> void remember_ref_into_optional_region(T* p) {
+    _optional_refs->add_ref(p);
+  }
+
   template <class T> void update_rs(HeapRegion* from, T* p, int tid) {
     // If the new value of the field points to the same region or
     // is the to-space, we don't need to include it in the Rset updates.
@@ -50,6 +50,8 @@ template <class T> void G1ParScanThreadState::do_oop_evac(T* p, HeapRegion* from
     oopDesc::encode_store_heap_oop(p, forwardee);
   } else if (in_cset_state.is_humongous()) {
     _g1h->set_humongous_is_live(obj);
+  } else if (in_cset_state.is_optional()) {
+    remember_ref_into_optional_region(p);
   } else {
     assert(!in_cset_state.is_in_cset_or_humongous(),
            err_msg("In_cset_state must be NotInCSet here, but is " CSETSTATE_FORMAT, in_cset_state.value()));
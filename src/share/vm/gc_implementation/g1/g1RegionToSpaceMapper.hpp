@@ -51,8 +51,14 @@ class G1RegionToSpaceMapper : public CHeapObj<mtGC> {
   // Mapping management
   BitMap _commit_map;
 
+  MemoryType _memory_type;
+
   G1RegionToSpaceMapper(ReservedSpace rs, size_t used_size, size_t page_size, size_t region_granularity, MemoryType type);
 
+  // Binds the given committed pages of the Java heap to the NUMA node of
+  // the region with the given index.
+  void numa_request_on_node(size_t start_page, size_t size_in_pages, uint region_idx);
+
   void fire_on_commit(uint start_idx, size_t num_regions, bool zero_filled);
  public:
   MemRegion reserved() { return _storage.reserved(); }
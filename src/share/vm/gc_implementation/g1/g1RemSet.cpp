@@ -257,6 +257,23 @@ void G1RemSet::scanRS(G1ParPushHeapRSClosure* oc,
   _g1p->phase_times()->record_time_secs(G1GCPhaseTimes::CodeRoots, worker_i, scanRScl.strong_code_root_scan_time_sec());
 }
 
+void G1RemSet::scan_optional_rem_sets(G1ParPushHeapRSClosure* oc,
+                                      CodeBlobClosure* code_root_cl,
+                                      uint worker_i) {
+  // The optional regions are at the head of the collection set, which
+  // the iteration reaches from any start region.
+  HeapRegion *startRegion = _g1->start_cset_region_for_worker(worker_i);
+
+  ScanRSClosure scanRScl(oc, code_root_cl, worker_i);
+
+  _g1->collection_set_iterate_from(startRegion, &scanRScl);
+  scanRScl.set_try_claimed();
+  _g1->collection_set_iterate_from(startRegion, &scanRScl);
+
+  assert(_cards_scanned != NULL, "invariant");
+  _cards_scanned[worker_i] += scanRScl.cards_done();
+}
+
 // Closure used for updating RSets and recording references that
 // point into the collection set. Only called during an
 // evacuation pause.
@@ -504,7 +521,7 @@ bool G1RemSet::refine_card(jbyte* card_ptr, uint worker_i,
     assert(!check_for_refs_into_cset, "sanity");
     assert(!SafepointSynchronize::is_at_safepoint(), "sanity");
 
-    card_ptr = hot_card_cache->insert(card_ptr);
+    card_ptr = hot_card_cache->insert(card_ptr, worker_i);
     if (card_ptr == NULL) {
       // There was no eviction. Nothing to do.
       return false;
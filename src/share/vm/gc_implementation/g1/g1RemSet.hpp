@@ -111,6 +111,14 @@ public:
               CodeBlobClosure* code_root_cl,
               uint worker_i);
 
+  // Like scanRS(), for the optional regions added to the collection set
+  // after it had been evacuated. The remembered sets scanned before are
+  // skipped, as are the cards claimed then. Their references into the
+  // optional regions have been remembered by the scanning worker.
+  void scan_optional_rem_sets(G1ParPushHeapRSClosure* oc,
+                              CodeBlobClosure* code_root_cl,
+                              uint worker_i);
+
   void updateRS(DirtyCardQueue* into_cset_dcq, uint worker_i);
 
   CardTableModRefBS* ct_bs() { return _ct_bs; }
@@ -265,7 +265,7 @@ public:
       current = &_young;
     } else if (r->isHumongous()) {
       current = &_humonguous;
-    } else if (r->is_old()) {
+    } else if (r->is_old() || r->is_archive()) {
       current = &_old;
     } else {
       ShouldNotReachHere();
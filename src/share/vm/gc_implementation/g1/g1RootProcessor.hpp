@@ -114,6 +114,11 @@ public:
                             OopClosure* scan_non_heap_weak_roots,
                             uint worker_i);
 
+  // As above, for the optional regions just added to the collection set.
+  void scan_optional_remembered_sets(G1ParPushHeapRSClosure* scan_rs,
+                                     OopClosure* scan_non_heap_weak_roots,
+                                     uint worker_i);
+
   // Inform the root processor about the number of worker threads
   void set_num_workers(int active_workers);
 };
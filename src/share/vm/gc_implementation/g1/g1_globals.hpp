@@ -173,6 +173,15 @@
           "Max number of entries per region in a sparse table."             \
           "Will be set ergonomically by default.")                          \
                                                                             \
+  develop(intx, G1RSetArrayEntriesMax, 256,                                 \
+          "Max number of cards in the array of a fine-grain table set "     \
+          "ergonomically.")                                                 \
+                                                                            \
+  product(intx, G1RSetArrayEntries, 0,                                      \
+          "Number of cards a fine-grain table keeps in an array before it " \
+          "is expanded to a bitmap. 0 uses bitmaps only. "                  \
+          "Will be set ergonomically by default.")                          \
+                                                                            \
   develop(bool, G1RecordHRRSOops, false,                                    \
           "When true, record recent calls to rem set operations.")          \
                                                                             \
@@ -320,6 +329,30 @@
           "Force use of evacuation failure handling during mixed "          \
           "evacuation pauses")                                              \
                                                                             \
+  product(bool, G1ParallelFullGC, false,                                    \
+          "Use the parallel GC threads for all four phases of a full "      \
+          "collection instead of the VM thread alone")                      \
+                                                                            \
+  product(uintx, G1PeriodicGCInterval, 0,                                   \
+          "Number of milliseconds without a collection after which a "      \
+          "concurrent cycle is started to uncommit unused heap memory. "    \
+          "Zero disables periodic collections")                             \
+                                                                            \
+  product(double, G1PeriodicGCSystemLoadThreshold, 0.0,                     \
+          "Maximum one minute system load average at which a periodic "     \
+          "collection is still started. Zero ignores the load")             \
+                                                                            \
+  product(uintx, G1OptionalCSetPercent, 20,                                 \
+          "Percentage of the time left for the old regions of a mixed "     \
+          "collection which is kept for optional old regions. These are "   \
+          "evacuated after the others as long as the pause time target "    \
+          "allows. Zero disables optional regions")                         \
+                                                                            \
+  product(bool, G1PinJNICriticalRegions, true,                              \
+          "Pin the regions of the objects of JNI critical sections, "       \
+          "which collections leave in place, instead of blocking "          \
+          "collections with the GC locker")                                 \
+                                                                            \
   diagnostic(bool, G1VerifyRSetsDuringFullGC, false,                        \
           "If true, perform verification of each heap region's "            \
           "remembered set when verifying the heap during a full GC.")       \
@@ -26,6 +26,7 @@
 #include "code/nmethod.hpp"
 #include "gc_implementation/g1/g1BlockOffsetTable.inline.hpp"
 #include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
+#include "gc_implementation/g1/g1NUMA.hpp"
 #include "gc_implementation/g1/g1OopClosures.inline.hpp"
 #include "gc_implementation/g1/heapRegion.inline.hpp"
 #include "gc_implementation/g1/heapRegionBounds.inline.hpp"
@@ -156,11 +157,50 @@ void HeapRegion::reset_after_compaction() {
   init_top_at_mark_start();
 }
 
+void HeapRegion::prepare_pinned_for_compaction() {
+  assert(is_pinned() && !isHumongous(), "only for pinned regions");
+  HeapWord* p = bottom();
+  while (p < top()) {
+    oop obj = oop(p);
+    size_t size = obj->size();
+    if (obj->is_gc_marked()) {
+      obj->forward_to(obj);
+    } else {
+      // Overwrite the dead object in place, which keeps the block
+      // offset table valid. Its klass may be unloaded by this GC.
+      CollectedHeap::fill_with_object(p, size);
+    }
+    p += size;
+  }
+}
+
+void HeapRegion::adjust_pinned_pointers() {
+  HeapWord* p = bottom();
+  while (p < top()) {
+    p += oop(p)->adjust_pointers();
+  }
+}
+
+void HeapRegion::reset_pinned_after_compaction() {
+  HeapWord* p = bottom();
+  while (p < top()) {
+    oop obj = oop(p);
+    if (obj->is_gc_marked()) {
+      obj->init_mark();
+    }
+    p += obj->size();
+  }
+  // Like after a compaction, the mark bitmap is invalid.
+  zero_marked_bytes();
+  init_top_at_mark_start();
+}
+
 void HeapRegion::hr_clear(bool par, bool clear_space, bool locked) {
   assert(_humongous_start_region == NULL,
          "we should have already filtered out humongous regions");
   assert(_end == _orig_end,
          "we should have already filtered out humongous regions");
+  assert(!is_pinned(), "pinned regions hold live objects");
 
   _in_collection_set = false;
 
@@ -271,11 +311,13 @@ HeapRegion::HeapRegion(uint hrm_index,
                        MemRegion mr) :
     G1OffsetTableContigSpace(sharedOffsetArray, mr),
     _hrm_index(hrm_index),
+    _node_index(G1NUMA::preferred_node_index_for_index(hrm_index)),
     _allocation_context(AllocationContext::system()),
     _humongous_start_region(NULL),
     _in_collection_set(false),
     _next_in_special_set(NULL), _orig_end(NULL),
     _claimed(InitialClaimValue), _evacuation_failed(false),
+    _pinned_object_count(0),
     _prev_marked_bytes(0), _next_marked_bytes(0), _gc_efficiency(0.0),
     _next_young_region(NULL),
     _next_dirty_cards_region(NULL), _next(NULL), _prev(NULL),
@@ -304,6 +346,12 @@ void HeapRegion::initialize(MemRegion mr, bool clear_space, bool mangle_space) {
 }
 
 CompactibleSpace* HeapRegion::next_compaction_space() const {
+  // A parallel full gc chains the regions each worker compacts into,
+  // see G1ParPrepareCompactClosure.
+  CompactibleSpace* next = CompactibleSpace::next_compaction_space();
+  if (next != NULL) {
+    return next;
+  }
   return G1CollectedHeap::heap()->next_compaction_region(this);
 }
 
@@ -733,7 +781,8 @@ public:
         HeapRegion* to   = _g1h->heap_region_containing(obj);
         if (from != NULL && to != NULL &&
             from != to &&
-            !to->isHumongous()) {
+            !to->isHumongous() &&
+            !to->is_archive()) {
           jbyte cv_obj = *_bs->byte_for_const(_containing_obj);
           jbyte cv_field = *_bs->byte_for_const(p);
           const jbyte dirty = CardTableModRefBS::dirty_card_val();
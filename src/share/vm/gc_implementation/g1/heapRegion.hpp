@@ -183,6 +183,12 @@ class G1OffsetTableContigSpace: public CompactibleSpace {
   virtual HeapWord* allocate(size_t word_size);
   HeapWord* par_allocate(size_t word_size);
 
+  // Record in the offset table a block that was put in place without
+  // going through allocate(), such as an archive object.
+  void alloc_block_in_bot(HeapWord* start, HeapWord* end) {
+    _offsets.alloc_block(start, end);
+  }
+
   HeapWord* saved_mark_word() const { ShouldNotReachHere(); return NULL; }
 
   // MarkSweep support phase3
@@ -215,6 +221,10 @@ class HeapRegion: public G1OffsetTableContigSpace {
   // The index of this region in the heap region sequence.
   uint  _hrm_index;
 
+  // The index of the NUMA node the memory of this region is bound to,
+  // see G1NUMA.
+  uint  _node_index;
+
   AllocationContext_t _allocation_context;
 
   HeapRegionType _type;
@@ -230,6 +240,9 @@ class HeapRegion: public G1OffsetTableContigSpace {
   // True iff an attempt to evacuate an object in the region failed.
   bool _evacuation_failed;
 
+  // Number of objects of the region in JNI critical sections.
+  volatile jint _pinned_object_count;
+
   // A heap region may be a member one of a number of special subsets, each
   // represented as linked lists through the field below.  Currently, there
   // is only one set:
@@ -341,7 +354,8 @@ class HeapRegion: public G1OffsetTableContigSpace {
     ParEvacFailureClaimValue   = 6,
     AggregateCountClaimValue   = 7,
     VerifyCountClaimValue      = 8,
-    ParMarkRootClaimValue      = 9
+    ParMarkRootClaimValue      = 9,
+    ParMarkSweepClaimValue     = 10
   };
 
   // All allocated blocks are occupied by objects in a HeapRegion
@@ -358,6 +372,8 @@ class HeapRegion: public G1OffsetTableContigSpace {
   // sequence, otherwise -1.
   uint hrm_index() const { return _hrm_index; }
 
+  uint node_index() const { return _node_index; }
+
   // The number of bytes marked live in the region in the last marking phase.
   size_t marked_bytes()    { return _prev_marked_bytes; }
   size_t live_bytes() {
@@ -418,6 +434,12 @@ class HeapRegion: public G1OffsetTableContigSpace {
 
   bool is_old() const { return _type.is_old(); }
 
+  // Archive regions hold objects mapped from the CDS archive. Their
+  // TAMS are kept at bottom so that all objects in them are implicitly
+  // live to concurrent marking, and they are never added to the
+  // collection set nor compacted by a full GC.
+  bool is_archive() const { return _type.is_archive(); }
+
   // For a humongous region, region in which it starts.
   HeapRegion* humongous_start_region() const {
     return _humongous_start_region;
@@ -613,6 +635,13 @@ class HeapRegion: public G1OffsetTableContigSpace {
     init_top_at_mark_start();
   }
 
+  // Full GCs do not compact pinned regions. Their live objects are
+  // forwarded to themselves and their dead ones replaced by filler
+  // objects in phase 2, so that the regions stay parsable.
+  void prepare_pinned_for_compaction();
+  void adjust_pinned_pointers();
+  void reset_pinned_after_compaction();
+
   void calc_gc_efficiency(void);
   double gc_efficiency() { return _gc_efficiency;}
 
@@ -675,6 +704,8 @@ class HeapRegion: public G1OffsetTableContigSpace {
 
   void set_old() { _type.set_old(); }
 
+  void set_archive() { _type.set_archive(); }
+
   // Determine if an object has been allocated since the last
   // mark performed by the collector. This returns true iff the object
   // is within the unmarked area of the region.
@@ -694,6 +725,15 @@ class HeapRegion: public G1OffsetTableContigSpace {
   // Returns the "evacuation_failed" property of the region.
   bool evacuation_failed() { return _evacuation_failed; }
 
+  // A region is pinned while some of its objects are in JNI critical
+  // sections. The objects of a pinned region must not move: the region
+  // is not added to the collection set if it is old, and its objects
+  // fail evacuation if it is young, which retains it as an old region.
+  // Humongous objects are pinned through their starts humongous region.
+  bool is_pinned() const { return _pinned_object_count > 0; }
+  inline void increment_pinned_object_count();
+  inline void decrement_pinned_object_count();
+
   // Sets the "evacuation_failed" property of the region.
   void set_evacuation_failed(bool b) {
     _evacuation_failed = b;
@@ -741,6 +781,8 @@ class HeapRegion: public G1OffsetTableContigSpace {
     _predicted_bytes_to_copy = bytes;
   }
 
+  // The region set with set_next_compaction_space(), if any, else the next
+  // non-humongous region of the heap.
   virtual CompactibleSpace* next_compaction_space() const;
 
   virtual void reset_after_compaction();
@@ -137,9 +137,19 @@ inline HeapWord* HeapRegion::allocate_no_bot_updates(size_t word_size) {
   return allocate_impl(word_size, end());
 }
 
+inline void HeapRegion::increment_pinned_object_count() {
+  Atomic::inc(&_pinned_object_count);
+}
+
+inline void HeapRegion::decrement_pinned_object_count() {
+  assert(_pinned_object_count > 0, "unbalanced unpinning");
+  Atomic::dec(&_pinned_object_count);
+}
+
 inline void HeapRegion::note_start_of_marking() {
   _next_marked_bytes = 0;
-  _next_top_at_mark_start = top();
+  // Archive objects are never marked, they are all implicitly live.
+  _next_top_at_mark_start = is_archive() ? bottom() : top();
 }
 
 inline void HeapRegion::note_end_of_marking() {
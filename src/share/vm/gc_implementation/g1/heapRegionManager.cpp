@@ -190,6 +190,33 @@ uint HeapRegionManager::expand_at(uint start, uint num_regions) {
   return expanded;
 }
 
+bool HeapRegionManager::allocate_containing_regions(MemRegion range, uint* commit_count) {
+  assert(reserved().contains(range), "range must be within the reserved heap");
+  uint start_index = (uint)(pointer_delta(range.start(), heap_bottom()) >> HeapRegion::LogOfHRGrainWords);
+  uint last_index = (uint)(pointer_delta(range.last(), heap_bottom()) >> HeapRegion::LogOfHRGrainWords);
+
+  for (uint i = start_index; i <= last_index; i++) {
+    if (is_available(i) && !at(i)->is_free()) {
+      return false;
+    }
+  }
+
+  uint commits = 0;
+  for (uint i = start_index; i <= last_index; i++) {
+    if (!is_available(i)) {
+      make_regions_available(i, 1);
+      commits++;
+    }
+    HeapRegion* hr = at(i);
+    assert(hr->is_empty(), err_msg("Free region %u is not empty", i));
+    _free_list.remove_starting_at(hr, 1);
+  }
+  verify_optional();
+
+  *commit_count = commits;
+  return true;
+}
+
 uint HeapRegionManager::find_contiguous(size_t num, bool empty_only) {
   uint found = 0;
   size_t length_found = 0;
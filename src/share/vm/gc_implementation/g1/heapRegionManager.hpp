@@ -26,6 +26,7 @@
 #define SHARE_VM_GC_IMPLEMENTATION_G1_HEAPREGIONMANAGER_HPP
 
 #include "gc_implementation/g1/g1BiasedArray.hpp"
+#include "gc_implementation/g1/g1NUMA.hpp"
 #include "gc_implementation/g1/g1RegionToSpaceMapper.hpp"
 #include "gc_implementation/g1/heapRegionSet.hpp"
 #include "services/memoryUsage.hpp"
@@ -163,8 +164,14 @@ public:
     _free_list.add_ordered(list);
   }
 
-  HeapRegion* allocate_free_region(bool is_old) {
-    HeapRegion* hr = _free_list.remove_region(is_old);
+  // Prefers a region of the NUMA node with requested_node_index.
+  HeapRegion* allocate_free_region(bool is_old, uint requested_node_index = G1NUMA::AnyNodeIndex) {
+    HeapRegion* hr;
+    if (requested_node_index != G1NUMA::AnyNodeIndex && G1NUMA::is_enabled()) {
+      hr = _free_list.remove_region_with_node_index(is_old, requested_node_index);
+    } else {
+      hr = _free_list.remove_region(is_old);
+    }
 
     if (hr != NULL) {
       assert(hr->next() == NULL, "Single region should not have next");
@@ -213,6 +220,13 @@ public:
   // this.
   uint expand_at(uint start, uint num_regions);
 
+  // Makes sure that the regions spanning the given range are available and
+  // removes them from the free list. The regions must all be free or
+  // uncommitted. Returns false, without allocating any region, if one of them
+  // is in use. Otherwise returns true with the number of regions that had to
+  // be committed in commit_count.
+  bool allocate_containing_regions(MemRegion range, uint* commit_count);
+
   // Find a contiguous set of empty regions of length num. Returns the start index of
   // that set, or G1_NO_HRM_INDEX.
   uint find_contiguous_only_empty(size_t num) { return find_contiguous(num, true); }
@@ -32,18 +32,38 @@
 #include "memory/padded.inline.hpp"
 #include "memory/space.inline.hpp"
 #include "oops/oop.inline.hpp"
+#include "runtime/orderAccess.inline.hpp"
 #include "utilities/bitMap.inline.hpp"
 #include "utilities/globalDefinitions.hpp"
 #include "utilities/growableArray.hpp"
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
+// A PerRegionTable keeps the cards of its region in one of two containers.
+// It starts with an array of G1RSetArrayEntries cards, which threads fill
+// lock-free: a card is CASed into the first empty slot, so the filled slots
+// are always a prefix of the array and no card is added twice.  When the
+// array is full, the table is expanded to a bitmap of HeapRegion::
+// CardsPerRegion bits holding the cards of the array, under the lock of the
+// owning remembered set.  The array is not changed after that, the bitmap
+// is used for all further accesses.  The coarse map of the owning table is
+// the last step, for regions whose every card is considered to be in the
+// remembered set.
+//
+// With G1RSetArrayEntries == 0 all tables are bitmaps, as before.
+
 class PerRegionTable: public CHeapObj<mtGC> {
   friend class OtherRegionsTable;
   friend class HeapRegionRemSetIterator;
 
+  enum SomePrivateConstants {
+    NullCard = -1
+  };
+
   HeapRegion*     _hr;
-  BitMap          _bm;
+  CardIdx_t*      _cards;
+  // The map of the bitmap, NULL while the cards are kept in _cards.
+  BitMap::bm_word_t* volatile _bm_map;
   jint            _occupied;
 
   // next pointer for free/allocated 'all' list
@@ -58,35 +78,108 @@ class PerRegionTable: public CHeapObj<mtGC> {
   // Global free list of PRTs
   static PerRegionTable* _free_list;
 
+  static size_t array_entries() { return (size_t)G1RSetArrayEntries; }
+  static size_t bm_size_in_words() {
+    return BitMap::word_align_up(HeapRegion::CardsPerRegion) / BitsPerWord;
+  }
+
 protected:
+  bool is_array() const { return _bm_map == NULL; }
+
   // We need access in order to union things into the base table.
-  BitMap* bm() { return &_bm; }
+  BitMap bm() const {
+    assert(!is_array(), "No bitmap yet");
+    return BitMap(_bm_map, HeapRegion::CardsPerRegion);
+  }
+
+  void clear_array() {
+    for (size_t i = 0; i < array_entries(); i++) {
+      _cards[i] = NullCard;
+    }
+  }
 
   void recount_occupied() {
-    _occupied = (jint) bm()->count_one_bits();
+    _occupied = (jint) bm().count_one_bits();
   }
 
   PerRegionTable(HeapRegion* hr) :
     _hr(hr),
+    _cards(NULL),
+    _bm_map(NULL),
     _occupied(0),
-    _bm(HeapRegion::CardsPerRegion, false /* in-resource-area */),
     _collision_list_next(NULL), _next(NULL), _prev(NULL)
-  {}
+  {
+    if (array_entries() > 0) {
+      _cards = NEW_C_HEAP_ARRAY(CardIdx_t, array_entries(), mtGC);
+      clear_array();
+    } else {
+      expand_to_bitmap();
+    }
+  }
+
+  ~PerRegionTable() {
+    if (_cards != NULL) {
+      FREE_C_HEAP_ARRAY(CardIdx_t, _cards, mtGC);
+    }
+    if (!is_array()) {
+      FREE_C_HEAP_ARRAY(BitMap::bm_word_t, _bm_map, mtGC);
+    }
+  }
+
+  // Returns false if the card was not in the array and the array is full.
+  bool add_card_to_array(CardIdx_t from_card, bool par) {
+    for (size_t i = 0; i < array_entries(); i++) {
+      CardIdx_t c = _cards[i];
+      if (c == from_card) {
+        return true;
+      }
+      if (c == NullCard) {
+        if (par) {
+          c = Atomic::cmpxchg(from_card, (volatile jint*)&_cards[i], NullCard);
+          if (c == NullCard) {
+            Atomic::inc(&_occupied);
+            return true;
+          } else if (c == from_card) {
+            return true;
+          }
+          // Another card took the slot, try the next one.
+        } else {
+          _cards[i] = from_card;
+          _occupied++;
+          return true;
+        }
+      }
+    }
+    return false;
+  }
 
-  void add_card_work(CardIdx_t from_card, bool par) {
-    if (!_bm.at(from_card)) {
+  bool add_card_work(CardIdx_t from_card, bool par) {
+    BitMap::bm_word_t* map = (BitMap::bm_word_t*)OrderAccess::load_ptr_acquire(&_bm_map);
+    if (map == NULL) {
+      if (add_card_to_array(from_card, par)) {
+        return true;
+      }
+      map = (BitMap::bm_word_t*)OrderAccess::load_ptr_acquire(&_bm_map);
+      if (map == NULL) {
+        // The array is full, the caller has to expand the table.
+        return false;
+      }
+    }
+    BitMap bm(map, HeapRegion::CardsPerRegion);
+    if (!bm.at(from_card)) {
       if (par) {
-        if (_bm.par_at_put(from_card, 1)) {
+        if (bm.par_at_put(from_card, 1)) {
           Atomic::inc(&_occupied);
         }
       } else {
-        _bm.at_put(from_card, 1);
+        bm.at_put(from_card, 1);
         _occupied++;
       }
     }
+    return true;
   }
 
-  void add_reference_work(OopOrNarrowOopStar from, bool par) {
+  bool add_reference_work(OopOrNarrowOopStar from, bool par) {
     // Must make this robust in case "from" is not in "_hr", because of
     // concurrency.
 
@@ -113,8 +206,9 @@ protected:
 
       assert(0 <= from_card && (size_t)from_card < HeapRegion::CardsPerRegion,
              "Must be in range.");
-      add_card_work(from_card, par);
+      return add_card_work(from_card, par);
     }
+    return true;
   }
 
 public:
@@ -135,41 +229,96 @@ public:
     _hr = hr;
     _collision_list_next = NULL;
     _occupied = 0;
-    _bm.clear();
+    if (is_array()) {
+      clear_array();
+    } else {
+      bm().clear();
+    }
+  }
+
+  // Moves the cards of a full array into a new bitmap.  Requires the
+  // lock of the owning remembered set, which also serializes with the
+  // reuse of this table.  Does nothing if the table has a bitmap already
+  // or if its array is not full (any more).
+  void expand_to_bitmap() {
+    if (!is_array() || (array_entries() > 0 && _cards[array_entries() - 1] == NullCard)) {
+      return;
+    }
+    BitMap::bm_word_t* map = NEW_C_HEAP_ARRAY(BitMap::bm_word_t, bm_size_in_words(), mtGC);
+    BitMap bm(map, HeapRegion::CardsPerRegion);
+    bm.clear();
+    for (size_t i = 0; i < array_entries(); i++) {
+      bm.set_bit(_cards[i]);
+    }
+    OrderAccess::release_store_ptr(&_bm_map, map);
+  }
+
+  // Goes back to the array, dropping all cards.  Only for tables on the
+  // free list, which nobody else can access.
+  void release_bitmap() {
+    if (!is_array() && array_entries() > 0) {
+      FREE_C_HEAP_ARRAY(BitMap::bm_word_t, _bm_map, mtGC);
+      _bm_map = NULL;
+    }
   }
 
-  void add_reference(OopOrNarrowOopStar from) {
-    add_reference_work(from, /*parallel*/ true);
+  // The adding functions return false if the table has to be expanded
+  // to a bitmap first, see expand_to_bitmap().
+  bool add_reference(OopOrNarrowOopStar from) {
+    return add_reference_work(from, /*parallel*/ true);
   }
 
-  void seq_add_reference(OopOrNarrowOopStar from) {
-    add_reference_work(from, /*parallel*/ false);
+  bool seq_add_reference(OopOrNarrowOopStar from) {
+    return add_reference_work(from, /*parallel*/ false);
   }
 
   void scrub(CardTableModRefBS* ctbs, BitMap* card_bm) {
     HeapWord* hr_bot = hr()->bottom();
     size_t hr_first_card_index = ctbs->index_for(hr_bot);
-    bm()->set_intersection_at_offset(*card_bm, hr_first_card_index);
-    recount_occupied();
+    if (is_array()) {
+      size_t n = 0;
+      for (size_t i = 0; i < array_entries() && _cards[i] != NullCard; i++) {
+        if (card_bm->at(hr_first_card_index + _cards[i])) {
+          _cards[n++] = _cards[i];
+        }
+      }
+      for (size_t i = n; i < array_entries(); i++) {
+        _cards[i] = NullCard;
+      }
+      _occupied = (jint) n;
+    } else {
+      bm().set_intersection_at_offset(*card_bm, hr_first_card_index);
+      recount_occupied();
+    }
   }
 
-  void add_card(CardIdx_t from_card_index) {
-    add_card_work(from_card_index, /*parallel*/ true);
+  bool add_card(CardIdx_t from_card_index) {
+    return add_card_work(from_card_index, /*parallel*/ true);
   }
 
-  void seq_add_card(CardIdx_t from_card_index) {
-    add_card_work(from_card_index, /*parallel*/ false);
+  bool seq_add_card(CardIdx_t from_card_index) {
+    return add_card_work(from_card_index, /*parallel*/ false);
   }
 
   // (Destructively) union the bitmap of the current table into the given
   // bitmap (which is assumed to be of the same size.)
   void union_bitmap_into(BitMap* bm) {
-    bm->set_union(_bm);
+    if (is_array()) {
+      for (size_t i = 0; i < array_entries() && _cards[i] != NullCard; i++) {
+        bm->set_bit(_cards[i]);
+      }
+    } else {
+      bm->set_union(this->bm());
+    }
   }
 
   // Mem size in bytes.
   size_t mem_size() const {
-    return sizeof(PerRegionTable) + _bm.size_in_words() * HeapWordSize;
+    size_t sz = sizeof(PerRegionTable) + array_entries() * sizeof(CardIdx_t);
+    if (!is_array()) {
+      sz += bm_size_in_words() * HeapWordSize;
+    }
+    return sz;
   }
 
   // Requires "from" to be in "hr()".
@@ -177,7 +326,33 @@ public:
     assert(hr()->is_in_reserved(from), "Precondition.");
     size_t card_ind = pointer_delta(from, hr()->bottom(),
                                     CardTableModRefBS::card_size);
-    return _bm.at(card_ind);
+    if (is_array()) {
+      for (size_t i = 0; i < array_entries() && _cards[i] != NullCard; i++) {
+        if ((size_t)_cards[i] == card_ind) {
+          return true;
+        }
+      }
+      return false;
+    }
+    return bm().at(card_ind);
+  }
+
+  // Iteration: returns the position after pos which holds a card, or
+  // HeapRegion::CardsPerRegion if there is none.  Start with (size_t)-1.
+  // The positions are slots of the array if in_array, cards otherwise.
+  size_t next_position(size_t pos, bool in_array) const {
+    size_t next = pos + 1;
+    if (in_array) {
+      if (next < array_entries() && _cards[next] != NullCard) {
+        return next;
+      }
+      return HeapRegion::CardsPerRegion;
+    }
+    return bm().get_next_one_offset(next);
+  }
+
+  size_t card_at_position(size_t pos, bool in_array) const {
+    return in_array ? (size_t)_cards[pos] : pos;
   }
 
   // Bulk-free the PRTs from prt to last, assumes that they are
@@ -207,6 +382,7 @@ public:
         (PerRegionTable*)
         Atomic::cmpxchg_ptr(nxt, &_free_list, fl);
       if (res == fl) {
+        fl->release_bitmap();
         fl->init(hr, true);
         return fl;
       } else {
@@ -519,8 +695,10 @@ void OtherRegionsTable::add_reference(OopOrNarrowOopStar from, int tid) {
         assert(sprt_entry != NULL, "There should have been an entry");
         for (int i = 0; i < SparsePRTEntry::cards_num(); i++) {
           CardIdx_t c = sprt_entry->card(i);
-          if (c != SparsePRTEntry::NullEntry) {
-            prt->add_card(c);
+          if (c != SparsePRTEntry::NullEntry && !prt->add_card(c)) {
+            prt->expand_to_bitmap();
+            bool res = prt->add_card(c);
+            assert(res, "A bitmap takes every card");
           }
         }
         // Now we can delete the sparse entry.
@@ -535,7 +713,11 @@ void OtherRegionsTable::add_reference(OopOrNarrowOopStar from, int tid) {
   // OtherRegionsTable for why this is OK.
   assert(prt != NULL, "Inv");
 
-  prt->add_reference(from);
+  while (!prt->add_reference(from)) {
+    // The array of prt is full.
+    MutexLockerEx x(_m, Mutex::_no_safepoint_check_flag);
+    prt->expand_to_bitmap();
+  }
 
   if (G1RecordHRRSOops) {
     HeapRegionRemSet::record(hr(), from);
@@ -741,11 +923,9 @@ size_t OtherRegionsTable::occ_sparse() const {
 
 size_t OtherRegionsTable::mem_size() const {
   size_t sum = 0;
-  // all PRTs are of the same size so it is sufficient to query only one of them.
-  if (_first_all_fine_prts != NULL) {
-    assert(_last_all_fine_prts != NULL &&
-      _first_all_fine_prts->mem_size() == _last_all_fine_prts->mem_size(), "check that mem_size() is constant");
-    sum += _first_all_fine_prts->mem_size() * _n_fine_entries;
+  // PRTs with a bitmap are larger than those with an array only.
+  for (PerRegionTable* cur = _first_all_fine_prts; cur != NULL; cur = cur->next()) {
+    sum += cur->mem_size();
   }
   sum += (sizeof(PerRegionTable*) * _max_fine_entries);
   sum += (_coarse_map.size_in_words() * HeapWordSize);
@@ -867,6 +1047,13 @@ void HeapRegionRemSet::setup_remset_size() {
   if (FLAG_IS_DEFAULT(G1RSetRegionEntries)) {
     G1RSetRegionEntries = G1RSetRegionEntriesBase * (region_size_log_mb + 1);
   }
+  if (FLAG_IS_DEFAULT(G1RSetArrayEntries)) {
+    // At most half the size of the bitmap, the array is searched linearly.
+    G1RSetArrayEntries = (intx)MIN2(HeapRegion::CardsPerRegion / (2 * BitsPerByte * sizeof(CardIdx_t)),
+                                    (size_t)G1RSetArrayEntriesMax);
+  }
+  guarantee(G1RSetArrayEntries >= 0 &&
+            (size_t)G1RSetArrayEntries < HeapRegion::CardsPerRegion, "Sanity");
   guarantee(G1RSetSparseRegionEntries > 0 && G1RSetRegionEntries > 0 , "Sanity");
 }
 
@@ -991,6 +1178,7 @@ HeapRegionRemSetIterator:: HeapRegionRemSetIterator(HeapRegionRemSet* hrrs) :
   _coarse_cur_region_cur_card(HeapRegion::CardsPerRegion-1),
   _cur_card_in_prt(HeapRegion::CardsPerRegion),
   _fine_cur_prt(NULL),
+  _fine_cur_in_array(false),
   _n_yielded_coarse(0),
   _n_yielded_fine(0),
   _n_yielded_sparse(0),
@@ -1024,7 +1212,7 @@ bool HeapRegionRemSetIterator::coarse_has_next(size_t& card_index) {
 bool HeapRegionRemSetIterator::fine_has_next(size_t& card_index) {
   if (fine_has_next()) {
     _cur_card_in_prt =
-      _fine_cur_prt->_bm.get_next_one_offset(_cur_card_in_prt + 1);
+      _fine_cur_prt->next_position(_cur_card_in_prt, _fine_cur_in_array);
   }
   if (_cur_card_in_prt == HeapRegion::CardsPerRegion) {
     // _fine_cur_prt may still be NULL in case if there are not PRTs at all for
@@ -1034,12 +1222,13 @@ bool HeapRegionRemSetIterator::fine_has_next(size_t& card_index) {
     }
     PerRegionTable* next_prt = _fine_cur_prt->next();
     switch_to_prt(next_prt);
-    _cur_card_in_prt = _fine_cur_prt->_bm.get_next_one_offset(_cur_card_in_prt + 1);
+    _cur_card_in_prt = _fine_cur_prt->next_position(_cur_card_in_prt, _fine_cur_in_array);
   }
 
-  card_index = _cur_region_card_offset + _cur_card_in_prt;
-  guarantee(_cur_card_in_prt < HeapRegion::CardsPerRegion,
-            err_msg("Card index "SIZE_FORMAT" must be within the region", _cur_card_in_prt));
+  size_t card_in_prt = _fine_cur_prt->card_at_position(_cur_card_in_prt, _fine_cur_in_array);
+  card_index = _cur_region_card_offset + card_in_prt;
+  guarantee(card_in_prt < HeapRegion::CardsPerRegion,
+            err_msg("Card index "SIZE_FORMAT" must be within the region", card_in_prt));
   return true;
 }
 
@@ -1050,6 +1239,9 @@ bool HeapRegionRemSetIterator::fine_has_next() {
 void HeapRegionRemSetIterator::switch_to_prt(PerRegionTable* prt) {
   assert(prt != NULL, "Cannot switch to NULL prt");
   _fine_cur_prt = prt;
+  // A table expanded during the iteration still has all its cards in the
+  // array, so stay with the container it started with.
+  _fine_cur_in_array = prt->is_array();
 
   HeapWord* r_bot = _fine_cur_prt->hr()->bottom();
   _cur_region_card_offset = _bosa->index_for(r_bot);
@@ -1206,7 +1398,7 @@ HeapRegionRemSet::finish_cleanup_task(HRRSCleanupTask* hrrs_cleanup_task) {
 void PerRegionTable::test_fl_mem_size() {
   PerRegionTable* dummy = alloc(NULL);
 
-  size_t min_prt_size = sizeof(void*) + dummy->bm()->size_in_words() * HeapWordSize;
+  size_t min_prt_size = sizeof(void*) + G1RSetArrayEntries * sizeof(CardIdx_t);
   assert(dummy->mem_size() > min_prt_size,
          err_msg("PerRegionTable memory usage is suspiciously small, only has "SIZE_FORMAT" bytes. "
                  "Should be at least "SIZE_FORMAT" bytes.", dummy->mem_size(), min_prt_size));
@@ -99,7 +99,7 @@ class FromCardCache : public AllStatic {
 
 // The "_fine_grain_entries" array is an open hash table of PerRegionTables
 // (PRTs), indicating regions for which we're keeping the RS as a set of
-// cards.  The strategy is to cap the size of the fine-grain table,
+// cards, in a small array or in a bitmap.  The strategy is to cap the size of the fine-grain table,
 // deleting an entry and setting the corresponding coarse-grained bit when
 // we would overflow this cap.
 
@@ -477,7 +477,9 @@ class HeapRegionRemSetIterator : public StackObj {
 
   // The PRT we are currently iterating over.
   PerRegionTable* _fine_cur_prt;
-  // Card offset within the current PRT.
+  // Whether the current PRT is iterated through its array.
+  bool _fine_cur_in_array;
+  // Position within the current PRT, see PerRegionTable::next_position().
   size_t _cur_card_in_prt;
 
   // Update internal variables when switching to the given PRT.
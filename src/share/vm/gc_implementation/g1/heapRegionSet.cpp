@@ -24,6 +24,7 @@
 
 #include "precompiled.hpp"
 #include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
+#include "gc_implementation/g1/g1NUMA.hpp"
 #include "gc_implementation/g1/heapRegionRemSet.hpp"
 #include "gc_implementation/g1/heapRegionSet.inline.hpp"
 
@@ -254,6 +255,25 @@ void FreeRegionList::remove_starting_at(HeapRegion* first, uint num_regions) {
   verify_optional();
 }
 
+HeapRegion* FreeRegionList::remove_region_with_node_index(bool from_head,
+                                                          uint requested_node_index) {
+  check_mt_safety();
+  verify_optional();
+
+  // The list is ordered by index, so the nodes of its regions alternate
+  // unless regions of one node are in use; only look at a few of them.
+  uint max_search_depth = 8 * G1NUMA::num_active_nodes();
+  HeapRegion* cur = from_head ? _head : _tail;
+  for (uint depth = 0; cur != NULL && depth < max_search_depth; depth++) {
+    if (cur->node_index() == requested_node_index) {
+      remove_starting_at(cur, 1);
+      return cur;
+    }
+    cur = from_head ? cur->next() : cur->prev();
+  }
+  return remove_region(from_head);
+}
+
 void FreeRegionList::verify() {
   // See comment in HeapRegionSetBase::verify() about MT safety and
   // verification.
@@ -207,6 +207,45 @@ void VM_G1IncCollectionPause::doit_epilogue() {
   }
 }
 
+bool VM_G1PeriodicCollection::doit_prologue() {
+  // Note the relative order of the locks must match that in
+  // VM_GC_Operation::doit_prologue() or deadlocks can occur
+  ConcurrentMarkThread::slt()->manipulatePLL(SurrogateLockerThread::acquirePLL);
+  Heap_lock->lock();
+
+  if (skip_operation()) {
+    // Another collection happened since the concurrent mark thread
+    // decided to start this one, so the VM is not idle.
+    Heap_lock->unlock();
+    ConcurrentMarkThread::slt()->manipulatePLL(SurrogateLockerThread::releaseAndNotifyPLL);
+    _prologue_succeeded = false;
+  } else {
+    _prologue_succeeded = true;
+    SharedHeap::heap()->_thread_holds_heap_lock_for_gc = true;
+  }
+  return _prologue_succeeded;
+}
+
+void VM_G1PeriodicCollection::doit() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  GCCauseSetter x(g1h, _gc_cause);
+
+  // A cycle may have been started after the concurrent mark thread
+  // checked, there is nothing to do then.
+  if (g1h->g1_policy()->force_initial_mark_if_outside_cycle(_gc_cause)) {
+    g1h->do_collection_pause_at_safepoint(g1h->g1_policy()->max_pause_time_ms());
+    _cycle_started = g1h->concurrent_mark()->cmThread()->started();
+  }
+}
+
+void VM_G1PeriodicCollection::doit_epilogue() {
+  // Note the relative order of the unlocks must match that in
+  // VM_GC_Operation::doit_epilogue()
+  SharedHeap::heap()->_thread_holds_heap_lock_for_gc = false;
+  Heap_lock->unlock();
+  ConcurrentMarkThread::slt()->manipulatePLL(SurrogateLockerThread::releaseAndNotifyPLL);
+}
+
 void VM_CGC_Operation::acquire_pending_list_lock() {
   assert(_needs_pll, "don't call this otherwise");
   // The caller may block while communicating
@@ -35,6 +35,7 @@
 //   - VM_G1OperationWithAllocRequest
 //     - VM_G1CollectForAllocation
 //     - VM_G1IncCollectionPause
+//   - VM_G1PeriodicCollection
 
 class VM_G1OperationWithAllocRequest : public VM_CollectForAllocation {
 protected:
@@ -98,6 +99,28 @@ public:
   bool should_retry_gc() const { return _should_retry_gc; }
 };
 
+// An initial-mark pause started by the concurrent mark thread when
+// there was no collection for G1PeriodicGCInterval ms, see
+// ConcurrentMarkThread::sleepBeforeNextCycle(). As for VM_CGC_Operation
+// the pending list lock is manipulated through the SLT.
+class VM_G1PeriodicCollection: public VM_GC_Operation {
+private:
+  bool _cycle_started;
+public:
+  VM_G1PeriodicCollection(uint gc_count_before)
+    : VM_GC_Operation(gc_count_before, GCCause::_g1_periodic_collection),
+      _cycle_started(false) { }
+  virtual VMOp_Type type() const { return VMOp_G1PeriodicCollection; }
+  virtual bool doit_prologue();
+  virtual void doit();
+  virtual void doit_epilogue();
+  virtual const char* name() const {
+    return "garbage-first periodic collection pause";
+  }
+  // Whether the pause started a concurrent cycle.
+  bool cycle_started() const { return _cycle_started; }
+};
+
 // Concurrent GC stop-the-world operations such as remark and cleanup;
 // consider sharing these with CMS's counterparts.
 class VM_CGC_Operation: public VM_Operation {
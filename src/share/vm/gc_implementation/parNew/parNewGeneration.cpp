@@ -35,6 +35,7 @@
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/parGCAllocBuffer.inline.hpp"
 #include "gc_implementation/shared/spaceDecorator.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/defNewGeneration.inline.hpp"
 #include "memory/genCollectedHeap.hpp"
 #include "memory/genOopClosures.inline.hpp"
@@ -1026,6 +1027,12 @@ void ParNewGeneration::collect(bool   full,
                                               _gc_timer, gc_tracer.gc_id());
   }
   gc_tracer.report_gc_reference_stats(stats);
+
+  if (StringDedup::is_enabled()) {
+    // Unlink dead strings from the deduplication queue and table, and
+    // update the references to the surviving ones.
+    StringDedup::unlink_or_oops_do(&is_alive, &keep_alive);
+  }
   if (!promotion_failed()) {
     // Swap the survivor spaces.
     eden()->clear(SpaceDecorator::Mangle);
@@ -1236,6 +1243,13 @@ oop ParNewGeneration::copy_to_survivor_space_avoiding_promotion_undo(
 #endif
 
   if (forward_ptr == NULL) {
+    if (StringDedup::is_enabled() && new_obj != old) {
+      StringDedup::enqueue_from_evacuation(true,                      // from_young
+                                           is_in_reserved(new_obj),   // to_young
+                                           par_scan_state->thread_num(),
+                                           new_obj);
+    }
+
     oop obj_to_push = new_obj;
     if (par_scan_state->should_be_partially_scanned(obj_to_push, old)) {
       // Length field used as index of next element to be scanned.
@@ -1364,6 +1378,13 @@ oop ParNewGeneration::copy_to_survivor_space_with_undo(
   }
 
   if (forward_ptr == NULL) {
+    if (StringDedup::is_enabled() && new_obj != old) {
+      StringDedup::enqueue_from_evacuation(true,                      // from_young
+                                           is_in_reserved(new_obj),   // to_young
+                                           par_scan_state->thread_num(),
+                                           new_obj);
+    }
+
     oop obj_to_push = new_obj;
     if (par_scan_state->should_be_partially_scanned(obj_to_push, old)) {
       // Length field used as index of next element to be scanned.
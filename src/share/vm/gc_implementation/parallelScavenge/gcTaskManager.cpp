@@ -28,6 +28,7 @@
 #include "gc_implementation/shared/adaptiveSizePolicy.hpp"
 #include "memory/allocation.hpp"
 #include "memory/allocation.inline.hpp"
+#include "runtime/atomic.inline.hpp"
 #include "runtime/mutex.hpp"
 #include "runtime/mutexLocker.hpp"
 #include "runtime/orderAccess.inline.hpp"
@@ -325,6 +326,17 @@ GCTask* GCTaskQueue::remove(GCTask* task) {
   return result;
 }
 
+bool GCTaskQueue::has_only_ordinary_tasks() const {
+  for (GCTask* element = insert_end();
+       element != NULL;
+       element = element->older()) {
+    if (!element->is_ordinary_task()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 NOT_PRODUCT(
 // Count the elements in the queue and verify the length against
 // that count.
@@ -381,6 +393,7 @@ GCTaskManager::GCTaskManager(uint workers) :
   _workers(workers),
   _active_workers(0),
   _idle_workers(0),
+  _outstanding_ready_tasks(0),
   _ndc(NULL) {
   initialize();
 }
@@ -389,6 +402,7 @@ GCTaskManager::GCTaskManager(uint workers, NotifyDoneClosure* ndc) :
   _workers(workers),
   _active_workers(0),
   _idle_workers(0),
+  _outstanding_ready_tasks(0),
   _ndc(ndc) {
   initialize();
 }
@@ -407,6 +421,9 @@ void GCTaskManager::initialize() {
   _noop_task = NoopGCTask::create_on_c_heap();
   _idle_inactive_task = WaitForBarrierGCTask::create_on_c_heap();
   _resource_flag = NEW_C_HEAP_ARRAY(bool, workers(), mtGC);
+  _ready_queue = new GCTaskReadyQueue();
+  _ready_queue->initialize();
+  _ready_task_flag = NEW_C_HEAP_ARRAY(bool, workers(), mtGC);
   {
     // Set up worker threads.
     //     Distribute the workers among the available processors,
@@ -435,6 +452,7 @@ void GCTaskManager::initialize() {
   set_unblocked();
   for (uint w = 0; w < workers(); w += 1) {
     set_resource_flag(w, false);
+    set_ready_task_flag(w, false);
   }
   reset_delivered_tasks();
   reset_completed_tasks();
@@ -449,6 +467,7 @@ void GCTaskManager::initialize() {
 GCTaskManager::~GCTaskManager() {
   assert(busy_workers() == 0, "still have busy workers");
   assert(queue()->is_empty(), "still have queued work");
+  assert(!has_ready_tasks(), "still have published work");
   NoopGCTask::destroy(_noop_task);
   _noop_task = NULL;
   WaitForBarrierGCTask::destroy(_idle_inactive_task);
@@ -465,6 +484,14 @@ GCTaskManager::~GCTaskManager() {
     FREE_C_HEAP_ARRAY(bool, _resource_flag, mtGC);
     _resource_flag = NULL;
   }
+  if (_ready_task_flag != NULL) {
+    FREE_C_HEAP_ARRAY(bool, _ready_task_flag, mtGC);
+    _ready_task_flag = NULL;
+  }
+  if (_ready_queue != NULL) {
+    delete _ready_queue;
+    _ready_queue = NULL;
+  }
   if (queue() != NULL) {
     GCTaskQueue* unsynchronized_queue = queue()->unsynchronized_queue();
     GCTaskQueue::destroy(unsynchronized_queue);
@@ -630,65 +657,109 @@ void GCTaskManager::add_list(GCTaskQueue* list) {
 // a notify is sent to the waiting GC workers which then
 // compete to get tasks.  If a GC worker wakes up and there
 // is no work on the queue, it is given a noop_task to execute
-// and then loops to find more work.
+// and then loops to find more work.  Tasks published on the
+// ready queue are claimed without holding the monitor.
 
 GCTask* GCTaskManager::get_task(uint which) {
   GCTask* result = NULL;
-  // Grab the queue lock.
-  MutexLockerEx ml(monitor(), Mutex::_no_safepoint_check_flag);
-  // Wait while the queue is block or
-  // there is nothing to do, except maybe release resources.
-  while (is_blocked() ||
-         (queue()->is_empty() && !should_release_resources(which))) {
-    if (TraceGCTaskManager) {
-      tty->print_cr("GCTaskManager::get_task(%u)"
-                    "  blocked: %s"
-                    "  empty: %s"
-                    "  release: %s",
-                    which,
-                    is_blocked() ? "true" : "false",
-                    queue()->is_empty() ? "true" : "false",
-                    should_release_resources(which) ? "true" : "false");
-      tty->print_cr("    => (%s)->wait()",
-                    monitor()->name());
+  for (;;) {
+    result = claim_ready_task(which);
+    if (result != NULL) {
+      return result;
     }
-    monitor()->wait(Mutex::_no_safepoint_check_flag, 0);
-  }
-  // We've reacquired the queue lock here.
-  // Figure out which condition caused us to exit the loop above.
-  if (!queue()->is_empty()) {
-    if (UseGCTaskAffinity) {
-      result = queue()->dequeue(which);
+    // Grab the queue lock.
+    MutexLockerEx ml(monitor(), Mutex::_no_safepoint_check_flag);
+    // Wait while the queue is block or
+    // there is nothing to do, except maybe release resources.
+    while (is_blocked() ||
+           (queue()->is_empty() && !has_ready_tasks() &&
+            !should_release_resources(which))) {
+      if (TraceGCTaskManager) {
+        tty->print_cr("GCTaskManager::get_task(%u)"
+                      "  blocked: %s"
+                      "  empty: %s"
+                      "  ready: %s"
+                      "  release: %s",
+                      which,
+                      is_blocked() ? "true" : "false",
+                      queue()->is_empty() ? "true" : "false",
+                      has_ready_tasks() ? "true" : "false",
+                      should_release_resources(which) ? "true" : "false");
+        tty->print_cr("    => (%s)->wait()",
+                      monitor()->name());
+      }
+      monitor()->wait(Mutex::_no_safepoint_check_flag, 0);
+    }
+    // We've reacquired the queue lock here.
+    // Figure out which condition caused us to exit the loop above.
+    if (!queue()->is_empty()) {
+      if (UseGCTaskAffinity) {
+        result = queue()->dequeue(which);
+      } else {
+        result = queue()->dequeue();
+      }
+      if (result->is_barrier_task()) {
+        assert(which != sentinel_worker(),
+               "blocker shouldn't be bogus");
+        set_blocking_worker(which);
+      }
+    } else if (has_ready_tasks()) {
+      // Tasks were published on the ready queue.
+      // Release monitor() and go claim one.
+      continue;
     } else {
-      result = queue()->dequeue();
+      // The queue is empty, but we were woken up.
+      // Just hand back a Noop task,
+      // in case someone wanted us to release resources, or whatever.
+      result = noop_task();
+      increment_noop_tasks();
     }
-    if (result->is_barrier_task()) {
-      assert(which != sentinel_worker(),
-             "blocker shouldn't be bogus");
-      set_blocking_worker(which);
+    assert(result != NULL, "shouldn't have null task");
+    if (TraceGCTaskManager) {
+      tty->print_cr("GCTaskManager::get_task(%u) => " INTPTR_FORMAT " [%s]",
+                    which, result, GCTask::Kind::to_string(result->kind()));
+      tty->print_cr("     %s", result->name());
     }
-  } else {
-    // The queue is empty, but we were woken up.
-    // Just hand back a Noop task,
-    // in case someone wanted us to release resources, or whatever.
-    result = noop_task();
-    increment_noop_tasks();
-  }
-  assert(result != NULL, "shouldn't have null task");
-  if (TraceGCTaskManager) {
-    tty->print_cr("GCTaskManager::get_task(%u) => " INTPTR_FORMAT " [%s]",
-                  which, result, GCTask::Kind::to_string(result->kind()));
-    tty->print_cr("     %s", result->name());
+    if (!result->is_idle_task()) {
+      increment_busy_workers();
+      increment_delivered_tasks();
+    }
+    return result;
+    // Release monitor().
   }
-  if (!result->is_idle_task()) {
-    increment_busy_workers();
-    increment_delivered_tasks();
+}
+
+// Claim a task published by execute_and_wait() without taking
+// the monitor.  The ready queue is only pushed by the VMThread,
+// so the workers all take from its global end and get the tasks
+// in the order they were added to the list.
+
+GCTask* GCTaskManager::claim_ready_task(uint which) {
+  GCTask* result = NULL;
+  while (has_ready_tasks()) {
+    if (ready_queue()->pop_global(result)) {
+      assert(result != NULL, "shouldn't have null task");
+      set_ready_task_flag(which, true);
+      if (TraceGCTaskManager) {
+        tty->print_cr("GCTaskManager::claim_ready_task(%u) => "
+                      INTPTR_FORMAT " [%s]",
+                      which, result, result->name());
+      }
+      return result;
+    }
+    // Lost the race for the oldest task; retry.
+    SpinPause();
   }
-  return result;
-  // Release monitor().
+  return NULL;
 }
 
 void GCTaskManager::note_completion(uint which) {
+  if (ready_task_flag(which)) {
+    // The task came from the ready queue.
+    set_ready_task_flag(which, false);
+    note_ready_task_completion(which);
+    return;
+  }
   MutexLockerEx ml(monitor(), Mutex::_no_safepoint_check_flag);
   if (TraceGCTaskManager) {
     tty->print_cr("GCTaskManager::note_completion(%u)", which);
@@ -738,6 +809,79 @@ void GCTaskManager::note_completion(uint which) {
   // Release monitor().
 }
 
+// Published tasks are not counted as busy workers.  Each completion
+// just decrements the outstanding count; the worker that takes it to
+// zero is the only one that needs the monitor, to wake the VMThread
+// in wait_for_ready_tasks().
+
+void GCTaskManager::note_ready_task_completion(uint which) {
+  jint remaining = Atomic::add(-1, &_outstanding_ready_tasks);
+  assert(remaining >= 0, "more completions than published tasks");
+  if (remaining == 0) {
+    MutexLockerEx ml(monitor(), Mutex::_no_safepoint_check_flag);
+    increment_emptied_queue();
+    if (TraceGCTaskManager) {
+      tty->print_cr("    GCTaskManager::note_ready_task_completion(%u) done",
+                    which);
+    }
+    // Notify client that we are done.
+    NotifyDoneClosure* ndc = notify_done_closure();
+    if (ndc != NULL) {
+      ndc->notify(this);
+    }
+    (void) monitor()->notify_all();
+    // Release monitor().
+  }
+}
+
+// Push the tasks of "list" on the ready queue, if they can be
+// handed out without the central queue.  Barrier and idle tasks
+// depend on the monitor, affinity needs dequeue(which), and tasks
+// already on the central queue (e.g., IdleGCTasks) have to be
+// handed out first.  Returns false, leaving "list" untouched,
+// if the list has to go through the central queue.
+
+bool GCTaskManager::publish_ready_tasks(GCTaskQueue* list) {
+  if (UseGCTaskAffinity ||
+      list->is_empty() ||
+      list->length() > ready_queue()->max_elems() ||
+      !list->has_only_ordinary_tasks()) {
+    return false;
+  }
+  MutexLockerEx ml(monitor(), Mutex::_no_safepoint_check_flag);
+  if (!queue()->is_empty()) {
+    return false;
+  }
+  assert(!has_ready_tasks(), "previous job still has published tasks");
+  assert(_outstanding_ready_tasks == 0, "previous job still running");
+  if (TraceGCTaskManager) {
+    tty->print_cr("GCTaskManager::publish_ready_tasks(%u)", list->length());
+  }
+  // Set the count before any task can be claimed.  push() releases
+  // the new bottom, which orders this store before the task.
+  _outstanding_ready_tasks = (jint) list->length();
+  while (!list->is_empty()) {
+    bool pushed = ready_queue()->push(list->dequeue());
+    assert(pushed, "ready queue overflow");
+  }
+  // Wake the workers sleeping in get_task().
+  (void) monitor()->notify_all();
+  return true;
+  // Release monitor().
+}
+
+void GCTaskManager::wait_for_ready_tasks() {
+  MutexLockerEx ml(monitor(), Mutex::_no_safepoint_check_flag);
+  while (OrderAccess::load_acquire(&_outstanding_ready_tasks) != 0) {
+    if (TraceGCTaskManager) {
+      tty->print_cr("GCTaskManager::wait_for_ready_tasks()"
+                    "  outstanding: %d", _outstanding_ready_tasks);
+    }
+    monitor()->wait(Mutex::_no_safepoint_check_flag, 0);
+  }
+  // Release monitor().
+}
+
 uint GCTaskManager::increment_busy_workers() {
   assert(queue()->own_lock(), "don't own the lock");
   _busy_workers += 1;
@@ -783,9 +927,15 @@ void GCTaskManager::note_release(uint which) {
 // to complete.  GC workers that execute a stealing task remain in
 // the stealing task until all stealing tasks have completed.  The load
 // balancing afforded by the stealing tasks work best if the stealing
-// tasks are added last to the list.
+// tasks are added last to the list.  When possible the tasks are
+// published on the lock-free ready queue instead; they are handed
+// out in the same order.
 
 void GCTaskManager::execute_and_wait(GCTaskQueue* list) {
+  if (publish_ready_tasks(list)) {
+    wait_for_ready_tasks();
+    return;
+  }
   WaitForBarrierGCTask* fin = WaitForBarrierGCTask::create();
   list->enqueue(fin);
   // The barrier task will be read by one of the GC
@@ -810,6 +960,17 @@ void GCTaskManager::set_resource_flag(uint which, bool value) {
   _resource_flag[which] = value;
 }
 
+bool GCTaskManager::ready_task_flag(uint which) {
+  assert(which < workers(), "index out of bounds");
+  return _ready_task_flag[which];
+}
+
+void GCTaskManager::set_ready_task_flag(uint which, bool value) {
+  // This can be done without a lock because each thread writes one element.
+  assert(which < workers(), "index out of bounds");
+  _ready_task_flag[which] = value;
+}
+
 //
 // NoopGCTask
 //
@@ -27,6 +27,7 @@
 
 #include "runtime/mutex.hpp"
 #include "utilities/growableArray.hpp"
+#include "utilities/taskqueue.hpp"
 
 //
 // The GCTaskManager is a queue of GCTasks, and accessors
@@ -55,6 +56,11 @@ class Mutex;
 class Monitor;
 class ThreadClosure;
 
+// The lock-free queue through which execute_and_wait() publishes
+// a job's tasks.  Only the VMThread pushes; workers claim tasks
+// with pop_global() so they are handed out in FIFO order.
+typedef GenericTaskQueue<GCTask*, mtGC, 1024> GCTaskReadyQueue;
+
 // The abstract base GCTask.
 class GCTask : public ResourceObj {
 public:
@@ -164,6 +170,8 @@ public:
   uint length() const {
     return _length;
   }
+  //     Are all the tasks on the queue ordinary tasks?
+  bool has_only_ordinary_tasks() const;
   // Methods.
   //     Enqueue one task.
   void enqueue(GCTask* task);
@@ -353,6 +361,14 @@ protected:
 //
 // For PSScavenge and ParCompactionManager the GC threads are
 // held in the GCTaskThread** _thread array in GCTaskManager.
+//  The tasks of a job handed to execute_and_wait() are normally not
+// put on the monitor-protected queue.  They are pushed on a lock-free
+// GCTaskReadyQueue and the GC threads claim them, still in FIFO order,
+// with a CAS.  Completion is counted atomically and only the GC thread
+// that finishes the last task takes the monitor to wake the VMThread,
+// so the monitor is just where GC threads sleep between jobs.  Jobs
+// containing barrier or idle tasks, jobs that would be queued behind
+// IdleGCTasks, and UseGCTaskAffinity still go through the queue.
 
 
 class GCTaskManager : public CHeapObj<mtGC> {
@@ -382,6 +398,9 @@ private:
   uint                      _noop_tasks;        // Count of noop tasks.
   WaitForBarrierGCTask*     _idle_inactive_task;// Task for inactive workers
   volatile uint             _idle_workers;      // Number of idled workers
+  GCTaskReadyQueue*         _ready_queue;       // Lock-free published tasks.
+  bool*                     _ready_task_flag;   // Array of flag per threads.
+  volatile jint             _outstanding_ready_tasks; // Unfinished published tasks.
 public:
   // Factory create and destroy methods.
   static GCTaskManager* create(uint workers) {
@@ -483,6 +502,19 @@ protected:
   void set_thread(uint which, GCTaskThread* value);
   bool resource_flag(uint which);
   void set_resource_flag(uint which, bool value);
+  bool ready_task_flag(uint which);
+  void set_ready_task_flag(uint which, bool value);
+  //     The lock-free handout of the tasks of execute_and_wait().
+  GCTaskReadyQueue* ready_queue() const {
+    return _ready_queue;
+  }
+  bool has_ready_tasks() const {
+    return !ready_queue()->is_empty();
+  }
+  bool publish_ready_tasks(GCTaskQueue* list);
+  GCTask* claim_ready_task(uint which);
+  void note_ready_task_completion(uint which);
+  void wait_for_ready_tasks();
   // Modifier methods with some semantics.
   //     Is any worker blocking handing out new tasks?
   uint blocking_worker() const {
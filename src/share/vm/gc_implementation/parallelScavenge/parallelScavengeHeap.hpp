@@ -108,6 +108,9 @@ class ParallelScavengeHeap : public CollectedHeap {
   void post_initialize();
   void update_counters();
 
+  // Stop the string deduplication threads, if any.
+  virtual void stop();
+
   // The alignment used for the various areas
   size_t space_alignment()      { return _collector_policy->space_alignment(); }
   size_t generation_alignment() { return _collector_policy->gen_alignment(); }
@@ -40,6 +40,7 @@
 #include "gc_implementation/shared/isGCActiveMark.hpp"
 #include "gc_implementation/shared/markSweep.hpp"
 #include "gc_implementation/shared/spaceDecorator.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_interface/gcCause.hpp"
 #include "memory/gcLocker.inline.hpp"
 #include "memory/referencePolicy.hpp"
@@ -566,6 +567,11 @@ void PSMarkSweep::mark_sweep_phase1(bool clear_all_softrefs) {
   // Delete entries for dead interned strings.
   StringTable::unlink(is_alive_closure());
 
+  // Delete entries for dead strings being deduplicated.
+  if (StringDedup::is_enabled()) {
+    StringDedup::unlink(is_alive_closure());
+  }
+
   // Clean up unreferenced symbols in symbol table.
   SymbolTable::unlink();
   _gc_tracer->report_object_count_after_gc(is_alive_closure());
@@ -635,6 +641,9 @@ void PSMarkSweep::mark_sweep_phase3() {
   CodeBlobToOopClosure adjust_from_blobs(adjust_pointer_closure(), CodeBlobToOopClosure::FixRelocations);
   CodeCache::blobs_do(&adjust_from_blobs);
   StringTable::oops_do(adjust_pointer_closure());
+  if (StringDedup::is_enabled()) {
+    StringDedup::oops_do(adjust_pointer_closure());
+  }
   ref_processor()->weak_oops_do(adjust_pointer_closure());
   PSScavenge::reference_processor()->weak_oops_do(adjust_pointer_closure());
 
@@ -64,6 +64,9 @@ void PSPromotionManager::initialize() {
   }
   // The VMThread gets its own PSPromotionManager, which is not available
   // for work stealing.
+  for (uint i = 0; i <= ParallelGCThreads; i++) {
+    _manager_array[i]._worker_id = i;
+  }
 }
 
 PSPromotionManager* PSPromotionManager::gc_thread_promotion_manager(int index) {
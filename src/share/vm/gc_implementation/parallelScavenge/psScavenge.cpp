@@ -39,6 +39,7 @@
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/isGCActiveMark.hpp"
 #include "gc_implementation/shared/spaceDecorator.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_interface/gcCause.hpp"
 #include "memory/collectorPolicy.hpp"
 #include "memory/gcLocker.inline.hpp"
@@ -473,6 +474,14 @@ bool PSScavenge::invoke_no_policy() {
       StringTable::unlink_or_oops_do(&_is_alive_closure, &root_closure);
     }
 
+    if (StringDedup::is_enabled()) {
+      GCTraceTime tm("StringDedup", false, false, &_gc_timer, _gc_tracer.gc_id());
+      // Unlink dead strings from the deduplication queue and table, and
+      // update the references to the surviving ones.
+      PSScavengeRootsClosure root_closure(promotion_manager);
+      StringDedup::unlink_or_oops_do(&_is_alive_closure, &root_closure);
+    }
+
     // Finally, flush the promotion_manager's labs, and deallocate its stacks.
     promotion_failure_occurred = PSPromotionManager::post_scavenge(_gc_tracer);
     if (promotion_failure_occurred) {
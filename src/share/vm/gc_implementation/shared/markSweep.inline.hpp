@@ -30,16 +30,25 @@
 #include "utilities/stack.inline.hpp"
 #include "utilities/macros.hpp"
 #if INCLUDE_ALL_GCS
-#include "gc_implementation/g1/g1StringDedup.hpp"
+#include "gc_implementation/g1/g1Allocator.hpp"
 #include "gc_implementation/parallelScavenge/psParallelCompact.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif // INCLUDE_ALL_GCS
 
+inline bool MarkSweep::is_archive_object(oop object) {
+#if INCLUDE_ALL_GCS
+  return G1ArchiveAllocator::is_archive_object(object);
+#else
+  return false;
+#endif // INCLUDE_ALL_GCS
+}
+
 inline void MarkSweep::mark_object(oop obj) {
 #if INCLUDE_ALL_GCS
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     // We must enqueue the object before it is marked
     // as we otherwise can't read the object's age.
-    G1StringDedup::enqueue_from_mark(obj);
+    StringDedup::enqueue_from_mark(0 /* worker_id */, obj);
   }
 #endif
   // some marks may contain information we need to preserve so we store them away
@@ -63,7 +72,7 @@ template <class T> inline void MarkSweep::follow_root(T* p) {
   T heap_oop = oopDesc::load_heap_oop(p);
   if (!oopDesc::is_null(heap_oop)) {
     oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
-    if (!obj->mark()->is_marked()) {
+    if (!obj->mark()->is_marked() && !is_archive_object(obj)) {
       mark_object(obj);
       obj->follow_contents();
     }
@@ -76,7 +85,7 @@ template <class T> inline void MarkSweep::mark_and_push(T* p) {
   T heap_oop = oopDesc::load_heap_oop(p);
   if (!oopDesc::is_null(heap_oop)) {
     oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
-    if (!obj->mark()->is_marked()) {
+    if (!obj->mark()->is_marked() && !is_archive_object(obj)) {
       mark_object(obj);
       _marking_stack.push(obj);
     }
@@ -94,12 +103,15 @@ template <class T> inline void MarkSweep::adjust_pointer(T* p) {
   if (!oopDesc::is_null(heap_oop)) {
     oop obj     = oopDesc::decode_heap_oop_not_null(heap_oop);
     oop new_obj = oop(obj->mark()->decode_pointer());
-    assert(new_obj != NULL ||                         // is forwarding ptr?
+    assert(is_archive_object(obj) ||                  // never forwarded
+           new_obj != NULL ||                         // is forwarding ptr?
            obj->mark() == markOopDesc::prototype() || // not gc marked?
            (UseBiasedLocking && obj->mark()->has_bias_pattern()),
                                                       // not gc marked?
            "should be forwarded");
-    if (new_obj != NULL) {
+    // The mark of an archive object may be a stack lock rather than a
+    // forwarding pointer.
+    if (new_obj != NULL && !is_archive_object(obj)) {
       assert(Universe::heap()->is_in_reserved(new_obj),
              "should be in object space");
       oopDesc::encode_store_heap_oop_not_null(p, new_obj);
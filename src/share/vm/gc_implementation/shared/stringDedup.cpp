@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#include "precompiled.hpp"
+#include "classfile/javaClasses.hpp"
+#include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
+#include "gc_implementation/parallelScavenge/parallelScavengeHeap.inline.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
+#include "gc_implementation/shared/stringDedupStat.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
+#include "gc_implementation/shared/stringDedupThread.hpp"
+#include "memory/genCollectedHeap.hpp"
+
+bool StringDedup::_enabled = false;
+
+void StringDedup::initialize() {
+  assert(UseG1GC || UseParallelGC || UseConcMarkSweepGC,
+         "String deduplication only available with G1, ParallelGC and CMS");
+  if (UseStringDeduplication) {
+    _enabled = true;
+    StringDedupQueue::create();
+    StringDedupTable::create();
+    StringDedupThread::create();
+  }
+}
+
+void StringDedup::stop() {
+  assert(is_enabled(), "String deduplication not enabled");
+  StringDedupThread::stop();
+}
+
+bool StringDedup::is_in_young(oop obj) {
+  CollectedHeap* heap = Universe::heap();
+  switch (heap->kind()) {
+    case CollectedHeap::G1CollectedHeap:
+      return ((G1CollectedHeap*)heap)->heap_region_containing_raw(obj)->is_young();
+    case CollectedHeap::ParallelScavengeHeap:
+      return ((ParallelScavengeHeap*)heap)->is_in_young(obj);
+    case CollectedHeap::GenCollectedHeap:
+      return ((GenCollectedHeap*)heap)->is_in_young(obj);
+    default:
+      ShouldNotReachHere();
+      return false;
+  }
+}
+
+bool StringDedup::is_candidate_from_mark(oop obj) {
+  if (java_lang_String::is_instance(obj)) {
+    bool from_young = is_in_young(obj);
+    if (from_young && obj->age() < StringDeduplicationAgeThreshold) {
+      // Candidate found. String is being evacuated from young to old but has not
+      // reached the deduplication age threshold, i.e. has not previously been a
+      // candidate during its life in the young generation.
+      return true;
+    }
+  }
+
+  // Not a candidate
+  return false;
+}
+
+void StringDedup::enqueue_from_mark(uint worker_id, oop java_string) {
+  assert(is_enabled(), "String deduplication not enabled");
+  if (is_candidate_from_mark(java_string)) {
+    StringDedupQueue::push(worker_id, java_string);
+  }
+}
+
+bool StringDedup::is_candidate_from_evacuation(bool from_young, bool to_young, oop obj) {
+  if (from_young && java_lang_String::is_instance(obj)) {
+    if (to_young && obj->age() == StringDeduplicationAgeThreshold) {
+      // Candidate found. String is being evacuated from young to young and just
+      // reached the deduplication age threshold.
+      return true;
+    }
+    if (!to_young && obj->age() < StringDeduplicationAgeThreshold) {
+      // Candidate found. String is being evacuated from young to old but has not
+      // reached the deduplication age threshold, i.e. has not previously been a
+      // candidate during its life in the young generation.
+      return true;
+    }
+  }
+
+  // Not a candidate
+  return false;
+}
+
+void StringDedup::enqueue_from_evacuation(bool from_young, bool to_young, uint worker_id, oop java_string) {
+  assert(is_enabled(), "String deduplication not enabled");
+  if (is_candidate_from_evacuation(from_young, to_young, java_string)) {
+    StringDedupQueue::push(worker_id, java_string);
+  }
+}
+
+void StringDedup::deduplicate(oop java_string) {
+  assert(is_enabled(), "String deduplication not enabled");
+  StringDedupStat dummy; // Statistics from this path is never used
+  StringDedupTable::deduplicate(java_string, dummy, StringDedupTable::no_worker_id);
+}
+
+void StringDedup::oops_do(OopClosure* keep_alive) {
+  assert(is_enabled(), "String deduplication not enabled");
+  unlink_or_oops_do(NULL, keep_alive, true /* allow_resize_and_rehash */);
+}
+
+void StringDedup::unlink(BoolObjectClosure* is_alive) {
+  assert(is_enabled(), "String deduplication not enabled");
+  // Don't allow a potential rehash during unlink, as the unlink
+  // operation itself might remove enough entries to invalidate such a decision.
+  unlink_or_oops_do(is_alive, NULL, false /* allow_resize_and_rehash */);
+}
+
+void StringDedup::unlink_or_oops_do(BoolObjectClosure* is_alive,
+                                    OopClosure* keep_alive,
+                                    bool allow_resize_and_rehash) {
+  assert(is_enabled(), "String deduplication not enabled");
+  StringDedupUnlinkOrOopsDoClosure cl(is_alive, keep_alive, allow_resize_and_rehash);
+  unlink_or_oops_do(&cl, 0);
+}
+
+void StringDedup::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id) {
+  assert(is_enabled(), "String deduplication not enabled");
+  StringDedupQueue::unlink_or_oops_do(cl);
+  StringDedupTable::unlink_or_oops_do(cl, worker_id);
+}
+
+void StringDedup::threads_do(ThreadClosure* tc) {
+  assert(is_enabled(), "String deduplication not enabled");
+  for (uint i = 0; i < StringDedupThread::n_threads(); i++) {
+    tc->do_thread(StringDedupThread::thread(i));
+  }
+}
+
+void StringDedup::print_worker_threads_on(outputStream* st) {
+  assert(is_enabled(), "String deduplication not enabled");
+  for (uint i = 0; i < StringDedupThread::n_threads(); i++) {
+    StringDedupThread::thread(i)->print_on(st);
+    st->cr();
+  }
+}
+
+void StringDedup::verify() {
+  assert(is_enabled(), "String deduplication not enabled");
+  StringDedupQueue::verify();
+  StringDedupTable::verify();
+}
+
+StringDedupUnlinkOrOopsDoClosure::StringDedupUnlinkOrOopsDoClosure(BoolObjectClosure* is_alive,
+                                                                       OopClosure* keep_alive,
+                                                                       bool allow_resize_and_rehash) :
+  _is_alive(is_alive),
+  _keep_alive(keep_alive),
+  _rehashed_table(NULL),
+  _next_queue(0),
+  _next_bucket(0) {
+  if (allow_resize_and_rehash) {
+    // Drop the previous table of a completed resize. A rehash is not
+    // started while a resize is still in progress, it will eventually
+    // happen if the situation persists.
+    StringDedupTable::finish_resize();
+    _rehashed_table = StringDedupTable::prepare_rehash();
+  }
+}
+
+StringDedupUnlinkOrOopsDoClosure::~StringDedupUnlinkOrOopsDoClosure() {
+  if (is_rehashing()) {
+    StringDedupTable::finish_rehash(_rehashed_table);
+  }
+}
@@ -24,63 +24,76 @@
 
 #include "precompiled.hpp"
 #include "classfile/javaClasses.hpp"
-#include "gc_implementation/g1/g1StringDedupQueue.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
 #include "memory/gcLocker.hpp"
 #include "runtime/mutexLocker.hpp"
+#include "runtime/orderAccess.inline.hpp"
 #include "utilities/stack.inline.hpp"
 
-G1StringDedupQueue* G1StringDedupQueue::_queue = NULL;
-const size_t        G1StringDedupQueue::_max_size = 1000000; // Max number of elements per queue
-const size_t        G1StringDedupQueue::_max_cache_size = 0; // Max cache size per queue
+StringDedupQueue* StringDedupQueue::_queue = NULL;
+const size_t        StringDedupQueue::_max_size = 1000000; // Max number of elements per queue
+const size_t        StringDedupQueue::_max_cache_size = 0; // Max cache size per queue
 
-G1StringDedupQueue::G1StringDedupQueue() :
-  _cursor(0),
+StringDedupQueue::StringDedupQueue() :
   _cancel(false),
   _empty(true),
   _dropped(0) {
-  _nqueues = MAX2(ParallelGCThreads, (size_t)1);
-  _queues = NEW_C_HEAP_ARRAY(G1StringDedupWorkerQueue, _nqueues, mtGC);
+  _nqueues = ParallelGCThreads + 1;
+  _queues = NEW_C_HEAP_ARRAY(StringDedupWorkerQueue, _nqueues, mtGC);
   for (size_t i = 0; i < _nqueues; i++) {
-    new (_queues + i) G1StringDedupWorkerQueue(G1StringDedupWorkerQueue::default_segment_size(), _max_cache_size, _max_size);
+    new (_queues + i) StringDedupWorkerQueue(StringDedupWorkerQueue::default_segment_size(), _max_cache_size, _max_size);
+  }
+  _claimed = NEW_C_HEAP_ARRAY(volatile jint, _nqueues, mtGC);
+  for (size_t i = 0; i < _nqueues; i++) {
+    _claimed[i] = 0;
+  }
+
+  // Spread the deduplication threads over the queues
+  size_t nworkers = StringDeduplicationThreads;
+  _claims = NEW_C_HEAP_ARRAY(size_t, nworkers, mtGC);
+  _cursors = NEW_C_HEAP_ARRAY(size_t, nworkers, mtGC);
+  for (size_t i = 0; i < nworkers; i++) {
+    _claims[i] = _nqueues;
+    _cursors[i] = i % _nqueues;
   }
 }
 
-G1StringDedupQueue::~G1StringDedupQueue() {
+StringDedupQueue::~StringDedupQueue() {
   ShouldNotReachHere();
 }
 
-void G1StringDedupQueue::create() {
+void StringDedupQueue::create() {
   assert(_queue == NULL, "One string deduplication queue allowed");
-  _queue = new G1StringDedupQueue();
+  _queue = new StringDedupQueue();
 }
 
-void G1StringDedupQueue::wait() {
+void StringDedupQueue::wait() {
   MonitorLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
   while (_queue->_empty && !_queue->_cancel) {
     ml.wait(Mutex::_no_safepoint_check_flag);
   }
 }
 
-void G1StringDedupQueue::cancel_wait() {
+void StringDedupQueue::cancel_wait() {
   MonitorLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
   _queue->_cancel = true;
-  ml.notify();
+  ml.notify_all();
 }
 
-void G1StringDedupQueue::push(uint worker_id, oop java_string) {
+void StringDedupQueue::push(uint worker_id, oop java_string) {
   assert(SafepointSynchronize::is_at_safepoint(), "Must be at safepoint");
   assert(worker_id < _queue->_nqueues, "Invalid queue");
 
   // Push and notify waiter
-  G1StringDedupWorkerQueue& worker_queue = _queue->_queues[worker_id];
+  StringDedupWorkerQueue& worker_queue = _queue->_queues[worker_id];
   if (!worker_queue.is_full()) {
     worker_queue.push(java_string);
     if (_queue->_empty) {
       MonitorLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
       if (_queue->_empty) {
-        // Mark non-empty and notify waiter
+        // Mark non-empty and notify waiters
         _queue->_empty = false;
-        ml.notify();
+        ml.notify_all();
       }
     }
   } else {
@@ -89,34 +102,69 @@ void G1StringDedupQueue::push(uint worker_id, oop java_string) {
   }
 }
 
-oop G1StringDedupQueue::pop() {
+bool StringDedupQueue::claim(size_t queue) {
+  return _queue->_claimed[queue] == 0 &&
+         Atomic::cmpxchg(1, &_queue->_claimed[queue], 0) == 0;
+}
+
+void StringDedupQueue::release(size_t queue) {
+  assert(_queue->_claimed[queue] != 0, "Queue not claimed");
+  OrderAccess::release_store(&_queue->_claimed[queue], 0);
+}
+
+oop StringDedupQueue::pop(size_t queue) {
+  StringDedupWorkerQueue* worker_queue = &_queue->_queues[queue];
+  while (!worker_queue->is_empty()) {
+    oop obj = worker_queue->pop();
+    // The oop we pop can be NULL if it was marked
+    // dead. Just ignore those and pop the next oop.
+    if (obj != NULL) {
+      return obj;
+    }
+  }
+  return NULL;
+}
+
+oop StringDedupQueue::pop(uint worker_id) {
   assert(!SafepointSynchronize::is_at_safepoint(), "Must not be at safepoint");
+  assert(worker_id < StringDeduplicationThreads, "Invalid worker id");
   No_Safepoint_Verifier nsv;
 
+  // Continue with the queue claimed last time
+  size_t* claimed = &_queue->_claims[worker_id];
+  if (*claimed < _queue->_nqueues) {
+    oop obj = pop(*claimed);
+    if (obj != NULL) {
+      return obj;
+    }
+    release(*claimed);
+    *claimed = _queue->_nqueues;
+  }
+
   // Try all queues before giving up
+  size_t* cursor = &_queue->_cursors[worker_id];
   for (size_t tries = 0; tries < _queue->_nqueues; tries++) {
     // The cursor indicates where we left of last time
-    G1StringDedupWorkerQueue* queue = &_queue->_queues[_queue->_cursor];
-    while (!queue->is_empty()) {
-      oop obj = queue->pop();
-      // The oop we pop can be NULL if it was marked
-      // dead. Just ignore those and pop the next oop.
+    size_t queue = *cursor;
+    *cursor = (queue + 1) % _queue->_nqueues;
+    if (!_queue->_queues[queue].is_empty() && claim(queue)) {
+      oop obj = pop(queue);
       if (obj != NULL) {
+        *claimed = queue;
         return obj;
       }
+      release(queue);
     }
-
-    // Try next queue
-    _queue->_cursor = (_queue->_cursor + 1) % _queue->_nqueues;
   }
 
-  // Mark empty
+  // Mark empty. Queues claimed by other threads are still being
+  // processed by them.
   _queue->_empty = true;
 
   return NULL;
 }
 
-void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl) {
+void StringDedupQueue::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl) {
   // A worker thread first claims a queue, which ensures exclusive
   // access to that queue, then continues to process it.
   for (;;) {
@@ -132,7 +180,7 @@ void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* c
   }
 }
 
-void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl, size_t queue) {
+void StringDedupQueue::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, size_t queue) {
   assert(queue < _queue->_nqueues, "Invalid queue");
   StackIterator<oop, mtGC> iter(_queue->_queues[queue]);
   while (!iter.is_empty()) {
@@ -148,13 +196,13 @@ void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* c
   }
 }
 
-void G1StringDedupQueue::print_statistics(outputStream* st) {
+void StringDedupQueue::print_statistics(outputStream* st) {
   st->print_cr(
     "   [Queue]\n"
     "      [Dropped: "UINTX_FORMAT"]", _queue->_dropped);
 }
 
-void G1StringDedupQueue::verify() {
+void StringDedupQueue::verify() {
   for (size_t i = 0; i < _queue->_nqueues; i++) {
     StackIterator<oop, mtGC> iter(_queue->_queues[i]);
     while (!iter.is_empty()) {
@@ -22,14 +22,14 @@
  *
  */
 
-#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPQUEUE_HPP
-#define SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPQUEUE_HPP
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPQUEUE_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPQUEUE_HPP
 
 #include "memory/allocation.hpp"
 #include "oops/oop.hpp"
 #include "utilities/stack.hpp"
 
-class G1StringDedupUnlinkOrOopsDoClosure;
+class StringDedupUnlinkOrOopsDoClosure;
 
 //
 // The deduplication queue acts as the communication channel between the stop-the-world
@@ -39,42 +39,55 @@ class G1StringDedupUnlinkOrOopsDoClosure;
 // to entries in the deduplication hashtable which points to character arrays).
 //
 // While users of the queue treat it as a single queue, it is implemented as a set of
-// queues, one queue per GC worker thread, to allow lock-free and cache-friendly enqueue
-// operations by the GC workers.
+// queues, one queue per GC worker thread and one for the VM thread, to allow lock-free
+// and cache-friendly enqueue operations by the GC workers.
 //
 // The oops in the queue are treated as weak pointers, meaning the objects they point to
 // can become unreachable and pruned (cleared) before being popped by the deduplication
 // thread.
 //
 // Pushing to the queue is thread safe (this relies on each thread using a unique worker
-// id), but only allowed during a safepoint. Popping from the queue is NOT thread safe
-// and can only be done by the deduplication thread outside a safepoint.
+// id), but only allowed during a safepoint. Popping from the queue can only be done by
+// the deduplication threads outside a safepoint. A deduplication thread first claims one
+// of the GC worker queues, which gives it exclusive access to that queue, and pops from
+// it until it is empty before moving on to the next unclaimed queue. This way the
+// deduplication threads process the queues in parallel.
 //
 // The StringDedupQueue_lock is only used for blocking and waking up the deduplication
-// thread in case the queue is empty or becomes non-empty, respectively. This lock does
+// threads in case the queue is empty or becomes non-empty, respectively. This lock does
 // not otherwise protect the queue content.
 //
-class G1StringDedupQueue : public CHeapObj<mtGC> {
+class StringDedupQueue : public CHeapObj<mtGC> {
 private:
-  typedef Stack<oop, mtGC> G1StringDedupWorkerQueue;
+  typedef Stack<oop, mtGC> StringDedupWorkerQueue;
 
-  static G1StringDedupQueue* _queue;
+  static StringDedupQueue* _queue;
   static const size_t        _max_size;
   static const size_t        _max_cache_size;
 
-  G1StringDedupWorkerQueue*  _queues;
+  StringDedupWorkerQueue*  _queues;
   size_t                     _nqueues;
-  size_t                     _cursor;
+  volatile jint*             _claimed;   // Per queue, non-zero if claimed
+  size_t*                    _claims;    // Per deduplication thread, the claimed queue
+  size_t*                    _cursors;   // Per deduplication thread, the next queue to try
   bool                       _cancel;
   volatile bool              _empty;
 
   // Statistics counter, only used for logging.
   uintx                      _dropped;
 
-  G1StringDedupQueue();
-  ~G1StringDedupQueue();
+  StringDedupQueue();
+  ~StringDedupQueue();
 
-  static void unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl, size_t queue);
+  // Pops the next live oop from the given claimed queue, returns NULL
+  // if the queue is empty.
+  static oop pop(size_t queue);
+
+  // Claims and releases exclusive access to the given queue.
+  static bool claim(size_t queue);
+  static void release(size_t queue);
+
+  static void unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, size_t queue);
 
 public:
   static void create();
@@ -88,14 +101,14 @@ public:
   // Pushes a deduplication candidate onto a specific GC worker queue.
   static void push(uint worker_id, oop java_string);
 
-  // Pops a deduplication candidate from any queue, returns NULL if
-  // all queues are empty.
-  static oop pop();
+  // Pops a deduplication candidate for the given deduplication thread
+  // from any queue, returns NULL if all unclaimed queues are empty.
+  static oop pop(uint worker_id);
 
-  static void unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl);
+  static void unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl);
 
   static void print_statistics(outputStream* st);
   static void verify();
 };
 
-#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPQUEUE_HPP
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPQUEUE_HPP
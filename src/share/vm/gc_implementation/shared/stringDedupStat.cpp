@@ -23,9 +23,9 @@
  */
 
 #include "precompiled.hpp"
-#include "gc_implementation/g1/g1StringDedupStat.hpp"
+#include "gc_implementation/shared/stringDedupStat.hpp"
 
-G1StringDedupStat::G1StringDedupStat() :
+StringDedupStat::StringDedupStat() :
   _inspected(0),
   _skipped(0),
   _hashed(0),
@@ -47,7 +47,7 @@ G1StringDedupStat::G1StringDedupStat() :
   _block_elapsed(0.0) {
 }
 
-void G1StringDedupStat::add(const G1StringDedupStat& stat) {
+void StringDedupStat::add(const StringDedupStat& stat) {
   _inspected           += stat._inspected;
   _skipped             += stat._skipped;
   _hashed              += stat._hashed;
@@ -68,7 +68,7 @@ void G1StringDedupStat::add(const G1StringDedupStat& stat) {
   _block_elapsed       += stat._block_elapsed;
 }
 
-void G1StringDedupStat::print_summary(outputStream* st, const G1StringDedupStat& last_stat, const G1StringDedupStat& total_stat) {
+void StringDedupStat::print_summary(outputStream* st, const StringDedupStat& last_stat, const StringDedupStat& total_stat) {
   double total_deduped_bytes_percent = 0.0;
 
   if (total_stat._new_bytes > 0) {
@@ -80,16 +80,16 @@ void G1StringDedupStat::print_summary(outputStream* st, const G1StringDedupStat&
   st->stamp(PrintGCTimeStamps);
   st->print_cr(
     "[GC concurrent-string-deduplication, "
-    G1_STRDEDUP_BYTES_FORMAT_NS"->"G1_STRDEDUP_BYTES_FORMAT_NS"("G1_STRDEDUP_BYTES_FORMAT_NS"), avg "
-    G1_STRDEDUP_PERCENT_FORMAT_NS", "G1_STRDEDUP_TIME_FORMAT"]",
-    G1_STRDEDUP_BYTES_PARAM(last_stat._new_bytes),
-    G1_STRDEDUP_BYTES_PARAM(last_stat._new_bytes - last_stat._deduped_bytes),
-    G1_STRDEDUP_BYTES_PARAM(last_stat._deduped_bytes),
+    STRDEDUP_BYTES_FORMAT_NS"->"STRDEDUP_BYTES_FORMAT_NS"("STRDEDUP_BYTES_FORMAT_NS"), avg "
+    STRDEDUP_PERCENT_FORMAT_NS", "STRDEDUP_TIME_FORMAT"]",
+    STRDEDUP_BYTES_PARAM(last_stat._new_bytes),
+    STRDEDUP_BYTES_PARAM(last_stat._new_bytes - last_stat._deduped_bytes),
+    STRDEDUP_BYTES_PARAM(last_stat._deduped_bytes),
     total_deduped_bytes_percent,
     last_stat._exec_elapsed);
 }
 
-void G1StringDedupStat::print_statistics(outputStream* st, const G1StringDedupStat& stat, bool total) {
+void StringDedupStat::print_statistics(outputStream* st, const StringDedupStat& stat, bool total) {
   double young_percent               = 0.0;
   double old_percent                 = 0.0;
   double skipped_percent             = 0.0;
@@ -135,28 +135,28 @@ void G1StringDedupStat::print_statistics(outputStream* st, const G1StringDedupSt
 
   if (total) {
     st->print_cr(
-      "   [Total Exec: "UINTX_FORMAT"/"G1_STRDEDUP_TIME_FORMAT", Idle: "UINTX_FORMAT"/"G1_STRDEDUP_TIME_FORMAT", Blocked: "UINTX_FORMAT"/"G1_STRDEDUP_TIME_FORMAT"]",
+      "   [Total Exec: "UINTX_FORMAT"/"STRDEDUP_TIME_FORMAT", Idle: "UINTX_FORMAT"/"STRDEDUP_TIME_FORMAT", Blocked: "UINTX_FORMAT"/"STRDEDUP_TIME_FORMAT"]",
       stat._exec, stat._exec_elapsed, stat._idle, stat._idle_elapsed, stat._block, stat._block_elapsed);
   } else {
     st->print_cr(
-      "   [Last Exec: "G1_STRDEDUP_TIME_FORMAT", Idle: "G1_STRDEDUP_TIME_FORMAT", Blocked: "UINTX_FORMAT"/"G1_STRDEDUP_TIME_FORMAT"]",
+      "   [Last Exec: "STRDEDUP_TIME_FORMAT", Idle: "STRDEDUP_TIME_FORMAT", Blocked: "UINTX_FORMAT"/"STRDEDUP_TIME_FORMAT"]",
       stat._exec_elapsed, stat._idle_elapsed, stat._block, stat._block_elapsed);
   }
   st->print_cr(
-    "      [Inspected:    "G1_STRDEDUP_OBJECTS_FORMAT"]\n"
-    "         [Skipped:   "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT")]\n"
-    "         [Hashed:    "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT")]\n"
-    "         [Known:     "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT")]\n"
-    "         [New:       "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT") "G1_STRDEDUP_BYTES_FORMAT"]\n"
-    "      [Deduplicated: "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT") "G1_STRDEDUP_BYTES_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT")]\n"
-    "         [Young:     "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT") "G1_STRDEDUP_BYTES_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT")]\n"
-    "         [Old:       "G1_STRDEDUP_OBJECTS_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT") "G1_STRDEDUP_BYTES_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT")]",
+    "      [Inspected:    "STRDEDUP_OBJECTS_FORMAT"]\n"
+    "         [Skipped:   "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT")]\n"
+    "         [Hashed:    "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT")]\n"
+    "         [Known:     "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT")]\n"
+    "         [New:       "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT") "STRDEDUP_BYTES_FORMAT"]\n"
+    "      [Deduplicated: "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT") "STRDEDUP_BYTES_FORMAT"("STRDEDUP_PERCENT_FORMAT")]\n"
+    "         [Young:     "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT") "STRDEDUP_BYTES_FORMAT"("STRDEDUP_PERCENT_FORMAT")]\n"
+    "         [Old:       "STRDEDUP_OBJECTS_FORMAT"("STRDEDUP_PERCENT_FORMAT") "STRDEDUP_BYTES_FORMAT"("STRDEDUP_PERCENT_FORMAT")]",
     stat._inspected,
     stat._skipped, skipped_percent,
     stat._hashed, hashed_percent,
     stat._known, known_percent,
-    stat._new, new_percent, G1_STRDEDUP_BYTES_PARAM(stat._new_bytes),
-    stat._deduped, deduped_percent, G1_STRDEDUP_BYTES_PARAM(stat._deduped_bytes), deduped_bytes_percent,
-    stat._deduped_young, deduped_young_percent, G1_STRDEDUP_BYTES_PARAM(stat._deduped_young_bytes), deduped_young_bytes_percent,
-    stat._deduped_old, deduped_old_percent, G1_STRDEDUP_BYTES_PARAM(stat._deduped_old_bytes), deduped_old_bytes_percent);
+    stat._new, new_percent, STRDEDUP_BYTES_PARAM(stat._new_bytes),
+    stat._deduped, deduped_percent, STRDEDUP_BYTES_PARAM(stat._deduped_bytes), deduped_bytes_percent,
+    stat._deduped_young, deduped_young_percent, STRDEDUP_BYTES_PARAM(stat._deduped_young_bytes), deduped_young_bytes_percent,
+    stat._deduped_old, deduped_old_percent, STRDEDUP_BYTES_PARAM(stat._deduped_old_bytes), deduped_old_bytes_percent);
 }
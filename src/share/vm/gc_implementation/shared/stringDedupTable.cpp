@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#include "precompiled.hpp"
+#include "classfile/altHashing.hpp"
+#include "classfile/javaClasses.hpp"
+#include "gc_implementation/g1/g1SATBCardTableModRefBS.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
+#include "memory/gcLocker.hpp"
+#include "memory/padded.inline.hpp"
+#include "oops/typeArrayOop.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/orderAccess.inline.hpp"
+
+//
+// Freelist in the deduplication table entry cache. Links table
+// entries together using their _next fields.
+//
+class StringDedupEntryFreeList : public CHeapObj<mtGC> {
+private:
+  StringDedupEntry* _list;
+  size_t              _length;
+
+public:
+  StringDedupEntryFreeList() :
+    _list(NULL),
+    _length(0) {
+  }
+
+  void add(StringDedupEntry* entry) {
+    entry->set_next(_list);
+    _list = entry;
+    _length++;
+  }
+
+  StringDedupEntry* remove() {
+    StringDedupEntry* entry = _list;
+    if (entry != NULL) {
+      _list = entry->next();
+      _length--;
+    }
+    return entry;
+  }
+
+  size_t length() {
+    return _length;
+  }
+};
+
+//
+// Cache of deduplication table entries. This cache provides fast allocation and
+// reuse of table entries to lower the pressure on the underlying allocator.
+// But more importantly, it provides fast/deferred freeing of table entries. This
+// is important because freeing of table entries is done during stop-the-world
+// phases and it is not uncommon for large number of entries to be freed at once.
+// Tables entries that are freed during these phases are placed onto a freelist in
+// the cache. The deduplication thread, which executes in a concurrent phase, will
+// later reuse or free the underlying memory for these entries.
+//
+// The cache allows for multi-threaded allocations and frees. Each deduplication
+// thread allocates from its own subset of the freelists, freelist i being used by
+// deduplication thread i % StringDeduplicationThreads, so allocations need no
+// synchronization. Threads other than the deduplication threads bypass the cache.
+//
+class StringDedupEntryCache : public CHeapObj<mtGC> {
+private:
+  // One freelist per GC worker to allow lock less freeing of
+  // entries while doing a parallel scan of the table. Using
+  // PaddedEnd to avoid false sharing.
+  PaddedEnd<StringDedupEntryFreeList>* _lists;
+  size_t                                 _nlists;
+  size_t                                 _nworkers;
+
+public:
+  StringDedupEntryCache();
+  ~StringDedupEntryCache();
+
+  // Get a table entry from the cache freelists of the given deduplication
+  // thread, or allocate a new entry if they are empty.
+  StringDedupEntry* alloc(uint worker_id);
+
+  // Insert a table entry into the cache freelist.
+  void free(StringDedupEntry* entry, uint worker_id);
+
+  // Returns current number of entries in the cache.
+  size_t size();
+
+  // If the freelists of the given deduplication thread have grown above
+  // the given max size, trim them down and deallocate the memory occupied
+  // by trimmed of entries.
+  void trim(uint worker_id, size_t max_size);
+};
+
+StringDedupEntryCache::StringDedupEntryCache() {
+  _nlists = MAX2(ParallelGCThreads, (size_t)1);
+  _nworkers = StringDeduplicationThreads;
+  _lists = PaddedArray<StringDedupEntryFreeList, mtGC>::create_unfreeable((uint)_nlists);
+}
+
+StringDedupEntryCache::~StringDedupEntryCache() {
+  ShouldNotReachHere();
+}
+
+StringDedupEntry* StringDedupEntryCache::alloc(uint worker_id) {
+  if (worker_id < _nworkers) {
+    for (size_t i = worker_id; i < _nlists; i += _nworkers) {
+      StringDedupEntry* entry = _lists[i].remove();
+      if (entry != NULL) {
+        return entry;
+      }
+    }
+  }
+  return new StringDedupEntry();
+}
+
+void StringDedupEntryCache::free(StringDedupEntry* entry, uint worker_id) {
+  assert(entry->obj() != NULL, "Double free");
+  assert(worker_id < _nlists, "Invalid worker id");
+  entry->set_obj(NULL);
+  entry->set_hash(0);
+  _lists[worker_id].add(entry);
+}
+
+size_t StringDedupEntryCache::size() {
+  size_t size = 0;
+  for (size_t i = 0; i < _nlists; i++) {
+    size += _lists[i].length();
+  }
+  return size;
+}
+
+void StringDedupEntryCache::trim(uint worker_id, size_t max_size) {
+  assert(worker_id < _nworkers, "Invalid worker id");
+  size_t cache_size = 0;
+  for (size_t i = worker_id; i < _nlists; i += _nworkers) {
+    StringDedupEntryFreeList* list = &_lists[i];
+    cache_size += list->length();
+    while (cache_size > max_size) {
+      StringDedupEntry* entry = list->remove();
+      assert(entry != NULL, "Should not be null");
+      cache_size--;
+      delete entry;
+    }
+  }
+}
+
+StringDedupTable* volatile StringDedupTable::_table = NULL;
+StringDedupTable*      StringDedupTable::_resize_source = NULL;
+volatile size_t          StringDedupTable::_resize_next_bucket = 0;
+bool                     StringDedupTable::_resize_forced = false;
+volatile uintx           StringDedupTable::_entries = 0;
+Mutex**                  StringDedupTable::_locks = NULL;
+StringDedupEntryCache* StringDedupTable::_entry_cache = NULL;
+
+const uint               StringDedupTable::no_worker_id = max_juint;
+
+const size_t             StringDedupTable::_min_size = (1 << 10);   // 1024
+const size_t             StringDedupTable::_max_size = (1 << 24);   // 16777216
+const double             StringDedupTable::_grow_load_factor = 2.0; // Grow table at 200% load
+const double             StringDedupTable::_shrink_load_factor = _grow_load_factor / 3.0; // Shrink table at 67% load
+const double             StringDedupTable::_max_cache_factor = 0.1; // Cache a maximum of 10% of the table size
+const uintx              StringDedupTable::_rehash_multiple = 60;   // Hash bucket has 60 times more collisions than expected
+const uintx              StringDedupTable::_rehash_threshold = (uintx)(_rehash_multiple * _grow_load_factor);
+const size_t             StringDedupTable::_lock_count = 64;        // Must not be larger than _min_size
+const size_t             StringDedupTable::_resize_chunk_size = 256; // Buckets moved per resize step
+
+uintx                    StringDedupTable::_entries_added = 0;
+uintx                    StringDedupTable::_entries_removed = 0;
+uintx                    StringDedupTable::_resize_count = 0;
+uintx                    StringDedupTable::_rehash_count = 0;
+
+StringDedupTable::StringDedupTable(size_t size, jint hash_seed) :
+  _size(size),
+  _grow_threshold((uintx)(size * _grow_load_factor)),
+  _shrink_threshold((uintx)(size * _shrink_load_factor)),
+  _rehash_needed(false),
+  _hash_seed(hash_seed) {
+  assert(is_power_of_2(size), "Table size must be a power of 2");
+  _buckets = NEW_C_HEAP_ARRAY(StringDedupEntry*, _size, mtGC);
+  memset(_buckets, 0, _size * sizeof(StringDedupEntry*));
+}
+
+StringDedupTable::~StringDedupTable() {
+  FREE_C_HEAP_ARRAY(StringDedupEntry*, _buckets, mtGC);
+}
+
+void StringDedupTable::create() {
+  assert(_table == NULL, "One string deduplication table allowed");
+  assert(is_power_of_2(_lock_count) && _lock_count <= _min_size, "Invalid lock count");
+  _locks = NEW_C_HEAP_ARRAY(Mutex*, _lock_count, mtGC);
+  for (size_t i = 0; i < _lock_count; i++) {
+    _locks[i] = new Mutex(Mutex::leaf, "StringDedupTable bucket lock", true);
+  }
+  _entry_cache = new StringDedupEntryCache();
+  _table = new StringDedupTable(_min_size);
+}
+
+StringDedupTable* StringDedupTable::table() {
+  return (StringDedupTable*)OrderAccess::load_ptr_acquire(&_table);
+}
+
+bool StringDedupTable::use_java_hash() {
+  return table()->_hash_seed == 0;
+}
+
+void StringDedupTable::add(typeArrayOop value, unsigned int hash, StringDedupEntry** list, uint worker_id) {
+  StringDedupEntry* entry = _entry_cache->alloc(worker_id);
+  entry->set_obj(value);
+  entry->set_hash(hash);
+  entry->set_next(*list);
+  *list = entry;
+  Atomic::inc_ptr(&_entries);
+}
+
+void StringDedupTable::remove(StringDedupEntry** pentry, uint worker_id) {
+  StringDedupEntry* entry = *pentry;
+  *pentry = entry->next();
+  _entry_cache->free(entry, worker_id);
+}
+
+void StringDedupTable::transfer(StringDedupEntry** pentry, StringDedupTable* dest) {
+  StringDedupEntry* entry = *pentry;
+  *pentry = entry->next();
+  unsigned int hash = entry->hash();
+  size_t index = dest->hash_to_index(hash);
+  StringDedupEntry** list = dest->bucket(index);
+  entry->set_next(*list);
+  *list = entry;
+}
+
+bool StringDedupTable::equals(typeArrayOop value1, typeArrayOop value2) {
+  return (value1 == value2 ||
+          (value1->length() == value2->length() &&
+           (!memcmp(value1->base(T_CHAR),
+                    value2->base(T_CHAR),
+                    value1->length() * sizeof(jchar)))));
+}
+
+typeArrayOop StringDedupTable::lookup(typeArrayOop value, unsigned int hash,
+                                        StringDedupEntry** list, uintx &count) {
+  for (StringDedupEntry* entry = *list; entry != NULL; entry = entry->next()) {
+    if (entry->hash() == hash) {
+      typeArrayOop existing_value = entry->obj();
+      if (equals(value, existing_value)) {
+        // Match found
+        return existing_value;
+      }
+    }
+    count++;
+  }
+
+  // Not found
+  return NULL;
+}
+
+typeArrayOop StringDedupTable::lookup_or_add_inner(typeArrayOop value, unsigned int hash, uint worker_id) {
+  size_t index = hash_to_index(hash);
+  StringDedupEntry** list = bucket(index);
+  uintx count = 0;
+
+  // Lookup in list
+  typeArrayOop existing_value = lookup(value, hash, list, count);
+
+  // Check if rehash is needed
+  if (count > _rehash_threshold) {
+    _rehash_needed = true;
+  }
+
+  if (existing_value == NULL) {
+    // Not found, add new entry
+    add(value, hash, list, worker_id);
+
+    // Update statistics
+    Atomic::inc_ptr(&_entries_added);
+  }
+
+  return existing_value;
+}
+
+typeArrayOop StringDedupTable::lookup_or_add(typeArrayOop value, unsigned int hash, uint worker_id) {
+  // Protect the buckets for this hash code, in both tables while resizing,
+  // from concurrent access. Entries not moved yet are still found in the
+  // previous table, new entries always go into the active table.
+  MutexLockerEx ml(lock_for(hash), Mutex::_no_safepoint_check_flag);
+  StringDedupTable* active = table();
+  StringDedupTable* source = _resize_source;
+  if (source != NULL && source != active) {
+    uintx count = 0;
+    typeArrayOop existing_value = source->lookup(value, hash, source->bucket(source->hash_to_index(hash)), count);
+    if (existing_value != NULL) {
+      return existing_value;
+    }
+  }
+  return active->lookup_or_add_inner(value, hash, worker_id);
+}
+
+unsigned int StringDedupTable::hash_code(typeArrayOop value) {
+  unsigned int hash;
+  int length = value->length();
+  const jchar* data = (jchar*)value->base(T_CHAR);
+
+  if (use_java_hash()) {
+    hash = java_lang_String::hash_code(data, length);
+  } else {
+    hash = AltHashing::murmur3_32(table()->_hash_seed, data, length);
+  }
+
+  return hash;
+}
+
+void StringDedupTable::deduplicate(oop java_string, StringDedupStat& stat, uint worker_id) {
+  assert(java_lang_String::is_instance(java_string), "Must be a string");
+  No_Safepoint_Verifier nsv;
+
+  stat.inc_inspected();
+
+  typeArrayOop value = java_lang_String::value(java_string);
+  if (value == NULL) {
+    // String has no value
+    stat.inc_skipped();
+    return;
+  }
+
+  unsigned int hash = 0;
+
+  if (use_java_hash()) {
+    // Get hash code from cache
+    hash = java_lang_String::hash(java_string);
+  }
+
+  if (hash == 0) {
+    // Compute hash
+    hash = hash_code(value);
+    stat.inc_hashed();
+  }
+
+  if (use_java_hash() && hash != 0) {
+    // Store hash code in cache
+    java_lang_String::set_hash(java_string, hash);
+  }
+
+  typeArrayOop existing_value = lookup_or_add(value, hash, worker_id);
+  if (existing_value == value) {
+    // Same value, already known
+    stat.inc_known();
+    return;
+  }
+
+  // Get size of value array
+  uintx size_in_bytes = value->size() * HeapWordSize;
+  stat.inc_new(size_in_bytes);
+
+  if (existing_value != NULL) {
+    if (UseG1GC) {
+      // Enqueue the reference to make sure it is kept alive. Concurrent mark might
+      // otherwise declare it dead if there are no other strong references to this
+      // object. CMS finds it through the card dirtied by the store below.
+      G1SATBCardTableModRefBS::enqueue(existing_value);
+    }
+
+    // Existing value found, deduplicate string
+    java_lang_String::set_value(java_string, existing_value);
+
+    if (StringDedup::is_in_young(value)) {
+      stat.inc_deduped_young(size_in_bytes);
+    } else {
+      stat.inc_deduped_old(size_in_bytes);
+    }
+  }
+}
+
+bool StringDedupTable::is_resize_needed() {
+  StringDedupTable* active = table();
+  return (_entries > active->_grow_threshold && active->_size < _max_size) ||
+         (_entries < active->_shrink_threshold && active->_size > _min_size) ||
+         _resize_forced;
+}
+
+void StringDedupTable::start_resize() {
+  MutexLockerEx ml(StringDedupTable_lock, Mutex::_no_safepoint_check_flag);
+  if (_resize_source != NULL || !is_resize_needed()) {
+    // Already resizing, or another thread did the resize
+    return;
+  }
+
+  size_t size = _table->_size;
+
+  if (_entries > _table->_grow_threshold && size < _max_size) {
+    // Grow table, double the size
+    size *= 2;
+  } else if (_entries < _table->_shrink_threshold && size > _min_size) {
+    // Shrink table, half the size
+    size /= 2;
+  } else {
+    // Force grow
+    size *= 2;
+    if (size > _max_size) {
+      // Too big, force shrink instead
+      size /= 4;
+    }
+  }
+  _resize_forced = false;
+
+  // Update statistics
+  _resize_count++;
+
+  // Allocate and install the new table. The entries of the previous table
+  // will be moved by the deduplication threads calling resize_step(). The
+  // source must be visible before the new table, see lookup_or_add().
+  StringDedupTable* resized_table = new StringDedupTable(size, _table->_hash_seed);
+  _resize_next_bucket = 0;
+  _resize_source = _table;
+  OrderAccess::release_store_ptr(&_table, resized_table);
+}
+
+bool StringDedupTable::resize_step() {
+  assert(!SafepointSynchronize::is_at_safepoint(), "Must not be at safepoint");
+  if (_resize_source == NULL) {
+    if (!is_resize_needed()) {
+      // Resize not needed
+      return false;
+    }
+    start_resize();
+  }
+
+  StringDedupTable* dest = table();
+  StringDedupTable* source = _resize_source;
+  if (source == NULL || source == dest) {
+    return false;
+  }
+
+  // Claim the next chunk of buckets
+  size_t chunk_begin = (size_t)Atomic::add_ptr(_resize_chunk_size, &_resize_next_bucket) - _resize_chunk_size;
+  if (chunk_begin >= source->_size) {
+    // All buckets claimed
+    return false;
+  }
+  size_t chunk_end = MIN2(chunk_begin + _resize_chunk_size, source->_size);
+
+  // Move the entries. All entries of a bucket go to buckets
+  // protected by the same lock in the new table.
+  for (size_t bucket = chunk_begin; bucket < chunk_end; bucket++) {
+    MutexLockerEx ml(lock_for(bucket), Mutex::_no_safepoint_check_flag);
+    StringDedupEntry** entry = source->bucket(bucket);
+    while (*entry != NULL) {
+      source->transfer(entry, dest);
+    }
+  }
+
+  return true;
+}
+
+void StringDedupTable::finish_resize() {
+  assert(SafepointSynchronize::is_at_safepoint(), "Must be at safepoint");
+
+  if (StringDeduplicationResizeALot) {
+    _resize_forced = true;
+  }
+
+  if (_resize_source != NULL && _resize_next_bucket >= _resize_source->_size) {
+    // All entries have been moved and no deduplication thread is
+    // moving buckets during the safepoint, free the old table
+    delete _resize_source;
+    _resize_source = NULL;
+  }
+}
+
+void StringDedupTable::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id) {
+  // The table is divided into partitions to allow lock-less parallel processing by
+  // multiple worker threads. A worker thread first claims a partition, which ensures
+  // exclusive access to that part of the table, then continues to process it. While
+  // the table is being resized, the partitions of the previous table follow those of
+  // the currently active table.
+  StringDedupTable* active = _table;
+  StringDedupTable* source = _resize_source;
+  size_t active_size = active->_size;
+  size_t total_size = active_size;
+  size_t min_size = active_size;
+  if (source != NULL) {
+    total_size += source->_size;
+    min_size = MIN2(min_size, source->_size);
+  }
+
+  // Let each partition be one page worth of buckets
+  size_t partition_size = MIN2(min_size, os::vm_page_size() / sizeof(StringDedupEntry*));
+  assert(min_size % partition_size == 0, "Invalid partition size");
+
+  // Number of entries removed during the scan
+  uintx removed = 0;
+
+  for (;;) {
+    // Grab next partition to scan
+    size_t partition_begin = cl->claim_table_partition(partition_size);
+    size_t partition_end = partition_begin + partition_size;
+    if (partition_begin >= total_size) {
+      // End of table
+      break;
+    }
+
+    if (partition_begin < active_size) {
+      removed += unlink_or_oops_do(cl, active, partition_begin, partition_end, worker_id);
+    } else {
+      removed += unlink_or_oops_do(cl, source, partition_begin - active_size, partition_end - active_size, worker_id);
+    }
+  }
+
+  // Delayed update avoid contention on the counters
+  if (removed > 0) {
+    Atomic::add_ptr(-(intptr_t)removed, &_entries);
+    Atomic::add_ptr((intptr_t)removed, &_entries_removed);
+  }
+}
+
+uintx StringDedupTable::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl,
+                                            StringDedupTable* table,
+                                            size_t partition_begin,
+                                            size_t partition_end,
+                                            uint worker_id) {
+  uintx removed = 0;
+  for (size_t bucket = partition_begin; bucket < partition_end; bucket++) {
+    StringDedupEntry** entry = table->bucket(bucket);
+    while (*entry != NULL) {
+      oop* p = (oop*)(*entry)->obj_addr();
+      if (cl->is_alive(*p)) {
+        cl->keep_alive(p);
+        if (cl->is_rehashing()) {
+          // We are rehashing the table, rehash the entry but keep it
+          // in the table. We can't transfer entries into the new table
+          // at this point since we don't have exclusive access to all
+          // destination partitions. finish_rehash() will do a single
+          // threaded transfer of all entries.
+          typeArrayOop value = (typeArrayOop)*p;
+          unsigned int hash = hash_code(value);
+          (*entry)->set_hash(hash);
+        }
+
+        // Move to next entry
+        entry = (*entry)->next_addr();
+      } else {
+        // Not alive, remove entry from table
+        table->remove(entry, worker_id);
+        removed++;
+      }
+    }
+  }
+
+  return removed;
+}
+
+StringDedupTable* StringDedupTable::prepare_rehash() {
+  if (!_table->_rehash_needed && !StringDeduplicationRehashALot) {
+    // Rehash not needed
+    return NULL;
+  }
+
+  if (_resize_source != NULL) {
+    // Not while resizing, the entries of the previous table would
+    // have to be rehashed as well
+    return NULL;
+  }
+
+  // Update statistics
+  _rehash_count++;
+
+  // Compute new hash seed
+  _table->_hash_seed = AltHashing::compute_seed();
+
+  // Allocate the new table, same size and hash seed
+  return new StringDedupTable(_table->_size, _table->_hash_seed);
+}
+
+void StringDedupTable::finish_rehash(StringDedupTable* rehashed_table) {
+  assert(rehashed_table != NULL, "Invalid table");
+
+  // Move all newly rehashed entries into the correct buckets in the new table
+  for (size_t bucket = 0; bucket < _table->_size; bucket++) {
+    StringDedupEntry** entry = _table->bucket(bucket);
+    while (*entry != NULL) {
+      _table->transfer(entry, rehashed_table);
+    }
+  }
+
+  // Free old table
+  delete _table;
+
+  // Install new table
+  _table = rehashed_table;
+}
+
+void StringDedupTable::verify() {
+  verify(_table);
+  if (_resize_source != NULL) {
+    verify(_resize_source);
+  }
+}
+
+void StringDedupTable::verify(StringDedupTable* table) {
+  for (size_t bucket = 0; bucket < table->_size; bucket++) {
+    // Verify entries
+    StringDedupEntry** entry = table->bucket(bucket);
+    while (*entry != NULL) {
+      typeArrayOop value = (*entry)->obj();
+      guarantee(value != NULL, "Object must not be NULL");
+      guarantee(Universe::heap()->is_in_reserved(value), "Object must be on the heap");
+      guarantee(!value->is_forwarded(), "Object must not be forwarded");
+      guarantee(value->is_typeArray(), "Object must be a typeArrayOop");
+      unsigned int hash = hash_code(value);
+      guarantee((*entry)->hash() == hash, "Table entry has inorrect hash");
+      guarantee(table->hash_to_index(hash) == bucket, "Table entry has incorrect index");
+      entry = (*entry)->next_addr();
+    }
+
+    // Verify that we do not have entries with identical oops or identical arrays.
+    // We only need to compare entries in the same bucket. If the same oop or an
+    // identical array has been inserted more than once into different/incorrect
+    // buckets the verification step above will catch that.
+    StringDedupEntry** entry1 = table->bucket(bucket);
+    while (*entry1 != NULL) {
+      typeArrayOop value1 = (*entry1)->obj();
+      StringDedupEntry** entry2 = (*entry1)->next_addr();
+      while (*entry2 != NULL) {
+        typeArrayOop value2 = (*entry2)->obj();
+        guarantee(!equals(value1, value2), "Table entries must not have identical arrays");
+        entry2 = (*entry2)->next_addr();
+      }
+      entry1 = (*entry1)->next_addr();
+    }
+  }
+}
+
+void StringDedupTable::trim_entry_cache(uint worker_id) {
+  // Each deduplication thread gets its share of the maximum cache size
+  size_t max_cache_size = (size_t)(table()->_size * _max_cache_factor) / StringDeduplicationThreads;
+  _entry_cache->trim(worker_id, max_cache_size);
+}
+
+void StringDedupTable::print_statistics(outputStream* st) {
+  StringDedupTable* source = _resize_source;
+  size_t source_size = (source != NULL) ? source->_size : 0;
+  st->print_cr(
+    "   [Table]\n"
+    "      [Memory Usage: "STRDEDUP_BYTES_FORMAT_NS"]\n"
+    "      [Size: "SIZE_FORMAT", Min: "SIZE_FORMAT", Max: "SIZE_FORMAT", Resizing From: "SIZE_FORMAT"]\n"
+    "      [Entries: "UINTX_FORMAT", Load: "STRDEDUP_PERCENT_FORMAT_NS", Cached: " UINTX_FORMAT ", Added: "UINTX_FORMAT", Removed: "UINTX_FORMAT"]\n"
+    "      [Resize Count: "UINTX_FORMAT", Shrink Threshold: "UINTX_FORMAT"("STRDEDUP_PERCENT_FORMAT_NS"), Grow Threshold: "UINTX_FORMAT"("STRDEDUP_PERCENT_FORMAT_NS")]\n"
+    "      [Rehash Count: "UINTX_FORMAT", Rehash Threshold: "UINTX_FORMAT", Hash Seed: 0x%x]\n"
+    "      [Age Threshold: "UINTX_FORMAT"]",
+    STRDEDUP_BYTES_PARAM((_table->_size + source_size) * sizeof(StringDedupEntry*) + (_entries + _entry_cache->size()) * sizeof(StringDedupEntry)),
+    _table->_size, _min_size, _max_size, source_size,
+    _entries, (double)_entries / (double)_table->_size * 100.0, _entry_cache->size(), _entries_added, _entries_removed,
+    _resize_count, _table->_shrink_threshold, _shrink_load_factor * 100.0, _table->_grow_threshold, _grow_load_factor * 100.0,
+    _rehash_count, _rehash_threshold, _table->_hash_seed,
+    StringDeduplicationAgeThreshold);
+}
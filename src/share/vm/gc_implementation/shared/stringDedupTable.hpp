@@ -22,41 +22,41 @@
  *
  */
 
-#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPTABLE_HPP
-#define SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPTABLE_HPP
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTABLE_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTABLE_HPP
 
-#include "gc_implementation/g1/g1StringDedupStat.hpp"
+#include "gc_implementation/shared/stringDedupStat.hpp"
 #include "runtime/mutexLocker.hpp"
 
-class G1StringDedupEntryCache;
+class StringDedupEntryCache;
 
 //
 // Table entry in the deduplication hashtable. Points weakly to the
 // character array. Can be chained in a linked list in case of hash
 // collisions or when placed in a freelist in the entry cache.
 //
-class G1StringDedupEntry : public CHeapObj<mtGC> {
+class StringDedupEntry : public CHeapObj<mtGC> {
 private:
-  G1StringDedupEntry* _next;
+  StringDedupEntry* _next;
   unsigned int      _hash;
   typeArrayOop      _obj;
 
 public:
-  G1StringDedupEntry() :
+  StringDedupEntry() :
     _next(NULL),
     _hash(0),
     _obj(NULL) {
   }
 
-  G1StringDedupEntry* next() {
+  StringDedupEntry* next() {
     return _next;
   }
 
-  G1StringDedupEntry** next_addr() {
+  StringDedupEntry** next_addr() {
     return &_next;
   }
 
-  void set_next(G1StringDedupEntry* next) {
+  void set_next(StringDedupEntry* next) {
     _next = next;
   }
 
@@ -90,28 +90,53 @@ public:
 // The table is dynamically resized to accommodate the current number of table entries.
 // The table has hash buckets with chains for hash collision. If the average chain
 // length goes above or below given thresholds the table grows or shrinks accordingly.
+// Resizing is done incrementally by the deduplication threads: a new table is installed
+// as the currently active table and the deduplication threads move the buckets of the
+// previous table over in chunks, in between deduplicating strings. Until all buckets
+// are moved, lookups search both tables. The previous table is deleted at the next
+// safepoint after it has been emptied.
 //
 // The table is also dynamically rehashed (using a new hash seed) if it becomes severely
-// unbalanced, i.e., a hash chain is significantly longer than average.
+// unbalanced, i.e., a hash chain is significantly longer than average. Rehashing is
+// done by the GC workers during a safepoint, never while the table is being resized.
 //
-// All access to the table is protected by the StringDedupTable_lock, except under
-// safepoints in which case GC workers are allowed to access a table partitions they
-// have claimed without first acquiring the lock. Note however, that this applies only
-// the table partition (i.e. a range of elements in _buckets), not other parts of the
-// table such as the _entries field, statistics counters, etc.
+// Access to the hash buckets is protected by a set of striped locks, the lock of a
+// bucket being selected by the low bits of its index. Table sizes are powers of two
+// not less than the number of locks, so all entries with a given hash code are under
+// the same lock in both the previous and the currently active table during a resize.
+// Under safepoints GC workers are allowed to access the table partitions they have
+// claimed without first acquiring the locks. The _entries counter and the statistics
+// counters are updated atomically. The StringDedupTable_lock serializes the start
+// of a resize.
 //
-class G1StringDedupTable : public CHeapObj<mtGC> {
+class StringDedupTable : public CHeapObj<mtGC> {
 private:
   // The currently active hashtable instance. Only modified when
   // the table is resizes or rehashed.
-  static G1StringDedupTable*      _table;
+  static StringDedupTable* volatile _table;
+
+  // The previously active hashtable instance while its entries are
+  // moved into _table, otherwise NULL.
+  static StringDedupTable*      _resize_source;
+
+  // The next bucket of _resize_source to be claimed for moving.
+  static volatile size_t          _resize_next_bucket;
+
+  // Set at safepoints to force a resize with StringDeduplicationResizeALot.
+  static bool                     _resize_forced;
+
+  // Number of entries in the table, including the entries
+  // still in _resize_source.
+  static volatile uintx           _entries;
+
+  // The striped bucket locks.
+  static Mutex**                  _locks;
 
   // Cache for reuse and fast alloc/free of table entries.
-  static G1StringDedupEntryCache* _entry_cache;
+  static StringDedupEntryCache* _entry_cache;
 
-  G1StringDedupEntry**            _buckets;
+  StringDedupEntry**            _buckets;
   size_t                          _size;
-  uintx                           _entries;
   uintx                           _shrink_threshold;
   uintx                           _grow_threshold;
   bool                            _rehash_needed;
@@ -130,6 +155,8 @@ private:
   static const uintx              _rehash_multiple;
   static const uintx              _rehash_threshold;
   static const double             _max_cache_factor;
+  static const size_t             _lock_count;
+  static const size_t             _resize_chunk_size;
 
   // Table statistics, only used for logging.
   static uintx                    _entries_added;
@@ -137,11 +164,11 @@ private:
   static uintx                    _resize_count;
   static uintx                    _rehash_count;
 
-  G1StringDedupTable(size_t size, jint hash_seed = 0);
-  ~G1StringDedupTable();
+  StringDedupTable(size_t size, jint hash_seed = 0);
+  ~StringDedupTable();
 
   // Returns the hash bucket at the given index.
-  G1StringDedupEntry** bucket(size_t index) {
+  StringDedupEntry** bucket(size_t index) {
     return _buckets + index;
   }
 
@@ -150,38 +177,46 @@ private:
     return (size_t)hash & (_size - 1);
   }
 
+  // Returns the lock protecting the hash buckets for the given hash
+  // code or bucket index, in any table.
+  static Mutex* lock_for(size_t hash_or_index) {
+    return _locks[hash_or_index & (_lock_count - 1)];
+  }
+
+  // Returns the currently active table.
+  static StringDedupTable* table();
+
   // Adds a new table entry to the given hash bucket.
-  void add(typeArrayOop value, unsigned int hash, G1StringDedupEntry** list);
+  void add(typeArrayOop value, unsigned int hash, StringDedupEntry** list, uint worker_id);
 
   // Removes the given table entry from the table.
-  void remove(G1StringDedupEntry** pentry, uint worker_id);
+  void remove(StringDedupEntry** pentry, uint worker_id);
 
   // Transfers a table entry from the current table to the destination table.
-  void transfer(G1StringDedupEntry** pentry, G1StringDedupTable* dest);
+  void transfer(StringDedupEntry** pentry, StringDedupTable* dest);
 
   // Returns an existing character array in the given hash bucket, or NULL
   // if no matching character array exists.
   typeArrayOop lookup(typeArrayOop value, unsigned int hash,
-                      G1StringDedupEntry** list, uintx &count);
+                      StringDedupEntry** list, uintx &count);
 
   // Returns an existing character array in the table, or inserts a new
   // table entry if no matching character array exists.
-  typeArrayOop lookup_or_add_inner(typeArrayOop value, unsigned int hash);
+  typeArrayOop lookup_or_add_inner(typeArrayOop value, unsigned int hash, uint worker_id);
 
   // Thread safe lookup or add of table entry
-  static typeArrayOop lookup_or_add(typeArrayOop value, unsigned int hash) {
-    // Protect the table from concurrent access. Also note that this lock
-    // acts as a fence for _table, which could have been replaced by a new
-    // instance if the table was resized or rehashed.
-    MutexLockerEx ml(StringDedupTable_lock, Mutex::_no_safepoint_check_flag);
-    return _table->lookup_or_add_inner(value, hash);
-  }
+  static typeArrayOop lookup_or_add(typeArrayOop value, unsigned int hash, uint worker_id);
 
   // Returns true if the hashtable is currently using a Java compatible
   // hash function.
-  static bool use_java_hash() {
-    return _table->_hash_seed == 0;
-  }
+  static bool use_java_hash();
+
+  // Returns true if the table should grow or shrink.
+  static bool is_resize_needed();
+
+  // Installs a newly allocated table of the proper size as the currently
+  // active table, if a resize is still needed.
+  static void start_resize();
 
   static bool equals(typeArrayOop value1, typeArrayOop value2);
 
@@ -189,42 +224,50 @@ private:
   // currently active hash function and hash seed.
   static unsigned int hash_code(typeArrayOop value);
 
-  static uintx unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl,
+  static uintx unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl,
+                                 StringDedupTable* table,
                                  size_t partition_begin,
                                  size_t partition_end,
                                  uint worker_id);
 
+  static void verify(StringDedupTable* table);
+
 public:
+  // Worker id of threads other than the deduplication threads.
+  static const uint               no_worker_id;
+
   static void create();
 
   // Deduplicates the given String object, or adds its backing
-  // character array to the deduplication hashtable.
-  static void deduplicate(oop java_string, G1StringDedupStat& stat);
+  // character array to the deduplication hashtable. The worker_id
+  // is the id of the calling deduplication thread, or no_worker_id.
+  static void deduplicate(oop java_string, StringDedupStat& stat, uint worker_id);
 
-  // If a table resize is needed, returns a newly allocated empty
-  // hashtable of the proper size.
-  static G1StringDedupTable* prepare_resize();
+  // Starts a resize if needed and moves the next chunk of buckets
+  // of an ongoing resize. Returns false if there was nothing to move.
+  static bool resize_step();
 
-  // Installs a newly resized table as the currently active table
-  // and deletes the previously active table.
-  static void finish_resize(G1StringDedupTable* resized_table);
+  // At a safepoint, deletes the previously active table if all
+  // of its entries have been moved.
+  static void finish_resize();
 
   // If a table rehash is needed, returns a newly allocated empty
   // hashtable and updates the hash seed.
-  static G1StringDedupTable* prepare_rehash();
+  static StringDedupTable* prepare_rehash();
 
   // Transfers rehashed entries from the currently active table into
   // the new table. Installs the new table as the currently active table
   // and deletes the previously active table.
-  static void finish_rehash(G1StringDedupTable* rehashed_table);
+  static void finish_rehash(StringDedupTable* rehashed_table);
 
-  // If the table entry cache has grown too large, trim it down according to policy
-  static void trim_entry_cache();
+  // If the part of the table entry cache used by the given deduplication
+  // thread has grown too large, trim it down according to policy
+  static void trim_entry_cache(uint worker_id);
 
-  static void unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id);
+  static void unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id);
 
   static void print_statistics(outputStream* st);
   static void verify();
 };
 
-#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPTABLE_HPP
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTABLE_HPP
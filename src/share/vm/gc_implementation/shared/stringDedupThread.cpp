@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#include "precompiled.hpp"
+#include "gc_implementation/g1/g1Log.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
+#include "gc_implementation/shared/stringDedupThread.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
+
+StringDedupThread** StringDedupThread::_threads = NULL;
+uint                  StringDedupThread::_n_threads = 0;
+uint                  StringDedupThread::_n_active = 0;
+StringDedupStat     StringDedupThread::_last_stat;
+StringDedupStat     StringDedupThread::_total_stat;
+
+StringDedupThread::StringDedupThread(uint worker_id) :
+  ConcurrentGCThread(),
+  _worker_id(worker_id) {
+  set_name("String Deduplication Thread#%u", worker_id);
+  create_and_start();
+}
+
+StringDedupThread::~StringDedupThread() {
+  ShouldNotReachHere();
+}
+
+void StringDedupThread::create() {
+  assert(StringDedup::is_enabled(), "String deduplication not enabled");
+  assert(_threads == NULL, "One set of string deduplication threads allowed");
+  _n_threads = (uint)StringDeduplicationThreads;
+  _threads = NEW_C_HEAP_ARRAY(StringDedupThread*, _n_threads, mtGC);
+  for (uint i = 0; i < _n_threads; i++) {
+    _threads[i] = new StringDedupThread(i);
+  }
+}
+
+StringDedupThread* StringDedupThread::thread(uint worker_id) {
+  assert(StringDedup::is_enabled(), "String deduplication not enabled");
+  assert(_threads != NULL, "String deduplication threads not created");
+  assert(worker_id < _n_threads, "Invalid worker id");
+  return _threads[worker_id];
+}
+
+void StringDedupThread::print_on(outputStream* st) const {
+  st->print("\"%s\" ", name());
+  Thread::print_on(st);
+  st->cr();
+}
+
+void StringDedupThread::run() {
+  initialize_in_thread();
+  wait_for_universe_init();
+
+  // Main loop
+  for (;;) {
+    StringDedupStat stat;
+
+    stat.mark_idle();
+
+    // Wait for the queue to become non-empty
+    StringDedupQueue::wait();
+    if (_should_terminate) {
+      break;
+    }
+
+    {
+      // Include thread in safepoints
+      SuspendibleThreadSetJoiner sts;
+
+      mark_active();
+      stat.mark_exec();
+
+      // Process the queue
+      for (;;) {
+        oop java_string = StringDedupQueue::pop(_worker_id);
+        if (java_string == NULL) {
+          break;
+        }
+
+        StringDedupTable::deduplicate(java_string, stat, _worker_id);
+
+        // Move a chunk of the table if it is being resized
+        StringDedupTable::resize_step();
+
+        // Safepoint this thread if needed
+        if (sts.should_yield()) {
+          stat.mark_block();
+          sts.yield();
+          stat.mark_unblock();
+        }
+      }
+
+      // Help to finish an ongoing resize before going idle
+      while (StringDedupTable::resize_step()) {
+        if (sts.should_yield()) {
+          stat.mark_block();
+          sts.yield();
+          stat.mark_unblock();
+        }
+      }
+
+      StringDedupTable::trim_entry_cache(_worker_id);
+
+      stat.mark_done();
+
+      mark_inactive(stat);
+    }
+  }
+
+  terminate();
+}
+
+void StringDedupThread::mark_active() {
+  MutexLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
+  _n_active++;
+}
+
+void StringDedupThread::mark_inactive(const StringDedupStat& stat) {
+  StringDedupStat last_stat;
+  StringDedupStat total_stat;
+  bool last_active = false;
+
+  {
+    MutexLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
+    assert(_n_active > 0, "Thread not active");
+    _last_stat.add(stat);
+    if (--_n_active == 0) {
+      _total_stat.add(_last_stat);
+      last_stat = _last_stat;
+      total_stat = _total_stat;
+      _last_stat = StringDedupStat();
+      last_active = true;
+    }
+  }
+
+  if (last_active) {
+    // Print statistics
+    print(gclog_or_tty, last_stat, total_stat);
+  }
+}
+
+void StringDedupThread::stop() {
+  {
+    MonitorLockerEx ml(Terminator_lock);
+    for (uint i = 0; i < _n_threads; i++) {
+      _threads[i]->_should_terminate = true;
+    }
+  }
+
+  StringDedupQueue::cancel_wait();
+
+  {
+    MonitorLockerEx ml(Terminator_lock);
+    for (uint i = 0; i < _n_threads; i++) {
+      while (!_threads[i]->_has_terminated) {
+        ml.wait();
+      }
+    }
+  }
+}
+
+void StringDedupThread::print(outputStream* st, const StringDedupStat& last_stat, const StringDedupStat& total_stat) {
+  if ((UseG1GC ? G1Log::fine() : PrintGCDetails) || PrintStringDeduplicationStatistics) {
+    StringDedupStat::print_summary(st, last_stat, total_stat);
+    if (PrintStringDeduplicationStatistics) {
+      StringDedupStat::print_statistics(st, last_stat, false);
+      StringDedupStat::print_statistics(st, total_stat, true);
+      StringDedupTable::print_statistics(st);
+      StringDedupQueue::print_statistics(st);
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ *
+ */
+
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTHREAD_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTHREAD_HPP
+
+#include "gc_implementation/shared/stringDedupStat.hpp"
+#include "gc_implementation/shared/concurrentGCThread.hpp"
+
+//
+// The deduplication threads are where the actual deduplication occurs. They wait for
+// deduplication candidates to appear on the deduplication queue, remove them from
+// the queue and try to deduplicate them. They use the deduplication hashtable to
+// find identical, already existing, character arrays on the heap, and move the
+// entries of the table while it is being resized. The threads run concurrently with
+// the Java application but participate in safepoints to allow the GC to adjust and
+// unlink oops from the deduplication queue and table.
+//
+// The statistics of the threads are added up. They are printed by the last thread
+// to run out of work.
+//
+class StringDedupThread: public ConcurrentGCThread {
+private:
+  static StringDedupThread** _threads;
+  static uint                  _n_threads;
+
+  // Number of threads processing the queue, and the statistics of
+  // the threads since it was last zero, protected by the
+  // StringDedupQueue_lock.
+  static uint                  _n_active;
+  static StringDedupStat     _last_stat;
+  static StringDedupStat     _total_stat;
+
+  uint _worker_id;
+
+  StringDedupThread(uint worker_id);
+  ~StringDedupThread();
+
+  static void mark_active();
+  void mark_inactive(const StringDedupStat& stat);
+
+  void print(outputStream* st, const StringDedupStat& last_stat, const StringDedupStat& total_stat);
+
+public:
+  static void create();
+  static void stop();
+
+  static uint n_threads() {
+    return _n_threads;
+  }
+
+  static StringDedupThread* thread(uint worker_id);
+
+  virtual void run();
+  virtual void print_on(outputStream* st) const;
+};
+
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTHREAD_HPP
@@ -603,6 +603,13 @@ class CollectedHeap : public CHeapObj<mtInternal> {
   virtual void register_nmethod(nmethod* nm);
   virtual void unregister_nmethod(nmethod* nm);
 
+  // Pinning an object keeps it in place without blocking collections.
+  // Heaps that support it pin the objects of JNI critical sections
+  // instead of locking out GC with the GC_locker.
+  virtual bool supports_object_pinning() const { return false; }
+  virtual void pin_object(JavaThread* thread, oop obj);
+  virtual void unpin_object(JavaThread* thread, oop obj);
+
   void trace_heap_before_gc(GCTracer* gc_tracer);
   void trace_heap_after_gc(GCTracer* gc_tracer);
 
@@ -50,8 +50,10 @@
 #include "runtime/interfaceSupport.hpp"
 #include "runtime/java.hpp"
 #include "runtime/jfieldIDWorkaround.hpp"
+#include "runtime/lazyBacktrace.hpp"
 #include "runtime/osThread.hpp"
 #include "runtime/recoveryOracle.hpp"
+#include "runtime/recoveryWriteBack.hpp"
 #include "runtime/runtimeRecoveryState.hpp"
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/stubRoutines.hpp"
@@ -933,6 +935,8 @@ IRT_ENTRY(address, InterpreterRuntime::exception_handler_for_exception(JavaThrea
   address continuation = NULL;
 #endif
   address handler_pc = NULL;
+  // A deferred stack trace is built before its constructing frame is left.
+  LazyBacktrace::dispatched(thread);
   if (handler_bci < 0 || !thread->reguard_stack((address) &continuation)) {
     // Forward exception to callee (leaving bci/bcp untouched) because (a) no
     // handler in this method, or (b) after a stack overflow there is not yet
@@ -946,6 +950,9 @@ IRT_ENTRY(address, InterpreterRuntime::exception_handler_for_exception(JavaThrea
     // Count this for compilation purposes
     h_method->interpreter_throwout_increment(THREAD);
   } else {
+    if (RecoveryWriteBack::is_enabled()) {
+      RecoveryWriteBack::dispatched(thread, h_method(), current_bci, handler_bci);
+    }
     // handler in this method => change bci/bcp to handler bci/bcp and continue there
     handler_pc = h_method->code_base() + handler_bci;
 #ifndef CC_INTERP
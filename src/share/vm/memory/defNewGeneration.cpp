@@ -46,6 +46,10 @@
 #include "runtime/thread.inline.hpp"
 #include "utilities/copy.hpp"
 #include "utilities/stack.inline.hpp"
+#include "utilities/macros.hpp"
+#if INCLUDE_ALL_GCS
+#include "gc_implementation/shared/stringDedup.hpp"
+#endif // INCLUDE_ALL_GCS
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
@@ -646,6 +650,12 @@ void DefNewGeneration::collect(bool   full,
                                     NULL, _gc_timer, gc_tracer.gc_id());
   gc_tracer.report_gc_reference_stats(stats);
 
+#if INCLUDE_ALL_GCS
+  if (StringDedup::is_enabled()) {
+    StringDedup::unlink_or_oops_do(&is_alive, &keep_alive);
+  }
+#endif // INCLUDE_ALL_GCS
+
   if (!_promotion_failed) {
     // Swap the survivor spaces.
     eden()->clear(SpaceDecorator::Mangle);
@@ -815,6 +825,15 @@ oop DefNewGeneration::copy_to_survivor_space(oop old) {
   // Done, insert forward pointer to obj in this header
   old->forward_to(obj);
 
+#if INCLUDE_ALL_GCS
+  if (StringDedup::is_enabled()) {
+    StringDedup::enqueue_from_evacuation(true,                // from_young
+                                         is_in_reserved(obj), // to_young
+                                         0,                   // worker_id
+                                         obj);
+  }
+#endif // INCLUDE_ALL_GCS
+
   return obj;
 }
 
@@ -37,6 +37,10 @@
 #include "runtime/os.hpp"
 #include "services/memTracker.hpp"
 #include "utilities/defaultStream.hpp"
+#include "utilities/macros.hpp"
+#if INCLUDE_ALL_GCS
+#include "gc_implementation/g1/g1CollectedHeap.hpp"
+#endif // INCLUDE_ALL_GCS
 
 # include <sys/stat.h>
 # include <errno.h>
@@ -164,6 +168,10 @@ void FileMapInfo::FileMapHeader::populate(FileMapInfo* mapinfo, size_t alignment
   _version = _current_version;
   _alignment = alignment;
   _obj_alignment = ObjectAlignmentInBytes;
+  _narrow_oop_base = Universe::narrow_oop_base();
+  _narrow_oop_shift = Universe::narrow_oop_shift();
+  _narrow_klass_base = Universe::narrow_klass_base();
+  _narrow_klass_shift = Universe::narrow_klass_shift();
   _classpath_entry_table_size = mapinfo->_classpath_entry_table_size;
   _classpath_entry_table = mapinfo->_classpath_entry_table;
   _classpath_entry_size = mapinfo->_classpath_entry_size;
@@ -331,7 +339,7 @@ bool FileMapInfo::init_from_file(int fd) {
 
   size_t len = lseek(fd, 0, SEEK_END);
   struct FileMapInfo::FileMapHeader::space_info* si =
-    &_header->_space[MetaspaceShared::mc];
+    &_header->_space[MetaspaceShared::rm];
   if (si->_file_offset >= len || len - si->_file_offset < si->_used) {
     fail_continue("The shared archive file has been truncated.");
     return false;
@@ -442,6 +450,16 @@ void FileMapInfo::write_region(int region, char* base, size_t size,
 }
 
 
+// Dump a region which does not depend on the address it is mapped at.
+// There is no required address, so the base is not recorded.
+
+void FileMapInfo::write_relocatable_region(int region, char* base, size_t size) {
+  align_file_position();
+  write_region(region, base, size, size, true, false);
+  _header->_space[region]._base = NULL;
+}
+
+
 // Dump bytes to file -- at the current file position.
 
 void FileMapInfo::write_bytes(const void* buffer, int nbytes) {
@@ -552,7 +570,8 @@ ReservedSpace FileMapInfo::reserve_shared_memory() {
 }
 
 // Memory map a region in the address space.
-static const char* shared_region_name[] = { "ReadOnly", "ReadWrite", "MiscData", "MiscCode"};
+static const char* shared_region_name[] = { "ReadOnly", "ReadWrite", "MiscData", "MiscCode",
+                                            "RecoveryMetadata", "String"};
 
 char* FileMapInfo::map_region(int i) {
   struct FileMapInfo::FileMapHeader::space_info* si = &_header->_space[i];
@@ -577,6 +596,70 @@ char* FileMapInfo::map_region(int i) {
   return base;
 }
 
+// Memory map a relocatable region wherever the OS puts it. The region is not
+// part of the reserved shared space and is optional, failures leave the
+// base NULL without disabling sharing.
+char* FileMapInfo::map_relocatable_region(int i) {
+  struct FileMapInfo::FileMapHeader::space_info* si = &_header->_space[i];
+  size_t size = align_size_up(si->_used, os::vm_allocation_granularity());
+
+  char *base = os::map_memory(_fd, _full_path, si->_file_offset,
+                              NULL, size, true, false);
+  if (base == NULL) {
+    return NULL;
+  }
+  // Not fatal, unlike verify_region_checksum(); the caller goes on without the region.
+  if (VerifySharedSpaces && ClassLoader::crc32(0, base, (jint)si->_used) != si->_crc) {
+    os::unmap_memory(base, size);
+    return NULL;
+  }
+  MemTracker::record_virtual_memory_type((address)base, mtClassShared);
+  si->_base = base;
+  return base;
+}
+
+// Memory map the archived interned strings at the address they were
+// dumped at, into archive regions of the java heap. The region is
+// optional, if the heap or the oop and klass encodings differ from the
+// ones at dump time the strings are simply not shared.
+bool FileMapInfo::map_string_region() {
+#if INCLUDE_ALL_GCS
+  struct FileMapInfo::FileMapHeader::space_info* si = &_header->_space[MetaspaceShared::st];
+  if (si->_used == 0 ||
+      !MetaspaceShared::is_heap_object_archiving_allowed() ||
+      _header->_narrow_oop_base != Universe::narrow_oop_base() ||
+      _header->_narrow_oop_shift != Universe::narrow_oop_shift() ||
+      _header->_narrow_klass_base != Universe::narrow_klass_base() ||
+      _header->_narrow_klass_shift != Universe::narrow_klass_shift()) {
+    return false;
+  }
+
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  MemRegion range((HeapWord*)si->_base, si->_used / HeapWordSize);
+  if (!g1h->check_archive_addresses(range) ||
+      !g1h->alloc_archive_regions(range)) {
+    if (PrintSharedSpaces) {
+      tty->print_cr("Unable to allocate the shared string space at required address.");
+    }
+    return false;
+  }
+
+  // Map over the committed archive regions.
+  char* base = os::map_memory(_fd, _full_path, si->_file_offset,
+                              si->_base, si->_used, false, false);
+  if (base == NULL || base != si->_base ||
+      (VerifySharedSpaces && ClassLoader::crc32(0, base, (jint)si->_used) != si->_crc)) {
+    // The archive regions are already allocated and can not be handed
+    // back to the heap.
+    fail_stop("Unable to map String shared space at required address.");
+  }
+  g1h->fill_archive_regions(range);
+  return true;
+#else
+  return false;
+#endif // INCLUDE_ALL_GCS
+}
+
 bool FileMapInfo::verify_region_checksum(int i) {
   if (!VerifySharedSpaces) {
     return true;
@@ -725,6 +808,10 @@ bool FileMapInfo::validate_header() {
 // True if the p is within the mapped shared space, otherwise, false.
 bool FileMapInfo::is_in_shared_space(const void* p) {
   for (int i = 0; i < MetaspaceShared::n_regions; i++) {
+    if (i == MetaspaceShared::st) {
+      // The string space is part of the java heap.
+      continue;
+    }
     if (p >= _header->_space[i]._base &&
         p < _header->_space[i]._base + _header->_space[i]._used) {
       return true;
@@ -750,7 +837,8 @@ void FileMapInfo::stop_sharing_and_unmap(const char* msg) {
   if (map_info) {
     map_info->fail_continue(msg);
     for (int i = 0; i < MetaspaceShared::n_regions; i++) {
-      if (map_info->_header->_space[i]._base != NULL) {
+      // The string space stays mapped in the archive regions of the heap.
+      if (i != MetaspaceShared::st && map_info->_header->_space[i]._base != NULL) {
         map_info->unmap_region(i);
         map_info->_header->_space[i]._base = NULL;
       }
@@ -56,7 +56,7 @@ private:
   friend class ManifestStream;
   enum {
     _invalid_version = -1,
-    _current_version = 2
+    _current_version = 4
   };
 
   bool  _file_open;
@@ -91,6 +91,10 @@ public:
     int    _version;                  // (from enum, above.)
     size_t _alignment;                // how shared archive should be aligned
     int    _obj_alignment;            // value of ObjectAlignmentInBytes
+    address _narrow_oop_base;         // compressed oop encoding of the
+    int    _narrow_oop_shift;         //   archived java heap objects
+    address _narrow_klass_base;       // compressed klass encoding of the
+    int    _narrow_klass_shift;       //   archived java heap objects
 
     struct space_info {
       int    _crc;           // crc checksum of the current space
@@ -164,6 +168,7 @@ public:
   int    version()                    { return _header->_version; }
   size_t alignment()                  { return _header->_alignment; }
   size_t space_capacity(int i)        { return _header->_space[i]._capacity; }
+  size_t space_used(int i)            { return _header->_space[i]._used; }
   char*  region_base(int i)           { return _header->_space[i]._base; }
   struct FileMapHeader* header()      { return _header; }
 
@@ -182,9 +187,12 @@ public:
   void  write_space(int i, Metaspace* space, bool read_only);
   void  write_region(int region, char* base, size_t size,
                      size_t capacity, bool read_only, bool allow_exec);
+  void  write_relocatable_region(int region, char* base, size_t size);
   void  write_bytes(const void* buffer, int count);
   void  write_bytes_aligned(const void* buffer, int count);
   char* map_region(int i);
+  char* map_relocatable_region(int i);
+  bool  map_string_region() NOT_CDS_RETURN_(false);
   void  unmap_region(int i);
   bool  verify_region_checksum(int i);
   void  close();
@@ -58,6 +58,7 @@
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/concurrentMarkSweep/concurrentMarkSweepThread.hpp"
 #include "gc_implementation/concurrentMarkSweep/vmCMSOperations.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif // INCLUDE_ALL_GCS
 
 GenCollectedHeap* GenCollectedHeap::_gch;
@@ -157,12 +158,21 @@ jint GenCollectedHeap::initialize() {
   if (collector_policy()->is_concurrent_mark_sweep_policy()) {
     bool success = create_cms_collector();
     if (!success) return JNI_ENOMEM;
+    StringDedup::initialize();
   }
 #endif // INCLUDE_ALL_GCS
 
   return JNI_OK;
 }
 
+void GenCollectedHeap::stop() {
+#if INCLUDE_ALL_GCS
+  if (StringDedup::is_enabled()) {
+    StringDedup::stop();
+  }
+#endif // INCLUDE_ALL_GCS
+}
+
 
 char* GenCollectedHeap::allocate(size_t alignment,
                                  size_t* _total_reserved,
@@ -1226,6 +1236,9 @@ void GenCollectedHeap::gc_threads_do(ThreadClosure* tc) const {
   if (UseConcMarkSweepGC) {
     ConcurrentMarkSweepThread::threads_do(tc);
   }
+  if (StringDedup::is_enabled()) {
+    StringDedup::threads_do(tc);
+  }
 #endif // INCLUDE_ALL_GCS
 }
 
@@ -1237,6 +1250,9 @@ void GenCollectedHeap::print_gc_threads_on(outputStream* st) const {
   if (UseConcMarkSweepGC) {
     ConcurrentMarkSweepThread::print_all_on(st);
   }
+  if (StringDedup::is_enabled()) {
+    StringDedup::print_worker_threads_on(st);
+  }
 #endif // INCLUDE_ALL_GCS
 }
 
@@ -37,6 +37,7 @@
 #include "memory/metaspaceShared.hpp"
 #include "oops/objArrayOop.hpp"
 #include "oops/oop.inline.hpp"
+#include "runtime/recoveryMetadata.hpp"
 #include "runtime/signature.hpp"
 #include "runtime/vm_operations.hpp"
 #include "runtime/vmThread.hpp"
@@ -403,11 +404,14 @@ private:
   GrowableArray<Klass*> *_class_promote_order;
   VirtualSpace _md_vs;
   VirtualSpace _mc_vs;
+  address _rm_base;
+  size_t  _rm_size;
 
 public:
   VM_PopulateDumpSharedSpace(ClassLoaderData* loader_data,
-                             GrowableArray<Klass*> *class_promote_order) :
-    _loader_data(loader_data) {
+                             GrowableArray<Klass*> *class_promote_order,
+                             address rm_base, size_t rm_size) :
+    _loader_data(loader_data), _rm_base(rm_base), _rm_size(rm_size) {
 
     // Split up and initialize the misc code and data spaces
     ReservedSpace* shared_rs = MetaspaceShared::shared_rs();
@@ -513,6 +517,10 @@ void VM_PopulateDumpSharedSpace::doit() {
 
   NOT_PRODUCT(SystemDictionary::verify();)
 
+  // Archive the interned strings into the java heap if possible, so that
+  // their table can be shared like the symbol table.
+  MemRegion string_space = StringTable::archive_strings();
+
   // Copy the the symbol table, and the system dictionary to the shared
   // space in usable form.  Copy the hastable
   // buckets first [read-write], then copy the linked lists of entries
@@ -529,12 +537,29 @@ void VM_PopulateDumpSharedSpace::doit() {
   ClassLoader::copy_package_info_buckets(&md_top, md_end);
   ClassLoader::verify();
 
+  // An empty string table is recorded if the strings were not archived.
+  if (!string_space.is_empty()) {
+    StringTable::copy_buckets(&md_top, md_end);
+  } else {
+    *(intptr_t*)md_top = 0;
+    md_top += sizeof(intptr_t);
+    *(intptr_t*)md_top = 0;
+    md_top += sizeof(intptr_t);
+  }
+
   SymbolTable::copy_table(&md_top, md_end);
   SystemDictionary::copy_table(&md_top, md_end);
   ClassLoader::verify();
   ClassLoader::copy_package_info_table(&md_top, md_end);
   ClassLoader::verify();
 
+  if (!string_space.is_empty()) {
+    StringTable::copy_table(&md_top, md_end);
+  } else {
+    *(intptr_t*)md_top = 0;
+    md_top += sizeof(intptr_t);
+  }
+
   ClassLoaderExt::copy_lookup_cache_to_archive(&md_top, md_end);
 
   // Write the other data to the output array.
@@ -579,6 +604,10 @@ void VM_PopulateDumpSharedSpace::doit() {
   tty->print_cr(fmt_space, "rw", rw_bytes, rw_t_perc, rw_alloced, rw_u_perc, rw_space->bottom());
   tty->print_cr(fmt_space, "md", md_bytes, md_t_perc, md_alloced, md_u_perc, md_low);
   tty->print_cr(fmt_space, "mc", mc_bytes, mc_t_perc, mc_alloced, mc_u_perc, mc_low);
+  tty->print_cr("rm space: %9d bytes of recovery metadata for %d methods",
+                _rm_size, ((RecoveryMetadataHeader*)_rm_base)->_method_count);
+  tty->print_cr("st space: %9d bytes of interned strings at " PTR_FORMAT,
+                string_space.byte_size(), string_space.start());
   tty->print_cr("total   : %9d [100.0%% of total] out of %9d bytes [%4.1f%% used]",
                  total_bytes, total_alloced, total_u_perc);
 
@@ -608,6 +637,10 @@ void VM_PopulateDumpSharedSpace::doit() {
                         pointer_delta(mc_top, _mc_vs.low(), sizeof(char)),
                         SharedMiscCodeSize,
                         true, true);
+  mapinfo->write_region(MetaspaceShared::st, (char*)string_space.start(),
+                        string_space.byte_size(), string_space.byte_size(),
+                        false, false);
+  mapinfo->write_relocatable_region(MetaspaceShared::rm, (char*)_rm_base, _rm_size);
 
   // Pass 2 - write data.
   mapinfo->open_for_write();
@@ -623,6 +656,10 @@ void VM_PopulateDumpSharedSpace::doit() {
                         pointer_delta(mc_top, _mc_vs.low(), sizeof(char)),
                         SharedMiscCodeSize,
                         true, true);
+  mapinfo->write_region(MetaspaceShared::st, (char*)string_space.start(),
+                        string_space.byte_size(), string_space.byte_size(),
+                        false, false);
+  mapinfo->write_relocatable_region(MetaspaceShared::rm, (char*)_rm_base, _rm_size);
   mapinfo->close();
 
   memmove(vtbl_list, saved_vtbl, vtbl_list_size * sizeof(void*));
@@ -656,6 +693,18 @@ void MetaspaceShared::check_one_shared_class(Klass* k) {
   }
 }
 
+void MetaspaceShared::intern_one_shared_class_strings(Klass* k, TRAPS) {
+  if (k->oop_is_instance()) {
+    ConstantPool* cp = InstanceKlass::cast(k)->constants();
+    for (int i = 1; i < cp->length(); i++) {
+      if (cp->tag_at(i).is_string() && !cp->is_pseudo_string_at(i)) {
+        StringTable::intern(cp->unresolved_string_at(i), THREAD);
+        guarantee(!HAS_PENDING_EXCEPTION, "exception interning a string constant");
+      }
+    }
+  }
+}
+
 void MetaspaceShared::link_and_cleanup_shared_classes(TRAPS) {
   // We need to iterate because verification may cause additional classes
   // to be loaded.
@@ -765,10 +814,26 @@ void MetaspaceShared::preload_and_dump(TRAPS) {
   link_and_cleanup_shared_classes(CATCH);
   tty->print_cr("Rewriting and linking classes: done");
 
+  if (is_heap_object_archiving_allowed()) {
+    // Intern the string constants of the shared classes, so that they are
+    // archived with the string table.
+    tty->print("Interning string constants ... ");
+    SystemDictionary::classes_do(intern_one_shared_class_strings, CATCH);
+    tty->print_cr("done. ");
+  }
+
+  // The recovery metadata refers to classes and methods by name only, so it
+  // can be computed here, before the VM operation removes the unshareable
+  // information, and written as is.
+  tty->print("Computing recovery metadata ... ");
+  address rm_base = NULL;
+  size_t rm_size = RecoveryMetadata::dump_shared_classes(&rm_base, THREAD);
+  tty->print_cr("done. ");
+
   // Create and dump the shared spaces.   Everything so far is loaded
   // with the null class loader.
   ClassLoaderData* loader_data = ClassLoaderData::the_null_class_loader_data();
-  VM_PopulateDumpSharedSpace op(loader_data, class_promote_order);
+  VM_PopulateDumpSharedSpace op(loader_data, class_promote_order, rm_base, rm_size);
   VMThread::execute(&op);
 
   // Since various initialization steps have been undone by this process,
@@ -952,7 +1017,8 @@ bool MetaspaceShared::map_shared_spaces(FileMapInfo* mapinfo) {
        mapinfo->verify_region_checksum(mc) &&
       (image_alignment == (size_t)max_alignment()) &&
       mapinfo->validate_classpath_entry_table()) {
-    // Success (no need to do anything)
+    // The recovery metadata is optional, the archive is usable without it.
+    mapinfo->map_relocatable_region(rm);
     return true;
   } else {
     // If there was a failure in mapping any of the spaces, unmap the ones
@@ -1038,6 +1104,16 @@ void MetaspaceShared::initialize_shared_spaces() {
   buffer += pkgInfoLen;
   ClassLoader::verify();
 
+  // The string table buckets are only used if the archived strings can
+  // be mapped into the heap, see below.
+
+  int stringTableLen = *(intptr_t*)buffer;
+  buffer += sizeof(intptr_t);
+  int string_entries = *(intptr_t*)buffer;
+  buffer += sizeof(intptr_t);
+  HashtableBucket<mtSymbol>* string_buckets = (HashtableBucket<mtSymbol>*)buffer;
+  buffer += stringTableLen;
+
   // The following data in the shared misc data region are the linked
   // list elements (HashtableEntry objects) for the symbol table, string
   // table, and shared dictionary.  The heap objects refered to by the
@@ -1062,12 +1138,24 @@ void MetaspaceShared::initialize_shared_spaces() {
   buffer += sizeof(intptr_t);
   buffer += len;
 
+  len = *(intptr_t*)buffer;     // skip over string table entries
+  buffer += sizeof(intptr_t);
+  buffer += len;
+
   buffer = ClassLoaderExt::restore_lookup_cache_from_archive(buffer);
 
   intptr_t* array = (intptr_t*)buffer;
   ReadClosure rc(&array);
   serialize(&rc);
 
+  // Create the string table, sharing the archived one if its strings
+  // could be mapped at their dump time address in the heap.
+  if (stringTableLen > 0 && mapinfo->map_string_region()) {
+    StringTable::create_table(string_buckets, stringTableLen, string_entries);
+  } else {
+    StringTable::create_table();
+  }
+
   // Close the mapinfo file
   mapinfo->close();
 
@@ -74,7 +74,9 @@ class MetaspaceShared : AllStatic {
     rw = 1,  // read-write shared space in the heap
     md = 2,  // miscellaneous data for initializing tables, etc.
     mc = 3,  // miscellaneous code - vtable replacement.
-    n_regions = 4
+    rm = 4,  // recovery metadata, position independent, mapped anywhere.
+    st = 5,  // interned strings, mapped into archive regions of the java heap.
+    n_regions = 6
   };
 
   // Accessor functions to save shared space created for metadata, which has
@@ -103,6 +105,14 @@ class MetaspaceShared : AllStatic {
     CDS_ONLY(_shared_rs = rs;)
   }
 
+  // Interned strings are archived as java heap objects, which is only
+  // supported with G1 archive regions and compressed oops and class
+  // pointers, whose encodings are recorded in the archive.
+  static bool is_heap_object_archiving_allowed() {
+    CDS_ONLY(return (UseG1GC && UseCompressedOops && UseCompressedClassPointers);)
+    NOT_CDS(return false;)
+  }
+
   static void set_archive_loading_failed() {
     _archive_loading_failed = true;
   }
@@ -129,6 +139,7 @@ class MetaspaceShared : AllStatic {
   static bool try_link_class(InstanceKlass* ik, TRAPS);
   static void link_one_shared_class(Klass* obj, TRAPS);
   static void check_one_shared_class(Klass* obj);
+  static void intern_one_shared_class_strings(Klass* obj, TRAPS);
   static void link_and_cleanup_shared_classes(TRAPS);
 
   static int count_class(const char* classlist_file);
@@ -103,6 +103,7 @@ class SharedHeap : public CollectedHeap {
 
   friend class VM_GC_Operation;
   friend class VM_CGC_Operation;
+  friend class VM_G1PeriodicCollection;
 
 protected:
   // There should be only a single instance of "SharedHeap" in a program.
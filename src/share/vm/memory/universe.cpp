@@ -671,7 +671,6 @@ jint universe_init() {
     // the file is closed. Closing the file does not affect the
     // currently mapped regions.
     MetaspaceShared::initialize_shared_spaces();
-    StringTable::create_table();
   } else {
     SymbolTable::create_table();
     StringTable::create_table();
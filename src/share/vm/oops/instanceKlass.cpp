@@ -57,6 +57,7 @@
 #include "runtime/javaCalls.hpp"
 #include "runtime/mutexLocker.hpp"
 #include "runtime/orderAccess.inline.hpp"
+#include "runtime/recoveryPrefetch.hpp"
 #include "runtime/thread.inline.hpp"
 #include "services/classLoadingService.hpp"
 #include "services/threadService.hpp"
@@ -726,6 +727,9 @@ bool InstanceKlass::link_class_impl(
       }
 #endif
       this_oop->set_init_state(linked);
+      if (RecoveryPrefetch::is_enabled()) {
+        RecoveryPrefetch::class_linked(this_oop());
+      }
       if (JvmtiExport::should_post_class_prepare()) {
         Thread *thread = THREAD;
         assert(thread->is_Java_thread(), "thread->is_Java_thread()");
@@ -93,6 +93,7 @@ Method::Method(ConstMethod* xconst, AccessFlags access_flags, int size) {
   set_hidden(false);
   set_dont_inline(false);
   set_has_injected_profile(false);
+  set_recovery_metadata(_recovery_metadata_unknown);
   set_method_data(NULL);
   clear_method_counters();
   set_vtable_index(Method::garbage_vtable_index);
@@ -313,6 +314,8 @@ Symbol* Method::klass_name() const {
 
 void Method::remove_unshareable_info() {
   unlink_method();
+  // Looked up again against the archives of the run using the CDS archive.
+  set_recovery_metadata(_recovery_metadata_unknown);
 }
 
 
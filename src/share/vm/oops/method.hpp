@@ -116,7 +116,7 @@ class Method : public Metadata {
                     _hidden               : 1,
                     _dont_inline          : 1,
                     _has_injected_profile : 1,
-                                          : 2;
+                    _recovery_metadata    : 2;   // RecoveryMetadataState
 
 #ifndef PRODUCT
   int               _compiled_invocation_count;  // Number of nmethod invocations so far (for perf. debugging)
@@ -794,6 +794,16 @@ class Method : public Metadata {
   void set_hidden(bool x)               {        _hidden = x;               }
   bool     has_injected_profile()       { return _has_injected_profile;     }
   void set_has_injected_profile(bool x) {        _has_injected_profile = x; }
+  // Which archive holds the recovery metadata record of this method whose
+  // fingerprints match, once looked up, see recoveryMetadata.hpp
+  enum RecoveryMetadataState {
+    _recovery_metadata_unknown = 0,
+    _recovery_metadata_none    = 1,
+    _recovery_metadata_shared  = 2,
+    _recovery_metadata_file    = 3
+  };
+  RecoveryMetadataState recovery_metadata() { return (RecoveryMetadataState)_recovery_metadata; }
+  void set_recovery_metadata(RecoveryMetadataState x) { _recovery_metadata = x; }
 
   ConstMethod::MethodType method_type() const {
       return _constMethod->method_type();
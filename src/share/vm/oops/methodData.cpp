@@ -1174,6 +1174,8 @@ void MethodData::init() {
   _nof_decompiles = 0;
   _nof_overflow_recompiles = 0;
   _nof_overflow_traps = 0;
+  _nof_recoveries = 0;
+  _recovery_decay_stamp = 0;
   clear_escape_info();
   assert(sizeof(_trap_hist) % sizeof(HeapWord) == 0, "align");
   Copy::zero_to_words((HeapWord*) &_trap_hist,
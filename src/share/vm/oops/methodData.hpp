@@ -138,7 +138,10 @@ public:
     trap_mask_in_place = (trap_mask << trap_shift),
     flag_limit = trap_shift,
     flag_mask = right_n_bits(flag_limit),
-    first_flag = 0
+    first_flag = 0,
+    // Not one of the flags of a kind of data, the subclasses of ProfileData
+    // number theirs from first_flag, see ProfileData::is_recovery_site.
+    recovery_site_flag = flag_limit - 1
   };
 
   // Size computation
@@ -427,6 +430,15 @@ public:
     data()->set_trap_state(new_state);
   }
 
+  // A call site whose exceptions kept going to the recovery oracle, see
+  // RecoveryOracle::record_compiled_recovery. C2 does not inline it.
+  bool is_recovery_site() const {
+    return flag_at(DataLayout::recovery_site_flag);
+  }
+  void set_recovery_site() {
+    set_flag_at(DataLayout::recovery_site_flag);
+  }
+
   // Type checking
   virtual bool is_BitData()         const { return false; }
   virtual bool is_CounterData()     const { return false; }
@@ -2057,7 +2069,7 @@ public:
 
   // Whole-method sticky bits and flags
   enum {
-    _trap_hist_limit    = 20,   // decoupled from Deoptimization::Reason_LIMIT
+    _trap_hist_limit    = 21,   // decoupled from Deoptimization::Reason_LIMIT
     _trap_hist_mask     = max_jubyte,
     _extra_data_count   = 4     // extra DataLayout headers, for trap history
   }; // Public flag values
@@ -2065,6 +2077,8 @@ private:
   uint _nof_decompiles;             // count of all nmethod removals
   uint _nof_overflow_recompiles;    // recompile count, excluding recomp. bits
   uint _nof_overflow_traps;         // trap count, excluding _trap_hist
+  uint _nof_recoveries;             // recoveries from compiled code, decayed
+  jlong _recovery_decay_stamp;      // millis of the last decay of _nof_recoveries
   union {
     intptr_t _align;
     u1 _array[_trap_hist_limit];
@@ -2419,6 +2433,22 @@ public:
       method()->set_not_compilable(CompLevel_full_optimization, true, "decompile_count > PerMethodRecompilationCutoff");
     }
   }
+  // Exceptions compiled code of this method sent to the recovery oracle.
+  // The count is halved every RecoveryTrapDecayMillis, so that it measures
+  // a rate rather than the lifetime of the method. Updates may race.
+  uint inc_recovery_count(jlong now_millis) {
+    if (RecoveryTrapDecayMillis > 0) {
+      jlong periods = (now_millis - _recovery_decay_stamp) / RecoveryTrapDecayMillis;
+      if (periods > 0) {
+        _nof_recoveries = periods >= BitsPerInt ? 0 : _nof_recoveries >> periods;
+        _recovery_decay_stamp += periods * RecoveryTrapDecayMillis;
+      }
+    }
+    return ++_nof_recoveries;
+  }
+  void reset_recovery_count() {
+    _nof_recoveries = 0;
+  }
 
   // Return pointer to area dedicated to parameters in MDO
   ParametersTypeData* parameters_type_data() const {
@@ -257,6 +257,16 @@ bool InlineTree::should_not_inline(ciMethod *callee_method,
 
   // Now perform checks which are heuristic
 
+  // A call site whose exceptions keep going to the recovery oracle stays a
+  // call, see RecoveryOracle::record_compiled_recovery.
+  if (EnableRecovery) {
+    ciProfileData* data = caller_method->method_data()->bci_to_data(jvms->bci());
+    if (data != NULL && data->is_recovery_site()) {
+      set_msg("recovery site");
+      return true;
+    }
+  }
+
   if (is_unboxing_method(callee_method, C)) {
     // Inline unboxing methods.
     return false;
@@ -62,6 +62,7 @@
 #include "runtime/javaCalls.hpp"
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/recoveryOracle.hpp"
+#include "runtime/recoveryWriteBack.hpp"
 #include "runtime/runtimeRecoveryState.hpp"
 #include "runtime/signature.hpp"
 #include "runtime/threadCritical.hpp"
@@ -1076,6 +1077,8 @@ JRT_ENTRY_NO_ASYNC(address, OptoRuntime::handle_exception_C_helper(JavaThread* t
     if ((TraceRuntimeRecovery & TRACE_CHECKING) != 0) {
       tty->print_cr("[Ares] handle_exception_C_helper: detected an exception of interest in compiler.");
     }
+    address exception_pc = thread->exception_pc();
+    RecoveryOracle::record_compiled_recovery(thread, CodeCache::find_nmethod(exception_pc), exception_pc);
     deoptimize_caller_frame(thread);
   }
 
@@ -1159,6 +1162,9 @@ JRT_ENTRY_NO_ASYNC(address, OptoRuntime::handle_exception_C_helper(JavaThread* t
       } else {
         assert(handler_address == SharedRuntime::compute_compiled_exc_handler(nm, pc, exception, force_unwind, true), "Must be the same");
       }
+      if (!force_unwind && RecoveryWriteBack::is_enabled()) {
+        RecoveryWriteBack::compiled_dispatched(thread, nm, pc, exception, true);
+      }
     }
 
     thread->set_exception_pc(pc);
@@ -4233,12 +4233,16 @@ JNI_ENTRY(void*, jni_GetPrimitiveArrayCritical(JNIEnv *env, jarray array, jboole
  HOTSPOT_JNI_GETPRIMITIVEARRAYCRITICAL_ENTRY(
                                              env, array, (uintptr_t *) isCopy);
 #endif /* USDT2 */
-  GC_locker::lock_critical(thread);
   if (isCopy != NULL) {
     *isCopy = JNI_FALSE;
   }
   oop a = JNIHandles::resolve_non_null(array);
   assert(a->is_array(), "just checking");
+  if (Universe::heap()->supports_object_pinning()) {
+    Universe::heap()->pin_object(thread, a);
+  } else {
+    GC_locker::lock_critical(thread);
+  }
   BasicType type;
   if (a->is_objArray()) {
     type = T_OBJECT;
@@ -4264,8 +4268,13 @@ JNI_ENTRY(void, jni_ReleasePrimitiveArrayCritical(JNIEnv *env, jarray array, voi
   HOTSPOT_JNI_RELEASEPRIMITIVEARRAYCRITICAL_ENTRY(
                                                   env, array, carray, mode);
 #endif /* USDT2 */
-  // The array, carray and mode arguments are ignored
-  GC_locker::unlock_critical(thread);
+  // The carray and mode arguments are ignored
+  if (Universe::heap()->supports_object_pinning()) {
+    // The array is pinned, so it has not moved.
+    Universe::heap()->unpin_object(thread, JNIHandles::resolve_non_null(array));
+  } else {
+    GC_locker::unlock_critical(thread);
+  }
 #ifndef USDT2
   DTRACE_PROBE(hotspot_jni, ReleasePrimitiveArrayCritical__return);
 #else /* USDT2 */
@@ -4283,7 +4292,6 @@ JNI_ENTRY(const jchar*, jni_GetStringCritical(JNIEnv *env, jstring string, jbool
   HOTSPOT_JNI_GETSTRINGCRITICAL_ENTRY(
                                       env, string, (uintptr_t *) isCopy);
 #endif /* USDT2 */
-  GC_locker::lock_critical(thread);
   if (isCopy != NULL) {
     *isCopy = JNI_FALSE;
   }
@@ -4291,6 +4299,11 @@ JNI_ENTRY(const jchar*, jni_GetStringCritical(JNIEnv *env, jstring string, jbool
   int s_len = java_lang_String::length(s);
   typeArrayOop s_value = java_lang_String::value(s);
   int s_offset = java_lang_String::offset(s);
+  if (Universe::heap()->supports_object_pinning()) {
+    Universe::heap()->pin_object(thread, s_value);
+  } else {
+    GC_locker::lock_critical(thread);
+  }
   const jchar* ret;
   if (s_len > 0) {
     ret = s_value->char_at_addr(s_offset);
@@ -4315,8 +4328,18 @@ JNI_ENTRY(void, jni_ReleaseStringCritical(JNIEnv *env, jstring str, const jchar
   HOTSPOT_JNI_RELEASESTRINGCRITICAL_ENTRY(
                                           env, str, (uint16_t *) chars);
 #endif /* USDT2 */
-  // The str and chars arguments are ignored
-  GC_locker::unlock_critical(thread);
+  if (Universe::heap()->supports_object_pinning()) {
+    // Deduplication may have replaced the value of the string since, so
+    // unpin the pinned array the characters were taken from.
+    oop s = JNIHandles::resolve_non_null(str);
+    int s_offset = java_lang_String::length(s) > 0 ? java_lang_String::offset(s) : 0;
+    address s_value = (address)chars - arrayOopDesc::base_offset_in_bytes(T_CHAR) -
+                      s_offset * sizeof(jchar);
+    Universe::heap()->unpin_object(thread, oop((HeapWord*)s_value));
+  } else {
+    // The str and chars arguments are ignored
+    GC_locker::unlock_critical(thread);
+  }
 #ifndef USDT2
   DTRACE_PROBE(hotspot_jni, ReleaseStringCritical__return);
 #else /* USDT2 */
@@ -56,6 +56,7 @@
 #include "runtime/java.hpp"
 #include "runtime/javaCalls.hpp"
 #include "runtime/jfieldIDWorkaround.hpp"
+#include "runtime/lazyBacktrace.hpp"
 #include "runtime/orderAccess.inline.hpp"
 #include "runtime/os.hpp"
 #include "runtime/perfData.hpp"
@@ -516,12 +517,16 @@ JVM_END
 JVM_ENTRY(void, JVM_FillInStackTrace(JNIEnv *env, jobject receiver))
   JVMWrapper("JVM_FillInStackTrace");
   Handle exception(thread, JNIHandles::resolve_non_null(receiver));
+  if (LazyBacktrace::defer(thread, exception)) {
+    return;
+  }
   java_lang_Throwable::fill_in_stack_trace(exception);
 JVM_END
 
 
 JVM_ENTRY(jint, JVM_GetStackTraceDepth(JNIEnv *env, jobject throwable))
   JVMWrapper("JVM_GetStackTraceDepth");
+  LazyBacktrace::materialize(thread, Handle(thread, JNIHandles::resolve(throwable)));
   oop exception = JNIHandles::resolve(throwable);
   return java_lang_Throwable::get_stack_trace_depth(exception, THREAD);
 JVM_END
@@ -25,6 +25,7 @@
 #include "precompiled.hpp"
 
 #include "memory/metadataFactory.hpp"
+#include "memory/oopFactory.hpp"
 #include "memory/universe.hpp"
 #include "oops/oop.inline.hpp"
 
@@ -58,6 +59,9 @@
 #include "compiler/compileBroker.hpp"
 #include "jvmtifiles/jvmtiEnv.hpp"
 #include "runtime/compilationPolicy.hpp"
+#include "runtime/recoveryDecisionCache.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/runtimeRecoveryState.hpp"
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
@@ -915,6 +919,90 @@ WB_ENTRY(void, WB_ForceSafepoint(JNIEnv* env, jobject wb))
   VMThread::execute(&force_safepoint_op);
 WB_END
 
+// Runs the decision of the recovery oracle for exception on the stack of the
+// caller of decideRecovery, without applying it. Returns
+// { long[] decision, Class target } where decision holds the failure type,
+// recovery type, recovery context offset, early return offset, early return
+// type and the nanos spent in each RecoveryOracle::Stage.
+WB_ENTRY(jobjectArray, WB_DecideRecovery(JNIEnv* env, jobject wb, jobject exception))
+  if (exception == NULL) {
+    THROW_MSG_NULL(vmSymbols::java_lang_NullPointerException(), "exception is null");
+  }
+  RuntimeRecoveryState* rrs = thread->runtime_recovery_state();
+  if (rrs->is_in_recovery()) {
+    THROW_MSG_NULL(vmSymbols::java_lang_IllegalStateException(), "already in recovery");
+  }
+
+  Handle h_exception(thread, JNIHandles::resolve(exception));
+  jlong stage_nanos[RecoveryOracle::_stage_limit] = { 0 };
+  int failure_type;
+  int recovery_type;
+  int context_offset;
+  int early_return_offset = -1;
+  int early_return_type = T_ILLEGAL;
+  Handle target;
+  {
+    RecoveryMark recm(thread);
+    RecoveryAction action(thread, &h_exception);
+    // the top frame is decideRecovery itself, and the decision is not applied
+    RecoveryOracle::do_recover(thread, &action, 1, stage_nanos, false);
+
+    failure_type = action.failure_type();
+    recovery_type = action.recovery_type();
+    context_offset = action.recovery_context_offset();
+    if (action.can_error_transformation()) {
+      target = Handle(thread, action.target_exception_klass()->java_mirror());
+    } else if (action.can_early_return()) {
+      early_return_offset = action.early_return_offset();
+      early_return_type = action.early_return_type();
+    }
+    rrs->reset_runtime_recovery_state();
+  }
+
+  const int fixed = 5;
+  typeArrayOop decision = oopFactory::new_longArray(fixed + RecoveryOracle::_stage_limit, CHECK_NULL);
+  decision->long_at_put(0, failure_type);
+  decision->long_at_put(1, recovery_type);
+  decision->long_at_put(2, context_offset);
+  decision->long_at_put(3, early_return_offset);
+  decision->long_at_put(4, early_return_type);
+  for (int i = 0; i < RecoveryOracle::_stage_limit; i++) {
+    decision->long_at_put(fixed + i, stage_nanos[i]);
+  }
+  typeArrayHandle h_decision(thread, decision);
+
+  objArrayOop result = oopFactory::new_objArray(SystemDictionary::Object_klass(), 2, CHECK_NULL);
+  result->obj_at_put(0, h_decision());
+  result->obj_at_put(1, target());
+  return (jobjectArray) JNIHandles::make_local(env, result);
+WB_END
+
+WB_ENTRY(void, WB_ResetRecoveryDecisionCache(JNIEnv* env, jobject wb))
+  RecoveryDecisionCache::clear();
+WB_END
+
+// { entries, hits, misses } of the recovery decision cache
+WB_ENTRY(jintArray, WB_GetRecoveryDecisionCacheStatistics(JNIEnv* env, jobject wb))
+  typeArrayOop stats = oopFactory::new_intArray(3, CHECK_NULL);
+  stats->int_at_put(0, RecoveryDecisionCache::entry_count());
+  stats->int_at_put(1, RecoveryDecisionCache::hits());
+  stats->int_at_put(2, RecoveryDecisionCache::misses());
+  return (jintArray) JNIHandles::make_local(env, stats);
+WB_END
+
+// Timeouts per RecoveryOracle::Strategy
+WB_ENTRY(jintArray, WB_GetRecoveryStrategyTimeouts(JNIEnv* env, jobject wb))
+  typeArrayOop timeouts = oopFactory::new_intArray(RecoveryOracle::_strategy_limit, CHECK_NULL);
+  for (int i = 0; i < RecoveryOracle::_strategy_limit; i++) {
+    timeouts->int_at_put(i, RecoveryOracle::strategy_timeouts((RecoveryOracle::Strategy)i));
+  }
+  return (jintArray) JNIHandles::make_local(env, timeouts);
+WB_END
+
+WB_ENTRY(void, WB_ResetRecoveryStrategyTimeouts(JNIEnv* env, jobject wb))
+  RecoveryOracle::reset_strategy_timeouts();
+WB_END
+
 //Some convenience methods to deal with objects from java
 int WhiteBox::offset_for_field(const char* field_name, oop object,
     Symbol* signature_symbol) {
@@ -1105,6 +1193,12 @@ static JNINativeMethod methods[] = {
                                                       (void*)&WB_GetNMethod         },
   {CC"isMonitorInflated",  CC"(Ljava/lang/Object;)Z", (void*)&WB_IsMonitorInflated  },
   {CC"forceSafepoint",     CC"()V",                   (void*)&WB_ForceSafepoint     },
+  {CC"decideRecovery",     CC"(Ljava/lang/Throwable;)[Ljava/lang/Object;",
+                                                      (void*)&WB_DecideRecovery     },
+  {CC"resetRecoveryDecisionCache", CC"()V",           (void*)&WB_ResetRecoveryDecisionCache},
+  {CC"getRecoveryDecisionCacheStatistics", CC"()[I",  (void*)&WB_GetRecoveryDecisionCacheStatistics},
+  {CC"getRecoveryStrategyTimeouts", CC"()[I",         (void*)&WB_GetRecoveryStrategyTimeouts},
+  {CC"resetRecoveryStrategyTimeouts", CC"()V",        (void*)&WB_ResetRecoveryStrategyTimeouts},
 };
 
 #undef CC
@@ -2318,8 +2318,13 @@ bool Arguments::check_vm_args_consistency() {
                                        "G1ConcRSHotCardLimit");
     status = status && verify_interval(G1ConcRSLogCacheSize, 0, 27,
                                        "G1ConcRSLogCacheSize");
+    status = status && verify_percentage(G1OptionalCSetPercent, "G1OptionalCSetPercent");
+  }
+  if (UseStringDeduplication) {
     status = status && verify_interval(StringDeduplicationAgeThreshold, 1, markOopDesc::max_age,
                                        "StringDeduplicationAgeThreshold");
+    status = status && verify_min_value((intx)StringDeduplicationThreads, 1,
+                                        "StringDeduplicationThreads");
   }
   if (UseConcMarkSweepGC) {
     status = status && verify_min_value(CMSOldPLABNumRefills, 1, "CMSOldPLABNumRefills");
@@ -3886,8 +3886,11 @@ class CommandLineFlags {
           "Print string deduplication statistics")                          \
                                                                             \
   product(uintx, StringDeduplicationAgeThreshold, 3,                        \
-          "A string must reach this age (or be promoted to an old region) " \
-          "to be considered for deduplication")                             \
+          "A string must reach this age (or be promoted to the old "        \
+          "generation) to be considered for deduplication")                 \
+                                                                            \
+  product(uintx, StringDeduplicationThreads, 1,                             \
+          "Number of threads deduplicating strings concurrently")           \
                                                                             \
   diagnostic(bool, StringDeduplicationResizeALot, false,                    \
           "Force table resize every time the table is scanned")             \
@@ -3967,6 +3970,10 @@ class CommandLineFlags {
           "Make all catch-block to catch throwable.")                       \
   product(bool, UseJPF, false,                                              \
           "Use JPF to evaluate and rank error handlers.")                   \
+  product(intx, JPFWorkerThreads, 0,                                        \
+          "Number of threads evaluating JPF recovery candidates in "        \
+          "parallel, 0 runs all candidates in one JPF on the failing "      \
+          "thread")                                                         \
   product(bool, RecoverTrivial, true,                                       \
           "Ignore trivial handler.")                                        \
   product(bool, ForceEarlyReturnAt, false,                                  \
@@ -3978,7 +3985,121 @@ class CommandLineFlags {
           "Treat a finally block as a non-trivial handler if true.")        \
   product(bool, TransformIntoSuper, false,                                  \
           "if false, do not transform a RuntimeException"                   \
-          "into a Exception or Throwable")
+          "into a Exception or Throwable")                                  \
+  product(ccstr, RecoveryMetadataFile, NULL,                                \
+          "Archive of precomputed per-method recovery metadata, mapped "    \
+          "lazily on the first recovery")                                   \
+  product(bool, DumpRecoveryMetadata, false,                                \
+          "Scan the application class path, write its recovery metadata "   \
+          "to RecoveryMetadataFile and exit")                               \
+                                                                            \
+  product(intx, PerMethodRecoveryTrapLimit, 16,                             \
+          "Limit on recent exceptions sent from compiled code to the "      \
+          "recovery oracle per method, after which the method is "          \
+          "recompiled with the failing call site out of line (0 means no "  \
+          "limit)")                                                         \
+                                                                            \
+  product(intx, RecoveryTrapDecayMillis, 1000,                              \
+          "Milliseconds after which the count of recent recoveries of a "   \
+          "method compared to PerMethodRecoveryTrapLimit is halved (0 "     \
+          "means no decay)")                                                \
+                                                                            \
+  product(intx, RecoveryTimeBudgetMicros, 0,                                \
+          "Time budget of one recovery decision in microseconds. If "       \
+          "positive, handler lookups are tried from the cheapest to the "   \
+          "most expensive and the best action found when the budget "       \
+          "runs out is taken (0 means no budget)")                          \
+                                                                            \
+  product(intx, RecoveryDecisionCacheSize, 1024,                            \
+          "Number of recovery decisions remembered by failure site when "   \
+          "RecoveryTimeBudgetMicros is set (0 disables the cache)")         \
+                                                                            \
+  product(ccstr, RecoveryIndexFile, NULL,                                   \
+          "File of known handler keys, one per line in the format of the "  \
+          "redis keys, consulted before redis")                             \
+                                                                            \
+  product(bool, OmitStackTraceInTransformedException, false,                \
+          "Create the exceptions of error transformations as copies of "    \
+          "one constructed per failure site, with no stack trace except "   \
+          "for sampled ones")                                               \
+                                                                            \
+  product(intx, TransformedExceptionStackTraceSamples, 8,                   \
+          "Number of transformed exceptions per failure site which get a "  \
+          "full stack trace under OmitStackTraceInTransformedException")    \
+                                                                            \
+  product(intx, TransformedExceptionStackTraceInterval, 1000,               \
+          "After the first samples, every so many transformed exceptions "  \
+          "per failure site get a full stack trace under "                  \
+          "OmitStackTraceInTransformedException (0 means none)")            \
+                                                                            \
+  product(bool, LazyRecoveryBacktrace, false,                               \
+          "Defer the stack trace of RuntimeExceptions thrown under "        \
+          "EnableRecovery until it is read or the exception escapes "       \
+          "recovery")                                                       \
+                                                                            \
+  product(ccstr, RecoveryEventLogFile, NULL,                                \
+          "Write binary recovery events to <file>.<n>, see "                \
+          "DecodeRecoveryEventLog")                                         \
+                                                                            \
+  product(intx, RecoveryEventBufferSize, 1024,                              \
+          "Number of recovery events buffered per thread, a power of two")  \
+                                                                            \
+  product(uintx, RecoveryEventLogFileSize, 16*M,                            \
+          "Size of a recovery event log file after which the next one of "  \
+          "RecoveryEventLogFileCount is started")                           \
+                                                                            \
+  product(intx, RecoveryEventLogFileCount, 2,                               \
+          "Number of recovery event log files written in rotation")         \
+                                                                            \
+  product(intx, RecoveryEventLogFlushInterval, 100,                         \
+          "Milliseconds between two writes of the buffered recovery "       \
+          "events")                                                         \
+                                                                            \
+  product(ccstr, DecodeRecoveryEventLog, NULL,                              \
+          "Print the recovery event log file as text and exit")             \
+                                                                            \
+  product(ccstr, RecordRecoveryFile, NULL,                                  \
+          "Write every redis query and JPF run of the recovery oracle "     \
+          "with its answer to the file")                                    \
+                                                                            \
+  product(ccstr, ReplayRecoveryFile, NULL,                                  \
+          "Answer the redis queries and JPF runs of the recovery oracle "   \
+          "from a file written with RecordRecoveryFile")                    \
+                                                                            \
+  product(intx, RecoveryOutcomeWindowMillis, 0,                             \
+          "A recovery whose thread fails again or dies of an uncaught "     \
+          "exception within this many milliseconds counts as failed. "      \
+          "Outcomes are tracked per failure site and action, 0 disables "   \
+          "the tracking")                                                   \
+                                                                            \
+  product(intx, RecoveryOutcomeMinSamples, 8,                               \
+          "Outcomes of an action or strategy needed before it is judged")   \
+                                                                            \
+  product(intx, RecoveryOutcomeBadFailureRate, 90,                          \
+          "Percentage of failed outcomes from which an action is rejected " \
+          "at its failure site")                                            \
+                                                                            \
+  product(bool, AdaptiveRecoveryStrategies, false,                          \
+          "Try the error transformation strategies in the order of their "  \
+          "recovery outcomes and skip those which keep failing")            \
+                                                                            \
+  product(bool, PrefetchRecoveryHandlers, false,                            \
+          "Fetch the known handler keys naming the methods of each linked " \
+          "class from redis on a background thread, so that the failures "  \
+          "through the class look them up in the VM")                       \
+                                                                            \
+  product(intx, RecoveryWriteBackInterval, 0,                               \
+          "Write the handler of one of this many exception dispatches on "  \
+          "each thread back to redis, or to RecoveryIndexFile without "     \
+          "UseRedis, as an induced key (0 disables the write-back)")        \
+                                                                            \
+  product(intx, RecoveryWriteBackBufferSize, 64,                            \
+          "Observed handler keys a thread collects before handing them to " \
+          "the write back thread")                                          \
+                                                                            \
+  product(intx, RecoveryWriteBackFlushInterval, 1000,                       \
+          "Milliseconds after which a thread hands its observed handler "   \
+          "keys to the write back thread at its next sampled dispatch")
 
 
 
@@ -50,6 +50,9 @@
 #include "runtime/interfaceSupport.hpp"
 #include "runtime/java.hpp"
 #include "runtime/memprofiler.hpp"
+#include "runtime/recoveryEventLog.hpp"
+#include "runtime/recoveryPrefetch.hpp"
+#include "runtime/recoveryWriteBack.hpp"
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/statSampler.hpp"
 #include "runtime/sweeper.hpp"
@@ -496,6 +499,11 @@ void before_exit(JavaThread * thread) {
     FlatProfiler::print(10);
   }
 
+  // write the recovery events still buffered
+  RecoveryEventLog::stop();
+  RecoveryPrefetch::stop();
+  RecoveryWriteBack::stop();
+
   // shut down the StatSampler task
   StatSampler::disengage();
   StatSampler::destroy();
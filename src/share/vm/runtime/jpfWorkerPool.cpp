@@ -0,0 +1,396 @@
+#include "precompiled.hpp"
+
+#include "classfile/javaClasses.hpp"
+#include "classfile/symbolTable.hpp"
+#include "classfile/systemDictionary.hpp"
+#include "classfile/vmSymbols.hpp"
+#include "memory/oopFactory.hpp"
+#include "oops/objArrayKlass.hpp"
+#include "oops/typeArrayKlass.hpp"
+#include "runtime/interfaceSupport.hpp"
+#include "runtime/javaCalls.hpp"
+#include "runtime/jniHandles.hpp"
+#include "runtime/jpfWorkerPool.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/runtimeRecoveryState.hpp"
+
+static const char* ares_klass_name         = "gov/nasa/jpf/Ares";
+static const char* run_candidate_name      = "runCandidate";
+static const char* run_candidate_signature = "([Ljava/lang/Object;[Ljava/lang/Object;[Z)[Ljava/lang/Object;";
+
+int            JPFWorkerPool::_worker_count = 0;
+JPFEvaluation* JPFWorkerPool::_queue        = NULL;
+
+static volatile jint _pool_state = 0; // 0: not started, 1: starting, 2: started
+
+JPFEvaluation::JPFEvaluation(jobject data, jobject cancel) :
+  _data(data), _cancel(cancel), _next(0), _running(0), _abandoned(false), _next_evaluation(NULL) {
+  _candidates = new (ResourceObj::C_HEAP, mtInternal) GrowableArray<JPFCandidate*>(8, true, mtInternal);
+}
+
+JPFEvaluation::~JPFEvaluation() {
+  for (int i = 0; i < _candidates->length(); i++) {
+    JPFCandidate* c = _candidates->at(i);
+    JNIHandles::destroy_global(c->spec());
+    if (c->result() != NULL) {
+      JNIHandles::destroy_global(c->result());
+    }
+    delete c;
+  }
+  delete _candidates;
+  JNIHandles::destroy_global(_data);
+  JNIHandles::destroy_global(_cancel);
+}
+
+bool JPFEvaluation::is_decided(int &winner) const {
+  winner = -1;
+  for (int i = 0; i < _candidates->length(); i++) {
+    JPFCandidate::State s = _candidates->at(i)->state();
+    if (s == JPFCandidate::_accepted) {
+      winner = i;
+      return true;
+    } else if (s != JPFCandidate::_rejected) {
+      // a better ranked candidate is still pending or running
+      return false;
+    }
+  }
+  return true;
+}
+
+int JPFEvaluation::best_accepted() const {
+  for (int i = 0; i < _candidates->length(); i++) {
+    if (_candidates->at(i)->state() == JPFCandidate::_accepted) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool JPFEvaluation::has_next() const {
+  int winner;
+  return !_abandoned && _next < _candidates->length() && !is_decided(winner);
+}
+
+bool JPFWorkerPool::initialize(TRAPS) {
+  if (_pool_state == 2) {
+    return true;
+  }
+  if (Atomic::cmpxchg(1, &_pool_state, 0) != 0) {
+    // somebody else is starting the pool, do not wait for it
+    return false;
+  }
+  for (int i = 0; i < JPFWorkerThreads; i++) {
+    start_worker(i, THREAD);
+    if (HAS_PENDING_EXCEPTION) {
+      CLEAR_PENDING_EXCEPTION;
+      break;
+    }
+    _worker_count++;
+  }
+  if ((TraceRuntimeRecovery & TRACE_JPF) != 0) {
+    tty->print_cr("[Ares] JPFWorkerPool::initialize: started %d workers", _worker_count);
+  }
+  OrderAccess::release_store(&_pool_state, 2);
+  return _worker_count > 0;
+}
+
+void JPFWorkerPool::start_worker(int id, TRAPS) {
+  instanceKlassHandle klass (THREAD, SystemDictionary::Thread_klass());
+  instanceHandle thread_oop = klass->allocate_instance_handle(CHECK);
+
+  char name[32];
+  jio_snprintf(name, sizeof(name), "JPF Worker %d", id);
+  Handle string = java_lang_String::create_from_str(name, CHECK);
+
+  // Initialize thread_oop to put it into the system threadGroup
+  Handle thread_group (THREAD, Universe::system_thread_group());
+  JavaValue result(T_VOID);
+  JavaCalls::call_special(&result, thread_oop,
+                          klass,
+                          vmSymbols::object_initializer_name(),
+                          vmSymbols::threadgroup_string_void_signature(),
+                          thread_group,
+                          string,
+                          CHECK);
+
+  {
+    MutexLocker mu(Threads_lock);
+    JPFWorkerThread* thread = new JPFWorkerThread(&worker_entry);
+
+    if (thread == NULL || thread->osthread() == NULL) {
+      THROW_MSG(vmSymbols::java_lang_OutOfMemoryError(),
+                "unable to create new native thread");
+    }
+
+    java_lang_Thread::set_thread(thread_oop(), thread);
+    java_lang_Thread::set_priority(thread_oop(), NormPriority);
+    java_lang_Thread::set_daemon(thread_oop());
+    thread->set_threadObj(thread_oop());
+
+    Threads::add(thread);
+    Thread::start(thread);
+  }
+}
+
+bool JPFWorkerPool::is_supported(instanceKlassHandle ares) {
+  TempNewSymbol name = SymbolTable::probe(run_candidate_name, (int)strlen(run_candidate_name));
+  TempNewSymbol signature = SymbolTable::probe(run_candidate_signature, (int)strlen(run_candidate_signature));
+  if (name == NULL || signature == NULL) {
+    return false;
+  }
+  return ares->find_method(name, signature) != NULL;
+}
+
+void JPFWorkerPool::enqueue(JPFEvaluation* e) {
+  assert_lock_strong(JPFWorker_lock);
+  JPFEvaluation** p = &_queue;
+  while (*p != NULL) {
+    p = &(*p)->_next_evaluation;
+  }
+  *p = e;
+}
+
+void JPFWorkerPool::dequeue(JPFEvaluation* e) {
+  assert_lock_strong(JPFWorker_lock);
+  for (JPFEvaluation** p = &_queue; *p != NULL; p = &(*p)->_next_evaluation) {
+    if (*p == e) {
+      *p = e->_next_evaluation;
+      e->_next_evaluation = NULL;
+      return;
+    }
+  }
+}
+
+void JPFWorkerPool::worker_entry(JavaThread* thread, TRAPS) {
+  // Failures inside JPF are not for the oracle.
+  thread->runtime_recovery_state()->set_in_recovery();
+  thread->runtime_recovery_state()->set_in_run_jpf();
+
+  while (true) {
+    JPFCandidate* c = NULL;
+    JPFEvaluation* e = next_task(thread, &c);
+    jobject answer = evaluate(thread, e, c);
+    finish_task(thread, e, c, answer);
+  }
+}
+
+JPFEvaluation* JPFWorkerPool::next_task(JavaThread* thread, JPFCandidate** candidate) {
+  ThreadBlockInVM tbivm(thread);
+  MonitorLockerEx ml(JPFWorker_lock, Mutex::_no_safepoint_check_flag);
+  while (true) {
+    for (JPFEvaluation* e = _queue; e != NULL; e = e->_next_evaluation) {
+      if (e->has_next()) {
+        JPFCandidate* c = e->_candidates->at(e->_next++);
+        c->set_state(JPFCandidate::_running);
+        e->_running++;
+        *candidate = c;
+        return e;
+      }
+    }
+    ml.wait(Mutex::_no_safepoint_check_flag);
+  }
+}
+
+// Runs one candidate and returns a global handle of the answer, or NULL
+// when JPF rejected it or failed.
+jobject JPFWorkerPool::evaluate(JavaThread* thread, JPFEvaluation* e, JPFCandidate* c) {
+  HandleMark hm(thread);
+
+  objArrayHandle data(thread, (objArrayOop)JNIHandles::resolve_non_null(e->_data));
+  Handle spec(thread, JNIHandles::resolve_non_null(c->spec()));
+  Handle cancel(thread, JNIHandles::resolve_non_null(e->_cancel));
+
+  oop answer = run_candidate(thread, data, spec, cancel);
+  if (answer == NULL) {
+    return NULL;
+  }
+  return JNIHandles::make_global(Handle(thread, answer));
+}
+
+// Calls Ares.runCandidate on a copy of data. Returns the answer, or NULL
+// when JPF rejected the candidate or failed.
+oop JPFWorkerPool::run_candidate(JavaThread* thread, objArrayHandle data, Handle spec, Handle cancel) {
+  ResourceMark rm(thread);
+
+  TempNewSymbol ares_name = SymbolTable::new_symbol(ares_klass_name, thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+  Klass* k = SystemDictionary::resolve_or_null(ares_name, thread);
+  if (thread->has_pending_exception() || k == NULL) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+  KlassHandle ares(thread, k);
+
+  // Every run gets its own copy of the snapshot, JPF may write to it.
+  objArrayOop copy = copy_snapshot(data, thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+  objArrayHandle copy_h(thread, copy);
+
+  TempNewSymbol name = SymbolTable::new_symbol(run_candidate_name, thread);
+  TempNewSymbol signature = SymbolTable::new_symbol(run_candidate_signature, thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+
+  JavaValue result(T_ARRAY);
+  JavaCallArguments args;
+  args.push_oop(copy_h);
+  args.push_oop(spec);
+  args.push_oop(cancel);
+  JavaCalls::call_static(&result, ares, name, signature, &args, thread);
+
+  if (thread->has_pending_exception()) {
+    Handle px(thread, thread->pending_exception());
+    thread->clear_pending_exception();
+    if ((TraceRuntimeRecovery & TRACE_JPF) != 0) {
+      tty->print("[Ares] JPFWorkerPool::run_candidate: run jpf result in an exception: ");
+      java_lang_Throwable::print(px, tty);
+      tty->cr();
+    }
+    return NULL;
+  }
+
+  return (oop)result.get_jobject();
+}
+
+void JPFWorkerPool::finish_task(JavaThread* thread, JPFEvaluation* e, JPFCandidate* c, jobject answer) {
+  bool last = false;
+  {
+    ThreadBlockInVM tbivm(thread);
+    MonitorLockerEx ml(JPFWorker_lock, Mutex::_no_safepoint_check_flag);
+    c->set_result(answer);
+    c->set_state(answer != NULL ? JPFCandidate::_accepted : JPFCandidate::_rejected);
+    e->_running--;
+    last = e->_abandoned && e->_running == 0;
+    ml.notify_all();
+  }
+  if (last) {
+    delete e;
+  }
+}
+
+// Copies the top level array and the slot arrays in it; the objects in the
+// slots are shared.
+objArrayOop JPFWorkerPool::copy_snapshot(objArrayHandle data, TRAPS) {
+  int length = data->length();
+  objArrayOop copy_oop = oopFactory::new_objectArray(length, CHECK_NULL);
+  objArrayHandle copy(THREAD, copy_oop);
+
+  for (int i = 0; i < length; i++) {
+    Handle element(THREAD, data->obj_at(i));
+    if (element.not_null() && element->is_array()) {
+      int len = arrayOop(element())->length();
+      arrayOop c;
+      if (element->is_objArray()) {
+        c = oopFactory::new_objArray(ObjArrayKlass::cast(element->klass())->element_klass(), len, CHECK_NULL);
+      } else {
+        c = TypeArrayKlass::cast(element->klass())->allocate(len, CHECK_NULL);
+      }
+      arrayHandle c_h(THREAD, c);
+      element->klass()->copy_array(arrayOop(element()), 0, c_h(), 0, len, CHECK_NULL);
+      copy->obj_at_put(i, c_h());
+    } else {
+      copy->obj_at_put(i, element());
+    }
+  }
+  return copy();
+}
+
+objArrayOop JPFWorkerPool::evaluate_candidates(JavaThread* thread, objArrayHandle data,
+                                               GrowableArray<Handle>* candidates, jlong deadline, TRAPS) {
+  typeArrayOop cancel_oop = oopFactory::new_boolArray(1, CHECK_NULL);
+  typeArrayHandle cancel(THREAD, cancel_oop);
+
+  JPFEvaluation* e = new JPFEvaluation(JNIHandles::make_global(data), JNIHandles::make_global(cancel));
+  for (int i = 0; i < candidates->length(); i++) {
+    e->add_candidate(JNIHandles::make_global(candidates->at(i)));
+  }
+
+  int winner = -1;
+  jobject answer = NULL;
+  bool last = false;
+  {
+    ThreadBlockInVM tbivm(thread);
+    MonitorLockerEx ml(JPFWorker_lock, Mutex::_no_safepoint_check_flag);
+    enqueue(e);
+    ml.notify_all();
+    while (!e->is_decided(winner)) {
+      if (deadline == 0) {
+        ml.wait(Mutex::_no_safepoint_check_flag);
+        continue;
+      }
+      jlong remaining = deadline - os::javaTimeNanos();
+      if (remaining <= 0) {
+        // Out of time, settle for the best candidate accepted so far.
+        winner = e->best_accepted();
+        break;
+      }
+      ml.wait(Mutex::_no_safepoint_check_flag, MAX2(remaining / NANOSECS_PER_MILLISEC, (jlong)1));
+    }
+    dequeue(e);
+    e->_abandoned = true;
+    if (winner >= 0) {
+      // take over the answer, it outlives the evaluation
+      JPFCandidate* c = e->_candidates->at(winner);
+      answer = c->result();
+      c->set_result(NULL);
+    }
+    last = e->_running == 0;
+  }
+
+  // The candidates still running lost, tell JPF to stop them.
+  cancel->bool_at_put(0, JNI_TRUE);
+
+  if ((TraceRuntimeRecovery & TRACE_JPF) != 0) {
+    tty->print_cr("[Ares] JPFWorkerPool::evaluate_candidates: winner %d of %d candidates",
+        winner, candidates->length());
+  }
+
+  if (last) {
+    delete e;
+  }
+
+  if (answer == NULL) {
+    return NULL;
+  }
+  objArrayOop result = (objArrayOop)JNIHandles::resolve_non_null(answer);
+  JNIHandles::destroy_global(answer);
+  return result;
+}
+
+objArrayOop JPFWorkerPool::evaluate_candidates_sequentially(JavaThread* thread, objArrayHandle data,
+                                                            GrowableArray<Handle>* candidates, jlong deadline, TRAPS) {
+  typeArrayOop cancel_oop = oopFactory::new_boolArray(1, CHECK_NULL);
+  typeArrayHandle cancel(THREAD, cancel_oop);
+
+  int winner = -1;
+  oop answer = NULL;
+  for (int i = 0; i < candidates->length(); i++) {
+    if (deadline != 0 && os::javaTimeNanos() - deadline >= 0) {
+      if ((TraceRuntimeRecovery & TRACE_JPF) != 0) {
+        tty->print_cr("[Ares] JPFWorkerPool::evaluate_candidates_sequentially: out of time after %d of %d candidates",
+            i, candidates->length());
+      }
+      break;
+    }
+    answer = run_candidate(thread, data, candidates->at(i), cancel);
+    if (answer != NULL) {
+      winner = i;
+      break;
+    }
+  }
+
+  if ((TraceRuntimeRecovery & TRACE_JPF) != 0) {
+    tty->print_cr("[Ares] JPFWorkerPool::evaluate_candidates_sequentially: winner %d of %d candidates",
+        winner, candidates->length());
+  }
+  return (objArrayOop)answer;
+}
@@ -0,0 +1,126 @@
+#ifndef SHARE_VM_RUNTIME_JPFWORKERPOOL_HPP
+#define SHARE_VM_RUNTIME_JPFWORKERPOOL_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/handles.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/growableArray.hpp"
+
+//
+// Parallel evaluation of JPF recovery candidates.
+//
+// Ares.runDefault tries every candidate action in one JPF instance on the
+// failing thread. With JPFWorkerThreads > 0 the oracle instead builds the
+// candidate set itself and hands it to a pool of worker threads, each of
+// which runs
+//
+//   Ares.runCandidate(Object[] data, Object[] candidate, boolean[] cancel)
+//
+// on its own copy of the stack snapshot. A candidate is {"ErrorTransformation",
+// Class} or {"EarlyReturn", Integer depth}; JPF answers with the same shape
+// when the action is acceptable and null otherwise. Candidates are ranked,
+// the best ranked acceptable one wins as soon as every better ranked one has
+// been rejected, and cancel[0] is set to tell JPF to give up on the others.
+//
+
+class JPFCandidate : public CHeapObj<mtInternal> {
+ public:
+  enum State {
+    _pending,
+    _running,
+    _accepted,
+    _rejected
+  };
+
+ private:
+  jobject _spec;            // global handle of the Object[] candidate
+  jobject _result;          // global handle of the Object[] answered by JPF
+  State   _state;
+
+ public:
+  JPFCandidate(jobject spec) : _spec(spec), _result(NULL), _state(_pending) {}
+
+  jobject spec() const     { return _spec; }
+  jobject result() const   { return _result; }
+  State   state() const    { return _state; }
+
+  void set_state(State s)          { _state = s; }
+  void set_result(jobject result)  { _result = result; }
+};
+
+// One failure, shared by the requesting thread and the workers. Guarded by
+// JPFWorker_lock. Freed by whoever leaves it last.
+class JPFEvaluation : public CHeapObj<mtInternal> {
+  friend class JPFWorkerPool;
+ private:
+  jobject                       _data;      // stack snapshot from load_stack_data
+  jobject                       _cancel;    // boolean[1]
+  GrowableArray<JPFCandidate*>* _candidates;
+  int                           _next;      // next candidate to hand out
+  int                           _running;   // candidates being evaluated
+  bool                          _abandoned; // the requester has left
+  JPFEvaluation*                _next_evaluation;
+
+  // Returns true once the winner is known; winner is -1 when every
+  // candidate was rejected.
+  bool is_decided(int &winner) const;
+  bool has_next() const;
+  // The best ranked candidate accepted so far, -1 if none.
+  int  best_accepted() const;
+
+ public:
+  JPFEvaluation(jobject data, jobject cancel);
+  ~JPFEvaluation();
+
+  void add_candidate(jobject spec) { _candidates->append(new JPFCandidate(spec)); }
+  int  candidate_count() const     { return _candidates->length(); }
+};
+
+class JPFWorkerThread : public JavaThread {
+ public:
+  JPFWorkerThread(ThreadFunction entry_point) : JavaThread(entry_point) {}
+
+  // Hide this thread from external view.
+  bool is_hidden_from_external_view() const      { return true; }
+};
+
+class JPFWorkerPool : AllStatic {
+ private:
+  static int             _worker_count;
+  static JPFEvaluation*  _queue;       // evaluations with candidates left
+
+  static void start_worker(int id, TRAPS);
+  static void worker_entry(JavaThread* thread, TRAPS);
+
+  static JPFEvaluation* next_task(JavaThread* thread, JPFCandidate** candidate);
+  static jobject evaluate(JavaThread* thread, JPFEvaluation* e, JPFCandidate* c);
+  static oop run_candidate(JavaThread* thread, objArrayHandle data, Handle spec, Handle cancel);
+  static void finish_task(JavaThread* thread, JPFEvaluation* e, JPFCandidate* c, jobject answer);
+
+  static void enqueue(JPFEvaluation* e);
+  static void dequeue(JPFEvaluation* e);
+
+  static objArrayOop copy_snapshot(objArrayHandle data, TRAPS);
+
+ public:
+  // Starts the workers on the first use.
+  static bool initialize(TRAPS);
+
+  // Whether the JPF side provides Ares.runCandidate.
+  static bool is_supported(instanceKlassHandle ares);
+
+  // Returns the answer of the winning candidate, or NULL when all of them
+  // were rejected. Blocks the calling thread until the winner is known or,
+  // if deadline is not 0, until os::javaTimeNanos() passes deadline; the
+  // best ranked candidate accepted by then wins.
+  static objArrayOop evaluate_candidates(JavaThread* thread, objArrayHandle data,
+                                         GrowableArray<Handle>* candidates, jlong deadline, TRAPS);
+
+  // Same on the calling thread, one candidate after the other. The first
+  // accepted candidate wins; no further candidate is started once
+  // os::javaTimeNanos() passes deadline, if it is not 0.
+  static objArrayOop evaluate_candidates_sequentially(JavaThread* thread, objArrayHandle data,
+                                                      GrowableArray<Handle>* candidates, jlong deadline, TRAPS);
+};
+
+#endif // SHARE_VM_RUNTIME_JPFWORKERPOOL_HPP
@@ -0,0 +1,152 @@
+#include "precompiled.hpp"
+
+#include "classfile/javaClasses.hpp"
+#include "classfile/systemDictionary.hpp"
+#include "classfile/vmSymbols.hpp"
+#include "interpreter/bytecode.hpp"
+#include "runtime/frame.inline.hpp"
+#include "runtime/lazyBacktrace.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/runtimeRecoveryState.hpp"
+#include "runtime/thread.hpp"
+#include "runtime/vframe.hpp"
+
+// An interpreted frame keeps its locals in place for its whole life, unlike
+// its sp, which moves with the expression stack.
+static intptr_t* frame_id_of(javaVFrame* vf) {
+  return vf->fr().interpreter_frame_local_at(0);
+}
+
+// Whether the exception constructed at bci of method is thrown right there.
+static bool is_thrown_at(Method* method, int bci) {
+  if (method->java_code_at(bci) != Bytecodes::_invokespecial) {
+    // created by the VM for this bytecode
+    return true;
+  }
+  methodHandle mh(method);
+  Bytecode_invoke invoke(mh, bci);
+  if (invoke.name() != vmSymbols::object_initializer_name()) {
+    return true;
+  }
+  int next = bci + Bytecodes::length_for(Bytecodes::_invokespecial);
+  return next < method->code_size() && method->java_code_at(next) == Bytecodes::_athrow;
+}
+
+bool LazyBacktrace::defer(JavaThread* thread, Handle exception) {
+  if (!is_enabled() || !StackTraceInThrowable) {
+    return false;
+  }
+
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  if (state == NULL || state->is_in_recovery() || state->has_lazy_backtrace()) {
+    return false;
+  }
+  if (!exception->is_a(SystemDictionary::RuntimeException_klass()) ||
+      !thread->has_last_Java_frame()) {
+    return false;
+  }
+
+  // Find the frame which constructed the exception, below fillInStackTrace
+  // and the constructors of the exception class.
+  Method* method = NULL;
+  int bci = -1;
+  intptr_t* frame_id = NULL;
+  {
+    ResourceMark rm(thread);
+    RegisterMap map(thread);
+    javaVFrame* vf = thread->last_java_vframe(&map);
+    for (; vf != NULL; vf = vf->java_sender()) {
+      Method* m = vf->method();
+      if ((m->name() == vmSymbols::fillInStackTrace_name() ||
+           m->name() == vmSymbols::fillInStackTrace0_name() ||
+           m->name() == vmSymbols::object_initializer_name()) &&
+          exception->is_a(m->method_holder())) {
+        continue;
+      }
+      break;
+    }
+    if (vf == NULL || !vf->is_interpreted_frame() || vf->method()->is_native() ||
+        !is_thrown_at(vf->method(), vf->bci())) {
+      return false;
+    }
+    method = vf->method();
+    bci = vf->bci();
+    frame_id = frame_id_of(vf);
+  }
+
+  java_lang_Throwable::set_backtrace(exception(), NULL);
+  state->set_lazy_backtrace(exception(), method, bci, frame_id);
+
+  if ((TraceRuntimeRecovery & TRACE_TRANSFORMING) != 0) {
+    ResourceMark rm(thread);
+    tty->print_cr("[Ares] Deferring the stack trace of %s",
+        exception->klass()->name()->as_C_string());
+  }
+  return true;
+}
+
+// Returns the number of frames above the deferred one, or -1 if it is gone.
+static int depth_of_deferred_frame(JavaThread* thread, RuntimeRecoveryState* state) {
+  if (!thread->has_last_Java_frame()) {
+    return -1;
+  }
+  ResourceMark rm(thread);
+  RegisterMap map(thread);
+  int depth = 0;
+  for (javaVFrame* vf = thread->last_java_vframe(&map); vf != NULL; vf = vf->java_sender(), depth++) {
+    if (vf->is_interpreted_frame() && vf->method() == state->lazy_backtrace_method() &&
+        frame_id_of(vf) == state->lazy_backtrace_frame_id()) {
+      return depth;
+    }
+  }
+  return -1;
+}
+
+void LazyBacktrace::materialize(JavaThread* thread, Handle exception) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  if (state == NULL || !state->has_lazy_backtrace() ||
+      exception.is_null() || state->lazy_backtrace_exception() != exception()) {
+    return;
+  }
+  int depth = depth_of_deferred_frame(thread, state);
+  Method* method = state->lazy_backtrace_method();
+  int bci = state->lazy_backtrace_bci();
+  state->clr_lazy_backtrace();
+
+  if (depth < 0) {
+    // Not expected, see dispatched(). A trace of other frames would be
+    // wrong, leave it empty.
+    if ((TraceRuntimeRecovery & TRACE_TRANSFORMING) != 0) {
+      ResourceMark rm(thread);
+      tty->print_cr("[Ares] The constructing frame of %s is gone, its stack trace is left empty",
+          exception->klass()->name()->as_C_string());
+    }
+    return;
+  }
+  java_lang_Throwable::fill_in_stack_trace_from_frame(exception, method, bci, depth);
+
+  if ((TraceRuntimeRecovery & TRACE_TRANSFORMING) != 0) {
+    ResourceMark rm(thread);
+    tty->print_cr("[Ares] Filling in the deferred stack trace of %s",
+        exception->klass()->name()->as_C_string());
+  }
+}
+
+void LazyBacktrace::dispatched(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  if (state == NULL || !state->has_lazy_backtrace()) {
+    return;
+  }
+  // Whichever exception this is, the deferred one is not thrown any more
+  // from this frame, and it may be about to be popped.
+  if (depth_of_deferred_frame(thread, state) == 0) {
+    materialize(thread, Handle(thread, state->lazy_backtrace_exception()));
+  }
+}
+
+void LazyBacktrace::discard(JavaThread* thread, oop exception) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  if (state != NULL && state->lazy_backtrace_exception() == exception) {
+    state->clr_lazy_backtrace();
+  }
+}
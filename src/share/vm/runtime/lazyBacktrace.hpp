@@ -0,0 +1,54 @@
+#ifndef SHARE_VM_RUNTIME_LAZYBACKTRACE_HPP
+#define SHARE_VM_RUNTIME_LAZYBACKTRACE_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/handles.hpp"
+
+//
+// Deferred backtraces of RuntimeExceptions, -XX:+LazyRecoveryBacktrace.
+//
+// Most exceptions thrown under recovery are dropped by an early return and
+// their stack trace is never looked at. With the flag, fillInStackTrace of a
+// RuntimeException only records the method, bci and frame which constructed
+// it in the RuntimeRecoveryState of the thread. The backtrace is built from
+// that frame the first time it is read through getStackTrace or
+// printStackTrace, when the oracle transforms it, or at the latest when an
+// exception is dispatched in the constructing frame, i.e. before the frame
+// can be popped. An exception dropped by an early return never gets one.
+//
+// Only exceptions which cannot outlive their constructing frame unnoticed
+// are deferred: the frame has to be interpreted, since compiled frames are
+// popped by their unwind handlers without calling into the VM, and it has to
+// throw the exception right away, either with an athrow following the
+// constructor or because the VM created the exception for the current
+// bytecode. All others, e.g. exceptions stored in a field to be thrown
+// later, are filled in as usual. This also bounds the time the single
+// deferred exception per thread is held; while it is, other exceptions are
+// filled in as usual. Limitations:
+//  - the trace is read from the stack of the throwing thread, so another
+//    thread reading it before it is built sees an empty trace;
+//  - an early return which is given up after the decision leaves the
+//    exception without a stack trace.
+//
+
+class LazyBacktrace : AllStatic {
+ public:
+  static bool is_enabled() { return LazyRecoveryBacktrace && EnableRecovery; }
+
+  // Called from fillInStackTrace. Returns true if the backtrace of
+  // exception is deferred.
+  static bool defer(JavaThread* thread, Handle exception);
+
+  // Builds the backtrace of exception if it is the deferred one.
+  static void materialize(JavaThread* thread, Handle exception);
+
+  // Called by the interpreter when it dispatches an exception in the top
+  // frame. Builds the deferred backtrace if the top frame constructed it.
+  static void dispatched(JavaThread* thread);
+
+  // Forgets the deferred backtrace of exception, which is dropped.
+  static void discard(JavaThread* thread, oop exception);
+};
+
+#endif // SHARE_VM_RUNTIME_LAZYBACKTRACE_HPP
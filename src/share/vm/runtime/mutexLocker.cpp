@@ -125,6 +125,16 @@ Monitor* GCTaskManager_lock           = NULL;
 Mutex*   Management_lock              = NULL;
 Monitor* Service_lock                 = NULL;
 Monitor* PeriodicTask_lock            = NULL;
+Mutex*   RecoveryMetadata_lock        = NULL;
+Monitor* JPFWorker_lock               = NULL;
+Mutex*   RecoveryDecision_lock        = NULL;
+Mutex*   RecoveryIndex_lock           = NULL;
+Mutex*   TransformedException_lock    = NULL;
+Monitor* RecoveryEventLog_lock        = NULL;
+Mutex*   RecoveryReplay_lock          = NULL;
+Mutex*   RecoveryOutcome_lock         = NULL;
+Monitor* RecoveryPrefetch_lock        = NULL;
+Monitor* RecoveryWriteBack_lock       = NULL;
 
 #ifdef INCLUDE_TRACE
 Mutex*   JfrStacktrace_lock           = NULL;
@@ -279,6 +289,16 @@ void mutex_init() {
   def(ProfileVM_lock               , Monitor, special,   false); // used for profiling of the VMThread
   def(CompileThread_lock           , Monitor, nonleaf+5,   false );
   def(PeriodicTask_lock            , Monitor, nonleaf+5,   true);
+  def(RecoveryMetadata_lock        , Mutex  , leaf,        false);
+  def(JPFWorker_lock               , Monitor, special,     true ); // used for JPF worker pool operations
+  def(RecoveryDecision_lock        , Mutex  , leaf,        true );
+  def(RecoveryIndex_lock           , Mutex  , leaf,        true );
+  def(TransformedException_lock    , Mutex  , leaf,        true );
+  def(RecoveryEventLog_lock        , Monitor, leaf,        true ); // used for the recovery event writer
+  def(RecoveryReplay_lock          , Mutex  , leaf,        true );
+  def(RecoveryOutcome_lock         , Mutex  , leaf,        true );
+  def(RecoveryPrefetch_lock        , Monitor, leaf,        true ); // used for the recovery prefetch thread
+  def(RecoveryWriteBack_lock       , Monitor, leaf,        true ); // used for the recovery write back thread
 
 #ifdef INCLUDE_TRACE
   def(JfrMsg_lock                  , Monitor, leaf,        true);
@@ -141,6 +141,16 @@ extern Mutex*   MMUTracker_lock;                 // protects the MMU
 extern Mutex*   Management_lock;                 // a lock used to serialize JVM management
 extern Monitor* Service_lock;                    // a lock used for service thread operation
 extern Monitor* PeriodicTask_lock;               // protects the periodic task structure
+extern Mutex*   RecoveryMetadata_lock;           // guards lazy mapping of the recovery metadata archive
+extern Monitor* JPFWorker_lock;                  // protects the JPF worker pool and its evaluations
+extern Mutex*   RecoveryDecision_lock;           // protects the recovery decision cache
+extern Mutex*   RecoveryIndex_lock;              // protects the local index of known handler keys
+extern Mutex*   TransformedException_lock;       // protects the per site cache of transformed exceptions
+extern Monitor* RecoveryEventLog_lock;           // protects the recovery event rings list and the event log file
+extern Mutex*   RecoveryReplay_lock;             // protects the record file of oracle answers
+extern Mutex*   RecoveryOutcome_lock;            // protects the table of recovery outcomes
+extern Monitor* RecoveryPrefetch_lock;           // protects the queue and the covered classes of handler prefetching
+extern Monitor* RecoveryWriteBack_lock;          // protects the queue of observed handler keys
 
 #ifdef INCLUDE_TRACE
 extern Mutex*   JfrStacktrace_lock;              // used to guard access to the JFR stacktrace table
@@ -0,0 +1,136 @@
+#include "precompiled.hpp"
+
+#include "runtime/atomic.inline.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/recoveryDecisionCache.hpp"
+#include "runtime/recoveryOracle.hpp"
+
+RecoveryDecision* RecoveryDecisionCache::_table = NULL;
+int               RecoveryDecisionCache::_size = 0;
+volatile jint     RecoveryDecisionCache::_hits = 0;
+volatile jint     RecoveryDecisionCache::_misses = 0;
+
+RecoveryDecision* RecoveryDecisionCache::table() {
+  assert_lock_strong(RecoveryDecision_lock);
+  if (_table == NULL) {
+    int size = 1;
+    while (size < RecoveryDecisionCacheSize) {
+      size <<= 1;
+    }
+    _table = NEW_C_HEAP_ARRAY(RecoveryDecision, size, mtInternal);
+    memset(_table, 0, size * sizeof(RecoveryDecision));
+    _size = size;
+  }
+  return _table;
+}
+
+uintptr_t RecoveryDecisionCache::signature_for(GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                               RecoveryAction* action) {
+  uintptr_t h = (uintptr_t)action->origin_exception()->klass();
+  h = 31 * h + (uintptr_t)action->failure_type();
+  h = 31 * h + (uintptr_t)action->recovery_context_offset();
+  if (action->has_top_method()) {
+    h = 31 * h + (uintptr_t)action->top_method();
+  }
+  for (int index = 0; index <= action->recovery_context_offset(); index++) {
+    h = 31 * h + (uintptr_t)methods->at(index);
+    h = 31 * h + (uintptr_t)bcis->at(index);
+  }
+  return h != 0 ? h : 1;
+}
+
+bool RecoveryDecisionCache::lookup(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                   RecoveryAction* action) {
+  uintptr_t signature = signature_for(methods, bcis, action);
+
+  RecoveryDecision d;
+  {
+    MutexLockerEx ml(RecoveryDecision_lock, Mutex::_no_safepoint_check_flag);
+    d = table()[signature & (_size - 1)];
+  }
+
+  if (d._signature != signature ||
+      d._exception_klass != action->origin_exception()->klass() ||
+      d._failure_type != (u1)action->failure_type() ||
+      d._context_offset != action->recovery_context_offset() ||
+      d._top_method != methods->at(0) ||
+      d._top_bci != bcis->at(0)) {
+    Atomic::inc(&_misses);
+    return false;
+  }
+
+  switch (d._recovery_type) {
+  case RecoveryOracle::_error_transformation:
+    Atomic::inc(&_hits);
+    action->set_recovery_type(RecoveryOracle::_error_transformation);
+    action->set_target_exception_klass(KlassHandle(thread, d._target_exception_klass));
+    return true;
+  case RecoveryOracle::_early_return:
+    Atomic::inc(&_hits);
+    action->set_recovery_type(RecoveryOracle::_early_return);
+    action->set_early_return_offset(d._early_return_offset);
+    action->set_early_return_type((BasicType)d._early_return_type);
+    action->set_early_return_size_of_parameters(d._early_return_size_of_parameters);
+    return true;
+  default:
+    break;
+  }
+  Atomic::inc(&_misses);
+  return false;
+}
+
+void RecoveryDecisionCache::record(GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                   RecoveryAction* action) {
+  RecoveryDecision d;
+  memset(&d, 0, sizeof(RecoveryDecision));
+  d._signature = signature_for(methods, bcis, action);
+  d._exception_klass = action->origin_exception()->klass();
+  d._top_method = methods->at(0);
+  d._top_bci = bcis->at(0);
+  d._context_offset = action->recovery_context_offset();
+  d._failure_type = (u1)action->failure_type();
+  d._recovery_type = (u1)action->recovery_type();
+
+  if (action->can_error_transformation()) {
+    d._target_exception_klass = action->target_exception_klass();
+  } else if (action->can_early_return()) {
+    d._early_return_offset = action->early_return_offset();
+    d._early_return_type = (u1)action->early_return_type();
+    d._early_return_size_of_parameters = action->early_return_size_of_parameters();
+  } else {
+    return;
+  }
+
+  MutexLockerEx ml(RecoveryDecision_lock, Mutex::_no_safepoint_check_flag);
+  table()[d._signature & (_size - 1)] = d;
+}
+
+void RecoveryDecisionCache::purge() {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
+  MutexLockerEx ml(RecoveryDecision_lock, Mutex::_no_safepoint_check_flag);
+  if (_table != NULL) {
+    memset(_table, 0, _size * sizeof(RecoveryDecision));
+  }
+}
+
+void RecoveryDecisionCache::clear() {
+  {
+    MutexLockerEx ml(RecoveryDecision_lock, Mutex::_no_safepoint_check_flag);
+    if (_table != NULL) {
+      memset(_table, 0, _size * sizeof(RecoveryDecision));
+    }
+  }
+  Atomic::store(0, &_hits);
+  Atomic::store(0, &_misses);
+}
+
+int RecoveryDecisionCache::entry_count() {
+  MutexLockerEx ml(RecoveryDecision_lock, Mutex::_no_safepoint_check_flag);
+  int count = 0;
+  for (int i = 0; _table != NULL && i < _size; i++) {
+    if (_table[i]._signature != 0) {
+      count++;
+    }
+  }
+  return count;
+}
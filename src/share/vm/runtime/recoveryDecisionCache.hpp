@@ -0,0 +1,67 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYDECISIONCACHE_HPP
+#define SHARE_VM_RUNTIME_RECOVERYDECISIONCACHE_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/method.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/growableArray.hpp"
+
+class RecoveryAction;
+
+//
+// Recovery decisions taken under RecoveryTimeBudgetMicros, by failure site.
+//
+// A site is the class of the exception, the failure type and the frames of
+// the recovery context. The cache is direct mapped, a new decision replaces
+// whatever was in its slot. Entries refer to Methods and Klasses, so the whole
+// cache is dropped when classes are unloaded.
+//
+
+class RecoveryDecision VALUE_OBJ_CLASS_SPEC {
+ public:
+  uintptr_t _signature;        // 0 for an empty slot
+  Klass*    _exception_klass;
+  Method*   _top_method;
+  int       _top_bci;
+  int       _context_offset;
+  u1        _failure_type;
+  u1        _recovery_type;
+  u1        _early_return_type;
+  int       _early_return_offset;
+  int       _early_return_size_of_parameters;
+  Klass*    _target_exception_klass;
+};
+
+class RecoveryDecisionCache : AllStatic {
+ private:
+  static RecoveryDecision* _table;
+  static int               _size;      // a power of two
+  static volatile jint     _hits;
+  static volatile jint     _misses;
+
+  static RecoveryDecision* table();
+
+ public:
+  // Never 0. Depends on the failure type and recovery context of action.
+  static uintptr_t signature_for(GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                 RecoveryAction* action);
+
+  static bool is_enabled() { return RecoveryDecisionCacheSize > 0; }
+
+  // Fills in action and returns true if the site was decided before.
+  static bool lookup(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                     RecoveryAction* action);
+  static void record(GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                     RecoveryAction* action);
+
+  // Called at a safepoint when classes have been unloaded.
+  static void purge();
+
+  // For WhiteBox
+  static void clear();
+  static int  entry_count();
+  static jint hits()   { return _hits; }
+  static jint misses() { return _misses; }
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYDECISIONCACHE_HPP
@@ -0,0 +1,582 @@
+#include "precompiled.hpp"
+
+#include "oops/klass.hpp"
+#include "oops/method.hpp"
+#include "runtime/atomic.inline.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/orderAccess.inline.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryEventLog.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/runtimeRecoveryState.hpp"
+#include "utilities/growableArray.hpp"
+
+#ifndef O_BINARY       // if defined (Win32) use binary files.
+#define O_BINARY 0     // otherwise do nothing.
+#endif
+
+static const char recovery_event_log_magic[8] = { 'A', 'R', 'E', 'S', 'E', 'V', 'T', '\0' };
+static const juint recovery_event_log_version = 1;
+
+bool                     RecoveryEventLog::_active = false;
+RecoveryEventLogThread*  RecoveryEventLog::_writer = NULL;
+volatile bool            RecoveryEventLog::_should_terminate = false;
+volatile bool            RecoveryEventLog::_writer_terminated = false;
+RecoveryEventRing* volatile       RecoveryEventLog::_new_rings = NULL;
+RecoveryEventDefinition* volatile RecoveryEventLog::_new_definitions = NULL;
+volatile intptr_t*       RecoveryEventLog::_defined = NULL;
+volatile jint            RecoveryEventLog::_definition_count = 0;
+volatile jint            RecoveryEventLog::_purge_epoch = 0;
+RecoveryEventRing*       RecoveryEventLog::_rings = NULL;
+RecoveryEventDefinition* RecoveryEventLog::_definitions = NULL;
+RecoveryEventDefinition* RecoveryEventLog::_last_definition = NULL;
+int                      RecoveryEventLog::_fd = -1;
+int                      RecoveryEventLog::_file_index = -1;
+julong                   RecoveryEventLog::_file_size = 0;
+
+static size_t definition_size(RecoveryEvent* header) {
+  return sizeof(RecoveryEvent) + align_size_up(header->_data, BytesPerLong);
+}
+
+RecoveryEventRing::RecoveryEventRing(u4 thread_id, juint capacity) :
+  _capacity(capacity), _head(0), _tail(0), _dropped(0),
+  _thread_id(thread_id), _released(0), _next(NULL) {
+  _events = NEW_C_HEAP_ARRAY(RecoveryEvent, capacity, mtInternal);
+}
+
+RecoveryEventRing::~RecoveryEventRing() {
+  FREE_C_HEAP_ARRAY(RecoveryEvent, _events, mtInternal);
+}
+
+void RecoveryEventRing::push(RecoveryEvent* e) {
+  juint head = _head;
+  if (head - OrderAccess::load_acquire(&_tail) >= _capacity) {
+    Atomic::inc(&_dropped);
+    return;
+  }
+  e->_thread = _thread_id;
+  _events[head & (_capacity - 1)] = *e;
+  OrderAccess::release_store(&_head, head + 1);
+}
+
+juint RecoveryEventRing::drain(RecoveryEvent* buffer, juint max) {
+  juint tail = _tail;
+  juint head = OrderAccess::load_acquire(&_head);
+  juint n = MIN2(head - tail, max);
+  for (juint i = 0; i < n; i++) {
+    buffer[i] = _events[(tail + i) & (_capacity - 1)];
+  }
+  OrderAccess::release_store(&_tail, tail + n);
+  return n;
+}
+
+RecoveryEventLogThread::RecoveryEventLogThread() : NamedThread() {
+  set_name("Recovery Event Log Thread");
+}
+
+void RecoveryEventLogThread::run() {
+  this->record_stack_base_and_size();
+  this->initialize_thread_local_storage();
+
+  while (true) {
+    {
+      MutexLockerEx ml(RecoveryEventLog_lock, Mutex::_no_safepoint_check_flag);
+      if (!RecoveryEventLog::_should_terminate) {
+        RecoveryEventLog_lock->wait(Mutex::_no_safepoint_check_flag, RecoveryEventLogFlushInterval);
+      }
+      if (RecoveryEventLog::_should_terminate) {
+        break;
+      }
+    }
+    RecoveryEventLog::flush();
+  }
+
+  // The last flush, then let stop() go on.
+  RecoveryEventLog::flush();
+  if (RecoveryEventLog::_fd >= 0) {
+    os::close(RecoveryEventLog::_fd);
+    RecoveryEventLog::_fd = -1;
+  }
+  MutexLockerEx ml(RecoveryEventLog_lock, Mutex::_no_safepoint_check_flag);
+  RecoveryEventLog::_writer_terminated = true;
+  RecoveryEventLog_lock->notify_all();
+}
+
+void RecoveryEventLog::initialize() {
+  if (RecoveryEventLogFile == NULL) {
+    return;
+  }
+  if (RecoveryEventBufferSize <= 0 || !is_power_of_2(RecoveryEventBufferSize)) {
+    warning("RecoveryEventBufferSize must be a power of two, the recovery event log is disabled.");
+    return;
+  }
+
+  _defined = NEW_C_HEAP_ARRAY(intptr_t, _defined_table_size, mtInternal);
+  memset((void*)_defined, 0, _defined_table_size * sizeof(intptr_t));
+
+  // The writer is not running yet, the file is ours.
+  if (!open_next_file()) {
+    return;
+  }
+
+  _writer = new RecoveryEventLogThread();
+  if (_writer == NULL || !os::create_thread(_writer, os::os_thread)) {
+    warning("Unable to create the recovery event log thread.");
+    return;
+  }
+  os::start_thread(_writer);
+  _active = true;
+}
+
+void RecoveryEventLog::stop() {
+  if (!_active) {
+    return;
+  }
+  // The writer does the last flush; do not wait forever for a stuck write.
+  MutexLockerEx ml(RecoveryEventLog_lock, Mutex::_no_safepoint_check_flag);
+  _should_terminate = true;
+  RecoveryEventLog_lock->notify_all();
+  jlong deadline = os::javaTimeMillis() + MAX2(RecoveryEventLogFlushInterval, (intx)1000);
+  while (!_writer_terminated) {
+    jlong remaining = deadline - os::javaTimeMillis();
+    if (remaining <= 0) {
+      break;
+    }
+    RecoveryEventLog_lock->wait(Mutex::_no_safepoint_check_flag, remaining);
+  }
+  _active = false;
+}
+
+bool RecoveryEventLog::open_next_file() {
+  if (_fd >= 0) {
+    os::close(_fd);
+    _fd = -1;
+  }
+  _file_index = (_file_index + 1) % MAX2((int)RecoveryEventLogFileCount, 1);
+
+  char name[JVM_MAXPATHLEN];
+  jio_snprintf(name, sizeof(name), "%s.%d", RecoveryEventLogFile, _file_index);
+  _fd = os::open(name, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+  if (_fd < 0) {
+    warning("Unable to open recovery event log file %s.", name);
+    return false;
+  }
+  _file_size = 0;
+
+  juint header[2] = { recovery_event_log_version, (juint)sizeof(RecoveryEvent) };
+  write_bytes(recovery_event_log_magic, sizeof(recovery_event_log_magic));
+  write_bytes(header, sizeof(header));
+
+  // A new file starts with every live definition, retired ones included
+  // until the events which use them have been written.
+  take_new_definitions(false);
+  for (RecoveryEventDefinition* d = _definitions; d != NULL; d = d->_next) {
+    write_bytes(d->record(), d->_size);
+  }
+  return true;
+}
+
+void RecoveryEventLog::write_bytes(const void* buf, size_t size) {
+  if (_fd < 0) {
+    return;
+  }
+  if (os::write(_fd, buf, size) != size) {
+    warning("Unable to write to recovery event log file %s.%d.", RecoveryEventLogFile, _file_index);
+    os::close(_fd);
+    _fd = -1;
+    return;
+  }
+  _file_size += size;
+}
+
+// Moves the queued definitions to the end of the live ones, in the order
+// they were defined, and writes them to the current file if write is set.
+void RecoveryEventLog::take_new_definitions(bool write) {
+  RecoveryEventDefinition* list =
+    (RecoveryEventDefinition*)Atomic::xchg_ptr(NULL, (volatile void*)&_new_definitions);
+  RecoveryEventDefinition* reversed = NULL;
+  while (list != NULL) {
+    RecoveryEventDefinition* next = list->_next;
+    list->_next = reversed;
+    reversed = list;
+    list = next;
+  }
+  for (RecoveryEventDefinition* d = reversed; d != NULL; ) {
+    RecoveryEventDefinition* next = d->_next;
+    d->_next = NULL;
+    if (_last_definition == NULL) {
+      _definitions = d;
+    } else {
+      _last_definition->_next = d;
+    }
+    _last_definition = d;
+    if (write) {
+      write_bytes(d->record(), d->_size);
+    }
+    d = next;
+  }
+}
+
+// Frees the definitions made before the classes were unloaded in epoch.
+void RecoveryEventLog::retire_definitions(jint epoch) {
+  RecoveryEventDefinition** p = &_definitions;
+  _last_definition = NULL;
+  while (*p != NULL) {
+    RecoveryEventDefinition* d = *p;
+    if (d->_epoch < epoch) {
+      *p = d->_next;
+      FREE_C_HEAP_ARRAY(char, (char*)d, mtInternal);
+      Atomic::dec(&_definition_count);
+    } else {
+      _last_definition = d;
+      p = &d->_next;
+    }
+  }
+}
+
+void RecoveryEventLog::flush() {
+  RecoveryEvent buffer[_drain_buffer_size];
+
+  // Events logged before an unloading are in the rings by now, they are
+  // the last ones to need the definitions made before it.
+  jint epoch = OrderAccess::load_acquire(&_purge_epoch);
+
+  // Adopt the rings of new threads.
+  RecoveryEventRing* list = (RecoveryEventRing*)Atomic::xchg_ptr(NULL, (volatile void*)&_new_rings);
+  while (list != NULL) {
+    RecoveryEventRing* next = list->_next;
+    list->_next = _rings;
+    _rings = list;
+    list = next;
+  }
+
+  RecoveryEventRing** p = &_rings;
+  while (*p != NULL) {
+    RecoveryEventRing* ring = *p;
+    if (_file_size >= RecoveryEventLogFileSize && RecoveryEventLogFileCount > 1) {
+      open_next_file();
+    }
+    // A ring released before it is drained gets no more events.
+    bool released = OrderAccess::load_acquire(&ring->_released) != 0;
+
+    jint dropped = Atomic::xchg(0, &ring->_dropped);
+    if (dropped > 0) {
+      RecoveryEvent e;
+      memset(&e, 0, sizeof(RecoveryEvent));
+      e._time = os::javaTimeNanos();
+      e._type = RecoveryEvent::_dropped;
+      e._thread = ring->_thread_id;
+      e._data = dropped;
+      write_bytes(&e, sizeof(RecoveryEvent));
+    }
+
+    juint n;
+    while ((n = ring->drain(buffer, _drain_buffer_size)) > 0) {
+      write_bytes(buffer, n * sizeof(RecoveryEvent));
+    }
+    // The definitions of the drained events were queued before them.
+    take_new_definitions(true);
+
+    if (released) {
+      *p = ring->_next;
+      delete ring;
+    } else {
+      p = &ring->_next;
+    }
+  }
+
+  retire_definitions(epoch);
+}
+
+RecoveryEventRing* RecoveryEventLog::ring_for(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  RecoveryEventRing* ring = state->event_ring();
+  if (ring == NULL) {
+    ring = new RecoveryEventRing((u4)thread->osthread()->thread_id(), (juint)RecoveryEventBufferSize);
+    RecoveryEventRing* head;
+    do {
+      head = (RecoveryEventRing*)OrderAccess::load_ptr_acquire((volatile void*)&_new_rings);
+      ring->_next = head;
+    } while (Atomic::cmpxchg_ptr(ring, (volatile void*)&_new_rings, head) != head);
+    state->set_event_ring(ring);
+  }
+  return ring;
+}
+
+void RecoveryEventLog::release(RecoveryEventRing* ring) {
+  OrderAccess::release_store(&ring->_released, 1);
+}
+
+void RecoveryEventLog::purge() {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
+  if (!_active) {
+    return;
+  }
+  // No recovering thread is defining anything at the safepoint. The
+  // definitions made so far are retired by the writer's next flush.
+  memset((void*)_defined, 0, _defined_table_size * sizeof(intptr_t));
+  OrderAccess::release_store(&_purge_epoch, _purge_epoch + 1);
+}
+
+// Defines m the first time it is seen. The table of defined addresses is
+// probed without a lock; if it is too crowded m is left undefined and
+// decodes as its address.
+void RecoveryEventLog::define(Metadata* m, bool is_method) {
+  if (m == NULL) {
+    return;
+  }
+  const intptr_t key = (intptr_t)m;
+  const int probe_limit = 16;
+  unsigned int h = (unsigned int)(key ^ (key >> 16));
+  bool inserted = false;
+  for (int i = 0; i < probe_limit && !inserted; i++) {
+    volatile intptr_t* slot = &_defined[(h + i) & (_defined_table_size - 1)];
+    intptr_t cur = *slot;
+    if (cur == key) {
+      return;
+    }
+    if (cur == 0) {
+      cur = Atomic::cmpxchg_ptr(key, slot, (intptr_t)0);
+      if (cur == 0) {
+        inserted = true;
+      } else if (cur == key) {
+        return;
+      }
+    }
+  }
+  if (!inserted) {
+    return;
+  }
+  if (Atomic::add(1, &_definition_count) > _defined_table_size) {
+    Atomic::dec(&_definition_count);
+    return;
+  }
+
+  ResourceMark rm;
+  const char* name = is_method ? ((Method*)m)->name_and_sig_as_C_string() : ((Klass*)m)->external_name();
+  size_t length = strlen(name);
+
+  RecoveryEvent header;
+  memset(&header, 0, sizeof(RecoveryEvent));
+  header._time = os::javaTimeNanos();
+  header._type = is_method ? RecoveryEvent::_define_method : RecoveryEvent::_define_klass;
+  header._method = (uintptr_t)m;
+  header._data = (s4)length;
+
+  size_t size = definition_size(&header);
+  RecoveryEventDefinition* d = (RecoveryEventDefinition*)
+    NEW_C_HEAP_ARRAY(char, sizeof(RecoveryEventDefinition) + size, mtInternal);
+  d->_epoch = _purge_epoch;
+  d->_size = size;
+  memset(d->record(), 0, size);
+  memcpy(d->record(), &header, sizeof(RecoveryEvent));
+  memcpy(d->record() + sizeof(RecoveryEvent), name, length);
+
+  RecoveryEventDefinition* head;
+  do {
+    head = (RecoveryEventDefinition*)OrderAccess::load_ptr_acquire((volatile void*)&_new_definitions);
+    d->_next = head;
+  } while (Atomic::cmpxchg_ptr(d, (volatile void*)&_new_definitions, head) != head);
+}
+
+void RecoveryEventLog::push(JavaThread* thread, RecoveryEvent* e) {
+  e->_time = os::javaTimeNanos();
+  ring_for(thread)->push(e);
+}
+
+void RecoveryEventLog::log_failure(JavaThread* thread, Method* m, int bci, int failure_type, int context_offset) {
+  define(m, true);
+  RecoveryEvent e;
+  memset(&e, 0, sizeof(RecoveryEvent));
+  e._type = RecoveryEvent::_failure;
+  e._method = (uintptr_t)m;
+  e._bci = bci;
+  e._arg = (u2)failure_type;
+  e._data = context_offset;
+  push(thread, &e);
+}
+
+void RecoveryEventLog::log_strategy(JavaThread* thread, Method* m, int bci, int strategy, bool found, jlong nanos) {
+  define(m, true);
+  RecoveryEvent e;
+  memset(&e, 0, sizeof(RecoveryEvent));
+  e._type = RecoveryEvent::_strategy;
+  e._method = (uintptr_t)m;
+  e._bci = bci;
+  e._arg = (u2)strategy;
+  e._data = found ? 1 : 0;
+  e._value = nanos;
+  push(thread, &e);
+}
+
+void RecoveryEventLog::log_timeout(JavaThread* thread, int strategy) {
+  RecoveryEvent e;
+  memset(&e, 0, sizeof(RecoveryEvent));
+  e._type = RecoveryEvent::_timeout;
+  e._arg = (u2)strategy;
+  push(thread, &e);
+}
+
+void RecoveryEventLog::log_error_transformation(JavaThread* thread, Method* m, int bci, Klass* target) {
+  define(m, true);
+  define(target, false);
+  RecoveryEvent e;
+  memset(&e, 0, sizeof(RecoveryEvent));
+  e._type = RecoveryEvent::_error_transformation;
+  e._method = (uintptr_t)m;
+  e._bci = bci;
+  e._value = (jlong)(uintptr_t)target;
+  push(thread, &e);
+}
+
+void RecoveryEventLog::log_early_return(JavaThread* thread, Method* m, int bci, BasicType type, int offset) {
+  define(m, true);
+  RecoveryEvent e;
+  memset(&e, 0, sizeof(RecoveryEvent));
+  e._type = RecoveryEvent::_early_return;
+  e._method = (uintptr_t)m;
+  e._bci = bci;
+  e._arg = (u2)type;
+  e._data = offset;
+  push(thread, &e);
+}
+
+void RecoveryEventLog::log_recovery(JavaThread* thread, Method* m, int bci, int recovery_type, jlong nanos) {
+  define(m, true);
+  RecoveryEvent e;
+  memset(&e, 0, sizeof(RecoveryEvent));
+  e._type = RecoveryEvent::_recovery;
+  e._method = (uintptr_t)m;
+  e._bci = bci;
+  e._arg = (u2)recovery_type;
+  e._value = nanos;
+  push(thread, &e);
+}
+
+// Decoding
+
+class RecoveryEventName VALUE_OBJ_CLASS_SPEC {
+ public:
+  uintptr_t   _id;
+  const char* _name;
+};
+
+static const char* name_for(GrowableArray<RecoveryEventName>* names, uintptr_t id, char* buf, size_t buflen) {
+  // the latest definition wins
+  for (int i = names->length() - 1; i >= 0; i--) {
+    if (names->at(i)._id == id) {
+      return names->at(i)._name;
+    }
+  }
+  jio_snprintf(buf, buflen, INTPTR_FORMAT, id);
+  return buf;
+}
+
+bool RecoveryEventLog::decode(const char* path, outputStream* st) {
+  struct stat stat_buf;
+  if (os::stat(path, &stat_buf) != 0) {
+    st->print_cr("[Ares] Unable to find recovery event log file %s.", path);
+    return false;
+  }
+  int fd = os::open(path, O_RDONLY | O_BINARY, 0);
+  if (fd < 0) {
+    st->print_cr("[Ares] Unable to open recovery event log file %s.", path);
+    return false;
+  }
+  size_t size = (size_t)stat_buf.st_size;
+  char* buffer = NEW_C_HEAP_ARRAY(char, size + 1, mtInternal);
+  size_t n = os::read(fd, buffer, (unsigned int)size);
+  os::close(fd);
+
+  const size_t header_size = sizeof(recovery_event_log_magic) + 2 * sizeof(juint);
+  if (n != size || size < header_size ||
+      memcmp(buffer, recovery_event_log_magic, sizeof(recovery_event_log_magic)) != 0) {
+    st->print_cr("[Ares] %s is not a recovery event log file.", path);
+    FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+    return false;
+  }
+  juint* header = (juint*)(buffer + sizeof(recovery_event_log_magic));
+  if (header[0] != recovery_event_log_version || header[1] != sizeof(RecoveryEvent)) {
+    st->print_cr("[Ares] Unsupported recovery event log file %s (version %u, event size %u).",
+        path, header[0], header[1]);
+    FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+    return false;
+  }
+
+  ResourceMark rm;
+  GrowableArray<RecoveryEventName>* names = new GrowableArray<RecoveryEventName>(256);
+
+  // Definitions may follow the first events which use them, collect them first.
+  for (size_t pos = header_size; pos + sizeof(RecoveryEvent) <= size; ) {
+    RecoveryEvent* e = (RecoveryEvent*)(buffer + pos);
+    if (e->_type == RecoveryEvent::_define_method || e->_type == RecoveryEvent::_define_klass) {
+      size_t record_size = definition_size(e);
+      if (pos + record_size > size) {
+        break;
+      }
+      RecoveryEventName name;
+      name._id = e->_method;
+      name._name = NEW_RESOURCE_ARRAY(char, e->_data + 1);
+      memcpy((char*)name._name, buffer + pos + sizeof(RecoveryEvent), e->_data);
+      ((char*)name._name)[e->_data] = '\0';
+      names->append(name);
+      pos += record_size;
+    } else {
+      pos += sizeof(RecoveryEvent);
+    }
+  }
+
+  jlong start = -1;
+  char buf1[32];
+  char buf2[32];
+  for (size_t pos = header_size; pos + sizeof(RecoveryEvent) <= size; ) {
+    RecoveryEvent* e = (RecoveryEvent*)(buffer + pos);
+    if (e->_type == RecoveryEvent::_define_method || e->_type == RecoveryEvent::_define_klass) {
+      pos += definition_size(e);
+      continue;
+    }
+    pos += sizeof(RecoveryEvent);
+
+    if (start < 0) {
+      start = e->_time;
+    }
+    st->print("%12.6f [%u] ", (double)(e->_time - start) / NANOSECS_PER_SEC, e->_thread);
+    const char* site = name_for(names, e->_method, buf1, sizeof(buf1));
+    switch (e->_type) {
+    case RecoveryEvent::_failure:
+      st->print_cr("failure %s@%d: %s, recovery context offset=%d", site, e->_bci,
+          RecoveryOracle::failure_type_name((RecoveryOracle::FailureType)e->_arg), e->_data);
+      break;
+    case RecoveryEvent::_strategy:
+      st->print_cr("strategy %s@%d: %s %s in " JLONG_FORMAT "ns", site, e->_bci,
+          RecoveryOracle::strategy_name((RecoveryOracle::Strategy)e->_arg),
+          e->_data != 0 ? "found an action" : "found nothing", e->_value);
+      break;
+    case RecoveryEvent::_timeout:
+      st->print_cr("out of time budget at strategy %s",
+          RecoveryOracle::strategy_name((RecoveryOracle::Strategy)e->_arg));
+      break;
+    case RecoveryEvent::_error_transformation:
+      st->print_cr("error transformation %s@%d: to %s", site, e->_bci,
+          name_for(names, (uintptr_t)e->_value, buf2, sizeof(buf2)));
+      break;
+    case RecoveryEvent::_early_return:
+      st->print_cr("early return %s@%d: offset=%d, return type=%s", site, e->_bci, e->_data,
+          type2name((BasicType)e->_arg));
+      break;
+    case RecoveryEvent::_recovery:
+      st->print_cr("recovery %s@%d: %s in " JLONG_FORMAT "ns", site, e->_bci,
+          RecoveryOracle::recovery_type_name((RecoveryOracle::RecoveryType)e->_arg), e->_value);
+      break;
+    case RecoveryEvent::_dropped:
+      st->print_cr("%d events dropped", e->_data);
+      break;
+    default:
+      st->print_cr("unknown event %d", e->_type);
+      break;
+    }
+  }
+
+  FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+  return true;
+}
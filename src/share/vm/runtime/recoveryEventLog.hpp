@@ -0,0 +1,161 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYEVENTLOG_HPP
+#define SHARE_VM_RUNTIME_RECOVERYEVENTLOG_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/ostream.hpp"
+
+//
+// Binary recovery event log, -XX:RecoveryEventLogFile=<file>.
+//
+// TraceRuntimeRecovery formats every line on the recovering thread while
+// holding the tty lock. The event log instead has each JavaThread append
+// fixed size RecoveryEvents to its own ring; the ring has a single producer
+// and a single consumer, so pushing an event takes no lock. The
+// RecoveryEventLogThread drains all rings every RecoveryEventLogFlushInterval
+// ms into <file>.<n>, moving on to the next of RecoveryEventLogFileCount
+// files when one grows over RecoveryEventLogFileSize. A full ring drops the
+// event and the writer records how many were dropped.
+//
+// Methods and classes are identified by their address. The first time an
+// address is logged, the thread which logs it queues a definition record
+// with its name. New rings and definitions are queued with a CAS, recovering
+// threads never take RecoveryEventLog_lock; the writer only holds it to wait
+// for the next flush, never while writing. Every file starts with all live
+// definitions. When classes are unloaded the table of defined addresses is
+// cleared, so an address reused later is defined again, and the definitions
+// made before are retired once the events logged before have been written.
+//
+// -XX:DecodeRecoveryEventLog=<file> prints a log file as text and exits.
+//
+
+class RecoveryEvent VALUE_OBJ_CLASS_SPEC {
+ public:
+  enum Type {
+    _no_event,
+    _failure,                // site, _arg: failure type, _data: context offset
+    _strategy,               // site, _arg: strategy, _data: 1 if it found an action, _value: nanos
+    _timeout,                // _arg: strategy
+    _error_transformation,   // site, _value: id of the target class
+    _early_return,           // site, _arg: return type, _data: offset
+    _recovery,               // site, _arg: recovery type, _value: nanos
+    _dropped,                // _data: events dropped by the thread
+    _define_method,          // _method: id, _data: length of the name which follows
+    _define_klass,           // _method: id, _data: length of the name which follows
+    _type_limit
+  };
+
+  jlong     _time;           // os::javaTimeNanos()
+  jlong     _value;
+  uintptr_t _method;         // id of a Method, or of a Klass for definitions
+  u4        _thread;         // os thread id
+  u2        _type;
+  u2        _arg;
+  s4        _data;
+  s4        _bci;
+};
+
+// A definition record queued by a recovering thread, followed by the
+// RecoveryEvent header and the name written to the file.
+class RecoveryEventDefinition VALUE_OBJ_CLASS_SPEC {
+ public:
+  RecoveryEventDefinition* _next;
+  jint                     _epoch;      // RecoveryEventLog::_purge_epoch when defined
+  size_t                   _size;       // of the record in the file
+
+  char* record() const { return (char*)(this + 1); }
+};
+
+class RecoveryEventRing : public CHeapObj<mtInternal> {
+  friend class RecoveryEventLog;
+ private:
+  RecoveryEvent*     _events;
+  juint              _capacity;   // a power of two
+  volatile juint     _head;       // written by the owning thread
+  volatile juint     _tail;       // written by the writer
+  volatile jint      _dropped;
+  u4                 _thread_id;
+  volatile jint      _released;   // the owning thread has exited
+  RecoveryEventRing* _next;
+
+ public:
+  RecoveryEventRing(u4 thread_id, juint capacity);
+  ~RecoveryEventRing();
+
+  // Called by the owning thread only.
+  void push(RecoveryEvent* e);
+  // Called by the writer only, returns the number of events copied.
+  juint drain(RecoveryEvent* buffer, juint max);
+};
+
+class RecoveryEventLogThread : public NamedThread {
+ public:
+  RecoveryEventLogThread();
+
+  virtual void run();
+  bool is_hidden_from_external_view() const { return true; }
+};
+
+class RecoveryEventLog : AllStatic {
+  friend class RecoveryEventLogThread;
+ private:
+  enum {
+    _defined_table_size = 4096,    // a power of two
+    _drain_buffer_size  = 256
+  };
+
+  static bool                    _active;
+  static RecoveryEventLogThread* _writer;
+  static volatile bool           _should_terminate;
+  static volatile bool           _writer_terminated;
+
+  // Queued by recovering threads
+  static RecoveryEventRing* volatile       _new_rings;
+  static RecoveryEventDefinition* volatile _new_definitions;
+  static volatile intptr_t*      _defined;        // addresses with a definition
+  static volatile jint           _definition_count;
+  static volatile jint           _purge_epoch;
+
+  // Owned by the writer
+  static RecoveryEventRing*      _rings;
+  static RecoveryEventDefinition* _definitions;   // live definitions, in order
+  static RecoveryEventDefinition* _last_definition;
+  static int                     _fd;
+  static int                     _file_index;
+  static julong                  _file_size;
+
+  static RecoveryEventRing* ring_for(JavaThread* thread);
+  static void define(Metadata* m, bool is_method);
+  static void push(JavaThread* thread, RecoveryEvent* e);
+
+  static bool open_next_file();
+  static void write_bytes(const void* buf, size_t size);
+  static void take_new_definitions(bool write);
+  static void retire_definitions(jint epoch);
+  static void flush();
+
+ public:
+  static bool is_enabled() { return _active; }
+
+  // Called during VM initialization and exit.
+  static void initialize();
+  static void stop();
+
+  // Called by a thread when it exits.
+  static void release(RecoveryEventRing* ring);
+  // Called at a safepoint when classes have been unloaded.
+  static void purge();
+
+  static void log_failure(JavaThread* thread, Method* m, int bci, int failure_type, int context_offset);
+  static void log_strategy(JavaThread* thread, Method* m, int bci, int strategy, bool found, jlong nanos);
+  static void log_timeout(JavaThread* thread, int strategy);
+  static void log_error_transformation(JavaThread* thread, Method* m, int bci, Klass* target);
+  static void log_early_return(JavaThread* thread, Method* m, int bci, BasicType type, int offset);
+  static void log_recovery(JavaThread* thread, Method* m, int bci, int recovery_type, jlong nanos);
+
+  // Prints the events of a log file as text.
+  static bool decode(const char* path, outputStream* st);
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYEVENTLOG_HPP
@@ -0,0 +1,165 @@
+#include "precompiled.hpp"
+
+#include "runtime/atomic.inline.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryIndex.hpp"
+#include "runtime/recoveryOracle.hpp"
+
+#ifndef O_BINARY       // if defined (Win32) use binary files.
+#define O_BINARY 0     // otherwise do nothing.
+#endif
+
+RecoveryIndexEntry** RecoveryIndex::_buckets = NULL;
+int                  RecoveryIndex::_bucket_count = 0;
+int                  RecoveryIndex::_entry_count = 0;
+volatile jint        RecoveryIndex::_load_claimed = 0;
+
+unsigned int RecoveryIndex::hash_for(const char* key, size_t length) {
+  unsigned int h = 0;
+  for (size_t i = 0; i < length; i++) {
+    h = 31 * h + (unsigned int)(unsigned char)key[i];
+  }
+  return h;
+}
+
+bool RecoveryIndex::contains_locked(const char* key, size_t length, unsigned int hash) {
+  assert_lock_strong(RecoveryIndex_lock);
+  if (_buckets == NULL) {
+    return false;
+  }
+  for (RecoveryIndexEntry* e = _buckets[hash % _bucket_count]; e != NULL; e = e->_next) {
+    if (e->_hash == hash && strncmp(e->_key, key, length) == 0 && e->_key[length] == '\0') {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RecoveryIndex::grow_locked() {
+  assert_lock_strong(RecoveryIndex_lock);
+  int new_count = _bucket_count == 0 ? 1009 : _bucket_count * 2 + 1;
+  RecoveryIndexEntry** new_buckets = NEW_C_HEAP_ARRAY(RecoveryIndexEntry*, new_count, mtInternal);
+  memset(new_buckets, 0, new_count * sizeof(RecoveryIndexEntry*));
+  for (int i = 0; i < _bucket_count; i++) {
+    RecoveryIndexEntry* e = _buckets[i];
+    while (e != NULL) {
+      RecoveryIndexEntry* next = e->_next;
+      int b = e->_hash % new_count;
+      e->_next = new_buckets[b];
+      new_buckets[b] = e;
+      e = next;
+    }
+  }
+  if (_buckets != NULL) {
+    FREE_C_HEAP_ARRAY(RecoveryIndexEntry*, _buckets, mtInternal);
+  }
+  _buckets = new_buckets;
+  _bucket_count = new_count;
+}
+
+bool RecoveryIndex::add_locked(const char* key, size_t length) {
+  assert_lock_strong(RecoveryIndex_lock);
+  unsigned int hash = hash_for(key, length);
+  if (contains_locked(key, length, hash)) {
+    return false;
+  }
+  if (_entry_count >= _bucket_count * 2) {
+    grow_locked();
+  }
+
+  RecoveryIndexEntry* e = new RecoveryIndexEntry();
+  e->_hash = hash;
+  e->_key = NEW_C_HEAP_ARRAY(char, length + 1, mtInternal);
+  memcpy(e->_key, key, length);
+  e->_key[length] = '\0';
+
+  int b = hash % _bucket_count;
+  e->_next = _buckets[b];
+  _buckets[b] = e;
+  _entry_count++;
+  return true;
+}
+
+void RecoveryIndex::load(const char* path) {
+  struct stat st;
+  if (os::stat(path, &st) != 0) {
+    tty->print_cr("[Ares] Unable to find recovery index file %s.", path);
+    return;
+  }
+  int fd = os::open(path, O_RDONLY | O_BINARY, 0);
+  if (fd < 0) {
+    tty->print_cr("[Ares] Unable to open recovery index file %s.", path);
+    return;
+  }
+
+  size_t size = (size_t)st.st_size;
+  char* buffer = NEW_C_HEAP_ARRAY(char, size + 1, mtInternal);
+  size_t n = os::read(fd, buffer, (unsigned int)size);
+  os::close(fd);
+  if (n != size) {
+    tty->print_cr("[Ares] Unable to read recovery index file %s.", path);
+    FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+    return;
+  }
+  buffer[size] = '\0';
+
+  int count;
+  {
+    MutexLockerEx ml(RecoveryIndex_lock, Mutex::_no_safepoint_check_flag);
+    char* line = buffer;
+    while (line < buffer + size) {
+      char* end = strchr(line, '\n');
+      if (end == NULL) {
+        end = buffer + size;
+      }
+      size_t length = end - line;
+      if (length > 0 && line[length - 1] == '\r') {
+        length--;
+      }
+      if (length > 0) {
+        add_locked(line, length);
+      }
+      line = end + 1;
+    }
+    count = _entry_count;
+  }
+  FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+
+  if ((TraceRuntimeRecovery & TRACE_USE_REDIS) != 0) {
+    tty->print_cr("[Ares] Loaded %d known handler keys from %s", count, path);
+  }
+}
+
+// The file is read by the first thread which looks up a key. Threads
+// arriving while it is being read do not wait, they miss and fall back
+// to the next strategy.
+void RecoveryIndex::load_if_needed() {
+  if (_load_claimed != 0 || RecoveryIndexFile == NULL) {
+    return;
+  }
+  if (Atomic::cmpxchg(1, &_load_claimed, 0) == 0) {
+    load(RecoveryIndexFile);
+  }
+}
+
+bool RecoveryIndex::contains(const char* key) {
+  if (!is_enabled()) {
+    return false;
+  }
+  load_if_needed();
+
+  size_t length = strlen(key);
+  MutexLockerEx ml(RecoveryIndex_lock, Mutex::_no_safepoint_check_flag);
+  return contains_locked(key, length, hash_for(key, length));
+}
+
+bool RecoveryIndex::add(const char* key) {
+  if (!is_enabled()) {
+    return false;
+  }
+  load_if_needed();
+
+  MutexLockerEx ml(RecoveryIndex_lock, Mutex::_no_safepoint_check_flag);
+  return add_locked(key, strlen(key));
+}
@@ -0,0 +1,56 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYINDEX_HPP
+#define SHARE_VM_RUNTIME_RECOVERYINDEX_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/globals.hpp"
+
+//
+// A local set of known handler keys.
+//
+// The keys are the ones the oracle probes in redis, e.g.
+//
+//   <RedisKeyPrefix>-fuzzing:<exception class>:<bci>:<method>:...
+//
+// RecoveryIndexFile holds one key per line, as written by
+//
+//   redis-cli --scan --pattern '<RedisKeyPrefix>-*'
+//
+// A lookup is a hash probe in the VM, so the index is tried before redis.
+// With PrefetchRecoveryHandlers the index also holds the keys fetched from
+// redis, see recoveryPrefetch.hpp, with or without a file.
+//
+
+class RecoveryIndexEntry : public CHeapObj<mtInternal> {
+ public:
+  unsigned int        _hash;
+  char*               _key;
+  RecoveryIndexEntry* _next;
+};
+
+class RecoveryIndex : AllStatic {
+ private:
+  static RecoveryIndexEntry** _buckets;
+  static int                  _bucket_count;
+  static int                  _entry_count;
+  static volatile jint        _load_claimed;
+
+  static unsigned int hash_for(const char* key, size_t length);
+  static bool contains_locked(const char* key, size_t length, unsigned int hash);
+  static bool add_locked(const char* key, size_t length);
+  static void grow_locked();
+
+  static void load(const char* path);
+  static void load_if_needed();
+
+ public:
+  static bool is_enabled() { return RecoveryIndexFile != NULL || PrefetchRecoveryHandlers; }
+
+  static bool contains(const char* key);
+
+  // Returns false if the key was already known.
+  static bool add(const char* key);
+
+  static int entry_count() { return _entry_count; }
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYINDEX_HPP
@@ -0,0 +1,741 @@
+#include "precompiled.hpp"
+
+#include "classfile/classLoader.hpp"
+#include "classfile/symbolTable.hpp"
+#include "classfile/systemDictionary.hpp"
+#include "classfile/vmSymbols.hpp"
+#include "interpreter/bytecode.hpp"
+#include "interpreter/bytecodeStream.hpp"
+#include "memory/filemap.hpp"
+#include "memory/metaspaceShared.hpp"
+#include "oops/constantPool.hpp"
+#include "oops/instanceKlass.hpp"
+#include "runtime/arguments.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryMetadata.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/signature.hpp"
+
+#ifndef O_BINARY       // if defined (Win32) use binary files.
+#define O_BINARY 0     // otherwise do nothing.
+#endif
+
+RecoveryMetadataArchive* RecoveryMetadata::_archive = NULL;
+volatile bool            RecoveryMetadata::_load_attempted = false;
+RecoveryMetadataArchive* RecoveryMetadata::_shared_archive = NULL;
+volatile bool            RecoveryMetadata::_shared_attempted = false;
+
+static unsigned int hash_symbol(unsigned int h, Symbol* s) {
+  for (int i = 0; i < s->utf8_length(); i++) {
+    h = 31 * h + (unsigned int)s->byte_at(i);
+  }
+  return 31 * h + ':';
+}
+
+unsigned int RecoveryMetadata::hash_for(Symbol* holder, Symbol* name, Symbol* signature) {
+  unsigned int h = 0;
+  h = hash_symbol(h, holder);
+  h = hash_symbol(h, name);
+  h = hash_symbol(h, signature);
+  return h;
+}
+
+u4 RecoveryMetadata::class_fingerprint(InstanceKlass* holder) {
+  unsigned int h = holder->major_version();
+  h = 31 * h + holder->minor_version();
+  h = 31 * h + (unsigned int)holder->constants()->length();
+  h = 31 * h + (unsigned int)holder->methods()->length();
+  h = 31 * h + (unsigned int)holder->java_fields_count();
+  Klass* super = holder->super();
+  if (super != NULL) {
+    h = hash_symbol(h, super->name());
+  }
+  return (u4)h;
+}
+
+// The bytecodes are hashed in their java form, the rewriter and breakpoints
+// change the code array but neither the instructions nor their bcis.
+u4 RecoveryMetadata::method_fingerprint(Method* m) {
+  methodHandle method(Thread::current(), m);
+  unsigned int h = (unsigned int)method->code_size();
+  h = 31 * h + (unsigned int)method->max_locals();
+  if (!method->is_native() && !method->is_abstract()) {
+    BytecodeStream bs(method);
+    Bytecodes::Code code;
+    while ((code = bs.next()) >= 0) {
+      h = 31 * h + (unsigned int)bs.bci();
+      h = 31 * h + (unsigned int)code;
+    }
+  }
+  ConstantPool* pool = method->constants();
+  ExceptionTable table(method());
+  for (int i = 0; i < table.length(); i++) {
+    h = 31 * h + table.start_pc(i);
+    h = 31 * h + table.end_pc(i);
+    h = 31 * h + table.handler_pc(i);
+    int klass_index = table.catch_type_index(i);
+    if (klass_index != 0) {
+      h = hash_symbol(h, pool->klass_name_at(klass_index));
+    }
+  }
+  return (u4)h;
+}
+
+static bool is_trivial_name(Symbol* name) {
+  return name == vmSymbols::java_lang_Throwable() || name == vmSymbols::java_lang_Exception();
+}
+
+static u2 klass_flags(Klass* k) {
+  u2 flags = 0;
+  if (k->oop_is_instance()) {
+    if (InstanceKlass::cast(k)->find_method(vmSymbols::object_initializer_name(),
+                                            vmSymbols::string_void_signature()) != NULL) {
+      flags |= RecoveryHandlerEntry::_has_string_init;
+    }
+  }
+  return flags;
+}
+
+// Resolve the catch type called name the way the holder's constant pool
+// would, through the holder's loader, without loading anything. Returns
+// false when that loader has not loaded the class yet, the caller then
+// resolves the exception table entry itself.
+static bool find_catch_klass(InstanceKlass* holder, const char* name, Klass** result) {
+  Thread* THREAD = Thread::current();
+  TempNewSymbol sym = SymbolTable::probe(name, (int)strlen(name));
+  if (sym == NULL) {
+    return false;
+  }
+  Handle loader(THREAD, holder->class_loader());
+  Handle protection_domain(THREAD, holder->protection_domain());
+  Klass* k = SystemDictionary::find(sym, loader, protection_domain, THREAD);
+  if (HAS_PENDING_EXCEPTION) {
+    CLEAR_PENDING_EXCEPTION;
+    return false;
+  }
+  *result = k;
+  return k != NULL;
+}
+
+const RecoveryInvokeSite* RecoveryMethodRecord::invoke_site_at(int bci) const {
+  RecoveryInvokeSite* sites = invoke_sites();
+  int lo = 0;
+  int hi = invoke_count() - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) >> 1;
+    int mid_bci = sites[mid]._bci;
+    if (mid_bci < bci) {
+      lo = mid + 1;
+    } else if (mid_bci > bci) {
+      hi = mid - 1;
+    } else {
+      return &sites[mid];
+    }
+  }
+  return NULL;
+}
+
+bool RecoveryMetadataArchive::is_valid() const {
+  if (_size < sizeof(RecoveryMetadataHeader)) {
+    return false;
+  }
+  RecoveryMetadataHeader* h = header();
+  return h->_magic_value == (u4)RecoveryMetadataHeader::_magic
+      && h->_version_value == (u4)RecoveryMetadataHeader::_version
+      && h->_total_size == _size
+      && h->_strings_offset + h->_strings_size <= _size
+      && h->_index_offset + h->_method_count * sizeof(RecoveryMethodIndex) <= _size;
+}
+
+const RecoveryMethodRecord* RecoveryMetadataArchive::lookup(Method* method, bool check_fingerprints) const {
+  Symbol* holder    = method->method_holder()->name();
+  Symbol* name      = method->name();
+  Symbol* signature = method->signature();
+  u4 hash = RecoveryMetadata::hash_for(holder, name, signature);
+
+  RecoveryMethodIndex* idx = index();
+  int lo = 0;
+  int hi = method_count();
+  // lower bound of hash
+  while (lo < hi) {
+    int mid = (lo + hi) >> 1;
+    if (idx[mid]._hash < hash) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  for (int i = lo; i < method_count() && idx[i]._hash == hash; i++) {
+    RecoveryMethodRecord* r = (RecoveryMethodRecord*)(_base + idx[i]._record);
+    if (name->equals(string_at(r->_name))
+        && signature->equals(string_at(r->_signature))
+        && holder->equals(string_at(r->_holder))) {
+      if (check_fingerprints &&
+          (r->_class_fingerprint != RecoveryMetadata::class_fingerprint(method->method_holder())
+           || r->_method_fingerprint != RecoveryMetadata::method_fingerprint(method))) {
+        if ((TraceRuntimeRecovery & TRACE_METADATA) != 0) {
+          ResourceMark rm;
+          tty->print_cr("[Ares] Stale recovery metadata for %s, ignored", method->name_and_sig_as_C_string());
+        }
+        return NULL;
+      }
+      return r;
+    }
+  }
+  return NULL;
+}
+
+RecoveryMetadataWriter::RecoveryMetadataWriter(bool resolve_classes) : _resolve_classes(resolve_classes) {
+  _string_offsets = new RecoveryStringOffsets();
+  _records = new GrowableArray<u1>(64 * K);
+  _strings = new GrowableArray<u1>(64 * K);
+  _index   = new GrowableArray<RecoveryMethodIndex>(4 * K);
+  _strings->append(0); // offset 0 is the empty string
+}
+
+void RecoveryMetadataWriter::append_bytes(GrowableArray<u1>* to, const void* bytes, size_t size) {
+  const u1* p = (const u1*)bytes;
+  for (size_t i = 0; i < size; i++) {
+    to->append(p[i]);
+  }
+}
+
+u4 RecoveryMetadataWriter::add_string(Symbol* s) {
+  u4* known = _string_offsets->get(s);
+  if (known != NULL) {
+    return *known;
+  }
+  u4 offset = (u4)_strings->length();
+  for (int i = 0; i < s->utf8_length(); i++) {
+    _strings->append((u1)s->byte_at(i));
+  }
+  _strings->append(0);
+  _string_offsets->put(s, offset);
+  return offset;
+}
+
+// Returns NULL with no pending exception when the class cannot be resolved.
+Klass* RecoveryMetadataWriter::catch_klass_at(constantPoolHandle pool, int index, TRAPS) {
+  if (!_resolve_classes) {
+    return ConstantPool::klass_at_if_loaded(pool, index);
+  }
+  Klass* k = pool->klass_at(index, THREAD);
+  if (HAS_PENDING_EXCEPTION) {
+    CLEAR_PENDING_EXCEPTION;
+    return NULL;
+  }
+  return k;
+}
+
+void RecoveryMetadataWriter::add_method(Method* m, TRAPS) {
+  methodHandle method(THREAD, m);
+  constantPoolHandle pool(THREAD, method->constants());
+
+  GrowableArray<RecoveryHandlerEntry>* handlers = new GrowableArray<RecoveryHandlerEntry>(8);
+  GrowableArray<RecoveryCheckedException>* checked = new GrowableArray<RecoveryCheckedException>(4);
+  GrowableArray<RecoveryInvokeSite>* invokes = new GrowableArray<RecoveryInvokeSite>(16);
+
+  // 1). exception table with resolved catch types
+  {
+    ExceptionTable table(method());
+    for (int i = 0; i < table.length(); i++) {
+      RecoveryHandlerEntry e;
+      e._start_pc   = table.start_pc(i);
+      e._end_pc     = table.end_pc(i);
+      e._handler_pc = table.handler_pc(i);
+      e._flags      = 0;
+      e._catch_type = 0;
+
+      int klass_index = table.catch_type_index(i);
+      if (klass_index == 0) {
+        e._flags |= RecoveryHandlerEntry::_finally;
+      } else {
+        Symbol* name = pool->klass_name_at(klass_index);
+        e._catch_type = add_string(name);
+        if (is_trivial_name(name)) {
+          e._flags |= RecoveryHandlerEntry::_trivial;
+        }
+        Klass* k = catch_klass_at(pool, klass_index, THREAD);
+        if (k == NULL) {
+          e._flags |= RecoveryHandlerEntry::_unresolved;
+        } else {
+          e._flags |= klass_flags(k);
+        }
+      }
+      handlers->append(e);
+    }
+  }
+
+  // 2). declared checked exceptions
+  {
+    int length = method->checked_exceptions_length();
+    CheckedExceptionElement* table = length > 0 ? method->checked_exceptions_start() : NULL;
+    for (int i = 0; i < length; i++) {
+      RecoveryCheckedException ce;
+      Symbol* name = pool->klass_name_at(table[i].class_cp_index);
+      ce._name  = add_string(name);
+      ce._flags = is_trivial_name(name) ? RecoveryHandlerEntry::_trivial : 0;
+      Klass* k = catch_klass_at(pool, table[i].class_cp_index, THREAD);
+      if (k == NULL) {
+        ce._flags |= RecoveryHandlerEntry::_unresolved;
+      } else {
+        ce._flags |= klass_flags(k);
+      }
+      checked->append(ce);
+    }
+  }
+
+  // 3). invoke sites, the early return candidates.
+  // The size of parameters comes from the signature, no linking required.
+  if (!method->is_native() && !method->is_abstract()) {
+    BytecodeStream bs(method);
+    Bytecodes::Code code;
+    while ((code = bs.next()) >= 0) {
+      if (Bytecodes::is_invoke(code)) {
+        Bytecode_invoke bi(method, bs.bci());
+        RecoveryInvokeSite site;
+        site._bci = (u2)bs.bci();
+        site._result_type = (u1)bi.result_type();
+        site._code = (u1)code;
+        site._size_of_parameters = (u2)(ArgumentSizeComputer(bi.signature()).size() + (bi.has_receiver() ? 1 : 0));
+        site._pad = 0;
+        invokes->append(site);
+      }
+    }
+  }
+
+  Symbol* holder = method->method_holder()->name();
+
+  RecoveryMethodRecord r;
+  r._holder = add_string(holder);
+  r._name = add_string(method->name());
+  r._signature = add_string(method->signature());
+  r._hash = RecoveryMetadata::hash_for(holder, method->name(), method->signature());
+  r._handler_count = (u2)handlers->length();
+  r._checked_count = (u2)checked->length();
+  r._invoke_count = (u4)invokes->length();
+  r._class_fingerprint = RecoveryMetadata::class_fingerprint(method->method_holder());
+  r._method_fingerprint = RecoveryMetadata::method_fingerprint(method());
+
+  RecoveryMethodIndex idx;
+  idx._hash = r._hash;
+  idx._record = (u4)_records->length(); // relative, fixed up in finish()
+  _index->append(idx);
+
+  append_bytes(_records, &r, sizeof(r));
+  for (int i = 0; i < handlers->length(); i++) {
+    append_bytes(_records, handlers->adr_at(i), sizeof(RecoveryHandlerEntry));
+  }
+  for (int i = 0; i < checked->length(); i++) {
+    append_bytes(_records, checked->adr_at(i), sizeof(RecoveryCheckedException));
+  }
+  for (int i = 0; i < invokes->length(); i++) {
+    append_bytes(_records, invokes->adr_at(i), sizeof(RecoveryInvokeSite));
+  }
+}
+
+void RecoveryMetadataWriter::add_class(instanceKlassHandle klass, TRAPS) {
+  Array<Method*>* methods = klass->methods();
+  for (int i = 0; i < methods->length(); i++) {
+    add_method(methods->at(i), CHECK);
+  }
+}
+
+static int compare_index(RecoveryMethodIndex* a, RecoveryMethodIndex* b) {
+  if (a->_hash < b->_hash) return -1;
+  if (a->_hash > b->_hash) return 1;
+  return 0;
+}
+
+size_t RecoveryMetadataWriter::finish(address* result) {
+  _index->sort(compare_index);
+
+  size_t header_size  = sizeof(RecoveryMetadataHeader);
+  size_t index_size   = _index->length() * sizeof(RecoveryMethodIndex);
+  size_t records_size = _records->length();
+  size_t strings_size = align_size_up(_strings->length(), BytesPerWord);
+  size_t total        = header_size + index_size + records_size + strings_size;
+
+  address base = NEW_RESOURCE_ARRAY(u1, total);
+  memset(base, 0, total);
+
+  RecoveryMetadataHeader* h = (RecoveryMetadataHeader*)base;
+  h->_magic_value    = RecoveryMetadataHeader::_magic;
+  h->_version_value  = RecoveryMetadataHeader::_version;
+  h->_method_count   = (u4)_index->length();
+  h->_index_offset   = (u4)header_size;
+  h->_strings_offset = (u4)(header_size + index_size + records_size);
+  h->_strings_size   = (u4)strings_size;
+  h->_total_size     = (u4)total;
+
+  u4 records_offset = (u4)(header_size + index_size);
+  RecoveryMethodIndex* idx = (RecoveryMethodIndex*)(base + header_size);
+  for (int i = 0; i < _index->length(); i++) {
+    idx[i]._hash   = _index->at(i)._hash;
+    idx[i]._record = _index->at(i)._record + records_offset;
+  }
+  for (int i = 0; i < _records->length(); i++) {
+    base[records_offset + i] = _records->at(i);
+  }
+  for (int i = 0; i < _strings->length(); i++) {
+    base[h->_strings_offset + i] = _strings->at(i);
+  }
+
+  *result = base;
+  return total;
+}
+
+bool RecoveryMetadataWriter::write_to_file(const char* path) {
+  address base = NULL;
+  size_t size = finish(&base);
+
+  remove(path);
+  int fd = os::open(path, O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0444);
+  if (fd < 0) {
+    tty->print_cr("[Ares] Unable to create recovery metadata file %s.", path);
+    return false;
+  }
+  size_t written = os::write(fd, base, (unsigned int)size);
+  os::close(fd);
+  return written == size;
+}
+
+RecoveryMetadataArchive* RecoveryMetadata::load_archive(const char* path) {
+  struct stat st;
+  if (os::stat(path, &st) != 0) {
+    tty->print_cr("[Ares] Unable to find recovery metadata file %s.", path);
+    return NULL;
+  }
+  int fd = os::open(path, O_RDONLY | O_BINARY, 0);
+  if (fd < 0) {
+    tty->print_cr("[Ares] Unable to open recovery metadata file %s.", path);
+    return NULL;
+  }
+  size_t size = (size_t)st.st_size;
+  char* base = os::map_memory(fd, path, 0, NULL, size, true, false);
+  os::close(fd);
+  if (base == NULL) {
+    tty->print_cr("[Ares] Unable to map recovery metadata file %s.", path);
+    return NULL;
+  }
+
+  RecoveryMetadataArchive* archive = new RecoveryMetadataArchive((address)base, size);
+  if (!archive->is_valid()) {
+    tty->print_cr("[Ares] Recovery metadata file %s has a bad header, ignored.", path);
+    os::unmap_memory(base, size);
+    delete archive;
+    return NULL;
+  }
+
+  if ((TraceRuntimeRecovery & TRACE_METADATA) != 0) {
+    tty->print_cr("[Ares] Mapped recovery metadata for %d methods from %s", archive->method_count(), path);
+  }
+  return archive;
+}
+
+RecoveryMetadataArchive* RecoveryMetadata::archive() {
+  if (_load_attempted) {
+    return _archive;
+  }
+  if (RecoveryMetadataFile == NULL || DumpRecoveryMetadata) {
+    return NULL;
+  }
+
+  MutexLocker ml(RecoveryMetadata_lock);
+  if (!_load_attempted) {
+    _archive = load_archive(RecoveryMetadataFile);
+    OrderAccess::release_store((volatile jbyte*)&_load_attempted, (jbyte)true);
+  }
+  return _archive;
+}
+
+RecoveryMetadataArchive* RecoveryMetadata::shared_archive() {
+  if (_shared_attempted) {
+    return _shared_archive;
+  }
+
+  MutexLocker ml(RecoveryMetadata_lock);
+  if (!_shared_attempted) {
+#if INCLUDE_CDS
+    FileMapInfo* info = FileMapInfo::current_info();
+    if (UseSharedSpaces && info != NULL && info->region_base(MetaspaceShared::rm) != NULL) {
+      RecoveryMetadataArchive* a = new RecoveryMetadataArchive((address)info->region_base(MetaspaceShared::rm),
+                                                               info->space_used(MetaspaceShared::rm));
+      if (a->is_valid()) {
+        _shared_archive = a;
+        if ((TraceRuntimeRecovery & TRACE_METADATA) != 0) {
+          tty->print_cr("[Ares] Using shared recovery metadata for %d methods", a->method_count());
+        }
+      } else {
+        delete a;
+      }
+    }
+#endif
+    OrderAccess::release_store((volatile jbyte*)&_shared_attempted, (jbyte)true);
+  }
+  return _shared_archive;
+}
+
+const RecoveryMethodRecord* RecoveryMetadata::lookup(Method* method, RecoveryMetadataArchive** from) {
+  RecoveryMetadataArchive* a = NULL;
+  const RecoveryMethodRecord* r = NULL;
+  switch (method->recovery_metadata()) {
+  case Method::_recovery_metadata_none:
+    break;
+  case Method::_recovery_metadata_shared:
+    a = shared_archive();
+    r = a->lookup(method, false);
+    break;
+  case Method::_recovery_metadata_file:
+    a = archive();
+    r = a->lookup(method, false);
+    break;
+  default:
+    // Only classes which come from the CDS archive have records there.
+    if (method->is_shared()) {
+      a = shared_archive();
+      if (a != NULL) {
+        r = a->lookup(method, true);
+      }
+    }
+    if (r != NULL) {
+      method->set_recovery_metadata(Method::_recovery_metadata_shared);
+    } else {
+      a = archive();
+      if (a != NULL) {
+        r = a->lookup(method, true);
+      }
+      method->set_recovery_metadata(r != NULL ? Method::_recovery_metadata_file
+                                              : Method::_recovery_metadata_none);
+    }
+  }
+  if (from != NULL) {
+    *from = r != NULL ? a : NULL;
+  }
+  return r;
+}
+
+bool RecoveryMetadata::find_handler(Method* method, KlassHandle ex_klass, int throw_bci,
+                                    bool ignore_no_string_void,
+                                    KlassHandle &caught_klass, int &handler_bci) {
+  assert(ex_klass.not_null(), "caller resolves catch types when simulating a Throwable");
+
+  RecoveryMetadataArchive* a = NULL;
+  const RecoveryMethodRecord* r = lookup(method, &a);
+  if (r == NULL) {
+    return false;
+  }
+
+  RecoveryHandlerEntry* entries = r->handlers();
+  for (int i = 0; i < r->handler_count(); i++) {
+    RecoveryHandlerEntry* e = &entries[i];
+    if (!e->covers(throw_bci)) {
+      continue;
+    }
+    handler_bci = e->_handler_pc;
+    if (e->is_finally()) {
+      if (IgnoreFinallyBlock) { /* This is a finally block */
+        continue;
+      }
+      caught_klass = KlassHandle();
+      return true;
+    }
+    if (ignore_no_string_void && !e->has_string_init()) {
+      continue;
+    }
+    Klass* k = NULL;
+    if (!find_catch_klass(method->method_holder(), a->string_at(e->_catch_type), &k)) {
+      handler_bci = -1;
+      return false;
+    }
+    if (ex_klass->is_subtype_of(k)) {
+      caught_klass = KlassHandle(k);
+      return true;
+    }
+  }
+
+  handler_bci = -1;
+  caught_klass = KlassHandle();
+  return true;
+}
+
+bool RecoveryMetadata::invoke_site_at(Method* method, int bci,
+                                      BasicType &result_type, int &size_of_parameters) {
+  const RecoveryMethodRecord* r = lookup(method);
+  if (r == NULL) {
+    return false;
+  }
+  const RecoveryInvokeSite* site = r->invoke_site_at(bci);
+  if (site == NULL) {
+    return false;
+  }
+  result_type = site->result_type();
+  size_of_parameters = site->size_of_parameters();
+  return true;
+}
+
+// Class path scanning
+
+static void add_class_name(GrowableArray<char*>* names, const char* entry) {
+  int len = (int)strlen(entry);
+  if (len <= 6 || strcmp(".class", entry + len - 6) != 0) {
+    return;
+  }
+  char* name = NEW_RESOURCE_ARRAY(char, len - 6 + 1);
+  strncpy(name, entry, len - 6);
+  name[len - 6] = '\0';
+  // module-info, META-INF/versions/... are not loadable classes
+  if (strchr(name, '.') != NULL || strchr(name, '-') != NULL) {
+    return;
+  }
+  names->append(name);
+}
+
+static void add_zip_entry(const char* entry, void* context) {
+  add_class_name((GrowableArray<char*>*)context, entry);
+}
+
+static void add_directory(GrowableArray<char*>* names, const char* root, const char* relative) {
+  char path[JVM_MAXPATHLEN];
+  if (*relative == '\0') {
+    jio_snprintf(path, sizeof(path), "%s", root);
+  } else {
+    jio_snprintf(path, sizeof(path), "%s%s%s", root, os::file_separator(), relative);
+  }
+
+  DIR* dir = os::opendir(path);
+  if (dir == NULL) {
+    return;
+  }
+  char* dbuf = NEW_C_HEAP_ARRAY(char, os::readdir_buf_size(path), mtInternal);
+  struct dirent* ep;
+  while ((ep = os::readdir(dir, (dirent*)dbuf)) != NULL) {
+    if (strcmp(ep->d_name, ".") == 0 || strcmp(ep->d_name, "..") == 0) {
+      continue;
+    }
+    char child[JVM_MAXPATHLEN];
+    if (*relative == '\0') {
+      jio_snprintf(child, sizeof(child), "%s", ep->d_name);
+    } else {
+      jio_snprintf(child, sizeof(child), "%s/%s", relative, ep->d_name);
+    }
+    char full[JVM_MAXPATHLEN];
+    jio_snprintf(full, sizeof(full), "%s%s%s", root, os::file_separator(), child);
+    struct stat st;
+    if (os::stat(full, &st) != 0) {
+      continue;
+    }
+    if ((st.st_mode & S_IFDIR) == S_IFDIR) {
+      add_directory(names, root, child);
+    } else {
+      add_class_name(names, child);
+    }
+  }
+  FREE_C_HEAP_ARRAY(char, dbuf, mtInternal);
+  os::closedir(dir);
+}
+
+void RecoveryMetadata::dump_class_path(TRAPS) {
+  TraceTime timer("Dump Recovery Metadata", TraceStartupTime);
+  ResourceMark rm(THREAD);
+
+  if (RecoveryMetadataFile == NULL) {
+    tty->print_cr("[Ares] -XX:+DumpRecoveryMetadata requires -XX:RecoveryMetadataFile=<file>");
+    vm_exit(1);
+  }
+
+  GrowableArray<char*>* names = new GrowableArray<char*>(1024);
+
+  const char* class_path = Arguments::get_appclasspath();
+  if (class_path != NULL) {
+    char* cp = os::strdup(class_path, mtInternal);
+    char separator = *os::path_separator();
+    char* element = cp;
+    while (element != NULL) {
+      char* next = strchr(element, separator);
+      if (next != NULL) {
+        *next++ = '\0';
+      }
+      struct stat st;
+      if (*element != '\0' && os::stat(element, &st) == 0) {
+        if ((st.st_mode & S_IFDIR) == S_IFDIR) {
+          add_directory(names, element, "");
+        } else {
+          ClassPathEntry* entry = ClassLoader::create_class_path_entry(element, &st, false, false, THREAD);
+          if (HAS_PENDING_EXCEPTION) {
+            CLEAR_PENDING_EXCEPTION;
+          } else if (entry != NULL && entry->is_jar_file()) {
+            ((ClassPathZipEntry*)entry)->contents_do(add_zip_entry, names);
+          }
+        }
+      }
+      element = next;
+    }
+    os::free(cp, mtInternal);
+  }
+
+  tty->print_cr("[Ares] Scanning %d classes for recovery metadata ...", names->length());
+
+  Handle loader(THREAD, SystemDictionary::java_system_loader());
+  RecoveryMetadataWriter writer;
+  int class_count = 0;
+
+  for (int i = 0; i < names->length(); i++) {
+    HandleMark hm(THREAD);
+    TempNewSymbol sym = SymbolTable::new_symbol(names->at(i), THREAD);
+    if (HAS_PENDING_EXCEPTION) {
+      CLEAR_PENDING_EXCEPTION;
+      continue;
+    }
+    Klass* k = SystemDictionary::resolve_or_null(sym, loader, Handle(), THREAD);
+    if (HAS_PENDING_EXCEPTION || k == NULL || !k->oop_is_instance()) {
+      if ((TraceRuntimeRecovery & TRACE_METADATA) != 0) {
+        tty->print_cr("[Ares] dump_class_path: skip %s", names->at(i));
+      }
+      CLEAR_PENDING_EXCEPTION;
+      continue;
+    }
+    writer.add_class(instanceKlassHandle(THREAD, k), THREAD);
+    if (HAS_PENDING_EXCEPTION) {
+      CLEAR_PENDING_EXCEPTION;
+      continue;
+    }
+    class_count++;
+  }
+
+  if (!writer.write_to_file(RecoveryMetadataFile)) {
+    tty->print_cr("[Ares] Failed to write recovery metadata to %s", RecoveryMetadataFile);
+    vm_exit(1);
+  }
+
+  tty->print_cr("[Ares] Wrote recovery metadata of %d methods in %d classes to %s",
+      writer.method_count(), class_count, RecoveryMetadataFile);
+
+  // Like -Xshare:dump, the dumping VM is not meant to continue.
+  vm_exit(0);
+}
+
+// CDS dumping
+
+static RecoveryMetadataWriter* _shared_writer = NULL;
+
+static void add_shared_class(Klass* k, TRAPS) {
+  if (k->oop_is_instance()) {
+    _shared_writer->add_class(instanceKlassHandle(THREAD, k), THREAD);
+  }
+}
+
+size_t RecoveryMetadata::dump_shared_classes(address* result, TRAPS) {
+  assert(DumpSharedSpaces, "only when dumping the CDS archive");
+  // Resolving catch types would load classes which are not in the archive.
+  RecoveryMetadataWriter writer(false);
+  _shared_writer = &writer;
+  SystemDictionary::classes_do(add_shared_class, THREAD);
+  _shared_writer = NULL;
+  if (HAS_PENDING_EXCEPTION) {
+    CLEAR_PENDING_EXCEPTION;
+  }
+  return writer.finish(result);
+}
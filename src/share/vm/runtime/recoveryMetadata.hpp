@@ -0,0 +1,229 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYMETADATA_HPP
+#define SHARE_VM_RUNTIME_RECOVERYMETADATA_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/method.hpp"
+#include "runtime/handles.hpp"
+#include "utilities/growableArray.hpp"
+#include "utilities/resourceHash.hpp"
+
+//
+// Per-method recovery metadata.
+//
+// Most of what the RecoveryOracle computes at failure time only depends on
+// the class files: the exception tables and their catch types, the declared
+// checked exceptions and the shape of the invoke sites. The records below
+// hold these facts in a position independent layout (all references are
+// offsets) so that an archive can be mapped and used as is.
+//
+// Archive layout:
+//   RecoveryMetadataHeader
+//   RecoveryMethodIndex[method_count]    sorted by hash
+//   RecoveryMethodRecord ...             each followed by its tables
+//   string pool                          NUL terminated utf8, offset 0 is ""
+//
+
+class RecoveryHandlerEntry VALUE_OBJ_CLASS_SPEC {
+ public:
+  enum {
+    _finally         = 0x1, // catch_type_index == 0
+    _trivial         = 0x2, // catches Throwable or Exception
+    _has_string_init = 0x4, // the caught class has a <init>(String)
+    _unresolved      = 0x8  // the caught class could not be resolved when dumping
+  };
+
+  u2 _start_pc;
+  u2 _end_pc;
+  u2 _handler_pc;
+  u2 _flags;
+  u4 _catch_type;           // string offset of the caught class name, 0 for finally
+
+  bool is_finally() const       { return (_flags & _finally) != 0; }
+  bool is_trivial() const       { return (_flags & _trivial) != 0; }
+  bool has_string_init() const  { return (_flags & _has_string_init) != 0; }
+  bool covers(int bci) const    { return _start_pc <= bci && bci < _end_pc; }
+};
+
+class RecoveryCheckedException VALUE_OBJ_CLASS_SPEC {
+ public:
+  u4 _name;                 // string offset of the declared exception class name
+  u4 _flags;                // RecoveryHandlerEntry::_has_string_init, _trivial
+
+  bool has_string_init() const  { return (_flags & RecoveryHandlerEntry::_has_string_init) != 0; }
+};
+
+class RecoveryInvokeSite VALUE_OBJ_CLASS_SPEC {
+ public:
+  u2 _bci;
+  u1 _result_type;          // BasicType, T_VOID sites are always early-returnable
+  u1 _code;                 // Bytecodes::Code of the java bytecode
+  u2 _size_of_parameters;   // including the receiver
+  u2 _pad;
+
+  BasicType result_type() const { return (BasicType)_result_type; }
+  int size_of_parameters() const { return _size_of_parameters; }
+};
+
+class RecoveryMethodRecord VALUE_OBJ_CLASS_SPEC {
+ public:
+  u4 _holder;               // string offsets
+  u4 _name;
+  u4 _signature;
+  u4 _hash;
+  u2 _handler_count;
+  u2 _checked_count;
+  u4 _invoke_count;
+  u4 _class_fingerprint;    // shape of the holder when the record was written
+  u4 _method_fingerprint;   // bytecodes and exception table of the method
+
+  RecoveryHandlerEntry* handlers() const {
+    return (RecoveryHandlerEntry*)(((address)this) + sizeof(RecoveryMethodRecord));
+  }
+  RecoveryCheckedException* checked_exceptions() const {
+    return (RecoveryCheckedException*)(((address)handlers()) + _handler_count * sizeof(RecoveryHandlerEntry));
+  }
+  RecoveryInvokeSite* invoke_sites() const {
+    return (RecoveryInvokeSite*)(((address)checked_exceptions()) + _checked_count * sizeof(RecoveryCheckedException));
+  }
+
+  int handler_count() const { return _handler_count; }
+  int checked_count() const { return _checked_count; }
+  int invoke_count()  const { return (int)_invoke_count; }
+
+  // invoke sites are sorted by bci
+  const RecoveryInvokeSite* invoke_site_at(int bci) const;
+};
+
+class RecoveryMethodIndex VALUE_OBJ_CLASS_SPEC {
+ public:
+  u4 _hash;
+  u4 _record;               // offset of the RecoveryMethodRecord
+};
+
+class RecoveryMetadataHeader VALUE_OBJ_CLASS_SPEC {
+ public:
+  enum {
+    _magic   = 0xA4E5D0C1,
+    _version = 2
+  };
+
+  u4 _magic_value;
+  u4 _version_value;
+  u4 _method_count;
+  u4 _index_offset;
+  u4 _strings_offset;
+  u4 _strings_size;
+  u4 _total_size;
+  u4 _pad;
+};
+
+// A read only view of a recovery metadata archive, either mapped from
+// RecoveryMetadataFile or embedded in the CDS archive.
+class RecoveryMetadataArchive : public CHeapObj<mtInternal> {
+ private:
+  address _base;
+  size_t  _size;
+
+  RecoveryMetadataHeader* header() const { return (RecoveryMetadataHeader*)_base; }
+  RecoveryMethodIndex* index() const     { return (RecoveryMethodIndex*)(_base + header()->_index_offset); }
+
+ public:
+  RecoveryMetadataArchive(address base, size_t size) : _base(base), _size(size) {}
+
+  bool is_valid() const;
+  int method_count() const { return (int)header()->_method_count; }
+
+  const char* string_at(u4 offset) const {
+    assert(offset < header()->_strings_size, "string offset out of bounds");
+    return (const char*)(_base + header()->_strings_offset + offset);
+  }
+
+  // The fingerprints of the record are only compared with method's if
+  // check_fingerprints is set.
+  const RecoveryMethodRecord* lookup(Method* method, bool check_fingerprints) const;
+};
+
+typedef ResourceHashtable<Symbol*, u4, primitive_hash<Symbol*>, primitive_equals<Symbol*>, 4099> RecoveryStringOffsets;
+
+// Builds an archive in memory. Resource allocated, the caller holds the ResourceMark.
+class RecoveryMetadataWriter : public StackObj {
+ private:
+  RecoveryStringOffsets*              _string_offsets;
+  GrowableArray<u1>*                  _records;
+  GrowableArray<u1>*                  _strings;
+  GrowableArray<RecoveryMethodIndex>* _index;
+  bool                                _resolve_classes;
+
+  u4 add_string(Symbol* s);
+  Klass* catch_klass_at(constantPoolHandle pool, int index, TRAPS);
+  void append_bytes(GrowableArray<u1>* to, const void* bytes, size_t size);
+
+ public:
+  // When resolve_classes is false only classes which are already loaded are
+  // looked at, the others are recorded as unresolved.
+  RecoveryMetadataWriter(bool resolve_classes = true);
+
+  int method_count() const { return _index->length(); }
+
+  void add_method(Method* method, TRAPS);
+  void add_class(instanceKlassHandle klass, TRAPS);
+
+  // Lays out header, index, records and strings into one block allocated
+  // in the resource area and returns its size.
+  size_t finish(address* result);
+  bool write_to_file(const char* path);
+};
+
+class RecoveryMetadata : AllStatic {
+ private:
+  static RecoveryMetadataArchive* _archive;
+  static volatile bool            _load_attempted;
+  static RecoveryMetadataArchive* _shared_archive;
+  static volatile bool            _shared_attempted;
+
+  static RecoveryMetadataArchive* load_archive(const char* path);
+
+ public:
+  // The side archive is mapped on the first query, so that a VM which never
+  // recovers never pays for it.
+  static RecoveryMetadataArchive* archive();
+
+  // The recovery metadata region of the CDS archive, NULL without sharing.
+  static RecoveryMetadataArchive* shared_archive();
+
+  // Methods of shared classes are looked up in the CDS archive first, then
+  // in the side archive. from is set to the archive holding the record.
+  // The fingerprints are only checked on the first lookup of a method, its
+  // flags keep the outcome, since the archives do not change once mapped.
+  static const RecoveryMethodRecord* lookup(Method* method, RecoveryMetadataArchive** from = NULL);
+
+  static unsigned int hash_for(Symbol* holder, Symbol* name, Symbol* signature);
+
+  // Records are only used while these still match the loaded method, so a
+  // stale archive falls back to the class files instead of answering wrong.
+  static u4 class_fingerprint(InstanceKlass* holder);
+  static u4 method_fingerprint(Method* method);
+
+  // Finds the handler of method for an exception of class ex_klass thrown at
+  // throw_bci without touching the constant pool. Returns false when there
+  // is no valid metadata for the method or a catch type is not loaded by the
+  // holder's loader, in which case the caller falls back to the exception
+  // table.
+  static bool find_handler(Method* method, KlassHandle ex_klass, int throw_bci,
+                           bool ignore_no_string_void,
+                           KlassHandle &caught_klass, int &handler_bci);
+
+  // Returns false when there is no metadata for the invoke site.
+  static bool invoke_site_at(Method* method, int bci,
+                             BasicType &result_type, int &size_of_parameters);
+
+  // -XX:+DumpRecoveryMetadata: load every class on the application class
+  // path and write its recovery metadata into RecoveryMetadataFile.
+  static void dump_class_path(TRAPS);
+
+  // -Xshare:dump: compute the recovery metadata of all loaded classes without
+  // loading any more. Returns the size of the resource allocated archive.
+  static size_t dump_shared_classes(address* result, TRAPS);
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYMETADATA_HPP
@@ -2,7 +2,22 @@
 
 #include "precompiled.hpp"
 
+#include "code/nmethod.hpp"
+#include "code/scopeDesc.hpp"
 #include "interpreter/oopMapCache.hpp"
+#include "oops/methodData.hpp"
+#include "runtime/deoptimization.hpp"
+#include "runtime/jpfWorkerPool.hpp"
+#include "runtime/lazyBacktrace.hpp"
+#include "runtime/recoveryEventLog.hpp"
+#include "runtime/recoveryDecisionCache.hpp"
+#include "runtime/recoveryIndex.hpp"
+#include "runtime/recoveryMetadata.hpp"
+#include "runtime/recoveryOutcome.hpp"
+#include "runtime/recoveryPrefetch.hpp"
+#include "runtime/recoveryReplay.hpp"
+#include "runtime/transformedExceptionCache.hpp"
+#include "utilities/xmlstream.hpp"
 
 bool has_string_void_init(KlassHandle klass);
 
@@ -31,7 +46,19 @@ void RecoveryAction::print() {
 
 Handle RecoveryAction::allocate_target_exception(JavaThread* thread, Handle origin_exception) {
   KlassHandle exception_klass(thread, target_exception_klass());
-  return RecoveryOracle::allocate_target_exception(thread, origin_exception, exception_klass);
+  return RecoveryOracle::allocate_target_exception(thread, origin_exception, exception_klass, _site_method, _site_bci);
+}
+
+// Result type and callee parameter size of the invoke at bci.
+// The metadata archive answers without resolving the call site.
+void RecoveryOracle::invoke_site_shape(JavaThread* thread, Method* method, int bci,
+    BasicType &result_type, int &size_of_parameters) {
+  if (RecoveryMetadata::invoke_site_at(method, bci, result_type, size_of_parameters)) {
+    return;
+  }
+  Bytecode_invoke bi(method, bci);
+  result_type = bi.result_type();
+  size_of_parameters = bi.static_target(thread)->size_of_parameters();
 }
 
 void recoveryOracle_init() {
@@ -42,6 +69,8 @@ redisContext* RecoveryOracle::_context = NULL;
 
 volatile jint RecoveryOracle::_recovered_count = 0;
 
+volatile jint RecoveryOracle::_strategy_timeouts[RecoveryOracle::_strategy_limit] = { 0 };
+
 redisContext* RecoveryOracle::context() {
   return _context;
 }
@@ -58,6 +87,12 @@ jint RecoveryOracle::next_recovered_count() {
   return old_count;
 }
 
+void RecoveryOracle::reset_strategy_timeouts() {
+  for (int i = 0; i < _strategy_limit; i++) {
+    Atomic::store(0, &_strategy_timeouts[i]);
+  }
+}
+
 const char* get_recovery_mode() {
   if (UseRedis) {
     if (UseInduced) {
@@ -74,7 +109,8 @@ const char* get_recovery_mode() {
 }
 
 void RecoveryOracle::initialize() {
-  if (UseRedis) {
+  RecoveryReplay::initialize();
+  if (UseRedis && !RecoveryReplay::is_replaying()) {
     redisContext* c = redisConnect("127.0.0.1", 6379);
     if (c != NULL && c->err) {
       tty->print_cr("[Ares] ERROR: create redis context failed %s\n", c->errstr);
@@ -106,6 +142,77 @@ bool RecoveryOracle::quick_cannot_recover_check(JavaThread* thread, Handle excep
   return false;
 }
 
+// Each exception C2 code hands to the oracle costs a deoptimization of the
+// receiving frame. The recoveries are counted in the MethodData of the method
+// containing the call site (which may be inlined): every one is a
+// Reason_recovery trap, and a separate count is halved every
+// RecoveryTrapDecayMillis so that only a method which keeps recovering, not a
+// hot method which recovers now and then, reaches PerMethodRecoveryTrapLimit.
+// The call site is then marked as a recovery site in its profile, with a flag
+// of its own rather than the trap state other deoptimizations share, and the
+// nmethod is made not entrant. The next C2 compilation keeps the call at a
+// marked site out of line, so the exception path of the site is a compiled
+// call edge and a recovery only deoptimizes the frame of the caller. A marked
+// site does not trigger another recompilation.
+void RecoveryOracle::record_compiled_recovery(JavaThread* thread, nmethod* nm, address pc) {
+  if (nm == NULL || !nm->is_compiled_by_c2()) {
+    return;
+  }
+
+  // The call site may be inlined, count it in the method which contains it.
+  ScopeDesc* sd = nm->scope_desc_at(pc);
+  methodHandle trap_method(thread, sd->method());
+  int trap_bci = sd->bci();
+
+  MethodData* mdo = trap_method->method_data();
+  if (mdo == NULL) {
+    Method::build_interpreter_method_data(trap_method, thread);
+    if (thread->has_pending_exception()) {
+      thread->clear_pending_exception();
+      return;
+    }
+    mdo = trap_method->method_data();
+    if (mdo == NULL) {
+      return;
+    }
+  }
+
+  mdo->inc_trap_count(Deoptimization::Reason_recovery);
+  uint count = mdo->inc_recovery_count(os::javaTimeMillis());
+  if ((TraceRuntimeRecovery & TRACE_CHECKING) != 0) {
+    ResourceMark rm(thread);
+    tty->print_cr("[Ares] record_compiled_recovery: %s @ %d, %u recent recoveries",
+        trap_method->name_and_sig_as_C_string(), trap_bci, count);
+  }
+
+  if (PerMethodRecoveryTrapLimit <= 0 || count < (uint)PerMethodRecoveryTrapLimit) {
+    return;
+  }
+
+  ResourceMark rm(thread);
+  ProfileData* pdata = mdo->allocate_bci_to_data(trap_bci, NULL);
+  if (pdata == NULL || pdata->is_recovery_site()) {
+    // Already recompiled around this site, or nowhere to remember it.
+    mdo->reset_recovery_count();
+    return;
+  }
+  pdata->set_recovery_site();
+  mdo->reset_recovery_count();
+
+  if (xtty != NULL) {
+    ttyLocker ttyl;
+    xtty->begin_elem("recovery_recompile thread='" UINTX_FORMAT "' count='%u' bci='%d' action='recompile'",
+                     os::current_thread_id(), count, trap_bci);
+    nm->log_identity(xtty);
+    xtty->method(trap_method);
+    xtty->stamp();
+    xtty->end_elem();
+  }
+
+  mdo->inc_decompile_count();
+  nm->make_not_entrant();
+}
+
 const char* RecoveryOracle::failure_type_name(FailureType type) {
   switch(type) {
   case _not_a_failure:
@@ -140,6 +247,53 @@ const char* RecoveryOracle::recovery_type_name(RecoveryType type) {
   return "invalid recovery type";
 }
 
+const char* RecoveryOracle::strategy_name(Strategy strategy) {
+  switch(strategy) {
+  case _cache_strategy:
+    return "cache";
+  case _stack_strategy:
+    return "stack";
+  case _index_strategy:
+    return "index";
+  case _redis_strategy:
+    return "redis";
+  case _jpf_strategy:
+    return "jpf";
+  case _default_strategy:
+    return "default";
+  default:
+    break;
+  }
+
+  return "invalid strategy";
+}
+
+bool RecoveryOracle::out_of_budget(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  return state->has_recovery_deadline() && os::javaTimeNanos() >= state->recovery_deadline();
+}
+
+void RecoveryOracle::count_timeout(Strategy strategy) {
+  Atomic::inc(&_strategy_timeouts[strategy]);
+  if (RecoveryEventLog::is_enabled()) {
+    RecoveryEventLog::log_timeout(JavaThread::current(), strategy);
+  }
+  if ((TraceRuntimeRecovery & TRACE_PRINT_ACTION) != 0) {
+    tty->print_cr("[Ares] out of time budget at strategy %s (%d timeouts)",
+        strategy_name(strategy), _strategy_timeouts[strategy]);
+  }
+}
+
+void RecoveryOracle::reject_known_bad(JavaThread* thread, RecoveryAction* action) {
+  if (can_recover(action) && RecoveryOutcome::is_known_bad(action)) {
+    if ((TraceRuntimeRecovery & TRACE_PRINT_ACTION) != 0) {
+      tty->print_cr("[Ares] reject %s found by %s, it keeps failing at this site",
+          recovery_type_name(action->recovery_type()), strategy_name(action->strategy()));
+    }
+    action->set_recovery_type(_no_recovery);
+  }
+}
+
 
 bool RecoveryOracle::is_trivial_handler(KlassHandle handler_klass) {
   assert(handler_klass.not_null(), "sanity check");
@@ -152,9 +306,26 @@ void RecoveryOracle::recover(JavaThread* thread, RecoveryAction* action) {
   if ((TraceRuntimeRecovery & TRACE_PRINT_ACTION) != 0) {
     timer.start();
   }
+  jlong start = RecoveryEventLog::is_enabled() ? os::javaTimeNanos() : 0;
 
   do_recover(thread, action);
 
+  if (can_recover(action) && RecoveryOutcome::is_enabled()) {
+    RecoveryOutcome::recovery_applied(thread, action);
+  }
+
+  if (RecoveryEventLog::is_enabled() && action->site_method() != NULL) {
+    if (action->can_error_transformation()) {
+      RecoveryEventLog::log_error_transformation(thread, action->site_method(), action->site_bci(),
+          action->target_exception_klass());
+    } else if (action->can_early_return()) {
+      RecoveryEventLog::log_early_return(thread, action->site_method(), action->site_bci(),
+          action->early_return_type(), action->early_return_offset());
+    }
+    RecoveryEventLog::log_recovery(thread, action->site_method(), action->site_bci(),
+        action->recovery_type(), os::javaTimeNanos() - start);
+  }
+
   if ((TraceRuntimeRecovery & TRACE_PRINT_ACTION) != 0) {
     timer.stop();
     if (can_recover(action)) {
@@ -165,6 +336,14 @@ void RecoveryOracle::recover(JavaThread* thread, RecoveryAction* action) {
   if (!can_recover(action)) {
     thread->runtime_recovery_state()->set_last_checked_exception(NULL);
   }
+
+  // An exception dropped by an early return never needs its stack trace,
+  // any other one leaves the recovery with it.
+  if (action->can_early_return()) {
+    LazyBacktrace::discard(thread, action->origin_exception()());
+  } else {
+    LazyBacktrace::materialize(thread, action->origin_exception());
+  }
 }
 
 bool RecoveryOracle::is_sun_reflect_NativeMethodAccessorImpl(Method* method) {
@@ -180,7 +359,40 @@ bool RecoveryOracle::is_sun_reflect_NativeMethodAccessorImpl(Method* method) {
   return false;
 }
 
-void RecoveryOracle::do_recover(JavaThread* thread, RecoveryAction* action) {
+// Once a reflective call is inflated, sun.reflect.MethodAccessorGenerator
+// has generated a class which calls the target from bytecodes, instead of
+// invoke0. Its handler for Throwable wraps the exception into an
+// InvocationTargetException, as invoke0 does.
+bool RecoveryOracle::is_sun_reflect_GeneratedAccessor(Method* method) {
+  Klass* magic = SystemDictionary::reflect_MagicAccessorImpl_klass();
+  InstanceKlass* holder = method->method_holder();
+  return magic != NULL && holder->is_subclass_of(magic) &&
+      holder->name()->starts_with("sun/reflect/Generated");
+}
+
+bool RecoveryOracle::is_reflection_invoke(Method* method) {
+  if (is_sun_reflect_GeneratedAccessor(method)) {
+    return true;
+  }
+  if (method->name()->equals("invoke")) {
+    InstanceKlass* holder = method->method_holder();
+    return holder->name()->equals("sun/reflect/NativeMethodAccessorImpl") ||
+        holder->name()->equals("sun/reflect/DelegatingMethodAccessorImpl") ||
+        holder == SystemDictionary::reflect_Method_klass();
+  }
+  return false;
+}
+
+static void record_stage(jlong* stage_nanos, RecoveryOracle::Stage stage, jlong &stage_start) {
+  if (stage_nanos != NULL) {
+    jlong now = os::javaTimeNanos();
+    stage_nanos[stage] = now - stage_start;
+    stage_start = now;
+  }
+}
+
+void RecoveryOracle::do_recover(JavaThread* thread, RecoveryAction* action, int skip_frames, jlong* stage_nanos,
+                                bool record_outcome) {
   // Caller should do this check first
   //assert(!quick_cannot_recover_check(thread, action->origin_exception()), "sanity check");
   assert(action->origin_exception().not_null(), "sanity check");
@@ -208,7 +420,13 @@ void RecoveryOracle::do_recover(JavaThread* thread, RecoveryAction* action) {
   // 2) NPE happens during invoking an instance method where the stack frame is partially built. The actual complete top must NOT be a native method.
   // These two cases are exclusive.
   // has_incomplete_top is for the second case
+  jlong stage_start = stage_nanos != NULL ? os::javaTimeNanos() : 0;
   fill_stack(thread, methods, bcis);
+  for (int i = 0; i < skip_frames && methods->length() > 0; i++) {
+    methods->remove_at(0);
+    bcis->remove_at(0);
+  }
+  record_stage(stage_nanos, _fill_stack_stage, stage_start);
 
   if (methods->length() == 0) {
     action->set_recovery_type(_no_recovery);
@@ -218,8 +436,25 @@ void RecoveryOracle::do_recover(JavaThread* thread, RecoveryAction* action) {
     return;
   }
 
+  action->set_site(methods->at(0), bcis->at(0));
+
   // 1). Determine failure type and recovery context
   determine_failure_type_and_recovery_context(thread, methods, bcis, action);
+  record_stage(stage_nanos, _failure_type_stage, stage_start);
+
+  if (RecoveryEventLog::is_enabled()) {
+    RecoveryEventLog::log_failure(thread, methods->at(0), bcis->at(0),
+        action->failure_type(), action->recovery_context_offset());
+  }
+
+  if (record_outcome) {
+    if (RecoveryOutcome::is_enabled() && require_recovery(action->failure_type())) {
+      action->set_signature(RecoveryDecisionCache::signature_for(methods, bcis, action));
+      // The thread failed again, so its last recovery may not have helped.
+      RecoveryOutcome::failure_seen(thread);
+    }
+    thread->runtime_recovery_state()->set_failure_signature(action->signature());
+  }
 
   if (!require_recovery(action->failure_type())) {
     return;
@@ -227,7 +462,9 @@ void RecoveryOracle::do_recover(JavaThread* thread, RecoveryAction* action) {
 
   // We need to check whether we will recover in unsafe <init>
   // which will produce invalid object.
-  if (has_unsafe_init(thread, methods, bcis, action)) {
+  bool unsafe_init = has_unsafe_init(thread, methods, bcis, action);
+  record_stage(stage_nanos, _unsafe_init_stage, stage_start);
+  if (unsafe_init) {
     action->set_recovery_type(_no_recovery);
     thread->runtime_recovery_state()->set_last_checked_exception(NULL);
     return;
@@ -262,6 +499,7 @@ void RecoveryOracle::do_recover(JavaThread* thread, RecoveryAction* action) {
 
   // 2). Determine recovery action
   determine_recovery_action(thread, methods, bcis, action);
+  record_stage(stage_nanos, _recovery_action_stage, stage_start);
 
   if ((TraceRuntimeRecovery & TRACE_CHECKING) != 0) {
     assert(methods->length() > 0, "sanity check");
@@ -333,6 +571,12 @@ void RecoveryOracle::determine_failure_type_and_recovery_context(JavaThread* thr
     Method* current_method = methods->at(index);
     int current_bci = bcis->at(index);
 
+    // Not a handler of the program, the exception goes on to the caller of
+    // Method.invoke as with a native reflective call.
+    if (is_sun_reflect_GeneratedAccessor(current_method)) {
+      continue;
+    }
+
     handler_bci = -1;
     caught_klass = null_klass;
     fast_exception_handler_bci_and_caught_klass_for(current_method, ex_klass, current_bci, caught_klass, handler_bci, false, thread);
@@ -404,7 +648,8 @@ bool RecoveryOracle::can_recover(RecoveryAction* action) {
 }
 
 
-Handle RecoveryOracle::allocate_target_exception(JavaThread* thread, Handle origin_exception, KlassHandle target_exception_klass) {
+Handle RecoveryOracle::allocate_target_exception(JavaThread* thread, Handle origin_exception, KlassHandle target_exception_klass,
+    Method* site_method, int site_bci) {
   ResourceMark rm(thread);
 
   if (!TransformIntoSuper && origin_exception->is_a(target_exception_klass())) {
@@ -417,6 +662,14 @@ Handle RecoveryOracle::allocate_target_exception(JavaThread* thread, Handle orig
     return origin_exception;
   }
 
+  if (OmitStackTraceInTransformedException && site_method != NULL) {
+    Handle cheap_exception = TransformedExceptionCache::allocate(thread, origin_exception,
+        target_exception_klass, site_method, site_bci);
+    if (cheap_exception.not_null()) {
+      return cheap_exception;
+    }
+  }
+
   stringStream ss;
   ss.print("Exception transformation: %s -> %s.",
       origin_exception->klass()->name()->as_C_string(),
@@ -447,7 +700,8 @@ Handle RecoveryOracle::allocate_target_exception(JavaThread* thread, Handle orig
   return target_exception;
 }
 
-void RecoveryOracle::fast_error_transformation(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action) {
+void RecoveryOracle::fast_error_transformation(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action,
+    Strategy strategy) {
   const int end_index = action->recovery_context_offset();
 
   // TODO clear all handles
@@ -467,7 +721,7 @@ void RecoveryOracle::fast_error_transformation(JavaThread* thread, GrowableArray
     const int ce_length = current_method->checked_exceptions_length();
 
     if ((ce_length > 0 && UseStack) || UseForceThrowable) {
-      if (has_known_exception_handler(0, end_index, methods, bcis,
+      if (has_known_exception_handler(strategy, 0, end_index, methods, bcis,
             current_method, known_exception_type, handler_method, handler_bci, handler_index, thread)) {
         // TODO
         assert(!thread->has_pending_exception(), "sanity check");
@@ -528,7 +782,7 @@ void RecoveryOracle::fast_error_transformation(JavaThread* thread, GrowableArray
         const int ce_length = current_method->checked_exceptions_length();
 
         if ((ce_length > 0 && UseStack) || UseForceThrowable) {
-          if (has_known_exception_handler(0, end_index, methods, bcis,
+          if (has_known_exception_handler(strategy, 0, end_index, methods, bcis,
                 current_method, known_exception_type, handler_method, handler_bci, handler_index, thread)) {
             // TODO
             assert(!thread->has_pending_exception(), "sanity check");
@@ -579,7 +833,7 @@ void RecoveryOracle::fast_error_transformation(JavaThread* thread, GrowableArray
     const int ce_length = current_method->checked_exceptions_length();
 
     if ((ce_length > 0 && UseStack) || UseForceThrowable) {
-      if (has_known_exception_handler(index+1, end_index, methods, bcis,
+      if (has_known_exception_handler(strategy, index+1, end_index, methods, bcis,
             current_method, known_exception_type, handler_method, handler_bci, handler_index, thread)) {
         // TODO
         assert(!thread->has_pending_exception(), "sanity check");
@@ -644,19 +898,22 @@ void RecoveryOracle::fast_early_return(JavaThread* thread, GrowableArray<Method*
         Bytecodes::Code java_code = current_method->java_code_at(current_bci);
 
         if (Bytecodes::is_invoke(java_code)) {
-          Bytecode_invoke bi(current_method, current_bci);
+          BasicType result_type;
+          int size_of_parameters;
+          invoke_site_shape(thread, current_method, current_bci, result_type, size_of_parameters);
 
           action->set_recovery_type(_early_return);
           action->set_early_return_offset(index);
-          action->set_early_return_type(bi.result_type());
-          action->set_early_return_size_of_parameters(bi.static_target(thread)->size_of_parameters());
+          action->set_early_return_type(result_type);
+          action->set_early_return_size_of_parameters(size_of_parameters);
 
           if ((TraceRuntimeRecovery & TRACE_EARLYRET) != 0) {
             ResourceMark rm(thread);
+            Bytecode_invoke bi(current_method, current_bci);
 
             tty->print_cr("[Ares] fast_early_return: force early return (index=%d, rettype=%s, size_of_p=%d, %s@%d->%s",
                 index,
-                type2name(bi.result_type()),
+                type2name(result_type),
                 action->early_return_size_of_parameters(),
                 current_method->name_and_sig_as_C_string(),
                 current_bci,
@@ -748,22 +1005,25 @@ void RecoveryOracle::fast_early_return(JavaThread* thread, GrowableArray<Method*
           dropped_extra = 1;
         }
 
-        Bytecode_invoke bi(current_method, current_bci);
+        BasicType result_type;
+        int size_of_parameters;
+        invoke_site_shape(thread, current_method, current_bci, result_type, size_of_parameters);
 
-        if (OnlyEarlyReturnVoid && bi.result_type() != T_VOID) {
+        if (OnlyEarlyReturnVoid && result_type != T_VOID) {
           continue;
         }
         action->set_recovery_type(_early_return);
         action->set_early_return_offset(index);
-        action->set_early_return_type(bi.result_type());
-        action->set_early_return_size_of_parameters(bi.static_target(thread)->size_of_parameters());
+        action->set_early_return_type(result_type);
+        action->set_early_return_size_of_parameters(size_of_parameters);
 
         if ((TraceRuntimeRecovery & TRACE_EARLYRET) != 0) {
           ResourceMark rm(thread);
+          Bytecode_invoke bi(current_method, current_bci);
 
           tty->print_cr("[Ares] fast_early_return: index=%d, rettype=%s, size_of_p=%d, %s@%d->%s",
               index,
-              type2name(bi.result_type()),
+              type2name(result_type),
               action->early_return_size_of_parameters(),
               current_method->name_and_sig_as_C_string(),
               current_bci,
@@ -779,7 +1039,7 @@ void RecoveryOracle::fast_early_return(JavaThread* thread, GrowableArray<Method*
               failure_type_name(action->failure_type()),
               end_index,
               index,
-              type2name(bi.result_type()),
+              type2name(result_type),
               index + dropped_extra,
               methods->at(0)->name_and_sig_as_C_string());
         }
@@ -794,13 +1054,23 @@ void RecoveryOracle::determine_recovery_action(JavaThread* thread, GrowableArray
   const int recovery_context_offset = action->recovery_context_offset();
   assert(recovery_context_offset >= 0, "sanity check");
 
+  if (RecoveryTimeBudgetMicros > 0) {
+    RuntimeRecoveryState* state = thread->runtime_recovery_state();
+    state->set_recovery_deadline(os::javaTimeNanos() + (jlong)RecoveryTimeBudgetMicros * (NANOUNITS / MICROUNITS));
+    determine_recovery_action_within_budget(thread, methods, bcis, action);
+    state->clr_recovery_deadline();
+    return;
+  }
+
   if (UseJPF) {
     run_jpf_with_recovery_action(thread, methods, bcis, action);
+    reject_known_bad(thread, action);
     return; // JPF will try all other strategy
   }
 
   if (UseErrorTransformation) {
     fast_error_transformation(thread, methods, bcis, action);
+    reject_known_bad(thread, action);
 
     if (can_recover(action)) {
       return;
@@ -809,6 +1079,7 @@ void RecoveryOracle::determine_recovery_action(JavaThread* thread, GrowableArray
 
   if (UseEarlyReturn) {
     fast_early_return(thread, methods, bcis, action);
+    reject_known_bad(thread, action);
 
     if (can_recover(action)) {
       return;
@@ -818,6 +1089,138 @@ void RecoveryOracle::determine_recovery_action(JavaThread* thread, GrowableArray
   return;
 }
 
+// Under RecoveryTimeBudgetMicros the strategies run from the cheapest to the
+// most expensive one:
+//
+//   cache  decisions taken before for the same failure site
+//   stack  handlers on the stack, no I/O
+//   index  known handler keys in RecoveryIndexFile, a hash probe
+//   redis  one round trip per probed key
+//   jpf    a model checker run
+//
+// The first error transformation found is taken. When none is found before
+// the deadline, the early return found by fast_early_return is the best
+// action left; it only looks at the stack, so it is computed even when the
+// budget is gone. Redis stops probing and the JPF worker pool stops waiting
+// at the deadline, taking the best candidate accepted by then. Without
+// workers the candidates are run one after the other on the failing thread
+// and none is started past the deadline. A JPF side without runCandidate
+// gets one runDefault call, which cannot be interrupted and is only not
+// started once the budget is gone.
+//
+// Actions known to fail at the site, see recoveryOutcome.hpp, are rejected
+// whichever strategy finds them. With AdaptiveRecoveryStrategies the error
+// transformation strategies run by their success rate instead, and those
+// which keep failing are skipped.
+void RecoveryOracle::determine_recovery_action_within_budget(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action) {
+  const bool log_events = RecoveryEventLog::is_enabled();
+  jlong start = 0;
+
+  if (RecoveryDecisionCache::is_enabled()) {
+    start = log_events ? os::javaTimeNanos() : 0;
+    bool found = RecoveryDecisionCache::lookup(thread, methods, bcis, action);
+    if (found) {
+      action->set_strategy(_cache_strategy);
+      reject_known_bad(thread, action);
+      found = can_recover(action);
+    }
+    if (log_events) {
+      RecoveryEventLog::log_strategy(thread, methods->at(0), bcis->at(0), _cache_strategy,
+          found, os::javaTimeNanos() - start);
+    }
+    if (found) {
+      if ((TraceRuntimeRecovery & TRACE_PRINT_ACTION) != 0) {
+        ResourceMark rm(thread);
+        tty->print_cr("[Ares] determine_recovery_action: (" INTPTR_FORMAT ") (%s) (%s) (%s) (cached)",
+            p2i((address)action->origin_exception()()),
+            action->origin_exception()->klass()->name()->as_C_string(),
+            failure_type_name(action->failure_type()),
+            recovery_type_name(action->recovery_type()));
+      }
+      return;
+    }
+  }
+
+  bool timed_out = false;
+
+  if (UseErrorTransformation) {
+    Strategy strategies[] = { _stack_strategy, _index_strategy, _redis_strategy };
+    const int strategy_count = (int)(sizeof(strategies) / sizeof(strategies[0]));
+    if (AdaptiveRecoveryStrategies && RecoveryOutcome::is_enabled()) {
+      RecoveryOutcome::rank_strategies(strategies, strategy_count);
+    }
+    for (int i = 0; i < strategy_count; i++) {
+      Strategy strategy = strategies[i];
+      if (strategy == _stack_strategy && !UseStack && !UseForceThrowable) {
+        continue;
+      }
+      if (strategy == _index_strategy && !RecoveryIndex::is_enabled()) {
+        continue;
+      }
+      if (strategy == _redis_strategy && (!UseRedis || (context() == NULL && !RecoveryReplay::is_replaying()))) {
+        continue;
+      }
+      if (RecoveryOutcome::should_skip(strategy)) {
+        continue;
+      }
+      if (out_of_budget(thread)) {
+        count_timeout(strategy);
+        timed_out = true;
+        continue;
+      }
+
+      start = log_events ? os::javaTimeNanos() : 0;
+      fast_error_transformation(thread, methods, bcis, action, strategy);
+      action->set_strategy(strategy);
+      reject_known_bad(thread, action);
+      if (log_events) {
+        RecoveryEventLog::log_strategy(thread, methods->at(0), bcis->at(0), strategy,
+            can_recover(action), os::javaTimeNanos() - start);
+      }
+
+      if (can_recover(action)) {
+        break;
+      }
+      if (out_of_budget(thread)) {
+        count_timeout(strategy);
+        timed_out = true;
+      }
+    }
+  }
+
+  if (!can_recover(action) && UseJPF) {
+    if (out_of_budget(thread)) {
+      count_timeout(_jpf_strategy);
+      timed_out = true;
+    } else {
+      start = log_events ? os::javaTimeNanos() : 0;
+      run_jpf_with_recovery_action(thread, methods, bcis, action);
+      action->set_strategy(_jpf_strategy);
+      reject_known_bad(thread, action);
+      if (log_events) {
+        RecoveryEventLog::log_strategy(thread, methods->at(0), bcis->at(0), _jpf_strategy,
+            can_recover(action), os::javaTimeNanos() - start);
+      }
+      if (!can_recover(action) && out_of_budget(thread)) {
+        count_timeout(_jpf_strategy);
+        timed_out = true;
+      }
+    }
+  }
+
+  if (!can_recover(action) && UseEarlyReturn) {
+    fast_early_return(thread, methods, bcis, action);
+    action->set_strategy(_default_strategy);
+    reject_known_bad(thread, action);
+  }
+
+  // A decision taken in a hurry is not remembered, the next failure at the
+  // site may find a better one.
+  if (can_recover(action) && !timed_out && RecoveryDecisionCache::is_enabled()) {
+    RecoveryDecisionCache::record(methods, bcis, action);
+  }
+}
+
 void RecoveryOracle::fast_exception_handler_bci_and_caught_klass_use_induced(
     Method* method, int throw_bci,
     KlassHandle &caught_klass,
@@ -854,7 +1257,7 @@ void RecoveryOracle::fast_exception_handler_bci_and_caught_klass_use_induced(
             handler_bci
             );
 
-        if (!redis_contains_key_precise(key.as_string(), THREAD)) {
+        if (!redis_contains_key_of(method, key.as_string(), THREAD)) {
           continue;
         }
 
@@ -908,6 +1311,13 @@ void RecoveryOracle::fast_exception_handler_bci_and_caught_klass_for(
     TRAPS) {
   assert(handler_bci == -1, "sanity check");
   assert(caught_klass.is_null(), "sanity check");
+
+  // Precomputed catch types let us skip constant pool resolution
+  if (ex_klass.not_null() &&
+      RecoveryMetadata::find_handler(method, ex_klass, throw_bci, ignore_no_string_void, caught_klass, handler_bci)) {
+    return;
+  }
+
   // exception table holds quadruple entries of the form (beg_bci, end_bci, handler_bci, klass_index)
   // access exception table
   ExceptionTable table(method);
@@ -982,8 +1392,21 @@ void RecoveryOracle::fast_exception_handler_bci_and_caught_klass_for(
 }
 
 
-// return false when reply is nil, empty list, empty string
 bool RecoveryOracle::redis_contains_key_common(const char* keys_command, TRAPS) {
+  if (RecoveryReplay::is_replaying()) {
+    return RecoveryReplay::replay_redis(keys_command);
+  }
+
+  bool found = redis_send_command(keys_command);
+
+  if (RecoveryReplay::is_recording()) {
+    RecoveryReplay::record_redis(keys_command, found);
+  }
+  return found;
+}
+
+// return false when reply is nil, empty list, empty string
+bool RecoveryOracle::redis_send_command(const char* keys_command) {
 
   redisReply* reply = (redisReply*)redisCommand(
       _context,
@@ -1042,6 +1465,13 @@ bool RecoveryOracle::redis_contains_key_precise(const char* precise, TRAPS) {
   return redis_contains_key_common(ss.as_string(), THREAD);
 }
 
+bool RecoveryOracle::redis_contains_key_of(Method* method, const char* key, TRAPS) {
+  if (RecoveryPrefetch::covers(method)) {
+    return RecoveryIndex::contains(key);
+  }
+  return redis_contains_key_precise(key, THREAD);
+}
+
 bool RecoveryOracle::has_known_exception_handler_use_redis(
        int begin_index,
        int end_index,
@@ -1053,9 +1483,35 @@ bool RecoveryOracle::has_known_exception_handler_use_redis(
        int &handler_bci,
        int &handler_index,
        TRAPS) {
+  return has_known_exception_handler_use_keys(
+      _redis_strategy,
+      begin_index,
+      end_index,
+      methods, bcis,
+      top_method,
+      known_exception_type,
+      handler_method, handler_bci, handler_index, THREAD);
+}
+
+// The keys are looked up in redis for the _redis_strategy and in the
+// RecoveryIndex for the _index_strategy.
+bool RecoveryOracle::has_known_exception_handler_use_keys(
+       Strategy strategy,
+       int begin_index,
+       int end_index,
+       GrowableArray<Method*>* methods,
+       GrowableArray<int>* bcis,
+       Method* top_method,
+       KlassHandle &known_exception_type,
+       Method* &handler_method,
+       int &handler_bci,
+       int &handler_index,
+       TRAPS) {
 
   JavaThread* thread = (JavaThread*)THREAD;
 
+  assert(strategy == _redis_strategy || strategy == _index_strategy, "sanity check");
+
   int length = top_method->checked_exceptions_length();
 
   if (length <= 0) {
@@ -1096,10 +1552,19 @@ bool RecoveryOracle::has_known_exception_handler_use_redis(
             //          top_method->name_and_sig_as_C_string(),
             cs.as_string());
 
-        if (redis_contains_key_precise(key.as_string(), THREAD)) {
+        if (strategy == _redis_strategy && out_of_budget(thread)) {
+          return false;
+        }
+
+        bool found = strategy == _index_strategy ?
+            RecoveryIndex::contains(key.as_string()) :
+            redis_contains_key_of(current_method, key.as_string(), THREAD);
+
+        if (found) {
           if ((TraceRuntimeRecovery & TRACE_USE_REDIS) != 0) {
             ResourceMark rm(THREAD);
-            tty->print_cr("[Ares] has_known_exception_handler_use_redis: find the call string in redis. %s", key.as_string());
+            tty->print_cr("[Ares] has_known_exception_handler_use_redis: find the call string in %s. %s",
+                strategy_name(strategy), key.as_string());
           }
 
           known_exception_type = klass;
@@ -1110,12 +1575,13 @@ bool RecoveryOracle::has_known_exception_handler_use_redis(
         } else {
           if ((TraceRuntimeRecovery & TRACE_USE_REDIS) != 0) {
             ResourceMark rm(THREAD);
-            tty->print_cr("[Ares] has_known_exception_handler_use_redis: cannot find the call string in redis. %s", key.as_string());
+            tty->print_cr("[Ares] has_known_exception_handler_use_redis: cannot find the call string in %s. %s",
+                strategy_name(strategy), key.as_string());
           }
         }
       }
 
-      if (UseInduced) {
+      if (UseInduced && strategy == _redis_strategy) {
         fast_exception_handler_bci_and_caught_klass_use_induced(current_method, current_bci,
             known_exception_type, handler_bci, THREAD);
         if (HAS_PENDING_EXCEPTION) {
@@ -1178,6 +1644,11 @@ bool RecoveryOracle::has_known_exception_handler_use_stack(
       tty->print_cr("[Ares] has_known_exception_handler_use_stack: use stack: %d %s@%d", index, current_method->name_and_sig_as_C_string(), current_bci);
     }
 
+    // Its handler catches everything only to wrap it
+    if (is_sun_reflect_GeneratedAccessor(current_method)) {
+      continue;
+    }
+
     for (int i=0; i<ce_length; i++) {
       current_bci = bcis->at(index); // update current_bci, as we may change it in the following
 
@@ -1388,10 +1859,11 @@ void RecoveryOracle::fill_stack(JavaThread* thread, GrowableArray<Method*>* meth
 
       Bytecodes::Code java_code = current_method->java_code_at(current_bci);
       if (Bytecodes::is_invoke(java_code)) {
-        Bytecode_invoke bi(current_method, current_bci);
-        current_method = bi.static_target(thread)();
-
+        // Only resolve the incomplete top when we are going to print it
         if ((TraceRuntimeRecovery & TRACE_FILL_STACK) != 0) {
+          Bytecode_invoke bi(current_method, current_bci);
+          current_method = bi.static_target(thread)();
+
           ResourceMark rm(thread);
           tty->print_cr("[Ares] fill_stack:: -1. %s@UNKNOWN", current_method->name_and_sig_as_C_string());
         }
@@ -1461,7 +1933,7 @@ void RecoveryOracle::query_known_exception_handler(
     }
 
     //if (length > 0) {
-      if (has_known_exception_handler(index+1, methods->length(), methods, bcis,
+      if (has_known_exception_handler(_default_strategy, index+1, methods->length(), methods, bcis,
             current_method, known_exception_type, handler_method, handler_bci, handler_index, THREAD)) {
         return;
       }
@@ -1479,6 +1951,7 @@ void RecoveryOracle::query_known_exception_handler(
 }
 
 bool RecoveryOracle::has_known_exception_handler(
+    Strategy strategy,
     int begin_index,
     int end_index,
     GrowableArray<Method*>* methods,
@@ -1490,6 +1963,41 @@ bool RecoveryOracle::has_known_exception_handler(
     int &handler_index,
     TRAPS) {
 
+  switch (strategy) {
+  case _stack_strategy:
+    if (UseStack) {
+      return has_known_exception_handler_use_stack(
+          begin_index,
+          end_index,
+          methods, bcis,
+          top_method,
+          known_exception_type,
+          handler_method, handler_bci, handler_index, THREAD);
+    }
+    if (UseForceThrowable) {
+      return has_known_exception_handler_force_throwable(
+          begin_index,
+          end_index,
+          methods, bcis,
+          top_method,
+          known_exception_type,
+          handler_method, handler_bci, handler_index, THREAD);
+    }
+    return false;
+  case _index_strategy:
+  case _redis_strategy:
+    return has_known_exception_handler_use_keys(
+        strategy,
+        begin_index,
+        end_index,
+        methods, bcis,
+        top_method,
+        known_exception_type,
+        handler_method, handler_bci, handler_index, THREAD);
+  default:
+    break;
+  }
+
   if (UseRedis) {
     return has_known_exception_handler_use_redis(
         begin_index,
@@ -1536,6 +2044,9 @@ void RecoveryOracle::run_jpf_with_recovery_action(JavaThread* thread, GrowableAr
 
   Method* top_method = methods->at(0);
 
+  // Only a native reflective call leaves invoke0 at the top. An inflated one
+  // fails in the invoked method, above its generated accessor, whose frame
+  // load_stack_data leaves out like the other frames of Reflection.
   if (top_method->is_native()) {
     // currently we do not want run_jpf_in_native
     // Clear last checked exception and make a re-try 
@@ -1587,7 +2098,17 @@ void RecoveryOracle::run_jpf_with_recovery_action(JavaThread* thread, GrowableAr
   // In JPF, top has max_depth
   int final_max_depth = max_depth;
 
-  objArrayOop result_oop = run_jpf_with_exception(thread, exception, final_max_depth);
+  objArrayOop result_oop = NULL;
+  if (RecoveryReplay::is_replaying()) {
+    result_oop = RecoveryReplay::replay_jpf(thread, methods, bcis, exception, final_max_depth);
+  } else {
+    result_oop = run_jpf_with_exception(thread, exception, final_max_depth, methods, bcis);
+    if (RecoveryReplay::is_recording()) {
+      objArrayHandle answer(thread, result_oop);
+      RecoveryReplay::record_jpf(thread, methods, bcis, exception, max_depth, final_max_depth, answer);
+      result_oop = answer();
+    }
+  }
 
   if (result_oop == NULL) {
     return;
@@ -1649,19 +2170,22 @@ void RecoveryOracle::run_jpf_with_recovery_action(JavaThread* thread, GrowableAr
 
     assert(Bytecodes::is_invoke(java_code), "sanity check");
 
-    Bytecode_invoke bi(current_method, current_bci);
+    BasicType result_type;
+    int size_of_parameters;
+    invoke_site_shape(thread, current_method, current_bci, result_type, size_of_parameters);
 
     action->set_recovery_type(_early_return);
     action->set_early_return_offset(index);
-    action->set_early_return_type(bi.result_type());
-    action->set_early_return_size_of_parameters(bi.static_target(thread)->size_of_parameters());
+    action->set_early_return_type(result_type);
+    action->set_early_return_size_of_parameters(size_of_parameters);
 
     if ((TraceRuntimeRecovery & TRACE_EARLYRET) != 0) {
       ResourceMark rm(thread);
+      Bytecode_invoke bi(current_method, current_bci);
 
       tty->print_cr("[Ares] run_jpf_with_recovery_action: force early return (index=%d, rettype=%s, size_of_p=%d, %s@%d->%s",
           index,
-          type2name(bi.result_type()),
+          type2name(result_type),
           action->early_return_size_of_parameters(),
           current_method->name_and_sig_as_C_string(),
           current_bci,
@@ -1679,7 +2203,7 @@ void RecoveryOracle::run_jpf_with_recovery_action(JavaThread* thread, GrowableAr
           final_max_depth,
           index,
           index + dropped_extra,
-          type2name(bi.result_type()),
+          type2name(result_type),
           top_method->name_and_sig_as_C_string());
     }
 
@@ -1691,7 +2215,8 @@ void RecoveryOracle::run_jpf_with_recovery_action(JavaThread* thread, GrowableAr
 
 // as we cannot load all methods in the max_depth, i.e., recovery context,
 // we may only load the top final_max_depth frames
-objArrayOop RecoveryOracle::run_jpf_with_exception(JavaThread* thread, Handle exception, int &max_depth) {
+objArrayOop RecoveryOracle::run_jpf_with_exception(JavaThread* thread, Handle exception, int &max_depth,
+                                                   GrowableArray<Method*>* methods, GrowableArray<int>* bcis) {
   HandleMark hm(thread);
 
   TempNewSymbol aresClassName = SymbolTable::new_symbol("gov/nasa/jpf/Ares", thread);
@@ -1731,6 +2256,32 @@ objArrayOop RecoveryOracle::run_jpf_with_exception(JavaThread* thread, Handle ex
 
   objArrayHandle data_h(thread, data);
 
+  // Evaluate the candidates one by one if JPF supports it: on the worker
+  // pool, or on this thread when the remaining budget has to be checked
+  // between candidates.
+  jlong deadline = thread->runtime_recovery_state()->recovery_deadline();
+  bool per_candidate = JPFWorkerPool::is_supported(aresKlass);
+  bool parallel = per_candidate && JPFWorkerThreads > 0 && JPFWorkerPool::initialize(thread);
+  if (parallel || (per_candidate && deadline != 0)) {
+    ResourceMark rm(thread);
+    GrowableArray<Handle>* candidates = build_jpf_candidates(thread, methods, bcis, exception, max_depth);
+    if (candidates == NULL || candidates->is_empty()) {
+      return NULL;
+    }
+
+    assert(!thread->runtime_recovery_state()->is_in_run_jpf(), "sanity check");
+    thread->runtime_recovery_state()->set_in_run_jpf();
+    objArrayOop result = parallel ?
+      JPFWorkerPool::evaluate_candidates(thread, data_h, candidates, deadline, thread) :
+      JPFWorkerPool::evaluate_candidates_sequentially(thread, data_h, candidates, deadline, thread);
+    thread->runtime_recovery_state()->clr_in_run_jpf();
+    if (thread->has_pending_exception()) {
+      thread->clear_pending_exception();
+      return NULL;
+    }
+    return result;
+  }
+
   {
     assert(!thread->runtime_recovery_state()->is_in_run_jpf(), "sanity check");
 
@@ -1760,6 +2311,100 @@ objArrayOop RecoveryOracle::run_jpf_with_exception(JavaThread* thread, Handle ex
   }
 }
 
+static Handle make_jpf_candidate(JavaThread* thread, Handle type, Handle value) {
+  objArrayOop candidate = oopFactory::new_objectArray(2, thread);
+  if (thread->has_pending_exception()) {
+    return Handle();
+  }
+  candidate->obj_at_put(0, type());
+  candidate->obj_at_put(1, value());
+  return Handle(thread, candidate);
+}
+
+// The candidate actions runDefault would try, best ranked first: frames
+// closer to the failure first, and within a frame the error transformations
+// into the exceptions its handlers catch before the early return from its
+// call. Returns NULL on allocation failure.
+GrowableArray<Handle>* RecoveryOracle::build_jpf_candidates(JavaThread* thread, GrowableArray<Method*>* methods,
+                                                            GrowableArray<int>* bcis, Handle exception, int max_depth) {
+  GrowableArray<Handle>* candidates = new GrowableArray<Handle>(16);
+  GrowableArray<Klass*>* targets = new GrowableArray<Klass*>(8);
+  // Candidates known to fail at this site are not worth a JPF run
+  uintptr_t signature = thread->runtime_recovery_state()->failure_signature();
+
+  Handle error_transformation = java_lang_String::create_from_str("ErrorTransformation", thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+  Handle early_return = java_lang_String::create_from_str("EarlyReturn", thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+
+  for (int index = 0; index <= max_depth && index < methods->length(); index++) {
+    Method* m = methods->at(index);
+    if (m->is_native() || is_sun_reflect_GeneratedAccessor(m)) {
+      continue;
+    }
+    int bci = bcis->at(index);
+
+    ExceptionTable table(m);
+    constantPoolHandle pool(thread, m->constants());
+    for (int i = 0; i < table.length(); i++) {
+      int klass_index = table.catch_type_index(i);
+      if (klass_index == 0 || bci < table.start_pc(i) || bci >= table.end_pc(i)) {
+        continue;
+      }
+      // Resolved through the holder's loader like the other JPF paths do, a
+      // handler which never ran has an unresolved catch type.
+      Klass* k = pool->klass_at(klass_index, thread);
+      if (thread->has_pending_exception()) {
+        thread->clear_pending_exception();
+        continue;
+      }
+      if (k == exception->klass() || targets->contains(k) ||
+          !has_string_void_init(KlassHandle(thread, k))) {
+        continue;
+      }
+      targets->append(k);
+      if (RecoveryOutcome::is_known_bad(signature, RecoveryOutcome::action_key(_error_transformation, k, -1))) {
+        continue;
+      }
+      Handle c = make_jpf_candidate(thread, error_transformation, Handle(thread, k->java_mirror()));
+      if (c.is_null()) {
+        thread->clear_pending_exception();
+        return NULL;
+      }
+      candidates->append(c);
+    }
+
+    if (Bytecodes::is_invoke(m->java_code_at(bci)) &&
+        !RecoveryOutcome::is_known_bad(signature, RecoveryOutcome::action_key(_early_return, NULL, index))) {
+      // In JPF, top has max_depth
+      jvalue depth;
+      depth.i = max_depth - index;
+      Handle boxed(thread, java_lang_boxing_object::create(T_INT, &depth, thread));
+      if (thread->has_pending_exception()) {
+        thread->clear_pending_exception();
+        return NULL;
+      }
+      Handle c = make_jpf_candidate(thread, early_return, boxed);
+      if (c.is_null()) {
+        thread->clear_pending_exception();
+        return NULL;
+      }
+      candidates->append(c);
+    }
+  }
+
+  if ((TraceRuntimeRecovery & TRACE_JPF) != 0) {
+    tty->print_cr("[Ares] build_jpf_candidates: %d candidates within depth %d", candidates->length(), max_depth);
+  }
+  return candidates;
+}
+
 // In JVM, top's offset is 0 and top's depth is 0
 // In JPF, top's depth is max_depth
 objArrayOop RecoveryOracle::load_stack_data(JavaThread* thread, Handle exception, int &max_offset) {
@@ -1799,15 +2444,10 @@ objArrayOop RecoveryOracle::load_stack_data(JavaThread* thread, Handle exception
 
         bool skip_this_frame = false;
 
-        if (jvf->method()->name()->equals("invoke")) {
-          // Skip two invoke of Reflection
-          if (jvf->method()->method_holder()->name()->equals("sun/reflect/NativeMethodAccessorImpl")) {
-            skip_this_frame = true;
-          } else if (jvf->method()->method_holder()->name()->equals("sun/reflect/DelegatingMethodAccessorImpl")) {
-            skip_this_frame = true;
-          } else if (jvf->method()->method_holder() == SystemDictionary::reflect_Method_klass()) {
-            skip_this_frame = true;
-          }
+        // Skip the frames of Reflection, JPF invokes the target itself. The
+        // accessors generated for an inflated call do not exist in JPF.
+        if (is_reflection_invoke(jvf->method())) {
+          skip_this_frame = true;
         }
 
         if (!skip_this_frame) {
@@ -29,6 +29,8 @@
 
 #define TRACE_SKIP_UNSAFE      0x00001000
 #define TRACE_RECURSIVE        0x00002000
+#define TRACE_METADATA         0x00004000
+#define TRACE_JPF              0x00008000
 
 //class Recovery : AllStatic {
 //
@@ -53,23 +55,68 @@ public:
     _early_return = 2
   };
 
+  // Where the oracle looks for an action, from the cheapest to the most
+  // expensive. _default_strategy picks the handler lookup by UseRedis,
+  // UseStack and UseForceThrowable as without a time budget.
+  enum Strategy {
+    _default_strategy = -1,
+    _cache_strategy = 0,
+    _stack_strategy = 1,
+    _index_strategy = 2,
+    _redis_strategy = 3,
+    _jpf_strategy = 4,
+    _strategy_limit = 5
+  };
+
+  // The steps of do_recover, timed for WhiteBox::decideRecovery.
+  enum Stage {
+    _fill_stack_stage = 0,
+    _failure_type_stage = 1,
+    _unsafe_init_stage = 2,
+    _recovery_action_stage = 3,
+    _stage_limit = 4
+  };
+
 private:
   static redisContext* _context;
 
   static volatile jint  _recovered_count;
 
+  // Per strategy, how many times it was cut short or skipped because the
+  // recovery ran out of RecoveryTimeBudgetMicros.
+  static volatile jint  _strategy_timeouts[_strategy_limit];
+
+  static void count_timeout(Strategy strategy);
+
+  // Drops an action which is known to fail at its site.
+  static void reject_known_bad(JavaThread* thread, RecoveryAction* action);
+
 public:
 
   static jint next_recovered_count();
 
   static const char* failure_type_name(FailureType);
   static const char* recovery_type_name(RecoveryType);
+  static const char* strategy_name(Strategy);
+
+  static jint strategy_timeouts(Strategy strategy) { return _strategy_timeouts[strategy]; }
+  static void reset_strategy_timeouts();
+
+  // Whether the recovery of thread is past its deadline.
+  static bool out_of_budget(JavaThread* thread);
 
   static redisContext* context();
   static void initialize();
 
   static bool quick_cannot_recover_check(JavaThread* thread, Handle exception);
 
+  // Called by C2 code before the frame of nm is deoptimized to recover from an
+  // exception arriving at pc. Counts a Reason_recovery trap in the MethodData of
+  // the method containing the call site, and recompiles around the site once
+  // the decayed count reaches PerMethodRecoveryTrapLimit, see the comment in
+  // the .cpp file.
+  static void record_compiled_recovery(JavaThread* thread, nmethod* nm, address pc);
+
   static bool require_recovery(FailureType ft) {
     return ft == _uncaught_exception || ft == _trivially_handled;
   }
@@ -79,16 +126,27 @@ public:
   static bool is_trivial_handler(KlassHandle handler_klass);
 
   static void recover(JavaThread* thread, RecoveryAction* action);
-  static void do_recover(JavaThread* thread, RecoveryAction* action);
+  // skip_frames drops the top frames of the stack, stage_nanos receives the
+  // time spent in each Stage if not NULL. Decisions that are not applied
+  // (WhiteBox) pass record_outcome = false to leave the outcome tracking
+  // and the thread's failure signature alone.
+  static void do_recover(JavaThread* thread, RecoveryAction* action,
+      int skip_frames = 0, jlong* stage_nanos = NULL, bool record_outcome = true);
 
   static bool has_unsafe_init(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action);
 
   static void determine_failure_type_and_recovery_context(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action);
   static void determine_recovery_action(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action);
+  static void determine_recovery_action_within_budget(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action);
 
-  static Handle allocate_target_exception(JavaThread* thread, Handle origin_exception, KlassHandle target_exception_klass);
+  static Handle allocate_target_exception(JavaThread* thread, Handle origin_exception, KlassHandle target_exception_klass,
+      Method* site_method = NULL, int site_bci = -1);
 
-  static void fast_error_transformation(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action);
+  static void invoke_site_shape(JavaThread* thread, Method* method, int bci,
+      BasicType &result_type, int &size_of_parameters);
+
+  static void fast_error_transformation(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action,
+      Strategy strategy = _default_strategy);
   static void fast_early_return(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, RecoveryAction* action);
 
   static void fast_exception_handler_bci_and_caught_klass_for(Method* mh,
@@ -99,8 +157,11 @@ public:
 
 
   static bool redis_contains_key_common(const char* keys_command, TRAPS);
+  static bool redis_send_command(const char* keys_command);
   static bool redis_contains_key_prefix(const char* prefix, TRAPS);
   static bool redis_contains_key_precise(const char* key, TRAPS);
+  // A key naming method, answered locally if its class was prefetched.
+  static bool redis_contains_key_of(Method* method, const char* key, TRAPS);
 
   static void fill_stack(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis, int max_depth=MaxJavaStackTraceDepth, int max_frame_depth=MaxJavaStackTraceDepth);
 
@@ -125,6 +186,7 @@ public:
       );
 
   static bool has_known_exception_handler(
+       Strategy strategy,
        int begin_index,
        int end_index,
        GrowableArray<Method*>* methods,
@@ -136,6 +198,19 @@ public:
        int &handler_index,
        TRAPS);
 
+  static bool has_known_exception_handler_use_keys(
+       Strategy strategy,
+       int begin_index,
+       int end_index,
+       GrowableArray<Method*>* methods,
+       GrowableArray<int>* bcis,
+       Method* top_method,
+       KlassHandle &known_exception_type,
+       Method* &hander_method,
+       int &bci,
+       int &handler_index,
+       TRAPS);
+
   static bool has_known_exception_handler_use_redis(
        int begin_index,
        int end_index,
@@ -173,10 +248,16 @@ public:
        TRAPS);
 
   static bool is_sun_reflect_NativeMethodAccessorImpl(Method* mh);
+  static bool is_sun_reflect_GeneratedAccessor(Method* mh);
+  // A frame between Method.invoke and the invoked method
+  static bool is_reflection_invoke(Method* mh);
 
   static void run_jpf_with_recovery_action(JavaThread* thread, GrowableArray<Method*>* methods,
       GrowableArray<int>* bcis, RecoveryAction* action);
-  static objArrayOop run_jpf_with_exception(JavaThread* thread, Handle exception, int &max_depth);
+  static objArrayOop run_jpf_with_exception(JavaThread* thread, Handle exception, int &max_depth,
+                                            GrowableArray<Method*>* methods, GrowableArray<int>* bcis);
+  static GrowableArray<Handle>* build_jpf_candidates(JavaThread* thread, GrowableArray<Method*>* methods,
+                                                     GrowableArray<int>* bcis, Handle exception, int max_depth);
   static objArrayOop load_stack_data(JavaThread* thread, Handle exception, int &max_depth);
 };
 
@@ -201,9 +282,18 @@ private:
   // Used by reflection
   Method** _top_method;
 
+  // The top frame of the recovery stack, where the failure happened
+  Method* _site_method;
+  int _site_bci;
+
   // Use jni handles, thus we can freely use HandleMark
   Klass* _target_exception_klass;
 
+  // See RecoveryDecisionCache::signature_for, 0 until the failure type is known
+  uintptr_t _signature;
+  // The strategy which found the action
+  RecoveryOracle::Strategy _strategy;
+
 public:
   RecoveryAction(
       JavaThread* thread,
@@ -217,7 +307,11 @@ public:
     _early_return_size_of_parameters(0),
     _origin_exception(origin_exception),
     _top_method(NULL),
-    _target_exception_klass(NULL) {
+    _site_method(NULL),
+    _site_bci(-1),
+    _target_exception_klass(NULL),
+    _signature(0),
+    _strategy(RecoveryOracle::_default_strategy) {
   }
 
   ~RecoveryAction() {
@@ -263,6 +357,20 @@ public:
 
   Handle origin_exception() { return (*_origin_exception); }
 
+  void set_site(Method* method, int bci) {
+    _site_method = method;
+    _site_bci = bci;
+  }
+
+  Method* site_method() { return _site_method; }
+  int site_bci() { return _site_bci; }
+
+  uintptr_t signature() { return _signature; }
+  void set_signature(uintptr_t signature) { _signature = signature; }
+
+  RecoveryOracle::Strategy strategy() { return _strategy; }
+  void set_strategy(RecoveryOracle::Strategy strategy) { _strategy = strategy; }
+
   Klass* target_exception_klass() {
     assert(_target_exception_klass != NULL, "sanity check");
     return _target_exception_klass;
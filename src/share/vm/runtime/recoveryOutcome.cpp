@@ -0,0 +1,246 @@
+#include "precompiled.hpp"
+
+#include "runtime/atomic.inline.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryOutcome.hpp"
+#include "runtime/runtimeRecoveryState.hpp"
+
+RecoveryOutcomeEntry* RecoveryOutcome::_table = NULL;
+RuntimeRecoveryState* RecoveryOutcome::_pending_head = NULL;
+RuntimeRecoveryState* RecoveryOutcome::_pending_tail = NULL;
+volatile jint         RecoveryOutcome::_strategy_successes[RecoveryOracle::_strategy_limit];
+volatile jint         RecoveryOutcome::_strategy_failures[RecoveryOracle::_strategy_limit];
+volatile jint         RecoveryOutcome::_strategy_skips[RecoveryOracle::_strategy_limit];
+
+// Counts are halved when an entry reaches this many outcomes, so that an
+// action which started to fail, or to help, is judged by recent outcomes.
+static const jint max_outcomes = 1024;
+
+uintptr_t RecoveryOutcome::action_key(RecoveryOracle::RecoveryType type, Klass* target, int early_return_offset) {
+  switch (type) {
+  case RecoveryOracle::_error_transformation:
+    return (uintptr_t)target | 1;
+  case RecoveryOracle::_early_return:
+    return ((uintptr_t)early_return_offset << 2) | 2;
+  default:
+    return 0;
+  }
+}
+
+uintptr_t RecoveryOutcome::action_key(RecoveryAction* action) {
+  if (action->can_error_transformation()) {
+    return action_key(RecoveryOracle::_error_transformation, action->target_exception_klass(), -1);
+  } else if (action->can_early_return()) {
+    return action_key(RecoveryOracle::_early_return, NULL, action->early_return_offset());
+  }
+  return 0;
+}
+
+RecoveryOutcomeEntry* RecoveryOutcome::entry_for(uintptr_t signature, uintptr_t action) {
+  assert_lock_strong(RecoveryOutcome_lock);
+  if (_table == NULL) {
+    _table = NEW_C_HEAP_ARRAY(RecoveryOutcomeEntry, _table_size, mtInternal);
+    memset(_table, 0, _table_size * sizeof(RecoveryOutcomeEntry));
+  }
+  return &_table[(signature * 31 + action) & (_table_size - 1)];
+}
+
+bool RecoveryOutcome::is_bad(jint successes, jint failures) {
+  jlong total = (jlong)successes + failures;
+  return total > 0 && total >= RecoveryOutcomeMinSamples &&
+         (jlong)failures * 100 >= (jlong)RecoveryOutcomeBadFailureRate * total;
+}
+
+void RecoveryOutcome::record(uintptr_t signature, uintptr_t action, int strategy, bool success) {
+  assert_lock_strong(RecoveryOutcome_lock);
+  RecoveryOutcomeEntry* e = entry_for(signature, action);
+  if (e->_signature != signature || e->_action != action) {
+    e->_signature = signature;
+    e->_action = action;
+    e->_successes = 0;
+    e->_failures = 0;
+  }
+  if (success) {
+    e->_successes++;
+  } else {
+    e->_failures++;
+  }
+  if (e->_successes + e->_failures >= max_outcomes) {
+    e->_successes /= 2;
+    e->_failures /= 2;
+  }
+
+  // Updated under the lock as well, so that halving does not lose
+  // outcomes; readers do not take it.
+  if (strategy >= 0 && strategy < RecoveryOracle::_strategy_limit) {
+    if (success) {
+      _strategy_successes[strategy]++;
+    } else {
+      _strategy_failures[strategy]++;
+    }
+    if (_strategy_successes[strategy] + _strategy_failures[strategy] >= max_outcomes) {
+      _strategy_successes[strategy] /= 2;
+      _strategy_failures[strategy] /= 2;
+    }
+  }
+}
+
+void RecoveryOutcome::resolve_pending(RuntimeRecoveryState* state, bool failed) {
+  assert_lock_strong(RecoveryOutcome_lock);
+  assert(state->has_pending_outcome(), "sanity check");
+  RuntimeRecoveryState* prev = NULL;
+  RuntimeRecoveryState* cur = _pending_head;
+  while (cur != state) {
+    assert(cur != NULL, "pending outcome is not listed");
+    prev = cur;
+    cur = cur->next_pending_outcome();
+  }
+  if (prev == NULL) {
+    _pending_head = state->next_pending_outcome();
+  } else {
+    prev->set_next_pending_outcome(state->next_pending_outcome());
+  }
+  if (_pending_tail == state) {
+    _pending_tail = prev;
+  }
+  state->set_next_pending_outcome(NULL);
+
+  record(state->pending_outcome_signature(), state->pending_outcome_action(),
+      state->pending_outcome_strategy(), !failed);
+  if ((TraceRuntimeRecovery & TRACE_PRINT_ACTION) != 0) {
+    tty->print_cr("[Ares] recovery outcome: %s (signature " INTPTR_FORMAT ", action " INTPTR_FORMAT ", strategy %s)",
+        failed ? "failed" : "succeeded",
+        state->pending_outcome_signature(),
+        state->pending_outcome_action(),
+        RecoveryOracle::strategy_name((RecoveryOracle::Strategy)state->pending_outcome_strategy()));
+  }
+  state->clr_pending_outcome();
+}
+
+void RecoveryOutcome::failed_again(RuntimeRecoveryState* state) {
+  assert_lock_strong(RecoveryOutcome_lock);
+  assert(state->has_pending_outcome(), "sanity check");
+  jlong elapsed = os::javaTimeMillis() - state->pending_outcome_time();
+  resolve_pending(state, elapsed < RecoveryOutcomeWindowMillis);
+}
+
+void RecoveryOutcome::resolve_expired() {
+  assert_lock_strong(RecoveryOutcome_lock);
+  if (_pending_head == NULL) {
+    return;
+  }
+  jlong now = os::javaTimeMillis();
+  while (_pending_head != NULL &&
+         now - _pending_head->pending_outcome_time() >= RecoveryOutcomeWindowMillis) {
+    resolve_pending(_pending_head, false);
+  }
+}
+
+void RecoveryOutcome::failure_seen(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+  resolve_expired();
+  if (state->has_pending_outcome()) {
+    failed_again(state);
+  }
+}
+
+void RecoveryOutcome::uncaught_exception(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  if (state == NULL) {
+    return;
+  }
+  MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+  resolve_expired();
+  if (state->has_pending_outcome()) {
+    failed_again(state);
+  }
+}
+
+void RecoveryOutcome::thread_exiting(RuntimeRecoveryState* state) {
+  MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+  resolve_expired();
+  if (state->has_pending_outcome()) {
+    // The thread ran to its end without an uncaught exception.
+    resolve_pending(state, false);
+  }
+}
+
+void RecoveryOutcome::recovery_applied(JavaThread* thread, RecoveryAction* action) {
+  uintptr_t key = action_key(action);
+  if (action->signature() == 0 || key == 0) {
+    return;
+  }
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+  resolve_expired();
+  if (state->has_pending_outcome()) {
+    // Not a failure of the same thread, e.g. a second recovery of the
+    // same exception; the earlier one did not prevent it if it was
+    // applied within the window.
+    failed_again(state);
+  }
+  state->set_pending_outcome(action->signature(), key, action->strategy(), os::javaTimeMillis());
+  assert(state->next_pending_outcome() == NULL, "sanity check");
+  if (_pending_tail == NULL) {
+    _pending_head = state;
+  } else {
+    _pending_tail->set_next_pending_outcome(state);
+  }
+  _pending_tail = state;
+}
+
+bool RecoveryOutcome::is_known_bad(uintptr_t signature, uintptr_t action) {
+  if (!is_enabled() || signature == 0 || action == 0) {
+    return false;
+  }
+  MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+  resolve_expired();
+  RecoveryOutcomeEntry* e = entry_for(signature, action);
+  return e->_signature == signature && e->_action == action && is_bad(e->_successes, e->_failures);
+}
+
+void RecoveryOutcome::rank_strategies(RecoveryOracle::Strategy* strategies, int count) {
+  {
+    MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+    resolve_expired();
+  }
+  // Success rates with one success and one failure added, so that an untried
+  // strategy ranks at 1/2. A stable insertion sort, count is small.
+  for (int i = 1; i < count; i++) {
+    RecoveryOracle::Strategy s = strategies[i];
+    jlong s_successes = (jlong)_strategy_successes[s] + 1;
+    jlong s_total = s_successes + _strategy_failures[s] + 1;
+    int j = i - 1;
+    while (j >= 0) {
+      RecoveryOracle::Strategy t = strategies[j];
+      jlong t_successes = (jlong)_strategy_successes[t] + 1;
+      jlong t_total = t_successes + _strategy_failures[t] + 1;
+      if (s_successes * t_total <= t_successes * s_total) {
+        break;
+      }
+      strategies[j + 1] = t;
+      j--;
+    }
+    strategies[j + 1] = s;
+  }
+}
+
+bool RecoveryOutcome::should_skip(RecoveryOracle::Strategy strategy) {
+  if (!is_enabled() || !AdaptiveRecoveryStrategies) {
+    return false;
+  }
+  if (!is_bad(_strategy_successes[strategy], _strategy_failures[strategy])) {
+    return false;
+  }
+  return Atomic::add(1, &_strategy_skips[strategy]) % _retry_interval != 0;
+}
+
+void RecoveryOutcome::purge() {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
+  MutexLockerEx ml(RecoveryOutcome_lock, Mutex::_no_safepoint_check_flag);
+  if (_table != NULL) {
+    memset(_table, 0, _table_size * sizeof(RecoveryOutcomeEntry));
+  }
+}
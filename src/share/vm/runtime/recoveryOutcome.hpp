@@ -0,0 +1,94 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYOUTCOME_HPP
+#define SHARE_VM_RUNTIME_RECOVERYOUTCOME_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/recoveryOracle.hpp"
+
+class RuntimeRecoveryState;
+
+//
+// Outcomes of applied recoveries, -XX:RecoveryOutcomeWindowMillis=<ms>.
+//
+// A recovery is judged by what its thread does next. If the thread fails
+// again, or dies of an uncaught exception, within the window, the recovery
+// did not help and counts as a failure; otherwise it counts as a success.
+// A thread which ends normally counts as a success however soon it exits.
+// Pending outcomes are kept in a list, oldest first, and those older than
+// the window are resolved as successes whenever outcomes are recorded or
+// read, so that the recoveries of threads which keep running are counted.
+//
+// Outcomes are kept per failure signature (see RecoveryDecisionCache) and
+// action, in a direct mapped table, and per strategy which found the action.
+// An action which failed at least RecoveryOutcomeBadFailureRate percent of
+// RecoveryOutcomeMinSamples or more times for a signature is known bad: the
+// oracle rejects it and JPF does not evaluate it.
+//
+// With -XX:+AdaptiveRecoveryStrategies the error transformation strategies
+// are also tried in the order of their success rate, and a strategy whose
+// actions are as bad as that is skipped except for one failure in every
+// _retry_interval, which keeps its rate up to date.
+//
+
+class RecoveryOutcomeEntry VALUE_OBJ_CLASS_SPEC {
+ public:
+  uintptr_t _signature;      // 0 for an empty slot
+  uintptr_t _action;
+  jint      _successes;
+  jint      _failures;
+};
+
+class RecoveryOutcome : AllStatic {
+ private:
+  enum {
+    _table_size     = 4096,  // a power of two
+    _retry_interval = 64
+  };
+
+  static RecoveryOutcomeEntry* _table;
+  // States with a pending outcome, oldest first
+  static RuntimeRecoveryState* _pending_head;
+  static RuntimeRecoveryState* _pending_tail;
+  static volatile jint         _strategy_successes[RecoveryOracle::_strategy_limit];
+  static volatile jint         _strategy_failures[RecoveryOracle::_strategy_limit];
+  static volatile jint         _strategy_skips[RecoveryOracle::_strategy_limit];
+
+  static RecoveryOutcomeEntry* entry_for(uintptr_t signature, uintptr_t action);
+  static void record(uintptr_t signature, uintptr_t action, int strategy, bool success);
+  static bool is_bad(jint successes, jint failures);
+  static void resolve_pending(RuntimeRecoveryState* state, bool failed);
+  // Resolves the pending outcome of state as failed if within the window.
+  static void failed_again(RuntimeRecoveryState* state);
+  // Resolves the pending outcomes older than the window as successes.
+  static void resolve_expired();
+
+ public:
+  static bool is_enabled() { return RecoveryOutcomeWindowMillis > 0; }
+
+  static uintptr_t action_key(RecoveryOracle::RecoveryType type, Klass* target, int early_return_offset);
+  static uintptr_t action_key(RecoveryAction* action);
+
+  // A failure which requires recovery happened on thread.
+  static void failure_seen(JavaThread* thread);
+  // action is about to be applied on thread.
+  static void recovery_applied(JavaThread* thread, RecoveryAction* action);
+  // thread is about to dispatch an uncaught exception.
+  static void uncaught_exception(JavaThread* thread);
+  // The thread owning state is exiting normally.
+  static void thread_exiting(RuntimeRecoveryState* state);
+
+  static bool is_known_bad(uintptr_t signature, uintptr_t action);
+  static bool is_known_bad(RecoveryAction* action) {
+    return is_known_bad(action->signature(), action_key(action));
+  }
+
+  // Sorts strategies by their success rate, stable for equal rates.
+  static void rank_strategies(RecoveryOracle::Strategy* strategies, int count);
+  // Whether strategy should be skipped this time.
+  static bool should_skip(RecoveryOracle::Strategy strategy);
+
+  // Called at a safepoint when classes have been unloaded.
+  static void purge();
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYOUTCOME_HPP
@@ -0,0 +1,346 @@
+#include "precompiled.hpp"
+
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryIndex.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/recoveryPrefetch.hpp"
+#include "runtime/recoveryReplay.hpp"
+
+bool                      RecoveryPrefetch::_active = false;
+redisContext*             RecoveryPrefetch::_context = NULL;
+RecoveryPrefetchThread*   RecoveryPrefetch::_thread = NULL;
+volatile bool             RecoveryPrefetch::_should_terminate = false;
+RecoveryPrefetchRequest*  RecoveryPrefetch::_queue = NULL;
+RecoveryPrefetchRequest** RecoveryPrefetch::_covered = NULL;
+int                       RecoveryPrefetch::_covered_count = 0;
+int                       RecoveryPrefetch::_key_count = 0;
+
+static void free_induced_keys(RecoveryPrefetchRequest* request) {
+  for (int i = 0; i < request->_induced_count; i++) {
+    os::free(request->_induced_keys[i], mtInternal);
+  }
+  FREE_C_HEAP_ARRAY(char*, request->_induced_keys, mtInternal);
+  request->_induced_keys = NULL;
+  request->_induced_count = 0;
+}
+
+static void free_request(RecoveryPrefetchRequest* request) {
+  free_induced_keys(request);
+  os::free(request->_name, mtInternal);
+  delete request;
+}
+
+RecoveryPrefetchThread::RecoveryPrefetchThread() : NamedThread() {
+  set_name("Recovery Prefetch Thread");
+}
+
+void RecoveryPrefetchThread::run() {
+  this->record_stack_base_and_size();
+  this->initialize_thread_local_storage();
+
+  while (true) {
+    RecoveryPrefetchRequest* batch;
+    {
+      MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+      while (RecoveryPrefetch::_queue == NULL && !RecoveryPrefetch::_should_terminate) {
+        RecoveryPrefetch_lock->wait(Mutex::_no_safepoint_check_flag);
+      }
+      if (RecoveryPrefetch::_should_terminate) {
+        return;
+      }
+      batch = RecoveryPrefetch::_queue;
+      RecoveryPrefetchRequest* last = batch;
+      for (int i = 1; i < RecoveryPrefetch::_max_batch && last->_next != NULL; i++) {
+        last = last->_next;
+      }
+      RecoveryPrefetch::_queue = last->_next;
+      last->_next = NULL;
+    }
+
+    if (!RecoveryPrefetch::fetch(batch)) {
+      warning("Lost the redis connection of the recovery prefetch thread, prefetching stops.");
+      MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+      RecoveryPrefetch::_active = false;
+      while (RecoveryPrefetch::_queue != NULL) {
+        RecoveryPrefetchRequest* next = RecoveryPrefetch::_queue->_next;
+        free_request(RecoveryPrefetch::_queue);
+        RecoveryPrefetch::_queue = next;
+      }
+      return;
+    }
+  }
+}
+
+void RecoveryPrefetch::initialize() {
+  if (!PrefetchRecoveryHandlers) {
+    return;
+  }
+  if (!UseRedis) {
+    warning("PrefetchRecoveryHandlers needs UseRedis, handlers are not prefetched.");
+    return;
+  }
+  if (RecoveryReplay::is_recording() || RecoveryReplay::is_replaying()) {
+    warning("Handlers are not prefetched while recording or replaying oracle answers.");
+    return;
+  }
+
+  redisContext* c = redisConnect("127.0.0.1", 6379);
+  if (c == NULL || c->err) {
+    tty->print_cr("[Ares] ERROR: create redis context for prefetching failed %s\n",
+        c != NULL ? c->errstr : "");
+    return;
+  }
+  _context = c;
+
+  _covered = NEW_C_HEAP_ARRAY(RecoveryPrefetchRequest*, _covered_bucket_count, mtInternal);
+  memset(_covered, 0, _covered_bucket_count * sizeof(RecoveryPrefetchRequest*));
+
+  _thread = new RecoveryPrefetchThread();
+  if (_thread == NULL || !os::create_thread(_thread, os::os_thread)) {
+    warning("Unable to create the recovery prefetch thread.");
+    return;
+  }
+  os::start_thread(_thread);
+  _active = true;
+}
+
+void RecoveryPrefetch::stop() {
+  if (!_active) {
+    return;
+  }
+  MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+  _should_terminate = true;
+  _active = false;
+  RecoveryPrefetch_lock->notify_all();
+
+  if ((TraceRuntimeRecovery & TRACE_USE_REDIS) != 0) {
+    tty->print_cr("[Ares] Prefetched %d known handler keys for %d classes", _key_count, _covered_count);
+  }
+}
+
+unsigned int RecoveryPrefetch::hash_for(const char* name) {
+  unsigned int h = 0;
+  for (const char* p = name; *p != '\0'; p++) {
+    h = 31 * h + (unsigned int)(unsigned char)*p;
+  }
+  return h;
+}
+
+bool RecoveryPrefetch::is_covered_locked(const char* name, unsigned int hash) {
+  assert_lock_strong(RecoveryPrefetch_lock);
+  for (RecoveryPrefetchRequest* e = _covered[hash % _covered_bucket_count]; e != NULL; e = e->_next) {
+    if (strcmp(e->_name, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RecoveryPrefetch::cover(RecoveryPrefetchRequest* request) {
+  free_induced_keys(request);
+  unsigned int hash = hash_for(request->_name);
+  MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+  if (is_covered_locked(request->_name, hash)) {
+    free_request(request);
+    return;
+  }
+  int b = hash % _covered_bucket_count;
+  request->_next = _covered[b];
+  _covered[b] = request;
+  _covered_count++;
+}
+
+void RecoveryPrefetch::compute_induced_keys(InstanceKlass* ik, RecoveryPrefetchRequest* request) {
+  ResourceMark rm;
+  Array<Method*>* methods = ik->methods();
+  int count = 0;
+  for (int i = 0; i < methods->length(); i++) {
+    Method* m = methods->at(i);
+    if (m->has_exception_handler()) {
+      count += m->exception_table_length();
+    }
+  }
+  request->_induced_keys = NEW_C_HEAP_ARRAY(char*, MAX2(count, 1), mtInternal);
+  request->_induced_count = 0;
+
+  for (int i = 0; i < methods->length(); i++) {
+    Method* m = methods->at(i);
+    if (!m->has_exception_handler()) {
+      continue;
+    }
+    const char* name_and_sig = m->name_and_sig_as_C_string();
+    ExceptionTable table(m);
+    for (int j = 0; j < table.length(); j++) {
+      // finally handlers are never induced
+      if (table.catch_type_index(j) == 0) {
+        continue;
+      }
+      stringStream key;
+      key.print("%s-induced:%s:%d:%d:%d",
+          RedisKeyPrefix,
+          name_and_sig,
+          table.start_pc(j),
+          table.end_pc(j),
+          table.handler_pc(j));
+      request->_induced_keys[request->_induced_count++] = os::strdup(key.as_string(), mtInternal);
+    }
+  }
+}
+
+void RecoveryPrefetch::class_linked(InstanceKlass* ik) {
+  ResourceMark rm;
+  const char* name = ik->external_name();
+  unsigned int hash = hash_for(name);
+  {
+    MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+    if (!_active || is_covered_locked(name, hash)) {
+      return;
+    }
+  }
+
+  RecoveryPrefetchRequest* request = new RecoveryPrefetchRequest();
+  request->_name = os::strdup(name, mtInternal);
+  compute_induced_keys(ik, request);
+
+  MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+  if (!_active) {
+    free_request(request);
+    return;
+  }
+  request->_next = _queue;
+  _queue = request;
+  RecoveryPrefetch_lock->notify();
+}
+
+bool RecoveryPrefetch::covers(Method* m) {
+  if (!is_enabled()) {
+    return false;
+  }
+  ResourceMark rm;
+  const char* name = m->method_holder()->external_name();
+  unsigned int hash = hash_for(name);
+
+  MutexLockerEx ml(RecoveryPrefetch_lock, Mutex::_no_safepoint_check_flag);
+  return is_covered_locked(name, hash);
+}
+
+// Class names may contain glob metacharacters, '$' is fine.
+void RecoveryPrefetch::append_pattern(stringStream* st, const char* s) {
+  for (const char* p = s; *p != '\0'; p++) {
+    if (*p == '*' || *p == '?' || *p == '[' || *p == ']' || *p == '\\') {
+      st->put('\\');
+    }
+    st->put(*p);
+  }
+}
+
+bool RecoveryPrefetch::fetch(RecoveryPrefetchRequest* batch) {
+  ResourceMark rm;
+
+  int count = 0;
+  for (RecoveryPrefetchRequest* r = batch; r != NULL; r = r->_next) {
+    count++;
+  }
+
+  // Scan i is of the fuzzing keys of the i-th class. A cursor is NULL once
+  // its scan is done.
+  int scans = count;
+  char** patterns = NEW_RESOURCE_ARRAY(char*, scans);
+  char** cursors = NEW_RESOURCE_ARRAY(char*, scans);
+  bool* complete = NEW_RESOURCE_ARRAY(bool, count);
+  int i = 0;
+  for (RecoveryPrefetchRequest* r = batch; r != NULL; r = r->_next, i++) {
+    stringStream fuzzing;
+    fuzzing.print("%s-fuzzing:*:", RedisKeyPrefix);
+    append_pattern(&fuzzing, r->_name);
+    fuzzing.print(".*");
+    patterns[i] = fuzzing.as_string();
+    cursors[i] = (char*)"0";
+    complete[i] = true;
+  }
+
+  bool connected = true;
+
+  // The induced keys, all in one pipeline.
+  for (RecoveryPrefetchRequest* r = batch; r != NULL; r = r->_next) {
+    for (int k = 0; k < r->_induced_count; k++) {
+      redisAppendCommand(_context, "EXISTS %s", r->_induced_keys[k]);
+    }
+  }
+  i = 0;
+  for (RecoveryPrefetchRequest* r = batch; r != NULL && connected; r = r->_next, i++) {
+    for (int k = 0; k < r->_induced_count; k++) {
+      redisReply* reply = NULL;
+      if (redisGetReply(_context, (void**)&reply) != REDIS_OK || reply == NULL) {
+        connected = false;
+        break;
+      }
+      if (reply->type != REDIS_REPLY_INTEGER) {
+        complete[i] = false;
+      } else if (reply->integer > 0 && RecoveryIndex::add(r->_induced_keys[k])) {
+        _key_count++;
+      }
+      freeReplyObject(reply);
+    }
+  }
+
+  int remaining = scans;
+  while (remaining > 0 && connected) {
+    for (i = 0; i < scans; i++) {
+      if (cursors[i] != NULL) {
+        redisAppendCommand(_context, "SCAN %s MATCH %s COUNT %d", cursors[i], patterns[i], _scan_count);
+      }
+    }
+    for (i = 0; i < scans && connected; i++) {
+      if (cursors[i] == NULL) {
+        continue;
+      }
+      redisReply* reply = NULL;
+      if (redisGetReply(_context, (void**)&reply) != REDIS_OK || reply == NULL) {
+        connected = false;
+        break;
+      }
+      // [next cursor, [keys]]
+      if (reply->type == REDIS_REPLY_ARRAY && reply->elements == 2 &&
+          reply->element[0]->type == REDIS_REPLY_STRING &&
+          reply->element[1]->type == REDIS_REPLY_ARRAY) {
+        redisReply* keys = reply->element[1];
+        for (size_t j = 0; j < keys->elements; j++) {
+          redisReply* key = keys->element[j];
+          if (key->type == REDIS_REPLY_STRING && RecoveryIndex::add(key->str)) {
+            _key_count++;
+          }
+        }
+        const char* next = reply->element[0]->str;
+        if (strcmp(next, "0") == 0) {
+          cursors[i] = NULL;
+          remaining--;
+        } else {
+          cursors[i] = NEW_RESOURCE_ARRAY(char, strlen(next) + 1);
+          strcpy(cursors[i], next);
+        }
+      } else {
+        complete[i] = false;
+        cursors[i] = NULL;
+        remaining--;
+      }
+      freeReplyObject(reply);
+    }
+  }
+
+  RecoveryPrefetchRequest* r = batch;
+  for (i = 0; r != NULL; i++) {
+    RecoveryPrefetchRequest* next = r->_next;
+    if (connected && complete[i]) {
+      if ((TraceRuntimeRecovery & TRACE_USE_REDIS) != 0) {
+        tty->print_cr("[Ares] Prefetched the known handler keys of %s", r->_name);
+      }
+      cover(r);
+    } else {
+      free_request(r);
+    }
+    r = next;
+  }
+  return connected;
+}
@@ -0,0 +1,107 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYPREFETCH_HPP
+#define SHARE_VM_RUNTIME_RECOVERYPREFETCH_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/instanceKlass.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/thread.hpp"
+
+struct redisContext;
+
+//
+// Prefetching of known handler keys, -XX:+PrefetchRecoveryHandlers.
+//
+// Without it the first failure through a method probes redis once per frame
+// and candidate handler. With it, every class linked after VM initialization
+// is queued, and the RecoveryPrefetchThread asks redis for all keys which
+// name a method of the class on its own connection.
+//
+// The induced keys follow from the exception tables of the methods, one per
+// handler with a catch type, so they are computed when the class is linked
+// and checked with
+//
+//   EXISTS <RedisKeyPrefix>-induced:<method>:<start>:<end>:<handler>
+//
+// The fuzzing keys name the fuzzed arguments as well and cannot be computed,
+// they are scanned with
+//
+//   SCAN <cursor> MATCH <RedisKeyPrefix>-fuzzing:*:<class>.* COUNT _scan_count
+//
+// The EXISTS of all queued classes are pipelined, then one step of their
+// scans at a time. KEYS would do the scan in one reply, but blocks redis
+// for the whole keyspace, per class; a SCAN step only looks at about
+// _scan_count keys. The fuzzing keys are written by the fuzzer, so the
+// write back cannot keep a per class index of them instead.
+//
+// The keys go into the RecoveryIndex. Once all of them are fetched for a
+// class, the class is covered: a key for one of its methods which is not
+// in the index is not in redis either, so the redis strategy answers it from
+// the index.
+//
+// Classes are tracked by name, as are the keys, so coverage survives class
+// unloading. Prefetching is off while recording or replaying oracle answers,
+// see recoveryReplay.hpp, since its answers never go through the recorder.
+//
+
+class RecoveryPrefetchRequest : public CHeapObj<mtInternal> {
+ public:
+  char*                    _name;           // external name of the class
+  char**                   _induced_keys;   // NULL once covered
+  int                      _induced_count;
+  RecoveryPrefetchRequest* _next;
+};
+
+class RecoveryPrefetchThread : public NamedThread {
+ public:
+  RecoveryPrefetchThread();
+
+  virtual void run();
+  bool is_hidden_from_external_view() const { return true; }
+};
+
+class RecoveryPrefetch : AllStatic {
+  friend class RecoveryPrefetchThread;
+ private:
+  enum {
+    _covered_bucket_count = 4099,
+    _max_batch            = 64,     // classes per pipeline
+    _scan_count           = 1000    // COUNT of each SCAN step
+  };
+
+  static bool                     _active;
+  static redisContext*            _context;
+  static RecoveryPrefetchThread*  _thread;
+  static volatile bool            _should_terminate;
+
+  static RecoveryPrefetchRequest*  _queue;        // newest first
+  static RecoveryPrefetchRequest** _covered;      // names of covered classes
+  static int                       _covered_count;
+  static int                       _key_count;
+
+  static unsigned int hash_for(const char* name);
+  static bool is_covered_locked(const char* name, unsigned int hash);
+  static void cover(RecoveryPrefetchRequest* request);
+
+  static void append_pattern(stringStream* st, const char* s);
+  // The induced keys of the handlers of ik, in the C heap.
+  static void compute_induced_keys(InstanceKlass* ik, RecoveryPrefetchRequest* request);
+  // Fetches the keys of up to _max_batch requests, which it consumes.
+  // Returns false if the connection broke.
+  static bool fetch(RecoveryPrefetchRequest* batch);
+
+ public:
+  static bool is_enabled() { return _active; }
+
+  // Called during VM initialization and exit.
+  static void initialize();
+  static void stop();
+
+  // Called when ik has been linked.
+  static void class_linked(InstanceKlass* ik);
+
+  // Whether the keys naming methods of the holder of m are all in the
+  // RecoveryIndex.
+  static bool covers(Method* m);
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYPREFETCH_HPP
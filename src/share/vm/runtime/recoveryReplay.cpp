@@ -0,0 +1,260 @@
+#include "precompiled.hpp"
+
+#include "classfile/javaClasses.hpp"
+#include "classfile/symbolTable.hpp"
+#include "classfile/systemDictionary.hpp"
+#include "memory/oopFactory.hpp"
+#include "oops/objArrayOop.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/recoveryReplay.hpp"
+
+#ifndef O_BINARY       // if defined (Win32) use binary files.
+#define O_BINARY 0     // otherwise do nothing.
+#endif
+
+RecoveryReplayEntry** RecoveryReplay::_buckets = NULL;
+fileStream*           RecoveryReplay::_record = NULL;
+
+static const char* jpf_none                 = "none";
+static const char* jpf_error_transformation = "ET:";
+static const char* jpf_early_return         = "ER:";
+
+unsigned int RecoveryReplay::hash_for(const char* key) {
+  unsigned int h = 0;
+  for (const char* p = key; *p != '\0'; p++) {
+    h = 31 * h + (unsigned int)(unsigned char)*p;
+  }
+  return h;
+}
+
+void RecoveryReplay::put(const char* key, size_t key_length, const char* answer, size_t answer_length) {
+  RecoveryReplayEntry* e = new RecoveryReplayEntry();
+  e->_key = NEW_C_HEAP_ARRAY(char, key_length + 1, mtInternal);
+  memcpy(e->_key, key, key_length);
+  e->_key[key_length] = '\0';
+  e->_answer = NEW_C_HEAP_ARRAY(char, answer_length + 1, mtInternal);
+  memcpy(e->_answer, answer, answer_length);
+  e->_answer[answer_length] = '\0';
+  e->_hash = hash_for(e->_key);
+
+  // Later lines win, so a new entry goes in front of an older one.
+  int b = e->_hash % _bucket_count;
+  e->_next = _buckets[b];
+  _buckets[b] = e;
+}
+
+const char* RecoveryReplay::lookup(const char* kind, const char* query) {
+  ResourceMark rm;
+  stringStream ss;
+  ss.print("%s %s", kind, query);
+  const char* key = ss.as_string();
+  unsigned int hash = hash_for(key);
+  for (RecoveryReplayEntry* e = _buckets[hash % _bucket_count]; e != NULL; e = e->_next) {
+    if (e->_hash == hash && strcmp(e->_key, key) == 0) {
+      return e->_answer;
+    }
+  }
+  return NULL;
+}
+
+// Each line is "<kind> <answer> <query>", the key is "<kind> <query>".
+void RecoveryReplay::load(const char* path) {
+  struct stat st;
+  if (os::stat(path, &st) != 0) {
+    tty->print_cr("[Ares] Unable to find recovery replay file %s.", path);
+    return;
+  }
+  int fd = os::open(path, O_RDONLY | O_BINARY, 0);
+  if (fd < 0) {
+    tty->print_cr("[Ares] Unable to open recovery replay file %s.", path);
+    return;
+  }
+
+  size_t size = (size_t)st.st_size;
+  char* buffer = NEW_C_HEAP_ARRAY(char, size + 1, mtInternal);
+  size_t n = os::read(fd, buffer, (unsigned int)size);
+  os::close(fd);
+  if (n != size) {
+    tty->print_cr("[Ares] Unable to read recovery replay file %s.", path);
+    FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+    return;
+  }
+  buffer[size] = '\0';
+
+  int count = 0;
+  char* key = NEW_C_HEAP_ARRAY(char, size + 1, mtInternal);
+  char* line = buffer;
+  while (line < buffer + size) {
+    char* end = strchr(line, '\n');
+    if (end == NULL) {
+      end = buffer + size;
+    }
+    size_t length = end - line;
+    if (length > 0 && line[length - 1] == '\r') {
+      length--;
+    }
+    line[length] = '\0';
+
+    char* answer = strchr(line, ' ');
+    char* query = answer != NULL ? strchr(answer + 1, ' ') : NULL;
+    if (query != NULL) {
+      size_t kind_length = answer - line;
+      answer++;
+      size_t answer_length = query - answer;
+      query++;
+      jio_snprintf(key, size + 1, "%.*s %s", (int)kind_length, line, query);
+      put(key, strlen(key), answer, answer_length);
+      count++;
+    } else if (length > 0) {
+      tty->print_cr("[Ares] Ignoring malformed line in recovery replay file %s: %s", path, line);
+    }
+    line = end + 1;
+  }
+  FREE_C_HEAP_ARRAY(char, key, mtInternal);
+  FREE_C_HEAP_ARRAY(char, buffer, mtInternal);
+
+  if (TraceRuntimeRecovery > 0) {
+    tty->print_cr("[Ares] Loaded %d recorded oracle answers from %s", count, path);
+  }
+}
+
+void RecoveryReplay::initialize() {
+  if (is_replaying()) {
+    _buckets = NEW_C_HEAP_ARRAY(RecoveryReplayEntry*, _bucket_count, mtInternal);
+    memset(_buckets, 0, _bucket_count * sizeof(RecoveryReplayEntry*));
+    load(ReplayRecoveryFile);
+  }
+  if (is_recording()) {
+    _record = new (ResourceObj::C_HEAP, mtInternal) fileStream(RecordRecoveryFile);
+    if (!_record->is_open()) {
+      tty->print_cr("[Ares] Unable to open recovery record file %s.", RecordRecoveryFile);
+      delete _record;
+      _record = NULL;
+    }
+  }
+}
+
+void RecoveryReplay::record(const char* kind, const char* answer, const char* query) {
+  if (_record == NULL) {
+    return;
+  }
+  MutexLockerEx ml(RecoveryReplay_lock, Mutex::_no_safepoint_check_flag);
+  _record->print_cr("%s %s %s", kind, answer, query);
+  _record->flush();
+}
+
+void RecoveryReplay::record_redis(const char* command, bool found) {
+  record("redis", found ? "1" : "0", command);
+}
+
+bool RecoveryReplay::replay_redis(const char* command) {
+  const char* answer = lookup("redis", command);
+  return answer != NULL && strcmp(answer, "1") == 0;
+}
+
+const char* RecoveryReplay::jpf_query(GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                      Handle exception, int max_depth) {
+  stringStream ss;
+  ss.print("%s", exception->klass()->name()->as_C_string());
+  for (int index = 0; index <= max_depth && index < methods->length(); index++) {
+    ss.print(" %s@%d", methods->at(index)->name_and_sig_as_C_string(), bcis->at(index));
+  }
+  return ss.as_string();
+}
+
+void RecoveryReplay::record_jpf(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                Handle exception, int max_depth, int jpf_depth, objArrayHandle answer) {
+  ResourceMark rm(thread);
+  const char* query = jpf_query(methods, bcis, exception, max_depth);
+
+  stringStream ss;
+  if (answer.is_null()) {
+    ss.print("%s", jpf_none);
+  } else {
+    char* type = java_lang_String::as_utf8_string(answer->obj_at(0));
+    if (strcmp("ErrorTransformation", type) == 0) {
+      Klass* target = java_lang_Class::as_Klass(answer->obj_at(1));
+      ss.print("%s%s", jpf_error_transformation, target->name()->as_C_string());
+    } else {
+      jvalue value;
+      java_lang_boxing_object::get_value(answer->obj_at(1), &value);
+      ss.print("%s%d", jpf_early_return, jpf_depth - value.i);
+    }
+  }
+  record("jpf", ss.as_string(), query);
+}
+
+// The target of an error transformation is caught by a handler in the
+// recovery context, so one of the loaders of its frames can see it.
+Klass* RecoveryReplay::resolve_target(JavaThread* thread, const char* name, GrowableArray<Method*>* methods, int max_depth) {
+  TempNewSymbol sym = SymbolTable::new_symbol(name, thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+  for (int index = 0; index <= max_depth && index < methods->length(); index++) {
+    InstanceKlass* holder = methods->at(index)->method_holder();
+    Handle loader(thread, holder->class_loader());
+    Handle protection_domain(thread, holder->protection_domain());
+    Klass* k = SystemDictionary::resolve_or_null(sym, loader, protection_domain, thread);
+    if (thread->has_pending_exception()) {
+      thread->clear_pending_exception();
+      continue;
+    }
+    if (k != NULL) {
+      return k;
+    }
+  }
+  return NULL;
+}
+
+objArrayOop RecoveryReplay::replay_jpf(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                       Handle exception, int max_depth) {
+  ResourceMark rm(thread);
+  const char* answer = lookup("jpf", jpf_query(methods, bcis, exception, max_depth));
+  if (answer == NULL || strcmp(answer, jpf_none) == 0) {
+    return NULL;
+  }
+
+  Handle type;
+  Handle value;
+  if (strncmp(answer, jpf_error_transformation, strlen(jpf_error_transformation)) == 0) {
+    Klass* target = resolve_target(thread, answer + strlen(jpf_error_transformation), methods, max_depth);
+    if (target == NULL) {
+      return NULL;
+    }
+    value = Handle(thread, target->java_mirror());
+    type = java_lang_String::create_from_str("ErrorTransformation", thread);
+  } else if (strncmp(answer, jpf_early_return, strlen(jpf_early_return)) == 0) {
+    int offset = atoi(answer + strlen(jpf_early_return));
+    if (offset < 0 || offset > max_depth) {
+      return NULL;
+    }
+    // In JPF, top has max_depth
+    jvalue depth;
+    depth.i = max_depth - offset;
+    value = Handle(thread, java_lang_boxing_object::create(T_INT, &depth, thread));
+    if (thread->has_pending_exception()) {
+      thread->clear_pending_exception();
+      return NULL;
+    }
+    type = java_lang_String::create_from_str("EarlyReturn", thread);
+  } else {
+    return NULL;
+  }
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+
+  objArrayOop result = oopFactory::new_objectArray(2, thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return NULL;
+  }
+  result->obj_at_put(0, type());
+  result->obj_at_put(1, value());
+  return result;
+}
@@ -0,0 +1,78 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYREPLAY_HPP
+#define SHARE_VM_RUNTIME_RECOVERYREPLAY_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/method.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/handles.hpp"
+#include "utilities/growableArray.hpp"
+#include "utilities/ostream.hpp"
+
+//
+// Recording and replay of the answers of the external oracles.
+//
+// With -XX:RecordRecoveryFile=<file> every redis query and every JPF run is
+// written to the file together with its answer, one line each:
+//
+//   redis <0|1> <command>
+//   jpf <answer> <exception class> <method@bci>...
+//
+// A JPF answer is "none", "ET:<class name>" for an error transformation or
+// "ER:<offset>" for an early return, the offset counting from the top frame.
+// The frames are those of the recovery context handed to JPF.
+//
+// With -XX:ReplayRecoveryFile=<file> the oracle reads the answers from the
+// file instead: redis is not connected and JPF is not run. The file is read
+// during VM initialization. A query which is not in the file gets the
+// negative answer. If a query was recorded more than once, the last answer
+// is replayed.
+//
+
+class RecoveryReplayEntry : public CHeapObj<mtInternal> {
+ public:
+  unsigned int         _hash;
+  char*                _key;     // "<kind> <query>"
+  char*                _answer;
+  RecoveryReplayEntry* _next;
+};
+
+class RecoveryReplay : AllStatic {
+ private:
+  enum {
+    _bucket_count = 4099
+  };
+
+  static RecoveryReplayEntry** _buckets;
+  static fileStream*           _record;
+
+  static unsigned int hash_for(const char* key);
+  static const char* lookup(const char* kind, const char* query);
+  static void put(const char* key, size_t key_length, const char* answer, size_t answer_length);
+  static void load(const char* path);
+  static void record(const char* kind, const char* answer, const char* query);
+
+  static const char* jpf_query(GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                               Handle exception, int max_depth);
+  static Klass* resolve_target(JavaThread* thread, const char* name, GrowableArray<Method*>* methods, int max_depth);
+
+ public:
+  static bool is_recording() { return RecordRecoveryFile != NULL; }
+  static bool is_replaying() { return ReplayRecoveryFile != NULL; }
+
+  // Called during VM initialization.
+  static void initialize();
+
+  static void record_redis(const char* command, bool found);
+  static bool replay_redis(const char* command);
+
+  // answer is what run_jpf_with_exception returned for max_depth, NULL for
+  // none. The early return depth in it counts from jpf_depth, the depth JPF
+  // ended up with.
+  static void record_jpf(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                         Handle exception, int max_depth, int jpf_depth, objArrayHandle answer);
+  // Builds the answer as JPF would, or returns NULL.
+  static objArrayOop replay_jpf(JavaThread* thread, GrowableArray<Method*>* methods, GrowableArray<int>* bcis,
+                                Handle exception, int max_depth);
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYREPLAY_HPP
@@ -0,0 +1,289 @@
+#include "precompiled.hpp"
+
+#include "code/nmethod.hpp"
+#include "code/scopeDesc.hpp"
+#include "oops/method.hpp"
+#include "runtime/handles.inline.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/recoveryIndex.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/recoveryReplay.hpp"
+#include "runtime/recoveryWriteBack.hpp"
+#include "runtime/runtimeRecoveryState.hpp"
+
+bool                     RecoveryWriteBack::_active = false;
+redisContext*            RecoveryWriteBack::_context = NULL;
+fileStream*              RecoveryWriteBack::_file = NULL;
+RecoveryWriteBackThread* RecoveryWriteBack::_thread = NULL;
+volatile bool            RecoveryWriteBack::_should_terminate = false;
+RecoveryWriteBackBuffer* RecoveryWriteBack::_queue = NULL;
+RecoveryWriteBackKey**   RecoveryWriteBack::_written = NULL;
+int                      RecoveryWriteBack::_written_count = 0;
+
+RecoveryWriteBackBuffer::RecoveryWriteBackBuffer(int capacity) :
+  _count(0),
+  _capacity(capacity),
+  _start(0),
+  _next(NULL) {
+  _keys = NEW_C_HEAP_ARRAY(char*, capacity, mtInternal);
+}
+
+RecoveryWriteBackBuffer::~RecoveryWriteBackBuffer() {
+  for (int i = 0; i < _count; i++) {
+    os::free(_keys[i], mtInternal);
+  }
+  FREE_C_HEAP_ARRAY(char*, _keys, mtInternal);
+}
+
+bool RecoveryWriteBackBuffer::contains(const char* key) {
+  for (int i = 0; i < _count; i++) {
+    if (strcmp(_keys[i], key) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RecoveryWriteBackBuffer::add(const char* key) {
+  assert(!is_full(), "sanity check");
+  if (_count == 0) {
+    _start = os::javaTimeMillis();
+  }
+  _keys[_count++] = os::strdup(key, mtInternal);
+}
+
+RecoveryWriteBackThread::RecoveryWriteBackThread() : NamedThread() {
+  set_name("Recovery Write Back Thread");
+}
+
+void RecoveryWriteBackThread::run() {
+  this->record_stack_base_and_size();
+  this->initialize_thread_local_storage();
+
+  while (true) {
+    RecoveryWriteBackBuffer* buffers;
+    {
+      MutexLockerEx ml(RecoveryWriteBack_lock, Mutex::_no_safepoint_check_flag);
+      while (RecoveryWriteBack::_queue == NULL && !RecoveryWriteBack::_should_terminate) {
+        RecoveryWriteBack_lock->wait(Mutex::_no_safepoint_check_flag);
+      }
+      if (RecoveryWriteBack::_queue == NULL) {
+        return;
+      }
+      buffers = RecoveryWriteBack::_queue;
+      RecoveryWriteBack::_queue = NULL;
+    }
+
+    bool connected = true;
+    while (buffers != NULL) {
+      RecoveryWriteBackBuffer* next = buffers->_next;
+      if (connected && !RecoveryWriteBack::write(buffers)) {
+        warning("Lost the redis connection of the recovery write back thread, handlers are not written back.");
+        connected = false;
+      }
+      delete buffers;
+      buffers = next;
+    }
+    if (!connected) {
+      MutexLockerEx ml(RecoveryWriteBack_lock, Mutex::_no_safepoint_check_flag);
+      RecoveryWriteBack::_active = false;
+      return;
+    }
+  }
+}
+
+void RecoveryWriteBack::initialize() {
+  if (RecoveryWriteBackInterval <= 0) {
+    return;
+  }
+  if (RecoveryWriteBackBufferSize <= 0) {
+    warning("RecoveryWriteBackBufferSize must be positive, handlers are not written back.");
+    return;
+  }
+
+  if (UseRedis && !RecoveryReplay::is_replaying()) {
+    redisContext* c = redisConnect("127.0.0.1", 6379);
+    if (c == NULL || c->err) {
+      tty->print_cr("[Ares] ERROR: create redis context for write back failed %s\n",
+          c != NULL ? c->errstr : "");
+      return;
+    }
+    _context = c;
+  } else if (RecoveryIndexFile != NULL) {
+    _file = new (ResourceObj::C_HEAP, mtInternal) fileStream(RecoveryIndexFile, "a");
+    if (!_file->is_open()) {
+      tty->print_cr("[Ares] Unable to open recovery index file %s for write back.", RecoveryIndexFile);
+      delete _file;
+      _file = NULL;
+      return;
+    }
+  } else {
+    warning("RecoveryWriteBackInterval needs UseRedis or RecoveryIndexFile, handlers are not written back.");
+    return;
+  }
+
+  _written = NEW_C_HEAP_ARRAY(RecoveryWriteBackKey*, _written_bucket_count, mtInternal);
+  memset(_written, 0, _written_bucket_count * sizeof(RecoveryWriteBackKey*));
+
+  _thread = new RecoveryWriteBackThread();
+  if (_thread == NULL || !os::create_thread(_thread, os::os_thread)) {
+    warning("Unable to create the recovery write back thread.");
+    return;
+  }
+  os::start_thread(_thread);
+  _active = true;
+}
+
+void RecoveryWriteBack::stop() {
+  if (!_active) {
+    return;
+  }
+  MutexLockerEx ml(RecoveryWriteBack_lock, Mutex::_no_safepoint_check_flag);
+  _should_terminate = true;
+  _active = false;
+  RecoveryWriteBack_lock->notify_all();
+}
+
+bool RecoveryWriteBack::should_sample(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  return state != NULL && state->next_handler_dispatch() % (juint)RecoveryWriteBackInterval == 0;
+}
+
+void RecoveryWriteBack::dispatched(JavaThread* thread, Method* m, int bci, int handler_bci) {
+  if (should_sample(thread)) {
+    add(thread, m, bci, handler_bci);
+  }
+}
+
+void RecoveryWriteBack::compiled_dispatched(JavaThread* thread, nmethod* nm, address ret_pc,
+                                            Handle exception, bool top_frame_only) {
+  if (!should_sample(thread)) {
+    return;
+  }
+
+  ResourceMark rm(thread);
+  KlassHandle ek(thread, exception->klass());
+  for (ScopeDesc* sd = nm->scope_desc_at(ret_pc); sd != NULL; sd = top_frame_only ? NULL : sd->sender()) {
+    methodHandle mh(thread, sd->method());
+    int handler_bci = Method::fast_exception_handler_bci_for(mh, ek, sd->bci(), thread);
+    if (thread->has_pending_exception()) {
+      // The dispatch already resolved the catch types it needed
+      thread->clear_pending_exception();
+      return;
+    }
+    if (handler_bci >= 0) {
+      add(thread, mh(), sd->bci(), handler_bci);
+      return;
+    }
+  }
+}
+
+void RecoveryWriteBack::add(JavaThread* thread, Method* m, int bci, int handler_bci) {
+  ExceptionTable table(m);
+  int i = 0;
+  while (i < table.length() &&
+         (bci < table.start_pc(i) || bci >= table.end_pc(i) || table.handler_pc(i) != handler_bci)) {
+    i++;
+  }
+  if (i == table.length() || table.catch_type_index(i) == 0) {
+    return;
+  }
+
+  ResourceMark rm(thread);
+  stringStream key;
+  key.print("%s-induced:%s:%d:%d:%d",
+      RedisKeyPrefix,
+      m->name_and_sig_as_C_string(),
+      table.start_pc(i),
+      table.end_pc(i),
+      handler_bci);
+
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  RecoveryWriteBackBuffer* buffer = state->write_back_buffer();
+  if (buffer == NULL) {
+    buffer = new RecoveryWriteBackBuffer((int)RecoveryWriteBackBufferSize);
+    state->set_write_back_buffer(buffer);
+  }
+  if (!buffer->contains(key.as_string())) {
+    buffer->add(key.as_string());
+  }
+  if (buffer->is_full() || os::javaTimeMillis() - buffer->_start >= RecoveryWriteBackFlushInterval) {
+    hand_over(thread);
+  }
+}
+
+void RecoveryWriteBack::hand_over(JavaThread* thread) {
+  RuntimeRecoveryState* state = thread->runtime_recovery_state();
+  RecoveryWriteBackBuffer* buffer = state->write_back_buffer();
+  state->set_write_back_buffer(NULL);
+  release(buffer);
+}
+
+void RecoveryWriteBack::release(RecoveryWriteBackBuffer* buffer) {
+  if (buffer->_count > 0) {
+    MutexLockerEx ml(RecoveryWriteBack_lock, Mutex::_no_safepoint_check_flag);
+    if (_active) {
+      buffer->_next = _queue;
+      _queue = buffer;
+      RecoveryWriteBack_lock->notify();
+      return;
+    }
+  }
+  delete buffer;
+}
+
+bool RecoveryWriteBack::is_written(const char* key) {
+  unsigned int hash = 0;
+  for (const char* p = key; *p != '\0'; p++) {
+    hash = 31 * hash + (unsigned int)(unsigned char)*p;
+  }
+  int b = hash % _written_bucket_count;
+  for (RecoveryWriteBackKey* e = _written[b]; e != NULL; e = e->_next) {
+    if (e->_hash == hash && strcmp(e->_key, key) == 0) {
+      return true;
+    }
+  }
+
+  RecoveryWriteBackKey* e = new RecoveryWriteBackKey();
+  e->_hash = hash;
+  e->_key = os::strdup(key, mtInternal);
+  e->_next = _written[b];
+  _written[b] = e;
+  _written_count++;
+  return false;
+}
+
+bool RecoveryWriteBack::write(RecoveryWriteBackBuffer* buffer) {
+  int pending = 0;
+  for (int i = 0; i < buffer->_count; i++) {
+    const char* key = buffer->_keys[i];
+    if (is_written(key)) {
+      continue;
+    }
+    if (RecoveryIndex::is_enabled()) {
+      RecoveryIndex::add(key);
+    }
+    if (_context != NULL) {
+      redisAppendCommand(_context, "SET %s 1", key);
+      pending++;
+    } else {
+      _file->print_cr("%s", key);
+    }
+    if ((TraceRuntimeRecovery & TRACE_USE_INDUCED) != 0) {
+      tty->print_cr("[Ares] Writing back observed handler %s", key);
+    }
+  }
+
+  if (_file != NULL) {
+    _file->flush();
+  }
+  for (int i = 0; i < pending; i++) {
+    redisReply* reply = NULL;
+    if (redisGetReply(_context, (void**)&reply) != REDIS_OK || reply == NULL) {
+      return false;
+    }
+    freeReplyObject(reply);
+  }
+  return true;
+}
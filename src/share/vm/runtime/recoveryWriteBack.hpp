@@ -0,0 +1,113 @@
+#ifndef SHARE_VM_RUNTIME_RECOVERYWRITEBACK_HPP
+#define SHARE_VM_RUNTIME_RECOVERYWRITEBACK_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/method.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/ostream.hpp"
+
+class nmethod;
+struct redisContext;
+
+//
+// Write-back of observed handlers, -XX:RecoveryWriteBackInterval=<n>.
+//
+// The knowledge base only holds what fuzzing runs found. The VM sees real
+// handlers catch real exceptions: one of every n exception dispatches to a
+// handler on a thread, in the interpreter or in compiled code, is turned
+// into the induced key of the handler,
+//
+//   <RedisKeyPrefix>-induced:<method>:<start bci>:<end bci>:<handler bci>
+//
+// which the oracle probes for its error transformations. Handlers without a
+// catch type (finally) are not recorded. The unwound frames are gone by the
+// time of the dispatch, so no call string keys are written.
+//
+// Keys collect in a per thread buffer, duplicates dropped. A buffer is handed
+// to the RecoveryWriteBackThread when it is full, when its first key is older
+// than RecoveryWriteBackFlushInterval ms at the next dispatch, or when the
+// thread exits. The writer drops keys it wrote before and sends the rest to
+// redis as one pipeline of SETs on its own connection, or, without UseRedis,
+// appends them to RecoveryIndexFile. Keys go into the RecoveryIndex as well.
+// Buffers not handed over yet when the VM exits are lost.
+//
+
+class RecoveryWriteBackBuffer : public CHeapObj<mtInternal> {
+ public:
+  char**                   _keys;
+  int                      _count;
+  int                      _capacity;
+  jlong                    _start;      // os::javaTimeMillis() of the first key
+  RecoveryWriteBackBuffer* _next;
+
+  RecoveryWriteBackBuffer(int capacity);
+  ~RecoveryWriteBackBuffer();
+
+  bool contains(const char* key);
+  void add(const char* key);
+  bool is_full() { return _count >= _capacity; }
+};
+
+class RecoveryWriteBackThread : public NamedThread {
+ public:
+  RecoveryWriteBackThread();
+
+  virtual void run();
+  bool is_hidden_from_external_view() const { return true; }
+};
+
+class RecoveryWriteBackKey : public CHeapObj<mtInternal> {
+ public:
+  unsigned int          _hash;
+  char*                 _key;
+  RecoveryWriteBackKey* _next;
+};
+
+class RecoveryWriteBack : AllStatic {
+  friend class RecoveryWriteBackThread;
+ private:
+  enum {
+    _written_bucket_count = 4099
+  };
+
+  static bool                     _active;
+  static redisContext*            _context;
+  static fileStream*              _file;
+  static RecoveryWriteBackThread* _thread;
+  static volatile bool            _should_terminate;
+  static RecoveryWriteBackBuffer* _queue;
+
+  // Only used by the writer
+  static RecoveryWriteBackKey**   _written;
+  static int                      _written_count;
+
+  static bool should_sample(JavaThread* thread);
+  static void add(JavaThread* thread, Method* m, int bci, int handler_bci);
+  static void hand_over(JavaThread* thread);
+  static bool is_written(const char* key);
+  // Returns false if the connection broke.
+  static bool write(RecoveryWriteBackBuffer* buffer);
+
+ public:
+  static bool is_enabled() { return _active; }
+
+  // Called during VM initialization and exit.
+  static void initialize();
+  static void stop();
+
+  // Called when an exception thrown at bci of m is dispatched to the
+  // handler at handler_bci of m.
+  static void dispatched(JavaThread* thread, Method* m, int bci, int handler_bci);
+  // Called when exception thrown at ret_pc of nm is dispatched to a handler
+  // of nm, found in its ExceptionCache or not. The handler bci is only
+  // looked up again for sampled dispatches, in the top scope or in all of
+  // them.
+  static void compiled_dispatched(JavaThread* thread, nmethod* nm, address ret_pc,
+                                  Handle exception, bool top_frame_only);
+
+  // Called by a thread when it exits.
+  static void release(RecoveryWriteBackBuffer* buffer);
+};
+
+#endif // SHARE_VM_RUNTIME_RECOVERYWRITEBACK_HPP
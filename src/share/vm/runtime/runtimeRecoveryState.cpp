@@ -1,3 +1,6 @@
+#include "runtime/recoveryEventLog.hpp"
+#include "runtime/recoveryOutcome.hpp"
+#include "runtime/recoveryWriteBack.hpp"
 #include "runtime/runtimeRecoveryState.hpp"
 
 RecoveryMark::RecoveryMark(JavaThread* thread) : _thread(thread) {
@@ -22,6 +25,20 @@ RuntimeRecoveryState::RuntimeRecoveryState(JavaThread* thread):
   _earlyret_tos(ilgl),
   _earlyret_oop(NULL),
   _last_checked_exception(NULL),
+  _recovery_deadline(0),
+  _lazy_backtrace_exception(NULL),
+  _lazy_backtrace_method(NULL),
+  _lazy_backtrace_bci(-1),
+  _lazy_backtrace_frame_id(NULL),
+  _event_ring(NULL),
+  _failure_signature(0),
+  _pending_outcome_signature(0),
+  _pending_outcome_action(0),
+  _pending_outcome_strategy(-1),
+  _pending_outcome_time(0),
+  _next_pending_outcome(NULL),
+  _handler_dispatches(0),
+  _write_back_buffer(NULL),
   _earlyret_dispatch_next(NULL)
 {
   _earlyret_value.j = 0L;
@@ -40,13 +57,25 @@ void RuntimeRecoveryState::reset_runtime_recovery_state() {
   _earlyret_value.j = 0L;
   _earlyret_oop = NULL;
   _last_checked_exception = NULL;
+  _recovery_deadline = 0;
 }
 
 RuntimeRecoveryState::~RuntimeRecoveryState(){
   // TODO
+  if (RecoveryOutcome::is_enabled()) {
+    RecoveryOutcome::thread_exiting(this);
+  }
+  if (_write_back_buffer != NULL) {
+    RecoveryWriteBack::release(_write_back_buffer);
+  }
+  if (_event_ring != NULL) {
+    // the writer frees it once drained
+    RecoveryEventLog::release(_event_ring);
+  }
 }
 
 void RuntimeRecoveryState::oops_do(OopClosure* f) {
   f->do_oop((oop*) &_earlyret_oop);
   f->do_oop((oop*) &_last_checked_exception);
+  f->do_oop((oop*) &_lazy_backtrace_exception);
 }
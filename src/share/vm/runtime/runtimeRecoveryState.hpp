@@ -6,6 +6,9 @@
 
 #include "runtime/thread.hpp"
 
+class RecoveryEventRing;
+class RecoveryWriteBackBuffer;
+
 class RecoveryMark : public StackObj {
 
 private:
@@ -42,6 +45,34 @@ private:
 
   oop           _last_checked_exception;
 
+  // os::javaTimeNanos() by which the current recovery has to be decided,
+  // 0 if it has no time budget
+  jlong         _recovery_deadline;
+
+  // A RuntimeException whose backtrace is not captured yet, see lazyBacktrace.hpp
+  oop           _lazy_backtrace_exception;
+  Method*       _lazy_backtrace_method;     // the interpreted frame which constructed it
+  int           _lazy_backtrace_bci;
+  intptr_t*     _lazy_backtrace_frame_id;
+
+  // Events of this thread not written yet, see recoveryEventLog.hpp
+  RecoveryEventRing* _event_ring;
+
+  // Signature of the failure being recovered, and the last recovery applied
+  // whose outcome is not known yet, see recoveryOutcome.hpp. The pending
+  // outcome is protected by RecoveryOutcome_lock.
+  uintptr_t     _failure_signature;
+  uintptr_t     _pending_outcome_signature;     // 0 if none is pending
+  uintptr_t     _pending_outcome_action;
+  int           _pending_outcome_strategy;
+  jlong         _pending_outcome_time;          // os::javaTimeMillis()
+  RuntimeRecoveryState* _next_pending_outcome;
+
+  // Exception dispatches to a handler, and the observed handlers not written
+  // back yet, see recoveryWriteBack.hpp
+  juint         _handler_dispatches;
+  RecoveryWriteBackBuffer* _write_back_buffer;
+
   // XXX Only used by interpreter
   // We choose the tos in interpreterRuntime
   address       _earlyret_dispatch_next;
@@ -107,6 +138,49 @@ private:
   bool has_last_checked_exception(void)          { return _last_checked_exception != NULL; }
   void set_last_checked_exception(oop exception) { _last_checked_exception = exception; }
 
+  void  set_recovery_deadline(jlong deadline)    { _recovery_deadline = deadline; }
+  void  clr_recovery_deadline(void)              { _recovery_deadline = 0; }
+  jlong recovery_deadline(void)                  { return _recovery_deadline; }
+  bool  has_recovery_deadline(void)              { return _recovery_deadline != 0; }
+
+  oop       lazy_backtrace_exception(void)       { return _lazy_backtrace_exception; }
+  Method*   lazy_backtrace_method(void)          { return _lazy_backtrace_method; }
+  int       lazy_backtrace_bci(void)             { return _lazy_backtrace_bci; }
+  intptr_t* lazy_backtrace_frame_id(void)        { return _lazy_backtrace_frame_id; }
+  bool      has_lazy_backtrace(void)             { return _lazy_backtrace_exception != NULL; }
+  void      set_lazy_backtrace(oop exception, Method* method, int bci, intptr_t* frame_id) {
+    _lazy_backtrace_exception = exception;
+    _lazy_backtrace_method = method;
+    _lazy_backtrace_bci = bci;
+    _lazy_backtrace_frame_id = frame_id;
+  }
+  void      clr_lazy_backtrace(void)             { set_lazy_backtrace(NULL, NULL, -1, NULL); }
+
+  RecoveryEventRing* event_ring(void)                { return _event_ring; }
+  void set_event_ring(RecoveryEventRing* ring)       { _event_ring = ring; }
+
+  uintptr_t failure_signature(void)                  { return _failure_signature; }
+  void set_failure_signature(uintptr_t signature)    { _failure_signature = signature; }
+
+  bool      has_pending_outcome(void)                { return _pending_outcome_signature != 0; }
+  uintptr_t pending_outcome_signature(void)          { return _pending_outcome_signature; }
+  uintptr_t pending_outcome_action(void)             { return _pending_outcome_action; }
+  int       pending_outcome_strategy(void)           { return _pending_outcome_strategy; }
+  jlong     pending_outcome_time(void)               { return _pending_outcome_time; }
+  void set_pending_outcome(uintptr_t signature, uintptr_t action, int strategy, jlong time) {
+    _pending_outcome_signature = signature;
+    _pending_outcome_action = action;
+    _pending_outcome_strategy = strategy;
+    _pending_outcome_time = time;
+  }
+  void clr_pending_outcome(void)                     { set_pending_outcome(0, 0, -1, 0); }
+  RuntimeRecoveryState* next_pending_outcome(void)   { return _next_pending_outcome; }
+  void set_next_pending_outcome(RuntimeRecoveryState* state) { _next_pending_outcome = state; }
+
+  juint next_handler_dispatch(void)                  { return ++_handler_dispatches; }
+  RecoveryWriteBackBuffer* write_back_buffer(void)   { return _write_back_buffer; }
+  void set_write_back_buffer(RecoveryWriteBackBuffer* buffer) { _write_back_buffer = buffer; }
+
   void reset_runtime_recovery_state();
 
   void oops_do(OopClosure* f); // GC support
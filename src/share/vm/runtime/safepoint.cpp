@@ -75,6 +75,7 @@
 #endif
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/concurrentMarkSweep/concurrentMarkSweepThread.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_implementation/shared/suspendibleThreadSet.hpp"
 #endif // INCLUDE_ALL_GCS
 #ifdef COMPILER1
@@ -111,7 +112,9 @@ void SafepointSynchronize::begin() {
     // In the future we should investigate whether CMS can use the
     // more-general mechanism below.  DLD (01/05).
     ConcurrentMarkSweepThread::synchronize(false);
-  } else if (UseG1GC) {
+  }
+  if (UseG1GC || StringDedup::is_enabled()) {
+    // The string deduplication threads are suspendible with any collector.
     SuspendibleThreadSet::synchronize();
   }
 #endif // INCLUDE_ALL_GCS
@@ -485,10 +488,11 @@ void SafepointSynchronize::end() {
   }
 #if INCLUDE_ALL_GCS
   // If there are any concurrent GC threads resume them.
+  if (UseG1GC || StringDedup::is_enabled()) {
+    SuspendibleThreadSet::desynchronize();
+  }
   if (UseConcMarkSweepGC) {
     ConcurrentMarkSweepThread::desynchronize(false);
-  } else if (UseG1GC) {
-    SuspendibleThreadSet::desynchronize();
   }
 #endif // INCLUDE_ALL_GCS
   // record this time so VMThread can keep track how much time has elasped
@@ -60,6 +60,11 @@
 #include "runtime/objectMonitor.hpp"
 #include "runtime/orderAccess.inline.hpp"
 #include "runtime/osThread.hpp"
+#include "runtime/recoveryEventLog.hpp"
+#include "runtime/recoveryMetadata.hpp"
+#include "runtime/recoveryOutcome.hpp"
+#include "runtime/recoveryPrefetch.hpp"
+#include "runtime/recoveryWriteBack.hpp"
 #include "runtime/safepoint.hpp"
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/statSampler.hpp"
@@ -1760,6 +1765,9 @@ void JavaThread::exit(bool destroy_vm, ExitType exit_type) {
     // JSR-166: change call from from ThreadGroup.uncaughtException to
     // java.lang.Thread.dispatchUncaughtException
     if (uncaught_exception.not_null()) {
+      if (RecoveryOutcome::is_enabled()) {
+        RecoveryOutcome::uncaught_exception(this);
+      }
       Handle group(this, java_lang_Thread::threadGroup(threadObj()));
       {
         EXCEPTION_MARK;
@@ -3591,6 +3599,20 @@ jint Threads::create_vm(JavaVMInitArgs* args, bool* canTryAgain) {
     vm_exit_during_initialization(Handle(THREAD, PENDING_EXCEPTION));
   }
 
+  // The recovery metadata dump needs the application class loader.
+  if (DumpRecoveryMetadata) {
+    RecoveryMetadata::dump_class_path(THREAD);
+    ShouldNotReachHere();
+  }
+
+  if (DecodeRecoveryEventLog != NULL) {
+    vm_exit(RecoveryEventLog::decode(DecodeRecoveryEventLog, tty) ? 0 : 1);
+  }
+
+  RecoveryEventLog::initialize();
+  RecoveryPrefetch::initialize();
+  RecoveryWriteBack::initialize();
+
 #if INCLUDE_ALL_GCS
   // Support for ConcurrentMarkSweep. This should be cleaned up
   // and better encapsulated. The ugly nested if test would go away
@@ -0,0 +1,195 @@
+#include "precompiled.hpp"
+
+#include "classfile/javaClasses.hpp"
+#include "classfile/vmSymbols.hpp"
+#include "gc_interface/collectedHeap.inline.hpp"
+#include "memory/barrierSet.hpp"
+#include "oops/instanceKlass.hpp"
+#include "runtime/javaCalls.hpp"
+#include "runtime/jniHandles.hpp"
+#include "runtime/lazyBacktrace.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/recoveryOracle.hpp"
+#include "runtime/transformedExceptionCache.hpp"
+#include "utilities/copy.hpp"
+
+TransformedExceptionSite* TransformedExceptionCache::_table = NULL;
+
+static unsigned int site_hash(Method* method, int bci, Klass* origin_klass, Klass* target_klass) {
+  uintptr_t h = (uintptr_t)method;
+  h = 31 * h + (uintptr_t)bci;
+  h = 31 * h + (uintptr_t)origin_klass;
+  h = 31 * h + (uintptr_t)target_klass;
+  return (unsigned int)(h ^ (h >> 16));
+}
+
+TransformedExceptionSite* TransformedExceptionCache::site_at(Method* method, int bci,
+                                                             Klass* origin_klass, Klass* target_klass) {
+  assert_lock_strong(TransformedException_lock);
+  if (_table == NULL) {
+    _table = NEW_C_HEAP_ARRAY(TransformedExceptionSite, _table_size, mtInternal);
+    memset(_table, 0, _table_size * sizeof(TransformedExceptionSite));
+  }
+  return &_table[site_hash(method, bci, origin_klass, target_klass) & (_table_size - 1)];
+}
+
+bool TransformedExceptionCache::is_sampled(julong count) {
+  if (count <= (julong)TransformedExceptionStackTraceSamples) {
+    return true;
+  }
+  return TransformedExceptionStackTraceInterval > 0 &&
+         (count - TransformedExceptionStackTraceSamples) % (julong)TransformedExceptionStackTraceInterval == 0;
+}
+
+// Constructs the prototype of a site. Returns a null handle on failure.
+Handle TransformedExceptionCache::create_prototype(JavaThread* thread, Klass* origin_klass,
+                                                   instanceKlassHandle target_klass) {
+  ResourceMark rm(thread);
+  stringStream ss;
+  ss.print("Exception transformation: %s -> %s.",
+      origin_klass->name()->as_C_string(),
+      target_klass->name()->as_C_string());
+  Handle message = java_lang_String::create_from_str(ss.as_string(), thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return Handle();
+  }
+
+  Handle prototype = target_klass->allocate_instance_handle(thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return Handle();
+  }
+  JavaValue result(T_VOID);
+  JavaCalls::call_special(&result, prototype, target_klass,
+                          vmSymbols::object_initializer_name(),
+                          vmSymbols::string_void_signature(),
+                          message,
+                          thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return Handle();
+  }
+
+  // The constructor filled in the stack of this recovery, which is of no
+  // use to the copies.
+  LazyBacktrace::discard(thread, prototype());
+  java_lang_Throwable::set_backtrace(prototype(), NULL);
+  return prototype;
+}
+
+// A shallow copy of prototype, see JVM_Clone.
+Handle TransformedExceptionCache::copy_prototype(JavaThread* thread, Handle prototype) {
+  KlassHandle klass(thread, prototype->klass());
+  const int size = prototype->size();
+  oop copy = CollectedHeap::obj_allocate(klass, size, thread);
+  if (thread->has_pending_exception()) {
+    thread->clear_pending_exception();
+    return Handle();
+  }
+
+  assert(MinObjAlignmentInBytes >= BytesPerLong, "objects misaligned");
+  Copy::conjoint_jlongs_atomic((jlong*)prototype(), (jlong*)copy,
+                               (size_t)align_object_size(size) / HeapWordsPerLong);
+  copy->init_mark();
+
+  BarrierSet* bs = Universe::heap()->barrier_set();
+  assert(bs->has_write_region_opt(), "Barrier set does not have write_region");
+  bs->write_region(MemRegion((HeapWord*)copy, size));
+
+  Handle result(thread, copy);
+  if (klass->has_finalizer()) {
+    copy = InstanceKlass::register_finalizer(instanceOop(result()), thread);
+    if (thread->has_pending_exception()) {
+      thread->clear_pending_exception();
+      return Handle();
+    }
+    result = Handle(thread, copy);
+  }
+  return result;
+}
+
+Handle TransformedExceptionCache::allocate(JavaThread* thread, Handle origin_exception, KlassHandle target_klass,
+                                           Method* site_method, int site_bci) {
+  // The prototype is constructed without initializing the class, the full
+  // path initializes it.
+  if (!target_klass->oop_is_instance() || !InstanceKlass::cast(target_klass())->is_initialized()) {
+    return Handle();
+  }
+
+  Klass* origin_klass = origin_exception->klass();
+
+  Handle prototype;
+  {
+    MutexLockerEx ml(TransformedException_lock, Mutex::_no_safepoint_check_flag);
+    TransformedExceptionSite* s = site_at(site_method, site_bci, origin_klass, target_klass());
+    if (s->_method != site_method || s->_bci != site_bci ||
+        s->_origin_klass != origin_klass || s->_target_klass != target_klass()) {
+      // A new site, its first transformation is always created in full.
+      if (s->_prototype != NULL) {
+        JNIHandles::destroy_global(s->_prototype);
+      }
+      s->_method = site_method;
+      s->_bci = site_bci;
+      s->_origin_klass = origin_klass;
+      s->_target_klass = target_klass();
+      s->_prototype = NULL;
+      s->_count = 1;
+      return Handle();
+    }
+    s->_count++;
+    if (is_sampled(s->_count)) {
+      return Handle();
+    }
+    prototype = Handle(thread, JNIHandles::resolve(s->_prototype));
+  }
+
+  if (prototype.is_null()) {
+    prototype = create_prototype(thread, origin_klass, instanceKlassHandle(thread, target_klass()));
+    if (prototype.is_null()) {
+      return Handle();
+    }
+    jobject global = JNIHandles::make_global(prototype);
+
+    MutexLockerEx ml(TransformedException_lock, Mutex::_no_safepoint_check_flag);
+    TransformedExceptionSite* s = site_at(site_method, site_bci, origin_klass, target_klass());
+    if (s->_method == site_method && s->_bci == site_bci &&
+        s->_origin_klass == origin_klass && s->_target_klass == target_klass() &&
+        s->_prototype == NULL) {
+      s->_prototype = global;
+    } else {
+      // Another thread was faster, or the slot was taken over.
+      JNIHandles::destroy_global(global);
+    }
+  }
+
+  Handle exception = copy_prototype(thread, prototype);
+  if (exception.is_null()) {
+    return Handle();
+  }
+  java_lang_Throwable::set_cause(exception(), origin_exception());
+
+  if ((TraceRuntimeRecovery & TRACE_TRANSFORMING) != 0) {
+    ResourceMark rm(thread);
+    tty->print_cr("[Ares] Transforming an exception %s to %s without stack trace at %s@%d",
+        origin_klass->name()->as_C_string(),
+        target_klass->name()->as_C_string(),
+        site_method->name_and_sig_as_C_string(),
+        site_bci);
+  }
+  return exception;
+}
+
+void TransformedExceptionCache::purge() {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
+  MutexLockerEx ml(TransformedException_lock, Mutex::_no_safepoint_check_flag);
+  if (_table == NULL) {
+    return;
+  }
+  for (int i = 0; i < _table_size; i++) {
+    if (_table[i]._prototype != NULL) {
+      JNIHandles::destroy_global(_table[i]._prototype);
+    }
+  }
+  memset(_table, 0, _table_size * sizeof(TransformedExceptionSite));
+}
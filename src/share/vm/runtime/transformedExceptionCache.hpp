@@ -0,0 +1,59 @@
+#ifndef SHARE_VM_RUNTIME_TRANSFORMEDEXCEPTIONCACHE_HPP
+#define SHARE_VM_RUNTIME_TRANSFORMEDEXCEPTIONCACHE_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/method.hpp"
+#include "runtime/handles.hpp"
+
+//
+// Cheap exceptions for error transformations, -XX:+OmitStackTraceInTransformedException.
+//
+// A full transformation formats a message, runs the constructor of the target
+// class, which fills in the stack trace, and attaches the cause. At a site
+// which keeps failing the same way this dominates the cost of a recovery.
+// With the flag the sites are remembered by failing method, bci, original and
+// target class. The first TransformedExceptionStackTraceSamples
+// transformations at a site, and then one in every
+// TransformedExceptionStackTraceInterval, are created in full. For the others
+// a prototype is constructed once per site through the (String) constructor
+// of the target class, so its constructor and field initializers run, and
+// its stack trace is cleared. Each transformation gets a shallow copy of the
+// prototype, like Object.clone, with the original exception as its cause;
+// the message is shared and the stack trace is empty.
+//
+
+class TransformedExceptionSite VALUE_OBJ_CLASS_SPEC {
+ public:
+  Method*  _method;          // NULL for an empty slot
+  int      _bci;
+  Klass*   _origin_klass;
+  Klass*   _target_klass;
+  jobject  _prototype;       // global handle of the prototype, NULL until needed
+  julong   _count;           // transformations at this site
+};
+
+class TransformedExceptionCache : AllStatic {
+ private:
+  enum {
+    _table_size = 1024       // a power of two
+  };
+
+  static TransformedExceptionSite* _table;
+
+  static TransformedExceptionSite* site_at(Method* method, int bci, Klass* origin_klass, Klass* target_klass);
+  static bool is_sampled(julong count);
+
+  static Handle create_prototype(JavaThread* thread, Klass* origin_klass, instanceKlassHandle target_klass);
+  static Handle copy_prototype(JavaThread* thread, Handle prototype);
+
+ public:
+  // Returns the transformed exception, or a null handle when the caller has
+  // to create this one in full.
+  static Handle allocate(JavaThread* thread, Handle origin_exception, KlassHandle target_klass,
+                         Method* site_method, int site_bci);
+
+  // Called at a safepoint when classes have been unloaded.
+  static void purge();
+};
+
+#endif // SHARE_VM_RUNTIME_TRANSFORMEDEXCEPTIONCACHE_HPP
@@ -0,0 +1,73 @@
+/**
+ * @test TestG1NUMAAllocation
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary G1 with -XX:+UseNUMA allocates, evacuates and compacts correctly
+ *          from threads on any node, with one node or several.
+ * @library /testlibrary
+ * @run main/othervm -XX:+UseG1GC -XX:+UseNUMA -Xmx128m -Xmn16m
+ *                   -XX:G1HeapRegionSize=1m -XX:+PrintGCDetails
+ *                   -XX:+UnlockDiagnosticVMOptions -XX:+VerifyAfterGC
+ *                   TestG1NUMAAllocation
+ * @run main/othervm -XX:+UseG1GC -XX:+UseNUMA -XX:+AlwaysPreTouch -Xms64m -Xmx128m
+ *                   -XX:G1HeapRegionSize=1m TestG1NUMAAllocation
+ */
+
+import java.util.ArrayList;
+import java.util.List;
+
+import static com.oracle.java.testlibrary.Asserts.*;
+
+public class TestG1NUMAAllocation {
+    private static final int THREADS = 8;
+    private static final int KEPT = 20000;
+
+    static class Allocator extends Thread {
+        final int id;
+        final List<int[]> kept = new ArrayList<>();
+        Object sink;
+
+        Allocator(int id) {
+            this.id = id;
+        }
+
+        public void run() {
+            for (int i = 0; i < KEPT; i++) {
+                int[] a = new int[16];
+                a[0] = id;
+                a[15] = i;
+                kept.add(a);
+                for (int j = 0; j < 20; j++) {
+                    sink = new byte[64];
+                }
+            }
+        }
+
+        void check() {
+            assertEquals(kept.size(), KEPT);
+            for (int i = 0; i < KEPT; i++) {
+                int[] a = kept.get(i);
+                assertEquals(a[0], id);
+                assertEquals(a[15], i);
+            }
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        Allocator[] allocators = new Allocator[THREADS];
+        for (int i = 0; i < THREADS; i++) {
+            allocators[i] = new Allocator(i);
+            allocators[i].start();
+        }
+        for (Allocator a : allocators) {
+            a.join();
+        }
+        for (Allocator a : allocators) {
+            a.check();
+        }
+        System.gc();
+        for (Allocator a : allocators) {
+            a.check();
+        }
+        System.out.println("Passed");
+    }
+}
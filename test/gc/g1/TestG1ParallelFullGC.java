@@ -0,0 +1,111 @@
+/**
+ * @test TestG1ParallelFullGC
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary The parallel G1 full GC keeps the live object graph intact, moves
+ *          it, and clears weak references to unreachable objects.
+ * @library /testlibrary
+ * @run main/othervm -XX:+UseG1GC -XX:+G1ParallelFullGC -XX:ParallelGCThreads=4
+ *                   -XX:+ParallelRefProcEnabled -Xmx128m -XX:G1HeapRegionSize=1m
+ *                   -XX:+UnlockDiagnosticVMOptions -XX:+VerifyBeforeGC -XX:+VerifyAfterGC
+ *                   TestG1ParallelFullGC
+ * @run main/othervm -XX:+UseG1GC -XX:+G1ParallelFullGC -XX:ParallelGCThreads=1
+ *                   -Xmx128m TestG1ParallelFullGC
+ */
+
+import java.lang.ref.WeakReference;
+import java.util.ArrayList;
+import java.util.List;
+
+import static com.oracle.java.testlibrary.Asserts.*;
+
+public class TestG1ParallelFullGC {
+    static class Node {
+        final int value;
+        Node next;
+        Object[] children;
+
+        Node(int value) {
+            this.value = value;
+        }
+    }
+
+    private static final int LISTS = 64;
+    private static final int LENGTH = 2000;
+    // More elements than one stealable chunk of an object array.
+    private static final int WIDE = 100000;
+
+    private static Node[] lists = new Node[LISTS];
+    private static Object[] wide = new Object[WIDE];
+    private static List<byte[]> humongous = new ArrayList<>();
+
+    private static void build() {
+        for (int i = 0; i < LISTS; i++) {
+            Node head = null;
+            for (int j = LENGTH - 1; j >= 0; j--) {
+                Node n = new Node(i * LENGTH + j);
+                n.next = head;
+                n.children = new Object[] { Integer.valueOf(j), "n" + j };
+                head = n;
+                // Garbage between the live objects, so that they move.
+                new Node(-1).children = new Object[16];
+            }
+            lists[i] = head;
+        }
+        for (int i = 0; i < WIDE; i++) {
+            wide[i] = Integer.valueOf(i);
+        }
+        for (int i = 0; i < 4; i++) {
+            byte[] b = new byte[2 * 1024 * 1024];
+            b[0] = (byte)i;
+            b[b.length - 1] = (byte)i;
+            humongous.add(b);
+        }
+    }
+
+    private static void check() {
+        for (int i = 0; i < LISTS; i++) {
+            int j = 0;
+            for (Node n = lists[i]; n != null; n = n.next, j++) {
+                assertEquals(n.value, i * LENGTH + j);
+                assertEquals(n.children[0], Integer.valueOf(j));
+                assertEquals(n.children[1], "n" + j);
+            }
+            assertEquals(j, LENGTH);
+        }
+        for (int i = 0; i < WIDE; i++) {
+            assertEquals(wide[i], Integer.valueOf(i));
+        }
+        for (int i = 0; i < humongous.size(); i++) {
+            byte[] b = humongous.get(i);
+            assertEquals(b[0], (byte)i);
+            assertEquals(b[b.length - 1], (byte)i);
+        }
+    }
+
+    public static void main(String[] args) {
+        build();
+        WeakReference<Object> weak = new WeakReference<Object>(new Node(0));
+        WeakReference<Object> strong = new WeakReference<Object>(lists[0]);
+
+        for (int i = 0; i < 3; i++) {
+            System.gc();
+            check();
+        }
+        assertNull(weak.get(), "weak referent should have been cleared");
+        assertEquals(strong.get(), lists[0]);
+
+        // Drop half of the lists, the rest is compacted over them.
+        for (int i = 0; i < LISTS; i += 2) {
+            lists[i] = null;
+        }
+        System.gc();
+        for (int i = 1; i < LISTS; i += 2) {
+            int j = 0;
+            for (Node n = lists[i]; n != null; n = n.next, j++) {
+                assertEquals(n.value, i * LENGTH + j);
+            }
+            assertEquals(j, LENGTH);
+        }
+        System.out.println("Passed");
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * @test TestG1RSetArrayContainers
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary Remembered sets whose fine-grain tables keep their cards in arrays,
+ *          expanded to bitmaps when full, find every old-to-young reference.
+ * @library /testlibrary
+ * @run main/othervm -XX:+UseG1GC -Xmx64m -Xmn8m -XX:G1HeapRegionSize=1m
+ *                   -XX:G1RSetSparseRegionEntries=1 -XX:G1RSetArrayEntries=4
+ *                   -XX:+UnlockDiagnosticVMOptions -XX:+VerifyAfterGC
+ *                   TestG1RSetArrayContainers
+ * @run main/othervm -XX:+UseG1GC -Xmx64m -Xmn8m -XX:G1HeapRegionSize=1m
+ *                   -XX:G1RSetSparseRegionEntries=1
+ *                   -XX:+UnlockDiagnosticVMOptions -XX:+VerifyAfterGC
+ *                   TestG1RSetArrayContainers
+ * @run main/othervm -XX:+UseG1GC -Xmx64m -Xmn8m -XX:G1HeapRegionSize=1m
+ *                   -XX:G1RSetSparseRegionEntries=1 -XX:G1RSetArrayEntries=0
+ *                   -XX:+UnlockDiagnosticVMOptions -XX:+VerifyAfterGC
+ *                   TestG1RSetArrayContainers
+ */
+
+import static com.oracle.java.testlibrary.Asserts.*;
+
+public class TestG1RSetArrayContainers {
+    static class Holder {
+        Object young;
+        int id;
+    }
+
+    // Spread over several old regions. A region holds about 40000 of them.
+    private static final int HOLDERS = 200000;
+    private static Holder[] holders = new Holder[HOLDERS];
+    private static Object sink;
+
+    private static void allocateGarbage() {
+        for (int i = 0; i < 200000; i++) {
+            sink = new int[8];
+        }
+    }
+
+    public static void main(String[] args) {
+        for (int i = 0; i < HOLDERS; i++) {
+            holders[i] = new Holder();
+        }
+        // Promote the holders.
+        System.gc();
+
+        for (int round = 0; round < 8; round++) {
+            // Few cards of some source regions, many of others, so that
+            // some tables stay arrays and some are expanded.
+            int stride = round % 2 == 0 ? 997 : 3;
+            for (int i = round; i < HOLDERS; i += stride) {
+                holders[i].young = new Integer(i);
+                holders[i].id = round;
+            }
+            allocateGarbage();
+            for (int i = round; i < HOLDERS; i += stride) {
+                assertEquals(holders[i].young, Integer.valueOf(i));
+                assertEquals(holders[i].id, round);
+            }
+        }
+        System.out.println("Passed");
+    }
+}
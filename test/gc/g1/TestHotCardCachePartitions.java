@@ -0,0 +1,122 @@
+/**
+ * @test TestHotCardCachePartitions
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary Cards cached in the partitions of the hot card cache by several
+ *          refinement threads are refined or scanned before each pause.
+ * @library /testlibrary
+ * @run main TestHotCardCachePartitions
+ */
+
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+import com.oracle.java.testlibrary.*;
+import static com.oracle.java.testlibrary.Asserts.*;
+
+public class TestHotCardCachePartitions {
+    static class Workload {
+        private static final int THREADS = 4;
+        // Few old objects whose cards are dirtied over and over, which makes
+        // them hot.
+        private static final int HOT = 512;
+        private static Object[][] hot = new Object[THREADS][];
+
+        static class Mutator extends Thread {
+            final int id;
+            Object sink;
+            volatile Throwable failure;
+
+            Mutator(int id) {
+                this.id = id;
+            }
+
+            public void run() {
+                try {
+                    mutate();
+                } catch (Throwable t) {
+                    failure = t;
+                }
+            }
+
+            private void mutate() {
+                Object[] slots = hot[id];
+                for (int round = 0; round < 200; round++) {
+                    for (int i = 0; i < HOT; i++) {
+                        slots[i] = new Integer(round * HOT + i);
+                    }
+                    for (int i = 0; i < 2000; i++) {
+                        sink = new int[16];
+                    }
+                    for (int i = 0; i < HOT; i++) {
+                        assertEquals(slots[i], Integer.valueOf(round * HOT + i));
+                    }
+                }
+            }
+        }
+
+        public static void main(String[] args) throws Exception {
+            for (int i = 0; i < THREADS; i++) {
+                hot[i] = new Object[HOT];
+            }
+            // Promote the arrays.
+            System.gc();
+
+            Mutator[] mutators = new Mutator[THREADS];
+            for (int i = 0; i < THREADS; i++) {
+                mutators[i] = new Mutator(i);
+                mutators[i].start();
+            }
+            for (Mutator m : mutators) {
+                m.join();
+                if (m.failure != null) {
+                    throw new RuntimeException("Mutator " + m.id + " failed", m.failure);
+                }
+            }
+            System.out.println("Passed");
+        }
+    }
+
+    private static final Pattern INSERTIONS =
+        Pattern.compile("G1-Refine hot card cache insertions per partition:((?: \\d+)+)");
+
+    // Returns the cards inserted into each partition over all pauses.
+    private static long[] run(int refinementThreads, int partitions) throws Exception {
+        // Low refinement zones, so that all refinement threads and the
+        // mutators refine cards.
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UseG1GC", "-Xmx64m", "-Xmn8m", "-XX:G1HeapRegionSize=1m",
+            "-XX:G1ConcRefinementThreads=" + refinementThreads,
+            "-XX:G1ConcRSHotCardLimit=1", "-XX:G1ConcRSLogCacheSize=6",
+            "-XX:-G1UseAdaptiveConcRefinement", "-XX:G1ConcRefinementGreenZone=0",
+            "-XX:G1ConcRefinementYellowZone=4", "-XX:G1ConcRefinementRedZone=8",
+            "-XX:+UnlockDiagnosticVMOptions", "-XX:+G1TraceConcRefinement",
+            "-XX:+VerifyAfterGC",
+            Workload.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Passed");
+        output.shouldHaveExitValue(0);
+        output.shouldContain("G1-Refine hot card cache partitions: " + partitions + ",");
+
+        long[] insertions = new long[partitions];
+        Matcher m = INSERTIONS.matcher(output.getStdout());
+        while (m.find()) {
+            String[] counts = m.group(1).trim().split(" ");
+            assertEquals(counts.length, partitions);
+            for (int i = 0; i < partitions; i++) {
+                insertions[i] += Long.parseLong(counts[i]);
+            }
+        }
+        return insertions;
+    }
+
+    public static void main(String[] args) throws Exception {
+        // 64 cards, two partitions of at least one claim chunk of 32 cards.
+        long[] insertions = run(4, 2);
+        for (int i = 0; i < insertions.length; i++) {
+            assertGreaterThan(insertions[i], 0L, "No cards inserted into partition " + i);
+        }
+
+        insertions = run(1, 1);
+        assertGreaterThan(insertions[0], 0L, "No cards inserted");
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @test TestOptionalCollectionSet
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary Mixed collections keep -XX:G1OptionalCSetPercent of their old
+ *          region time for optional regions, evacuated incrementally.
+ * @library /testlibrary
+ * @run main TestOptionalCollectionSet
+ */
+
+import java.util.ArrayList;
+import java.util.List;
+
+import com.oracle.java.testlibrary.*;
+
+public class TestOptionalCollectionSet {
+    static class Mixed {
+        private static final int CHUNK = 16 * 1024;
+        private static List<byte[]> live = new ArrayList<>();
+        private static Object sink;
+
+        public static void main(String[] args) {
+            // Fragment the old generation: keep one of every four chunks.
+            List<byte[]> all = new ArrayList<>();
+            for (int i = 0; i < 4000; i++) {
+                byte[] b = new byte[CHUNK];
+                b[0] = (byte)i;
+                all.add(b);
+            }
+            System.gc();
+            for (int i = 0; i < all.size(); i += 4) {
+                live.add(all.get(i));
+            }
+            all = null;
+
+            // Young garbage, for the concurrent cycle and the mixed
+            // collections after it.
+            for (int i = 0; i < 400000; i++) {
+                sink = new byte[1024];
+            }
+
+            for (int i = 0; i < live.size(); i++) {
+                if (live.get(i)[0] != (byte)(i * 4)) {
+                    throw new RuntimeException("Corrupted chunk " + i);
+                }
+            }
+            System.out.println("Passed");
+        }
+    }
+
+    private static OutputAnalyzer run(String percent) throws Exception {
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UseG1GC", "-Xms128m", "-Xmx128m", "-XX:G1HeapRegionSize=1m",
+            "-XX:InitiatingHeapOccupancyPercent=0",
+            "-XX:+UnlockExperimentalVMOptions",
+            "-XX:G1MixedGCLiveThresholdPercent=100", "-XX:G1HeapWastePercent=0",
+            "-XX:MaxGCPauseMillis=20",
+            "-XX:G1OptionalCSetPercent=" + percent,
+            "-XX:+PrintGCDetails", "-XX:+PrintAdaptiveSizePolicy",
+            "-XX:+UnlockDiagnosticVMOptions", "-XX:+VerifyAfterGC",
+            Mixed.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Passed");
+        output.shouldHaveExitValue(0);
+        output.shouldContain("start mixed GCs");
+        return output;
+    }
+
+    public static void main(String[] args) throws Exception {
+        OutputAnalyzer output = run("50");
+        output.shouldContain("select optional regions");
+        if (output.getStdout().contains("Optional Evacuation")) {
+            output.shouldContain("Optional Regions");
+        }
+
+        output = run("0");
+        output.shouldNotContain("select optional regions");
+        output.shouldNotContain("Optional Evacuation");
+    }
+}
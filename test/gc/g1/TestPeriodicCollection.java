@@ -0,0 +1,64 @@
+/**
+ * @test TestPeriodicCollection
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary -XX:G1PeriodicGCInterval starts a concurrent cycle in an idle VM
+ *          which gives the unused heap back to the OS.
+ * @library /testlibrary
+ * @run main TestPeriodicCollection
+ */
+
+import java.lang.management.ManagementFactory;
+import java.util.ArrayList;
+import java.util.List;
+
+import com.oracle.java.testlibrary.*;
+
+public class TestPeriodicCollection {
+    static class Idle {
+        private static List<byte[]> garbage = new ArrayList<>();
+
+        private static long committed() {
+            return ManagementFactory.getMemoryMXBean().getHeapMemoryUsage().getCommitted();
+        }
+
+        public static void main(String[] args) throws Exception {
+            // Fill the heap, then drop everything and go idle.
+            for (int i = 0; i < 96; i++) {
+                garbage.add(new byte[1024 * 1024]);
+            }
+            long before = committed();
+            garbage = null;
+            Thread.sleep(Integer.parseInt(args[0]));
+            long after = committed();
+            System.out.println("committed " + before + " -> " + after);
+            if (args.length > 1 && after >= before) {
+                throw new RuntimeException("Heap was not shrunk: " + before + " -> " + after);
+            }
+        }
+    }
+
+    private static OutputAnalyzer run(String interval, String... idle) throws Exception {
+        String[] args = new String[] {
+            "-XX:+UseG1GC", "-Xms16m", "-Xmx128m", "-XX:G1HeapRegionSize=1m",
+            "-XX:MinHeapFreeRatio=10", "-XX:MaxHeapFreeRatio=20",
+            "-XX:G1PeriodicGCInterval=" + interval, "-XX:+PrintGC",
+            Idle.class.getName()
+        };
+        String[] all = new String[args.length + idle.length];
+        System.arraycopy(args, 0, all, 0, args.length);
+        System.arraycopy(idle, 0, all, args.length, idle.length);
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(all);
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldHaveExitValue(0);
+        return output;
+    }
+
+    public static void main(String[] args) throws Exception {
+        OutputAnalyzer output = run("100", "5000", "shrink");
+        output.shouldContain("G1 Periodic Collection");
+
+        // Disabled by default.
+        output = run("0", "1000");
+        output.shouldNotContain("G1 Periodic Collection");
+    }
+}
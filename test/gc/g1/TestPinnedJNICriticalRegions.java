@@ -0,0 +1,105 @@
+/**
+ * @test TestPinnedJNICriticalRegions
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary With -XX:+G1PinJNICriticalRegions collections run while arrays of
+ *          young, old and humongous regions are in JNI critical sections,
+ *          instead of being held off by the GC locker.
+ * @library /testlibrary
+ * @run main TestPinnedJNICriticalRegions
+ */
+
+import java.util.zip.Adler32;
+
+import com.oracle.java.testlibrary.*;
+
+public class TestPinnedJNICriticalRegions {
+    static class Critical {
+        private static final long DURATION_MS = 5000;
+        private static volatile Object sink;
+        private static volatile Throwable failure;
+
+        // Adler32.update(byte[]) checksums the array in a critical section.
+        static class Checksummer extends Thread {
+            final byte[] array;
+            final long expected;
+
+            Checksummer(byte[] array) {
+                this.array = array;
+                Adler32 a = new Adler32();
+                a.update(array, 0, array.length);
+                this.expected = a.getValue();
+            }
+
+            public void run() {
+                long end = System.currentTimeMillis() + DURATION_MS;
+                while (System.currentTimeMillis() < end && failure == null) {
+                    Adler32 a = new Adler32();
+                    a.update(array, 0, array.length);
+                    if (a.getValue() != expected) {
+                        failure = new RuntimeException("array changed in a critical section");
+                    }
+                }
+            }
+        }
+
+        private static byte[] filled(int size, int seed) {
+            byte[] b = new byte[size];
+            for (int i = 0; i < size; i++) {
+                b[i] = (byte)(i * 31 + seed);
+            }
+            return b;
+        }
+
+        public static void main(String[] args) throws Exception {
+            byte[] old = filled(64 * 1024, 1);
+            System.gc();
+            Thread[] threads = new Thread[] {
+                new Checksummer(filled(64 * 1024, 2)),        // young
+                new Checksummer(old),                         // old
+                new Checksummer(filled(4 * 1024 * 1024, 3))   // humongous
+            };
+            for (Thread t : threads) {
+                t.start();
+            }
+            long end = System.currentTimeMillis() + DURATION_MS;
+            int fulls = 0;
+            while (System.currentTimeMillis() < end) {
+                for (int i = 0; i < 10000; i++) {
+                    sink = new byte[256];
+                }
+                if (fulls < 3) {
+                    System.gc();
+                    fulls++;
+                }
+            }
+            for (Thread t : threads) {
+                t.join();
+            }
+            if (failure != null) {
+                throw new RuntimeException(failure);
+            }
+            System.out.println("done");
+        }
+    }
+
+    private static OutputAnalyzer run(String pin) throws Exception {
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UseG1GC", "-Xmx64m", "-Xmn8m", "-XX:G1HeapRegionSize=1m",
+            pin, "-XX:+PrintGC",
+            "-XX:+UnlockDiagnosticVMOptions", "-XX:+VerifyAfterGC",
+            Critical.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("done");
+        output.shouldHaveExitValue(0);
+        return output;
+    }
+
+    public static void main(String[] args) throws Exception {
+        OutputAnalyzer output = run("-XX:+G1PinJNICriticalRegions");
+        output.shouldNotContain("GCLocker Initiated GC");
+        output.shouldContain("GC pause");
+
+        // The GC locker, as before.
+        run("-XX:-G1PinJNICriticalRegions");
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @test TestGCTaskReadyQueue
+ * @summary Scavenges and full GCs of ParallelGC, whose tasks GC threads claim
+ *          from the lock-free ready queue, keep the object graph intact with
+ *          any number of GC threads and with task affinity.
+ * @key gc
+ * @library /testlibrary
+ * @run main TestGCTaskReadyQueue
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class TestGCTaskReadyQueue {
+    static class Workload {
+        static class Node {
+            final int value;
+            Node next;
+
+            Node(int value, Node next) {
+                this.value = value;
+                this.next = next;
+            }
+        }
+
+        private static Object sink;
+
+        public static void main(String[] args) {
+            Node[] lists = new Node[32];
+            for (int round = 0; round < 20; round++) {
+                for (int i = 0; i < lists.length; i++) {
+                    lists[i] = new Node(round, lists[i]);
+                    for (int j = 0; j < 5000; j++) {
+                        sink = new byte[64];
+                    }
+                }
+                if (round % 5 == 4) {
+                    System.gc();
+                }
+            }
+            for (Node head : lists) {
+                int expected = 19;
+                for (Node n = head; n != null; n = n.next, expected--) {
+                    if (n.value != expected) {
+                        throw new RuntimeException("Expected " + expected + " but was " + n.value);
+                    }
+                }
+                if (expected != -1) {
+                    throw new RuntimeException("List is too short");
+                }
+            }
+            System.out.println("done");
+        }
+    }
+
+    private static void run(String... extraArgs) throws Exception {
+        String[] args = new String[extraArgs.length + 7];
+        args[0] = "-XX:+UseParallelGC";
+        args[1] = "-Xmx64m";
+        args[2] = "-Xmn4m";
+        args[3] = "-XX:+UnlockDiagnosticVMOptions";
+        args[4] = "-XX:+VerifyAfterGC";
+        System.arraycopy(extraArgs, 0, args, 5, extraArgs.length);
+        args[args.length - 2] = "-XX:+PrintGC";
+        args[args.length - 1] = Workload.class.getName();
+        OutputAnalyzer output = new OutputAnalyzer(ProcessTools.createJavaProcessBuilder(args).start());
+        output.shouldContain("done");
+        output.shouldContain("Full GC");
+        output.shouldHaveExitValue(0);
+    }
+
+    public static void main(String[] args) throws Exception {
+        run("-XX:ParallelGCThreads=1");
+        run("-XX:ParallelGCThreads=8", "-XX:+UseParallelOldGC");
+        run("-XX:ParallelGCThreads=8", "-XX:-UseParallelOldGC");
+        // Jobs with task affinity still go through the monitor queue.
+        run("-XX:ParallelGCThreads=4", "-XX:+UseGCTaskAffinity");
+    }
+}
@@ -0,0 +1,13 @@
+/*
+ * @test TestStringDeduplicationCMS
+ * @summary Test string deduplication with -XX:+UseConcMarkSweepGC
+ * @key gc
+ * @requires vm.gc=="ConcMarkSweep" | vm.gc=="null"
+ * @library /testlibrary
+ */
+
+public class TestStringDeduplicationCMS {
+    public static void main(String[] args) throws Exception {
+        TestStringDeduplicationTools.testCollector("-XX:+UseConcMarkSweepGC");
+    }
+}
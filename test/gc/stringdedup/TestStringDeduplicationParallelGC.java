@@ -0,0 +1,13 @@
+/*
+ * @test TestStringDeduplicationParallelGC
+ * @summary Test string deduplication with -XX:+UseParallelGC
+ * @key gc
+ * @requires vm.gc=="Parallel" | vm.gc=="null"
+ * @library /testlibrary
+ */
+
+public class TestStringDeduplicationParallelGC {
+    public static void main(String[] args) throws Exception {
+        TestStringDeduplicationTools.testCollector("-XX:+UseParallelGC");
+    }
+}
@@ -0,0 +1,12 @@
+/*
+ * @test TestStringDeduplicationThreads
+ * @summary Test string deduplication with several deduplication threads
+ * @key gc
+ * @library /testlibrary
+ */
+
+public class TestStringDeduplicationThreads {
+    public static void main(String[] args) throws Exception {
+        TestStringDeduplicationTools.testThreads();
+    }
+}
@@ -169,11 +169,15 @@ class TestStringDeduplicationTools {
     }
 
     private static OutputAnalyzer runTest(String... extraArgs) throws Exception {
+        return runTestWithGC("-XX:+UseG1GC", extraArgs);
+    }
+
+    private static OutputAnalyzer runTestWithGC(String gc, String... extraArgs) throws Exception {
         String[] defaultArgs = new String[] {
             "-Xmn" + Xmn + "m",
             "-Xms" + Xms + "m",
             "-Xmx" + Xmx + "m",
-            "-XX:+UseG1GC",
+            gc,
             "-XX:+UnlockDiagnosticVMOptions",
             "-XX:+VerifyAfterGC" // Always verify after GC
         };
@@ -206,6 +210,10 @@ class TestStringDeduplicationTools {
         }
 
         public static OutputAnalyzer run(int numberOfStrings, int ageThreshold, String gcType, String... extraArgs) throws Exception {
+            return runWithGC("-XX:+UseG1GC", numberOfStrings, ageThreshold, gcType, extraArgs);
+        }
+
+        public static OutputAnalyzer runWithGC(String gc, int numberOfStrings, int ageThreshold, String gcType, String... extraArgs) throws Exception {
             String[] defaultArgs = new String[] {
                 "-XX:+UseStringDeduplication",
                 "-XX:StringDeduplicationAgeThreshold=" + ageThreshold,
@@ -220,7 +228,7 @@ class TestStringDeduplicationTools {
             args.addAll(Arrays.asList(extraArgs));
             args.addAll(Arrays.asList(defaultArgs));
 
-            return runTest(args.toArray(new String[args.size()]));
+            return runTestWithGC(gc, args.toArray(new String[args.size()]));
         }
     }
 
@@ -426,6 +434,54 @@ class TestStringDeduplicationTools {
         output.shouldHaveExitValue(0);
     }
 
+    public static void testThreads() throws Exception {
+        // Several deduplication threads drain the queues in parallel while
+        // the table is resized concurrently
+        OutputAnalyzer output = DeduplicationTest.run(LargeNumberOfStrings,
+                                                      DefaultAgeThreshold,
+                                                      YoungGC,
+                                                      "-XX:+PrintGC",
+                                                      "-XX:+PrintStringDeduplicationStatistics",
+                                                      "-XX:+StringDeduplicationResizeALot",
+                                                      "-XX:StringDeduplicationThreads=4");
+        output.shouldContain("GC concurrent-string-deduplication");
+        output.shouldContain("Deduplicated:");
+        output.shouldNotContain("Resize Count: 0");
+        output.shouldHaveExitValue(0);
+
+        output = DeduplicationTest.run(SmallNumberOfStrings,
+                                       DefaultAgeThreshold,
+                                       YoungGC,
+                                       "-XX:StringDeduplicationThreads=0");
+        output.shouldContain("StringDeduplicationThreads of 0 is invalid; must be at least 1");
+        output.shouldHaveExitValue(1);
+    }
+
+    public static void testCollector(String gc) throws Exception {
+        // Strings become candidates when aged or promoted by young GCs, and
+        // when marked by full GCs, of collectors other than G1 as well
+        OutputAnalyzer output = DeduplicationTest.runWithGC(gc,
+                                                            LargeNumberOfStrings,
+                                                            DefaultAgeThreshold,
+                                                            YoungGC,
+                                                            "-XX:+PrintGC",
+                                                            "-XX:+PrintStringDeduplicationStatistics");
+        output.shouldContain("GC concurrent-string-deduplication");
+        output.shouldContain("Deduplicated:");
+        output.shouldHaveExitValue(0);
+
+        output = DeduplicationTest.runWithGC(gc,
+                                             LargeNumberOfStrings,
+                                             DefaultAgeThreshold,
+                                             FullGC,
+                                             "-XX:+PrintGC",
+                                             "-XX:+PrintStringDeduplicationStatistics");
+        output.shouldContain("Full GC");
+        output.shouldContain("GC concurrent-string-deduplication");
+        output.shouldContain("Deduplicated:");
+        output.shouldHaveExitValue(0);
+    }
+
     public static void testInterned() throws Exception {
         // Test that interned strings are deduplicated before being interned
         OutputAnalyzer output = InternedTest.run();
@@ -0,0 +1,50 @@
+/*
+ * @test CompiledRecoveryRecompile
+ * @summary A compiled method whose exceptions keep going to the recovery oracle
+ *          is recompiled, not excluded from compilation.
+ * @library /testlibrary
+ * @run main CompiledRecoveryRecompile
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class CompiledRecoveryRecompile {
+    static class Target {
+        static int recovered;
+
+        static void fail(int i) throws java.io.IOException {
+            if ((i & 0xff) == 0) {
+                throw new IllegalStateException("fail");
+            }
+        }
+
+        static void run(int i) {
+            try {
+                fail(i);
+            } catch (java.io.IOException e) {
+                recovered++;
+            }
+        }
+
+        public static void main(String[] args) {
+            for (int i = 0; i < 200000; i++) {
+                run(i);
+            }
+            System.out.println("recovered " + recovered);
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        // TRACE_CHECKING
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:TraceRuntimeRecovery=4", "-XX:PerMethodRecoveryTrapLimit=4",
+            "-XX:RecoveryTrapDecayMillis=0", "-XX:+PrintCompilation",
+            "-cp", System.getProperty("test.classes"),
+            Target.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldMatch("record_compiled_recovery: .* [0-9]+ recent recoveries");
+        output.shouldNotContain("made not compilable");
+        output.shouldContain("recovered 782");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * @test InflatedReflectiveRecovery
+ * @summary An exception thrown through the accessor generated for an inflated
+ *          reflective call is an uncaught failure, as through invoke0.
+ * @library /testlibrary
+ * @run main InflatedReflectiveRecovery
+ */
+
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+
+import com.oracle.java.testlibrary.*;
+
+public class InflatedReflectiveRecovery {
+    // TRACE_CHECKING
+    private static final String TRACE = "-XX:TraceRuntimeRecovery=4";
+
+    static class Target {
+        public static void fail() {
+            throw new IllegalStateException("fail");
+        }
+
+        public static void main(String[] args) throws Exception {
+            Method m = Target.class.getMethod("fail");
+            try {
+                m.invoke(null);
+            } catch (InvocationTargetException e) {
+                System.out.println("done " + e.getCause());
+            }
+        }
+    }
+
+    private static OutputAnalyzer run(String inflation) throws Exception {
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            inflation, TRACE,
+            "-cp", System.getProperty("test.classes"), Target.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("done");
+        output.shouldHaveExitValue(0);
+        return output;
+    }
+
+    public static void main(String[] args) throws Exception {
+        // The catch of Throwable in the generated accessor only wraps the
+        // exception, it is not a handler of the program.
+        OutputAnalyzer output = run("-Dsun.reflect.noInflation=true");
+        output.shouldContain("determine_failure_type: (java/lang/IllegalStateException) uncaught exception");
+        output.shouldNotContain("caught class=java/lang/Throwable");
+
+        // The same for a native reflective call.
+        output = run("-Dsun.reflect.inflationThreshold=1000");
+        output.shouldContain("determine_failure_type: (java/lang/IllegalStateException) uncaught exception");
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * @test LazyRecoveryBacktrace
+ * @summary -XX:+LazyRecoveryBacktrace defers the stack trace of exceptions
+ *          thrown right where they are constructed, the deferred trace is the
+ *          one of the constructing frame.
+ * @library /testlibrary
+ * @run main LazyRecoveryBacktrace
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class LazyRecoveryBacktrace {
+    static class Target {
+        static RuntimeException stored;
+
+        static void thrower() {
+            throw new IllegalStateException("thrown");
+        }
+
+        static void store() {
+            stored = new IllegalArgumentException("stored");
+        }
+
+        static void throwStored() {
+            throw stored;
+        }
+
+        static void check(RuntimeException e, String top) {
+            StackTraceElement[] trace = e.getStackTrace();
+            if (trace.length < 2 ||
+                !trace[0].getMethodName().equals(top) ||
+                !trace[1].getMethodName().equals("main")) {
+                e.printStackTrace();
+                throw new RuntimeException("wrong stack trace of " + e);
+            }
+        }
+
+        public static void main(String[] args) {
+            try {
+                thrower();
+            } catch (IllegalStateException e) {
+                check(e, "thrower");
+            }
+            store();
+            try {
+                throwStored();
+            } catch (IllegalArgumentException e) {
+                check(e, "store");
+            }
+            System.out.println("traces ok");
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        // TRACE_TRANSFORMING
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-Xint", "-XX:+LazyRecoveryBacktrace", "-XX:TraceRuntimeRecovery=2",
+            "-cp", System.getProperty("test.classes"),
+            Target.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Deferring the stack trace of java/lang/IllegalStateException");
+        output.shouldContain("Filling in the deferred stack trace of java/lang/IllegalStateException");
+        output.shouldNotContain("Deferring the stack trace of java/lang/IllegalArgumentException");
+        output.shouldNotContain("is gone");
+        output.shouldContain("traces ok");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * @test ParallelJPFCandidates
+ * @summary -XX:JPFWorkerThreads evaluates the JPF recovery candidates on a
+ *          pool of workers, the best ranked accepted candidate wins.
+ * @library /testlibrary
+ * @run main ParallelJPFCandidates
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class ParallelJPFCandidates {
+    // A stand-in for the JPF side which accepts every error transformation.
+    private static final String ARES =
+        "package gov.nasa.jpf;" +
+        "public class Ares {" +
+        "    public static Object[] runDefault(Object[] data) {" +
+        "        throw new Error(\"runDefault must not be used\");" +
+        "    }" +
+        "    public static Object[] runCandidate(Object[] data, Object[] candidate, boolean[] cancel) {" +
+        "        if (!Thread.currentThread().getName().startsWith(\"JPF Worker\")) {" +
+        "            throw new Error(\"not on a worker\");" +
+        "        }" +
+        "        return \"ErrorTransformation\".equals(candidate[0]) ? candidate : null;" +
+        "    }" +
+        "}";
+
+    // The IllegalStateException of fail() is not caught. Transforming it
+    // into the FileSystemLoopException of middle() is ranked before the
+    // IOException of main(). Nothing loads FileSystemLoopException before,
+    // so the catch type of middle() is not resolved yet.
+    private static final String TARGET =
+        "import java.io.IOException;" +
+        "import java.nio.file.FileSystemLoopException;" +
+        "public class RecoveryTarget {" +
+        "    static void fail() throws IOException {" +
+        "        throw new IllegalStateException(\"fail\");" +
+        "    }" +
+        "    static void middle() throws IOException {" +
+        "        try {" +
+        "            fail();" +
+        "        } catch (FileSystemLoopException e) {" +
+        "            System.out.println(\"recovered in middle\");" +
+        "        }" +
+        "    }" +
+        "    public static void main(String[] args) {" +
+        "        try {" +
+        "            middle();" +
+        "        } catch (IOException e) {" +
+        "            System.out.println(\"recovered in main\");" +
+        "        }" +
+        "    }" +
+        "}";
+
+    public static void main(String[] args) throws Exception {
+        RecoveryTestUtils.writeClass("jpf", "gov.nasa.jpf.Ares", ARES);
+        RecoveryTestUtils.writeClass("app", "RecoveryTarget", TARGET);
+
+        // TRACE_JPF
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-Xbootclasspath/a:jpf", "-XX:+UseJPF", "-XX:JPFWorkerThreads=2",
+            "-XX:TraceRuntimeRecovery=32768",
+            "-cp", "app", "RecoveryTarget");
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("JPFWorkerPool::initialize: started 2 workers");
+        output.shouldMatch("evaluate_candidates: winner 0 of [1-9][0-9]* candidates");
+        output.shouldContain("recovered in middle");
+        output.shouldNotContain("runDefault must not be used");
+        output.shouldHaveExitValue(0);
+    }
+}
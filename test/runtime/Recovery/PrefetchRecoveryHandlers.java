@@ -0,0 +1,101 @@
+/*
+ * @test PrefetchRecoveryHandlers
+ * @summary -XX:+PrefetchRecoveryHandlers fetches the known handler keys of
+ *          each linked class: the induced keys of its handlers, and the
+ *          fuzzing keys over more than one SCAN step.
+ * @library /testlibrary
+ * @run main PrefetchRecoveryHandlers
+ */
+
+import java.io.BufferedReader;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.io.OutputStream;
+import java.net.Socket;
+
+import com.oracle.java.testlibrary.*;
+
+public class PrefetchRecoveryHandlers {
+    // TRACE_USE_REDIS
+    private static final String TRACE = "-XX:TraceRuntimeRecovery=64";
+
+    // More keys than one SCAN step looks at.
+    private static final int FILLER_KEYS = 5000;
+
+    static class Target {
+        public static void main(String[] args) {
+            // Gives the prefetch thread time for the scans of this class.
+            try {
+                Thread.sleep(3000);
+            } catch (InterruptedException e) {
+                throw new RuntimeException(e);
+            }
+            System.out.println("done");
+        }
+    }
+
+    private static Socket socket;
+    private static BufferedReader in;
+
+    private static void send(String... args) throws IOException {
+        StringBuilder sb = new StringBuilder("*" + args.length + "\r\n");
+        for (String arg : args) {
+            sb.append("$").append(arg.length()).append("\r\n").append(arg).append("\r\n");
+        }
+        OutputStream out = socket.getOutputStream();
+        out.write(sb.toString().getBytes("UTF-8"));
+        out.flush();
+    }
+
+    private static void expectOk(int replies) throws IOException {
+        for (int i = 0; i < replies; i++) {
+            String line = in.readLine();
+            if (line == null || line.startsWith("-")) {
+                throw new RuntimeException("redis error: " + line);
+            }
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        try {
+            socket = new Socket("127.0.0.1", 6379);
+        } catch (IOException e) {
+            System.out.println("No redis server on 127.0.0.1:6379, skipped");
+            return;
+        }
+        in = new BufferedReader(new InputStreamReader(socket.getInputStream(), "UTF-8"));
+
+        String prefix = "PrefetchRecoveryHandlers" + ProcessTools.getProcessId();
+        String name = Target.class.getName();
+        // The handler of the InterruptedException covers [0, 6) and is at 9.
+        String induced = prefix + "-induced:" + name + ".main([Ljava/lang/String;)V:0:6:9";
+        String fuzzing = prefix + "-fuzzing:0:" + name + ".main([Ljava/lang/String;)V:3";
+        try {
+            send("SET", induced, "1");
+            send("SET", fuzzing, "1");
+            for (int i = 0; i < FILLER_KEYS; i++) {
+                send("SET", prefix + "-filler:" + i, "1");
+            }
+            expectOk(FILLER_KEYS + 2);
+
+            ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+                "-XX:+UseRedis", "-XX:RedisKeyPrefix=" + prefix,
+                "-XX:+PrefetchRecoveryHandlers", TRACE,
+                "-cp", System.getProperty("test.classes"), name);
+            OutputAnalyzer output = new OutputAnalyzer(pb.start());
+            output.shouldContain("done");
+            output.shouldHaveExitValue(0);
+            output.shouldNotContain("Lost the redis connection");
+            output.shouldContain("Prefetched the known handler keys of " + name);
+            output.shouldMatch("Prefetched 2 known handler keys for [1-9][0-9]* classes");
+        } finally {
+            send("DEL", induced);
+            send("DEL", fuzzing);
+            for (int i = 0; i < FILLER_KEYS; i++) {
+                send("DEL", prefix + "-filler:" + i);
+            }
+            expectOk(FILLER_KEYS + 2);
+            socket.close();
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * @test RecordReplayRecovery
+ * @summary -XX:RecordRecoveryFile records the JPF answers of the recovery
+ *          oracle, -XX:ReplayRecoveryFile replays them without running JPF.
+ * @library /testlibrary
+ * @run main RecordReplayRecovery
+ */
+
+import java.nio.file.Files;
+import java.nio.file.Paths;
+
+import com.oracle.java.testlibrary.*;
+
+public class RecordReplayRecovery {
+    // A stand-in for the JPF side which transforms into the IOException.
+    private static final String ARES =
+        "package gov.nasa.jpf;" +
+        "public class Ares {" +
+        "    public static Object[] runDefault(Object[] data) {" +
+        "        return new Object[] { \"ErrorTransformation\", java.io.IOException.class };" +
+        "    }" +
+        "}";
+
+    // The IllegalStateException of fail() is not caught, the oracle
+    // transforms it into the IOException caught by main().
+    private static final String TARGET =
+        "import java.io.IOException;" +
+        "public class RecoveryTarget {" +
+        "    static void fail() throws IOException {" +
+        "        throw new IllegalStateException(\"fail\");" +
+        "    }" +
+        "    public static void main(String[] args) {" +
+        "        try {" +
+        "            fail();" +
+        "        } catch (IOException e) {" +
+        "            System.out.println(\"recovered\");" +
+        "        }" +
+        "    }" +
+        "}";
+
+    public static void main(String[] args) throws Exception {
+        RecoveryTestUtils.writeClass("jpf", "gov.nasa.jpf.Ares", ARES);
+        RecoveryTestUtils.writeClass("app", "RecoveryTarget", TARGET);
+
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-Xbootclasspath/a:jpf", "-XX:+UseJPF",
+            "-XX:RecordRecoveryFile=recovery.rec",
+            "-cp", "app", "RecoveryTarget");
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("recovered");
+        output.shouldHaveExitValue(0);
+
+        String record = new String(Files.readAllBytes(Paths.get("recovery.rec")));
+        if (!record.contains("jpf ET:java/io/IOException java/lang/IllegalStateException")) {
+            throw new RuntimeException("JPF answer not recorded: " + record);
+        }
+
+        // No JPF side this time, the answer comes from the file.
+        pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UseJPF", "-XX:ReplayRecoveryFile=recovery.rec",
+            "-XX:TraceRuntimeRecovery=32768",
+            "-cp", "app", "RecoveryTarget");
+        output = new OutputAnalyzer(pb.start());
+        output.shouldMatch("Loaded [1-9][0-9]* recorded oracle answers from recovery.rec");
+        output.shouldNotContain("cannot resolve gov/nasa/jpf/Ares");
+        output.shouldContain("recovered");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * @test RecoveryEventLogRotation
+ * @summary Every file of a rotated -XX:RecoveryEventLogFile defines the
+ *          methods its events refer to.
+ * @library /testlibrary
+ * @run main RecoveryEventLogRotation
+ */
+
+import java.io.File;
+
+import com.oracle.java.testlibrary.*;
+
+public class RecoveryEventLogRotation {
+    static class Target {
+        static void fail() throws java.io.IOException {
+            throw new IllegalStateException("fail");
+        }
+
+        public static void main(String[] args) throws Exception {
+            int recovered = 0;
+            for (int i = 0; i < 300; i++) {
+                try {
+                    fail();
+                } catch (java.io.IOException e) {
+                    recovered++;
+                }
+                Thread.sleep(1);
+            }
+            System.out.println("recovered " + recovered);
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:RecoveryEventLogFile=recovery.evt",
+            "-XX:RecoveryEventLogFileSize=1024",
+            "-XX:RecoveryEventLogFileCount=4",
+            "-XX:RecoveryEventLogFlushInterval=5",
+            "-cp", System.getProperty("test.classes"),
+            Target.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("recovered 300");
+        output.shouldHaveExitValue(0);
+
+        int files = 0;
+        for (int i = 0; i < 4; i++) {
+            if (!new File("recovery.evt." + i).exists()) {
+                continue;
+            }
+            files++;
+            pb = ProcessTools.createJavaProcessBuilder(
+                "-XX:DecodeRecoveryEventLog=recovery.evt." + i);
+            output = new OutputAnalyzer(pb.start());
+            output.shouldHaveExitValue(0);
+            // A site without a definition decodes as its address.
+            output.shouldNotMatch("(failure|strategy|recovery|early return|error transformation) 0x");
+        }
+        if (files < 2) {
+            throw new RuntimeException("the log was not rotated");
+        }
+    }
+}
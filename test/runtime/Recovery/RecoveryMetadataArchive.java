@@ -0,0 +1,63 @@
+/*
+ * @test RecoveryMetadataArchive
+ * @summary -XX:+DumpRecoveryMetadata writes an archive which is used for recovery
+ *          only while it matches the loaded classes.
+ * @library /testlibrary
+ * @run main RecoveryMetadataArchive
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class RecoveryMetadataArchive {
+    // TRACE_METADATA
+    private static final String TRACE = "-XX:TraceRuntimeRecovery=16384";
+
+    // The IllegalStateException of fail() is not caught, the oracle
+    // transforms it into the IOException caught by main().
+    private static String source(String extra) {
+        return "import java.io.IOException;" +
+               "public class RecoveryTarget {" +
+               "    static void fail() throws IOException {" +
+               extra +
+               "        throw new IllegalStateException(\"fail\");" +
+               "    }" +
+               "    public static void main(String[] args) {" +
+               "        try {" +
+               extra +
+               "            fail();" +
+               "        } catch (IOException e) {" +
+               "            System.out.println(\"recovered\");" +
+               "        }" +
+               "    }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        RecoveryTestUtils.writeClass("v1", "RecoveryTarget", source(""));
+        RecoveryTestUtils.writeClass("v2", "RecoveryTarget", source("System.out.println(\"v2\");"));
+        String archive = "-XX:RecoveryMetadataFile=recovery.rmd";
+
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+DumpRecoveryMetadata", archive, "-cp", "v1", "-version");
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Wrote recovery metadata of");
+        output.shouldHaveExitValue(0);
+
+        // The classes the archive was written from.
+        pb = ProcessTools.createJavaProcessBuilder(
+            archive, TRACE, "-cp", "v1", "RecoveryTarget");
+        output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Mapped recovery metadata");
+        output.shouldNotContain("Stale recovery metadata");
+        output.shouldContain("recovered");
+        output.shouldHaveExitValue(0);
+
+        // A changed class must not be answered from the archive.
+        pb = ProcessTools.createJavaProcessBuilder(
+            archive, TRACE, "-cp", "v2", "RecoveryTarget");
+        output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Stale recovery metadata");
+        output.shouldContain("recovered");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * @test RecoveryOutcomeTracking
+ * @summary A recovery counts as failed only if its thread fails again within
+ *          -XX:RecoveryOutcomeWindowMillis, and as succeeded once the window
+ *          has passed; an action which keeps failing is rejected at its site.
+ * @library /testlibrary
+ * @run main RecoveryOutcomeTracking
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class RecoveryOutcomeTracking {
+    // TRACE_PRINT_ACTION
+    private static final String TRACE = "-XX:TraceRuntimeRecovery=2048";
+
+    // Each worker recovers the IllegalStateException of fail() into the
+    // caught IOException, then ends normally or dies if args[0] is "die".
+    // With "keep" one worker keeps running past the window while the main
+    // thread recovers.
+    private static final String SOURCE =
+        "import java.io.IOException;" +
+        "public class RecoveryTarget implements Runnable {" +
+        "    private static volatile boolean stop;" +
+        "    private final boolean die;" +
+        "    RecoveryTarget(boolean die) { this.die = die; }" +
+        "    static void fail() throws IOException {" +
+        "        throw new IllegalStateException(\"fail\");" +
+        "    }" +
+        "    public void run() {" +
+        "        try {" +
+        "            fail();" +
+        "        } catch (IOException e) {" +
+        "            System.out.println(\"recovered\");" +
+        "        }" +
+        "        if (die) {" +
+        "            throw new RuntimeException(\"die\");" +
+        "        }" +
+        "    }" +
+        "    public static void main(String[] args) throws Exception {" +
+        "        if (args[0].equals(\"keep\")) {" +
+        "            Thread t = new Thread() {" +
+        "                public void run() {" +
+        "                    new RecoveryTarget(false).run();" +
+        "                    while (!stop) {" +
+        "                        Thread.yield();" +
+        "                    }" +
+        "                }" +
+        "            };" +
+        "            t.start();" +
+        "            Thread.sleep(2000);" +
+        "            new RecoveryTarget(false).run();" +
+        "            System.out.println(\"main recovered\");" +
+        "            stop = true;" +
+        "            t.join();" +
+        "            System.out.println(\"done\");" +
+        "            return;" +
+        "        }" +
+        "        boolean die = args[0].equals(\"die\");" +
+        "        for (int i = 0; i < 3; i++) {" +
+        "            Thread t = new Thread(new RecoveryTarget(die));" +
+        "            t.start();" +
+        "            t.join();" +
+        "        }" +
+        "        System.out.println(\"done\");" +
+        "    }" +
+        "}";
+
+    private static OutputAnalyzer run(String mode, int window) throws Exception {
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:RecoveryOutcomeWindowMillis=" + window,
+            "-XX:RecoveryOutcomeMinSamples=2",
+            "-XX:RecoveryOutcomeBadFailureRate=50",
+            TRACE, "-cp", ".", "RecoveryTarget", mode);
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("done");
+        output.shouldHaveExitValue(0);
+        return output;
+    }
+
+    public static void main(String[] args) throws Exception {
+        RecoveryTestUtils.writeClass(".", "RecoveryTarget", SOURCE);
+
+        // Threads which end normally after their recovery do not count
+        // against it, however soon they exit.
+        OutputAnalyzer output = run("live", 60000);
+        output.shouldContain("recovery outcome: succeeded");
+        output.shouldNotContain("recovery outcome: failed");
+        output.shouldNotContain("keeps failing at this site");
+
+        // Threads which die after their recovery do, and after two such
+        // outcomes the action is rejected for the third thread.
+        output = run("die", 60000);
+        output.shouldContain("recovery outcome: failed");
+        output.shouldContain("keeps failing at this site");
+
+        // The worker is still running when the recovery of the main thread
+        // resolves its outcome, the window having passed.
+        output = run("keep", 500);
+        output.shouldNotContain("recovery outcome: failed");
+        String stdout = output.getStdout();
+        int succeeded = stdout.indexOf("recovery outcome: succeeded");
+        if (succeeded < 0 || succeeded > stdout.indexOf("main recovered")) {
+            throw new RuntimeException("outcome not resolved while the worker runs");
+        }
+    }
+}
@@ -0,0 +1,20 @@
+import java.io.File;
+import java.io.FileOutputStream;
+
+import com.oracle.java.testlibrary.*;
+
+// Helpers shared by the recovery tests.
+public class RecoveryTestUtils {
+    // Compiles the source of the class name into dir/name.class, the
+    // package directories of name included.
+    public static void writeClass(String dir, String name, String source) throws Exception {
+        File file = new File(dir, name.replace('.', File.separatorChar) + ".class");
+        file.getParentFile().mkdirs();
+        FileOutputStream out = new FileOutputStream(file);
+        try {
+            out.write(InMemoryJavaCompiler.compile(name, source));
+        } finally {
+            out.close();
+        }
+    }
+}
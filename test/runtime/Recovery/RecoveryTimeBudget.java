@@ -0,0 +1,89 @@
+/*
+ * @test RecoveryTimeBudget
+ * @summary -XX:RecoveryTimeBudgetMicros bounds the JPF evaluation of recovery
+ *          candidates: the best candidate accepted at the deadline wins, and
+ *          no candidate is started past it.
+ * @library /testlibrary
+ * @run main RecoveryTimeBudget
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class RecoveryTimeBudget {
+    // A stand-in for the JPF side. It accepts every error transformation
+    // but the FileNotFoundException, which it takes its time to reject.
+    private static final String ARES =
+        "package gov.nasa.jpf;" +
+        "public class Ares {" +
+        "    public static Object[] runDefault(Object[] data) {" +
+        "        return null;" +
+        "    }" +
+        "    public static Object[] runCandidate(Object[] data, Object[] candidate, boolean[] cancel) {" +
+        "        if (!\"ErrorTransformation\".equals(candidate[0])) {" +
+        "            return null;" +
+        "        }" +
+        "        if (candidate[1] == java.io.FileNotFoundException.class) {" +
+        "            long end = System.currentTimeMillis() + 5000;" +
+        "            while (!cancel[0] && System.currentTimeMillis() < end) {" +
+        "                try { Thread.sleep(10); } catch (InterruptedException e) { }" +
+        "            }" +
+        "            return null;" +
+        "        }" +
+        "        return candidate;" +
+        "    }" +
+        "}";
+
+    // The IllegalStateException of fail() is not caught. Transforming it
+    // into the FileNotFoundException of middle() is ranked before the
+    // IOException of main().
+    private static final String TARGET =
+        "import java.io.FileNotFoundException;" +
+        "import java.io.IOException;" +
+        "public class RecoveryTarget {" +
+        "    static void fail() throws IOException {" +
+        "        throw new IllegalStateException(\"fail\");" +
+        "    }" +
+        "    static void middle() throws IOException {" +
+        "        try {" +
+        "            fail();" +
+        "        } catch (FileNotFoundException e) {" +
+        "            System.out.println(\"recovered in middle\");" +
+        "        }" +
+        "    }" +
+        "    public static void main(String[] args) {" +
+        "        try {" +
+        "            middle();" +
+        "        } catch (IOException e) {" +
+        "            System.out.println(\"recovered in main\");" +
+        "        }" +
+        "    }" +
+        "}";
+
+    private static OutputAnalyzer run(String workers) throws Exception {
+        // Only JPF finds error transformations; TRACE_JPF
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-Xbootclasspath/a:jpf", "-XX:+UseJPF", "-XX:-UseStack", workers,
+            "-XX:RecoveryTimeBudgetMicros=500000", "-XX:TraceRuntimeRecovery=32768",
+            "-cp", "app", "RecoveryTarget");
+        return new OutputAnalyzer(pb.start());
+    }
+
+    public static void main(String[] args) throws Exception {
+        RecoveryTestUtils.writeClass("jpf", "gov.nasa.jpf.Ares", ARES);
+        RecoveryTestUtils.writeClass("app", "RecoveryTarget", TARGET);
+
+        // The workers accept the IOException while the FileNotFoundException
+        // is still running at the deadline.
+        OutputAnalyzer output = run("-XX:JPFWorkerThreads=2");
+        output.shouldMatch("evaluate_candidates: winner [1-9][0-9]* of [0-9]+ candidates");
+        output.shouldContain("recovered in main");
+        output.shouldHaveExitValue(0);
+
+        // On the failing thread the FileNotFoundException uses up the budget,
+        // nothing is started after it.
+        output = run("-XX:JPFWorkerThreads=0");
+        output.shouldContain("evaluate_candidates_sequentially: out of time after 1 of");
+        output.shouldContain("evaluate_candidates_sequentially: winner -1 of");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * @test RecoveryWriteBack
+ * @summary -XX:RecoveryWriteBackInterval writes the handlers of sampled
+ *          exception dispatches to RecoveryIndexFile as induced keys.
+ * @library /testlibrary
+ * @run main RecoveryWriteBack
+ */
+
+import java.io.File;
+import java.nio.file.Files;
+
+import com.oracle.java.testlibrary.*;
+
+public class RecoveryWriteBack {
+    // TRACE_USE_INDUCED
+    private static final String TRACE = "-XX:TraceRuntimeRecovery=128";
+
+    static class Target {
+        static void fail(int i) {
+            throw new IllegalStateException("fail " + i);
+        }
+
+        public static void main(String[] args) throws Exception {
+            int caught = 0;
+            for (int i = 0; i < 100; i++) {
+                try {
+                    fail(i);
+                } catch (IllegalStateException e) {
+                    caught++;
+                }
+            }
+            // Gives the write back thread time for the handed over keys.
+            Thread.sleep(2000);
+            System.out.println("caught " + caught);
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        File index = new File("writeback.idx");
+        index.delete();
+
+        String name = Target.class.getName();
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:RecoveryWriteBackInterval=10",
+            "-XX:RecoveryWriteBackBufferSize=1",
+            "-XX:RecoveryIndexFile=" + index.getPath(),
+            TRACE, "-cp", System.getProperty("test.classes"), name);
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("caught 100");
+        output.shouldContain("Writing back observed handler -induced:" + name + ".main(");
+        output.shouldHaveExitValue(0);
+
+        // Each key is written once, however often its handler is sampled.
+        String key = null;
+        for (String line : Files.readAllLines(index.toPath())) {
+            if (line.startsWith("-induced:" + name + ".main([Ljava/lang/String;)V:")) {
+                if (key != null) {
+                    throw new RuntimeException("Written twice: " + line);
+                }
+                key = line;
+            }
+        }
+        if (key == null) {
+            throw new RuntimeException("The handler of main was not written to " + index);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * @test SharedRecoveryMetadata
+ * @summary -Xshare:dump stores the recovery metadata of the shared classes,
+ *          the oracle uses it for frames of shared methods.
+ * @library /testlibrary
+ * @run main SharedRecoveryMetadata
+ */
+
+import java.util.ArrayList;
+import java.util.List;
+
+import com.oracle.java.testlibrary.*;
+
+public class SharedRecoveryMetadata {
+    static class Target {
+        // The IllegalStateException crosses the shared ArrayList.forEach
+        // before the oracle transforms it into the caught exception.
+        public static void main(String[] args) {
+            List<String> list = new ArrayList<>();
+            list.add("x");
+            try {
+                list.forEach(s -> { throw new IllegalStateException(s); });
+            } catch (IllegalArgumentException e) {
+                System.out.println("recovered");
+            }
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        String archive = "-XX:SharedArchiveFile=./recovery.jsa";
+
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UnlockDiagnosticVMOptions", archive, "-Xshare:dump");
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        try {
+            output.shouldContain("Loading classes to share");
+            output.shouldHaveExitValue(0);
+        } catch (RuntimeException e) {
+            output.shouldContain("Unable to use shared archive");
+            System.out.println("Sharing is not supported, skipped");
+            return;
+        }
+        output.shouldMatch("rm space: +[0-9]+ bytes of recovery metadata for [1-9][0-9]* methods");
+
+        // TRACE_METADATA
+        pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UnlockDiagnosticVMOptions", archive, "-Xshare:on",
+            "-XX:TraceRuntimeRecovery=16384",
+            "-cp", System.getProperty("test.classes"),
+            Target.class.getName());
+        output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Using shared recovery metadata");
+        output.shouldContain("recovered");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * @test TransformedExceptionPrototype
+ * @summary -XX:+OmitStackTraceInTransformedException copies a prototype built
+ *          by the constructor of the target class, the copies have their own
+ *          cause and no stack trace.
+ * @library /testlibrary
+ * @run main TransformedExceptionPrototype
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class TransformedExceptionPrototype {
+    static class TargetException extends java.io.IOException {
+        final String initialized = "initialized";
+        final boolean constructed;
+
+        TargetException(String message) {
+            super(message);
+            constructed = true;
+        }
+    }
+
+    static class Target {
+        static void fail(int i) throws TargetException {
+            throw new IllegalStateException("fail " + i);
+        }
+
+        public static void main(String[] args) {
+            TargetException last = null;
+            for (int i = 0; i < 10; i++) {
+                try {
+                    fail(i);
+                } catch (TargetException e) {
+                    if (e == last) {
+                        throw new RuntimeException("exception reused");
+                    }
+                    if (e.initialized == null || !e.constructed) {
+                        throw new RuntimeException("constructor did not run");
+                    }
+                    if (!e.getCause().getMessage().equals("fail " + i)) {
+                        throw new RuntimeException("wrong cause " + e.getCause());
+                    }
+                    if (i >= 2 && e.getStackTrace().length != 0) {
+                        throw new RuntimeException("stack trace not omitted");
+                    }
+                    last = e;
+                }
+            }
+            System.out.println("recovered");
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        // TRACE_TRANSFORMING
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+OmitStackTraceInTransformedException",
+            "-XX:TransformedExceptionStackTraceSamples=2",
+            "-XX:TransformedExceptionStackTraceInterval=0",
+            "-XX:TraceRuntimeRecovery=2",
+            "-cp", System.getProperty("test.classes"),
+            Target.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("without stack trace at");
+        output.shouldContain("recovered");
+        output.shouldHaveExitValue(0);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * @test WhiteBoxDecideRecovery
+ * @summary WhiteBox.decideRecovery reports the decision of the recovery
+ *          oracle without applying it, the decision cache counts its hits.
+ * @library /testlibrary /testlibrary/whitebox
+ * @build WhiteBoxDecideRecovery
+ * @run main ClassFileInstaller sun.hotspot.WhiteBox
+ *                              sun.hotspot.WhiteBox$WhiteBoxPermission
+ * @run main/othervm -Xbootclasspath/a:. -XX:+UnlockDiagnosticVMOptions -XX:+WhiteBoxAPI
+ *                   -XX:RecoveryTimeBudgetMicros=10000000 -XX:RecoveryDecisionCacheSize=64
+ *                   WhiteBoxDecideRecovery
+ */
+
+import java.io.IOException;
+
+import com.oracle.java.testlibrary.*;
+import sun.hotspot.WhiteBox;
+
+public class WhiteBoxDecideRecovery {
+    private static final WhiteBox WB = WhiteBox.getWhiteBox();
+
+    // RecoveryOracle::RecoveryType
+    private static final long ERROR_TRANSFORMATION = 1;
+
+    private static Object[] decide() throws IOException {
+        return WB.decideRecovery(new IllegalStateException("decide"));
+    }
+
+    public static void main(String[] args) throws Exception {
+        WB.resetRecoveryDecisionCache();
+        WB.resetRecoveryStrategyTimeouts();
+
+        for (int i = 0; i < 2; i++) {
+            Object[] decision;
+            try {
+                decision = decide();
+            } catch (IOException e) {
+                throw new RuntimeException("the decision was applied", e);
+            }
+            long[] values = (long[]) decision[0];
+            Asserts.assertEQ(values[1], ERROR_TRANSFORMATION, "recovery type");
+            Asserts.assertEQ(decision[1], IOException.class, "target class");
+        }
+
+        int[] stats = WB.getRecoveryDecisionCacheStatistics();
+        Asserts.assertGTE(stats[0], 1, "entries");
+        Asserts.assertGTE(stats[1], 1, "hits");
+
+        WB.resetRecoveryDecisionCache();
+        stats = WB.getRecoveryDecisionCacheStatistics();
+        Asserts.assertEQ(stats[0], 0, "entries after reset");
+
+        for (int timeouts : WB.getRecoveryStrategyTimeouts()) {
+            Asserts.assertEQ(timeouts, 0, "timeouts within a generous budget");
+        }
+    }
+}
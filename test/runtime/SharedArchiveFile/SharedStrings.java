@@ -0,0 +1,73 @@
+/*
+ * @test SharedStrings
+ * @summary With G1 and compressed oops, -Xshare:dump archives the interned
+ *          strings into archive regions of the heap, which are used at run
+ *          time if the heap matches and ignored otherwise.
+ * @library /testlibrary
+ * @run main SharedStrings
+ */
+
+import com.oracle.java.testlibrary.*;
+
+public class SharedStrings {
+    static class Target {
+        public static void main(String[] args) {
+            // A string constant of a shared class, and of this one.
+            String shared = "java.lang.Object";
+            String local = "SharedStringsLocal";
+            if (shared.intern() != shared || local.intern() != local) {
+                throw new RuntimeException("literal is not the interned string");
+            }
+            String built = new StringBuilder("java.lang.").append("Object").toString();
+            for (int i = 0; i < 3; i++) {
+                System.gc();
+                if (built.intern() != shared) {
+                    throw new RuntimeException("interned string changed");
+                }
+            }
+            System.out.println("done");
+        }
+    }
+
+    private static final String ARCHIVE = "-XX:SharedArchiveFile=./SharedStrings.jsa";
+
+    private static OutputAnalyzer load(String... vmArgs) throws Exception {
+        String[] args = new String[vmArgs.length + 6];
+        args[0] = "-XX:+UnlockDiagnosticVMOptions";
+        System.arraycopy(vmArgs, 0, args, 1, vmArgs.length);
+        int i = vmArgs.length + 1;
+        args[i++] = ARCHIVE;
+        args[i++] = "-Xshare:auto";
+        args[i++] = "-cp";
+        args[i++] = System.getProperty("test.classes");
+        args[i++] = Target.class.getName();
+        OutputAnalyzer output = new OutputAnalyzer(ProcessTools.createJavaProcessBuilder(args).start());
+        output.shouldContain("done");
+        output.shouldHaveExitValue(0);
+        return output;
+    }
+
+    public static void main(String[] args) throws Exception {
+        if (!Platform.is64bit()) {
+            System.out.println("Archived strings need compressed oops, skipped");
+            return;
+        }
+
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(
+            "-XX:+UseG1GC", "-Xmx128m", "-XX:+UseCompressedOops",
+            "-XX:+UnlockDiagnosticVMOptions", ARCHIVE, "-Xshare:dump");
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        output.shouldContain("Loading classes to share");
+        output.shouldMatch("st space: +[1-9][0-9]* bytes of interned strings");
+        output.shouldHaveExitValue(0);
+
+        // The heap the strings were archived from, verified around the
+        // archive regions.
+        load("-XX:+UseG1GC", "-Xmx128m", "-XX:+UseCompressedOops",
+             "-XX:+VerifyBeforeGC", "-XX:+VerifyAfterGC");
+
+        // Other heaps fall back to a regular string table.
+        load("-XX:+UseParallelGC", "-Xmx128m");
+        load("-XX:+UseG1GC", "-Xmx128m", "-XX:-UseCompressedOops");
+    }
+}
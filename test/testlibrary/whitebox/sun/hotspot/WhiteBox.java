@@ -164,6 +164,19 @@ public class WhiteBox {
   public native int     getMethodEntryBci(Executable method);
   public native Object[] getNMethod(Executable method, boolean isOsr);
 
+  // Recovery oracle
+  // Decides the recovery of exception on the stack of the caller without
+  // applying it: { long[] { failure type, recovery type, recovery context
+  // offset, early return offset, early return type, stage nanos... },
+  // Class target of an error transformation }
+  public native Object[] decideRecovery(Throwable exception);
+  public native void    resetRecoveryDecisionCache();
+  // { entries, hits, misses }
+  public native int[]   getRecoveryDecisionCacheStatistics();
+  // timeouts per strategy: cache, stack, index, redis, jpf
+  public native int[]   getRecoveryStrategyTimeouts();
+  public native void    resetRecoveryStrategyTimeouts();
+
   // Intered strings
   public native boolean isInStringTable(String str);
 